@@ -25,6 +25,27 @@ ImageViewer::ImageViewer(QWidget* parent)
 	vW->setFillingColor(fillingColor);
 
 	connect(ui->listWidget, &QListWidget::currentRowChanged, this, &ImageViewer::layerSelectionChanged);
+
+	// Limit pamate pre undo historiu v MB
+	vW->setUndoMemoryLimit(settings.value("undo_memory_limit_mb", 32).toLongLong() * 1024 * 1024);
+
+	// Backend kreslenia sceny (Image > Render backend), volba sa pamata
+	QActionGroup* backendGroup = new QActionGroup(this);
+	backendGroup->addAction(ui->actionBackendSoftware);
+	backendGroup->addAction(ui->actionBackendQPainter);
+	backendGroup->addAction(ui->actionBackendNull);
+	RenderBackend::Kind backendKind = RenderBackend::Software;
+	if (RenderBackend::parseKind(settings.value("render_backend", "software").toString(), backendKind)) {
+		setRenderBackend(backendKind);
+	}
+
+#ifndef RENDER_PROFILER
+	ui->actionProfilerOverlay->setVisible(false);
+	ui->actionExportProfilerTrace->setVisible(false);
+#endif
+#ifndef Q_OS_UNIX
+	ui->actionSharedFramebuffer->setVisible(false);
+#endif
 }
 
 // Event filters
@@ -45,6 +66,11 @@ bool ImageViewer::ViewerWidgetEventFilter(QObject* obj, QEvent* event)
 		return false;
 	}
 
+	// Zaznam relacie: udalost so stavom nastrojov este pred spracovanim
+	if (session.isRecording()) {
+		recordSessionEvent(event);
+	}
+
 	if (event->type() == QEvent::MouseButtonPress) {
 		ViewerWidgetMouseButtonPress(w, event);
 	}
@@ -62,6 +88,10 @@ bool ImageViewer::ViewerWidgetEventFilter(QObject* obj, QEvent* event)
 	}
 	else if (event->type() == QEvent::Wheel) {
 		ViewerWidgetWheel(w, event);
+		// Ctrl + koliesko zoomuje, scroll area sa pritom nema posuvat
+		if (static_cast<QWheelEvent*>(event)->modifiers() & Qt::ControlModifier) {
+			return true;
+		}
 	}
 
 	return QObject::eventFilter(obj, event);
@@ -69,9 +99,21 @@ bool ImageViewer::ViewerWidgetEventFilter(QObject* obj, QEvent* event)
 void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 {
 	QMouseEvent* e = static_cast<QMouseEvent*>(event);
+	// Nastroje pracuju v suradniciach dokumentu, nie zoomovaneho widgetu
+	QPoint point = w->toDocument(e->pos());
 	static bool polygonActive = false;
 	static bool curveActive = false;
 
+	//	>> Shape picking (ID rovina vyrezu, bez prechadzania zBuffer)
+	bool drawingTool = ui->toolButtonDrawLine->isChecked() || ui->toolButtonDrawCircle->isChecked() || ui->toolButtonDrawPolygon->isChecked()
+		|| ui->toolButtonDrawCurve->isChecked() || ui->toolButtonDrawRectangle->isChecked();
+	if (e->button() == Qt::LeftButton && (!drawingTool || ui->pushButtonMove->isChecked())) {
+		int index = w->shapeIndexAt(e->pos());
+		if (index >= 0 && index < ui->listWidget->count()) {
+			ui->listWidget->setCurrentRow(index);
+		}
+	}
+
 	//	>> Line Drawing
 	if (e->button() == Qt::LeftButton && ui->toolButtonDrawLine->isChecked() && !ui->pushButtonMove->isChecked())
 	{
@@ -82,7 +124,8 @@ void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 			ui->listWidget->setCurrentRow(newRowIndex);
 			layerSelectionChanged(newRowIndex);
 
-			line = new Line(w->getDrawLineBegin(), e->pos(), layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+			line = new Line(w->getDrawLineBegin(), point, layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+			applyStrokeStyle(*line);
 			w->drawLine(*line);
 			w->addToZBuffer(*line, line->getZBufferPosition());
 
@@ -90,9 +133,9 @@ void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 			w->update();
 		}
 		else {
-			w->setDrawLineBegin(e->pos());
+			w->setDrawLineBegin(point);
 			w->setDrawLineActivated(true);
-			w->setPixel(e->pos().x(), e->pos().y(), borderColor);
+			w->setPixel(point.x(), point.y(), borderColor);
 			w->update();
 		}
 	}
@@ -106,15 +149,17 @@ void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 			int newRowIndex = ui->listWidget->count() - 1;
 			ui->listWidget->setCurrentRow(newRowIndex);
 
-			circle = new Circle(w->getDrawCircleCenter(), e->pos(), layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+			circle = new Circle(w->getDrawCircleCenter(), point, layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+			applyStrokeStyle(*circle);
+			applyFillStyle(*circle);
 			w->drawCircle(*circle);
 			vW->addToZBuffer(*circle, circle->getZBufferPosition());
 			w->setDrawCircleActivated(false);
 		}
 		else {
-			w->setDrawCircleCenter(e->pos());
+			w->setDrawCircleCenter(point);
 			w->setDrawCircleActivated(true);
-			w->setPixel(e->pos().x(), e->pos().y(), borderColor);
+			w->setPixel(point.x(), point.y(), borderColor);
 			w->update();
 		}
 	}
@@ -128,15 +173,17 @@ void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 			ui->listWidget->setCurrentRow(newRowIndex);
 
 			polygon = new MyPolygon(QVector<QPoint>(), layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+			applyStrokeStyle(*polygon);
 			polygonActive = true;
 		}
 
-		w->setPixel(e->pos().x(), e->pos().y(), borderColor);
-		polygon->addPoint(e->pos());
+		w->setPixel(point.x(), point.y(), borderColor);
+		polygon->addPoint(point);
 		w->update();
 	}
 	if (e->button() == Qt::RightButton && ui->toolButtonDrawPolygon->isChecked()) {
 		if (polygonActive) {
+			applyFillStyle(*polygon);
 			w->drawPolygon(*polygon);
 			vW->addToZBuffer(*polygon, polygon->getZBufferPosition());
 			polygonActive = false;
@@ -151,11 +198,12 @@ void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 			ui->listWidget->setCurrentRow(newRowIndex);
 
 			curve = new BezierCurve(QVector<QPoint>(), ui->listWidget->count(), ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+			applyStrokeStyle(*curve);
 			curveActive = true;
 		}
 
-		curve->addPoint(e->pos());
-		w->setPixel(e->pos().x(), e->pos().y(), borderColor);
+		curve->addPoint(point);
+		w->setPixel(point.x(), point.y(), borderColor);
 		w->update();
 	}
 	if (e->button() == Qt::RightButton && ui->toolButtonDrawCurve->isChecked()) {
@@ -175,21 +223,23 @@ void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 			int newRowIndex = ui->listWidget->count() - 1;
 			ui->listWidget->setCurrentRow(newRowIndex);
 			
-			if ((e->pos().y() > w->getDrawRectangleBegin().y() && e->pos().x() > w->getDrawRectangleBegin().x()) || (e->pos().y() < w->getDrawRectangleBegin().y() && w->getDrawRectangleBegin().x() > e->pos().x())) {
-				rectangle = new MyRectangle(w->getDrawRectangleBegin(), QPoint(e->pos().x(), w->getDrawRectangleBegin().y()), e->pos(), QPoint(w->getDrawRectangleBegin().x(), e->pos().y()), layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+			if ((point.y() > w->getDrawRectangleBegin().y() && point.x() > w->getDrawRectangleBegin().x()) || (point.y() < w->getDrawRectangleBegin().y() && w->getDrawRectangleBegin().x() > point.x())) {
+				rectangle = new MyRectangle(w->getDrawRectangleBegin(), QPoint(point.x(), w->getDrawRectangleBegin().y()), point, QPoint(w->getDrawRectangleBegin().x(), point.y()), layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
 			}
 			else {
-				rectangle = new MyRectangle(w->getDrawRectangleBegin(), QPoint(w->getDrawRectangleBegin().x(), e->pos().y()), e->pos(), QPoint(e->pos().x(), w->getDrawRectangleBegin().y()), layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
+				rectangle = new MyRectangle(w->getDrawRectangleBegin(), QPoint(w->getDrawRectangleBegin().x(), point.y()), point, QPoint(point.x(), w->getDrawRectangleBegin().y()), layerIndex, ui->checkBoxFilling->isChecked(), borderColor, fillingColor);
 			}
 
+			applyStrokeStyle(*rectangle);
+			applyFillStyle(*rectangle);
 			w->drawRectangle(*rectangle);
 			vW->addToZBuffer(*rectangle, rectangle->getZBufferPosition());
 			w->setDrawRectangleActivated(false);
 		}
 		else {
-			w->setDrawRectangleBegin(e->pos());
+			w->setDrawRectangleBegin(point);
 			w->setDrawRectangleActivated(true);
-			w->setPixel(e->pos().x(), e->pos().y(), borderColor);
+			w->setPixel(point.x(), point.y(), borderColor);
 			w->update();
 		}
 	}
@@ -197,19 +247,31 @@ void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 void ImageViewer::ViewerWidgetMouseButtonRelease(ViewerWidget* w, QEvent* event)
 {
 	QMouseEvent* e = static_cast<QMouseEvent*>(event);
+
+	// Cely tah mysou je v historii jeden posun
+	if (e->button() == Qt::LeftButton) {
+		w->endEditGroup();
+	}
 }
 void ImageViewer::ViewerWidgetMouseMove(ViewerWidget* w, QEvent* event)
 {
 	QMouseEvent* e = static_cast<QMouseEvent*>(event);
+	// Nastroje pracuju v suradniciach dokumentu, nie zoomovaneho widgetu
+	QPoint point = w->toDocument(e->pos());
+
+	//	>> Hover highlight, len citanie z ID roviny
+	if (!(e->buttons() & Qt::LeftButton)) {
+		w->setHoveredShape(w->shapeIndexAt(e->pos()));
+	}
 
 	//	>> Polygon Movement
 	if (ui->toolButtonDrawPolygon->isChecked()) {
 		if (e->buttons() & Qt::LeftButton && ui->pushButtonMove->isChecked()) {
-			QPoint offset = e->pos() -  w->getMoveStart();
+			QPoint offset = point -  w->getMoveStart();
 			if (!w->getMoveStart().isNull()) {
 				w->movePolygon(offset);
 			}
-			w->setMoveStart(e->pos());
+			w->setMoveStart(point);
 		}
 		else if (ui->pushButtonMove->isChecked()) {
 			w->setMoveStart(QPoint());
@@ -219,11 +281,11 @@ void ImageViewer::ViewerWidgetMouseMove(ViewerWidget* w, QEvent* event)
 	//	>> Line Movement
 	if (ui->toolButtonDrawLine->isChecked()) {
 		if (e->buttons() & Qt::LeftButton && ui->pushButtonMove->isChecked()) {
-			QPoint offset = e->pos() - w->getMoveStart();
+			QPoint offset = point - w->getMoveStart();
 			if (!w->getMoveStart().isNull()) {
 				w->moveLine(offset);
 			}
-			w->setMoveStart(e->pos());
+			w->setMoveStart(point);
 		}
 		else if (ui->pushButtonMove->isChecked()) {
 			w->setMoveStart(QPoint());
@@ -233,11 +295,11 @@ void ImageViewer::ViewerWidgetMouseMove(ViewerWidget* w, QEvent* event)
 	//	>> Curve Movement
 	if (ui->toolButtonDrawCurve->isChecked()) {
 		if (e->buttons() & Qt::LeftButton && ui->pushButtonMove->isChecked()) {
-			QPoint offset = e->pos() - w->getMoveStart();
+			QPoint offset = point - w->getMoveStart();
 			if (!w->getMoveStart().isNull()) {
 				w->moveCurve(offset);
 			}
-			w->setMoveStart(e->pos());
+			w->setMoveStart(point);
 		}
 		else if (ui->pushButtonMove->isChecked()) {
 			w->setMoveStart(QPoint());
@@ -247,11 +309,11 @@ void ImageViewer::ViewerWidgetMouseMove(ViewerWidget* w, QEvent* event)
 	//	>> Circle Movement
 	if (ui->toolButtonDrawCircle->isChecked()) {
 		if (e->buttons() & Qt::LeftButton && ui->pushButtonMove->isChecked()) {
-			QPoint offset = e->pos() - w->getMoveStart();
+			QPoint offset = point - w->getMoveStart();
 			if (!w->getMoveStart().isNull()) {
 				w->moveCircle(offset);
 			}
-			w->setMoveStart(e->pos());
+			w->setMoveStart(point);
 		}
 		else if (ui->pushButtonMove->isChecked()) {
 			w->setMoveStart(QPoint());
@@ -261,11 +323,11 @@ void ImageViewer::ViewerWidgetMouseMove(ViewerWidget* w, QEvent* event)
 	//	>> Rectangle Movement
 	if (ui->toolButtonDrawRectangle->isChecked()) {
 		if (e->buttons() & Qt::LeftButton && ui->pushButtonMove->isChecked()) {
-			QPoint offset = e->pos() - w->getMoveStart();
+			QPoint offset = point - w->getMoveStart();
 			if (!w->getMoveStart().isNull()) {
 				w->moveRectangle(offset);
 			}
-			w->setMoveStart(e->pos());
+			w->setMoveStart(point);
 		}
 		else if (ui->pushButtonMove->isChecked()) {
 			w->setMoveStart(QPoint());
@@ -274,6 +336,7 @@ void ImageViewer::ViewerWidgetMouseMove(ViewerWidget* w, QEvent* event)
 }
 void ImageViewer::ViewerWidgetLeave(ViewerWidget* w, QEvent* event)
 {
+	w->setHoveredShape(-1);
 }
 void ImageViewer::ViewerWidgetEnter(ViewerWidget* w, QEvent* event)
 {
@@ -282,6 +345,14 @@ void ImageViewer::ViewerWidgetWheel(ViewerWidget* w, QEvent* event)
 {
 	QWheelEvent* wheelEvent = static_cast<QWheelEvent*>(event);
 
+	if (wheelEvent->modifiers() & Qt::ControlModifier) {
+		int deltaY = wheelEvent->angleDelta().y();
+		if (deltaY != 0) {
+			zoomView(deltaY > 0 ? 1.25 : 0.8, wheelEvent->position().toPoint());
+		}
+		return;
+	}
+
 	if (ui->checkBoxScale->isChecked()) {
 		int deltaY = wheelEvent->angleDelta().y();
 		double scale = 1.0;
@@ -332,11 +403,46 @@ bool ImageViewer::openImage(QString filename)
 }
 bool ImageViewer::saveImage(QString filename)
 {
-	QFileInfo fi(filename);
-	QString extension = fi.completeSuffix();
+	if (vW->isEmpty()) {
+		return false;
+	}
+
+	// Editor drzi len viditelny vyrez, cely dokument sa vyrenderuje az pre export.
+	// Kreslenie aj kodovanie bezi na pozadi nad kopiou sceny, editor medzitym zostava plne pouzitelny
+	ImageExporter* exporter = new ImageExporter(this);
+	QProgressDialog* progress = new QProgressDialog(QString("Exporting %1...").arg(QFileInfo(filename).fileName()), "Cancel", 0, 100, this);
+	progress->setWindowModality(Qt::NonModal);
+	progress->setMinimumDuration(300);
+	progress->setValue(0);
+
+	connect(exporter, &ImageExporter::progressChanged, progress, &QProgressDialog::setValue);
+	connect(progress, &QProgressDialog::canceled, exporter, &ImageExporter::cancel);
+	connect(exporter, &ImageExporter::finished, this, [this, exporter, progress](bool success, bool canceled, const QString& fileName, const QString& errorMessage) {
+		progress->deleteLater();
+		exporter->deleteLater();
+
+		if (canceled) {
+			ui->statusBar->showMessage(QString("Export of %1 canceled.").arg(fileName), 3000);
+			return;
+		}
 
-	QImage* img = vW->getImage();
-	return img->save(filename, extension.toStdString().c_str());
+		if (!success) {
+			msgBox.setText(QString("Unable to save image: %1").arg(errorMessage));
+			msgBox.setIcon(QMessageBox::Warning);
+		}
+		else {
+			msgBox.setText(QString("File %1 saved.").arg(fileName));
+			msgBox.setIcon(QMessageBox::Information);
+		}
+		msgBox.exec();
+		});
+
+	if (!exporter->start(vW->exportDocument(), filename)) {
+		delete progress;
+		delete exporter;
+		return false;
+	}
+	return true;
 }
 
 //-----------------------------------------
@@ -361,12 +467,57 @@ void ImageViewer::on_actionSave_as_triggered()
 		if (!saveImage(fileName)) {
 			msgBox.setText("Unable to save image.");
 			msgBox.setIcon(QMessageBox::Warning);
+			msgBox.exec();
 		}
-		else {
-			msgBox.setText(QString("File %1 saved.").arg(fileName));
-			msgBox.setIcon(QMessageBox::Information);
+	}
+}
+
+void ImageViewer::on_actionUndo_triggered()
+{
+	if (!vW->canUndo()) {
+		ui->statusBar->showMessage("Nothing to undo.", 2000);
+		return;
+	}
+	applyHistoryStep(vW->undo());
+}
+
+void ImageViewer::on_actionRedo_triggered()
+{
+	if (!vW->canRedo()) {
+		ui->statusBar->showMessage("Nothing to redo.", 2000);
+		return;
+	}
+	applyHistoryStep(vW->redo());
+}
+
+// Zoznam vrstiev musi po undo/redo zodpovedat zBuffer
+void ImageViewer::applyHistoryStep(const EditHistory::Step& step)
+{
+	switch (step.kind) {
+	case EditHistory::Insert: {
+		Shape& shape = vW->getZBuffer()[step.index].first.get();
+		ui->listWidget->insertItem(step.index, SceneFile::shapeTypeName(shape.getType()) + " " + QString::number(shape.getZBufferPosition() + 1));
+		ui->listWidget->setCurrentRow(step.index);
+		break;
+	}
+	case EditHistory::Remove:
+		delete ui->listWidget->takeItem(step.index);
+		break;
+	case EditHistory::SwapLayers: {
+		QListWidgetItem* item = ui->listWidget->takeItem(step.index);
+		ui->listWidget->insertItem(step.index - 1, item);
+		ui->listWidget->setCurrentRow(step.index - 1);
+		break;
+	}
+	case EditHistory::None:
+		// Historia nesedela so scenou a bola zahodena, zoznam sa postavi znova
+		ui->listWidget->clear();
+		for (const auto& pair : vW->getZBuffer()) {
+			ui->listWidget->addItem(SceneFile::shapeTypeName(pair.first.get().getType()) + " " + QString::number(pair.second + 1));
 		}
-		msgBox.exec();
+		break;
+	default:
+		break;
 	}
 }
 
@@ -390,6 +541,441 @@ void ImageViewer::on_actionClear_triggered()
 	vW->clear();
 }
 
+void ImageViewer::on_actionResize_triggered()
+{
+	bool ok = false;
+	int width = QInputDialog::getInt(this, "Resize", "Width:", vW->getImgWidth(), 1, 65536, 1, &ok);
+	if (!ok) {
+		return;
+	}
+	int height = QInputDialog::getInt(this, "Resize", "Height:", vW->getImgHeight(), 1, 65536, 1, &ok);
+	if (!ok) {
+		return;
+	}
+
+	if (!vW->changeSize(width, height)) {
+		msgBox.setText("Unable to resize image.");
+		msgBox.setIcon(QMessageBox::Warning);
+		msgBox.exec();
+		return;
+	}
+	vW->redrawAllShapes();
+}
+
+void ImageViewer::on_actionZoomIn_triggered()
+{
+	zoomView(1.25, vW->visibleArea().center());
+}
+
+void ImageViewer::on_actionZoomOut_triggered()
+{
+	zoomView(0.8, vW->visibleArea().center());
+}
+
+void ImageViewer::on_actionZoomReset_triggered()
+{
+	zoomView(1.0 / vW->getZoom(), vW->visibleArea().center());
+}
+
+void ImageViewer::setRenderBackend(RenderBackend::Kind kind)
+{
+	QAction* actions[] = { ui->actionBackendSoftware, ui->actionBackendQPainter, ui->actionBackendNull };
+	actions[kind]->setChecked(true);
+	vW->setRenderBackend(kind);
+	settings.setValue("render_backend", RenderBackend::kindName(kind));
+
+	// Vyber kliknutim a hlbkovy test vie len vlastny rasterizer, null backend nekresli nic
+	if (kind != RenderBackend::Software) {
+		ui->statusBar->showMessage(QString("Render backend: %1 (no picking%2).").arg(RenderBackend::kindName(kind))
+			.arg(kind == RenderBackend::Null ? ", shapes are only counted" : ""), 3000);
+	}
+}
+
+void ImageViewer::on_actionBackendSoftware_triggered()
+{
+	setRenderBackend(RenderBackend::Software);
+}
+
+void ImageViewer::on_actionBackendQPainter_triggered()
+{
+	setRenderBackend(RenderBackend::Painter);
+}
+
+void ImageViewer::on_actionBackendNull_triggered()
+{
+	setRenderBackend(RenderBackend::Null);
+}
+
+void ImageViewer::on_actionProfilerOverlay_toggled(bool checked)
+{
+	vW->setProfilerOverlay(checked);
+	if (checked) {
+		vW->redrawAllShapes();
+	}
+}
+
+void ImageViewer::on_actionExportProfilerTrace_triggered()
+{
+	if (FrameProfiler::instance().frameCount() == 0) {
+		msgBox.setText("No profiled frames yet. Enable the profiler overlay first.");
+		msgBox.setIcon(QMessageBox::Information);
+		msgBox.exec();
+		return;
+	}
+
+	QString fileName = QFileDialog::getSaveFileName(this, "Export profiler trace", settings.value("folder_img_save_path", "").toString(), "Chrome trace (*.json)");
+	if (fileName.isEmpty()) {
+		return;
+	}
+
+	QString errorMessage;
+	if (!FrameProfiler::instance().exportChromeTrace(fileName, &errorMessage)) {
+		msgBox.setText(QString("Unable to export trace: %1").arg(errorMessage));
+		msgBox.setIcon(QMessageBox::Warning);
+		msgBox.exec();
+		return;
+	}
+	ui->statusBar->showMessage(QString("Trace with %1 frames saved to %2.").arg(FrameProfiler::instance().frameCount()).arg(fileName), 3000);
+}
+
+void ImageViewer::on_actionRecordSession_toggled(bool checked)
+{
+	if (checked) {
+		session.start(QSize(vW->getImgWidth(), vW->getImgHeight()), SceneFile::serialize(vW->getZBuffer()));
+		ui->statusBar->showMessage("Recording session...", 2000);
+		return;
+	}
+
+	session.stop();
+	if (session.getEvents().empty()) {
+		ui->statusBar->showMessage("No events recorded.", 2000);
+		return;
+	}
+
+	QString fileName = QFileDialog::getSaveFileName(this, "Save session", settings.value("folder_img_save_path", "").toString(), "Sessions (*.session)");
+	if (fileName.isEmpty()) {
+		return;
+	}
+
+	QString errorMessage;
+	if (!session.save(fileName, &errorMessage)) {
+		msgBox.setText(QString("Unable to save session: %1").arg(errorMessage));
+		msgBox.setIcon(QMessageBox::Warning);
+		msgBox.exec();
+		return;
+	}
+	ui->statusBar->showMessage(QString("%1 events (%2 s) saved to %3.").arg(session.getEvents().size())
+		.arg(session.durationNs() / 1e9, 0, 'f', 1).arg(fileName), 3000);
+}
+
+// Meno segmentu sa da zmenit v nastaveniach (shared_framebuffer_name), citatel: FrameTap <meno>
+void ImageViewer::on_actionSharedFramebuffer_toggled(bool checked)
+{
+	if (!checked) {
+		vW->setSharedFramebuffer(QString());
+		ui->statusBar->showMessage("Shared-memory publishing stopped.", 2000);
+		return;
+	}
+
+	QString name = settings.value("shared_framebuffer_name", SharedFramebuffer::DefaultName).toString();
+	QString errorMessage;
+	if (!vW->setSharedFramebuffer(name, &errorMessage)) {
+		QSignalBlocker blocker(ui->actionSharedFramebuffer);
+		ui->actionSharedFramebuffer->setChecked(false);
+		msgBox.setText(QString("Unable to create shared framebuffer: %1").arg(errorMessage));
+		msgBox.setIcon(QMessageBox::Warning);
+		msgBox.exec();
+		return;
+	}
+	ui->statusBar->showMessage(QString("Publishing canvas frames to shared memory %1.").arg(name), 3000);
+}
+
+//-----------------------------------------
+//		*** Session record/replay ***
+//-----------------------------------------
+
+SessionRecording::ToolState ImageViewer::currentToolState() const
+{
+	SessionRecording::ToolState state;
+	state.tools = (ui->toolButtonDrawLine->isChecked() ? SessionRecording::LineTool : 0)
+		| (ui->toolButtonDrawCircle->isChecked() ? SessionRecording::CircleTool : 0)
+		| (ui->toolButtonDrawPolygon->isChecked() ? SessionRecording::PolygonTool : 0)
+		| (ui->toolButtonDrawCurve->isChecked() ? SessionRecording::CurveTool : 0)
+		| (ui->toolButtonDrawRectangle->isChecked() ? SessionRecording::RectangleTool : 0);
+	state.move = ui->pushButtonMove->isChecked();
+	state.scale = ui->checkBoxScale->isChecked();
+	state.filling = ui->checkBoxFilling->isChecked();
+	state.borderColor = borderColor.rgba();
+	state.fillingColor = fillingColor.rgba();
+	state.strokeWidth = ui->spinBoxStrokeWidth->value();
+	state.join = ui->comboBoxJoin->currentIndex();
+	state.cap = ui->comboBoxCap->currentIndex();
+	state.fillStyle = ui->comboBoxFillStyle->currentIndex();
+	state.layer = ui->listWidget->currentRow();
+	state.zoom = vW->getZoom();
+	return state;
+}
+
+void ImageViewer::applyToolState(const SessionRecording::ToolState& state)
+{
+	ui->toolButtonDrawLine->setChecked((state.tools & SessionRecording::LineTool) != 0);
+	ui->toolButtonDrawCircle->setChecked((state.tools & SessionRecording::CircleTool) != 0);
+	ui->toolButtonDrawPolygon->setChecked((state.tools & SessionRecording::PolygonTool) != 0);
+	ui->toolButtonDrawCurve->setChecked((state.tools & SessionRecording::CurveTool) != 0);
+	ui->toolButtonDrawRectangle->setChecked((state.tools & SessionRecording::RectangleTool) != 0);
+	ui->pushButtonMove->setChecked(state.move);
+	ui->checkBoxScale->setChecked(state.scale);
+	ui->checkBoxFilling->setChecked(state.filling);
+
+	borderColor = QColor::fromRgba(state.borderColor);
+	fillingColor = QColor::fromRgba(state.fillingColor);
+	vW->setBorderColor(borderColor);
+	vW->setFillingColor(fillingColor);
+
+	ui->spinBoxStrokeWidth->setValue(state.strokeWidth);
+	ui->comboBoxJoin->setCurrentIndex(state.join);
+	ui->comboBoxCap->setCurrentIndex(state.cap);
+	ui->comboBoxFillStyle->setCurrentIndex(state.fillStyle);
+
+	if (state.layer < ui->listWidget->count() && state.layer != ui->listWidget->currentRow()) {
+		ui->listWidget->setCurrentRow(state.layer);
+	}
+	if (state.zoom != vW->getZoom()) {
+		vW->setZoom(state.zoom);
+	}
+}
+
+void ImageViewer::recordSessionEvent(QEvent* event)
+{
+	switch (event->type()) {
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+	case QEvent::MouseMove: {
+		QMouseEvent* e = static_cast<QMouseEvent*>(event);
+		SessionRecording::EventType type = event->type() == QEvent::MouseButtonPress ? SessionRecording::Press
+			: event->type() == QEvent::MouseButtonRelease ? SessionRecording::Release : SessionRecording::Move;
+		session.record(type, e->pos(), e->button(), e->buttons().toInt(), e->modifiers().toInt(), 0, currentToolState());
+		break;
+	}
+	case QEvent::Wheel: {
+		QWheelEvent* e = static_cast<QWheelEvent*>(event);
+		session.record(SessionRecording::Wheel, e->position().toPoint(), 0, e->buttons().toInt(), e->modifiers().toInt(), e->angleDelta().y(), currentToolState());
+		break;
+	}
+	case QEvent::Enter:
+		session.record(SessionRecording::Enter, QPoint(), 0, 0, 0, 0, currentToolState());
+		break;
+	case QEvent::Leave:
+		session.record(SessionRecording::Leave, QPoint(), 0, 0, 0, 0, currentToolState());
+		break;
+	default:
+		break;
+	}
+}
+
+void ImageViewer::restoreSessionScene(const SessionRecording& recording)
+{
+	std::vector<std::unique_ptr<Shape>> shapes;
+	recording.sceneShapes(shapes);
+
+	vW->clearZBuffer();
+	ui->listWidget->clear();
+	for (std::unique_ptr<Shape>& shape : shapes) {
+		int zBufferPosition = shape->getZBufferPosition();
+		ui->listWidget->addItem(SceneFile::shapeTypeName(shape->getType()) + " " + QString::number(zBufferPosition + 1));
+		vW->addToZBuffer(*shape.release(), zBufferPosition, false);
+	}
+	vW->redrawAllShapes();
+}
+
+// Zaznamenana udalost znova ako Qt udalost na platno, prejde rovnakym filtrom ako zivy vstup
+static void sendSessionEvent(QWidget* target, const SessionRecording::Event& recorded)
+{
+	QPointF local(recorded.pos);
+	QPointF global = target->mapToGlobal(local);
+	Qt::MouseButtons buttons = Qt::MouseButtons::fromInt(recorded.buttons);
+	Qt::KeyboardModifiers modifiers = Qt::KeyboardModifiers::fromInt(recorded.modifiers);
+
+	switch (recorded.type) {
+	case SessionRecording::Press:
+	case SessionRecording::Release:
+	case SessionRecording::Move: {
+		QEvent::Type type = recorded.type == SessionRecording::Press ? QEvent::MouseButtonPress
+			: recorded.type == SessionRecording::Release ? QEvent::MouseButtonRelease : QEvent::MouseMove;
+		QMouseEvent event(type, local, global, static_cast<Qt::MouseButton>(recorded.button), buttons, modifiers);
+		QCoreApplication::sendEvent(target, &event);
+		break;
+	}
+	case SessionRecording::Wheel: {
+		QWheelEvent event(local, global, QPoint(), QPoint(0, recorded.wheelDelta), buttons, modifiers, Qt::NoScrollPhase, false);
+		QCoreApplication::sendEvent(target, &event);
+		break;
+	}
+	case SessionRecording::Enter: {
+		QEnterEvent event(local, local, global);
+		QCoreApplication::sendEvent(target, &event);
+		break;
+	}
+	case SessionRecording::Leave: {
+		QEvent event(QEvent::Leave);
+		QCoreApplication::sendEvent(target, &event);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+// Spracovanie = filter udalosti a nastroj editora; snimka = od casu udalosti po dokresleny widget (repaint).
+// V povodnom tempe sa na udalost caka podla zaznamu - ak editor nestiha, dalsia udalost uz meska a jej
+// latencia snimky zahrnie aj cakanie. Bez cakania (flat out) ide udalost hned po dokresleni predchadzajucej.
+int ImageViewer::replaySession(const QString& filePath, bool realTime, double budgetP99Ms, const QString& eventsPath)
+{
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	SessionRecording recording;
+	QString errorMessage;
+	if (!recording.load(filePath, &errorMessage)) {
+		err << "Unable to load session " << filePath << ": " << errorMessage << "\n";
+		return 2;
+	}
+	if (!vW->changeSize(recording.getCanvasSize().width(), recording.getCanvasSize().height())) {
+		err << "Unable to allocate canvas.\n";
+		return 2;
+	}
+	restoreSessionScene(recording);
+	QCoreApplication::processEvents();
+
+	const std::vector<SessionRecording::Event>& events = recording.getEvents();
+	std::vector<qint64> processingNs(events.size());
+	std::vector<qint64> frameNs(events.size());
+	int appliedState = -1;
+
+	QElapsedTimer clock;
+	clock.start();
+	for (size_t i = 0; i < events.size(); i++) {
+		const SessionRecording::Event& recorded = events[i];
+		if (recorded.toolState != appliedState) {
+			applyToolState(recording.getToolStates()[recorded.toolState]);
+			appliedState = recorded.toolState;
+		}
+
+		qint64 scheduled = realTime ? recorded.timeNs : clock.nsecsElapsed();
+		for (qint64 wait = scheduled - clock.nsecsElapsed(); wait > 0; wait = scheduled - clock.nsecsElapsed()) {
+			if (wait > 2000000) {
+				QThread::usleep(static_cast<unsigned long>((wait - 1000000) / 1000));
+			}
+		}
+
+		qint64 begin = clock.nsecsElapsed();
+		sendSessionEvent(vW, recorded);
+		qint64 handled = clock.nsecsElapsed();
+		vW->repaint();
+		qint64 presented = clock.nsecsElapsed();
+
+		processingNs[i] = handled - begin;
+		frameNs[i] = presented - scheduled;
+		QCoreApplication::processEvents();
+	}
+	qint64 replayNs = clock.nsecsElapsed();
+
+	if (!eventsPath.isEmpty()) {
+		QFile eventsFile(eventsPath);
+		if (!eventsFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+			err << "Unable to write " << eventsPath << ": " << eventsFile.errorString() << "\n";
+			return 2;
+		}
+		QTextStream eventsOut(&eventsFile);
+		eventsOut << "Index,Type,TimeMs,ProcessingMs,FrameMs\n";
+		for (size_t i = 0; i < events.size(); i++) {
+			eventsOut << QString("%1,%2,%3,%4,%5\n").arg(i).arg(SessionRecording::eventTypeName(events[i].type))
+				.arg(events[i].timeNs / 1e6, 0, 'f', 3).arg(processingNs[i] / 1e6, 0, 'f', 3).arg(frameNs[i] / 1e6, 0, 'f', 3);
+		}
+	}
+
+	auto row = [&out](const QString& name, const SessionRecording::LatencySummary& summary) {
+		out << QString("%1 %2 %3 %4 %5 %6\n").arg(name, -20).arg(summary.count, 8)
+			.arg(summary.meanMs, 9, 'f', 3).arg(summary.p50Ms, 9, 'f', 3).arg(summary.p99Ms, 9, 'f', 3).arg(summary.maxMs, 9, 'f', 3);
+	};
+
+	out << QString("%1: %2 events over %3 s, replayed %4 in %5 s (%6 backend)\n")
+		.arg(QFileInfo(filePath).fileName()).arg(events.size()).arg(recording.durationNs() / 1e9, 0, 'f', 2)
+		.arg(realTime ? "at the recorded rate" : "flat out").arg(replayNs / 1e9, 0, 'f', 2).arg(RenderBackend::kindName(vW->getRenderBackend()));
+	out << QString("%1 %2 %3 %4 %5 %6\n").arg("", -20).arg("count", 8).arg("mean ms", 9).arg("p50 ms", 9).arg("p99 ms", 9).arg("max ms", 9);
+	for (int type = 0; type < SessionRecording::EventTypeCount; type++) {
+		std::vector<qint64> samples;
+		for (size_t i = 0; i < events.size(); i++) {
+			if (events[i].type == type) {
+				samples.push_back(processingNs[i]);
+			}
+		}
+		if (!samples.empty()) {
+			row(QString("%1 processing").arg(SessionRecording::eventTypeName(static_cast<SessionRecording::EventType>(type))), SessionRecording::summarize(samples));
+		}
+	}
+	row("all processing", SessionRecording::summarize(processingNs));
+	SessionRecording::LatencySummary frames = SessionRecording::summarize(frameNs);
+	row("frame latency", frames);
+
+	if (budgetP99Ms > 0 && frames.p99Ms > budgetP99Ms) {
+		out << QString("FAILED: p99 frame latency %1 ms exceeds the budget of %2 ms\n").arg(frames.p99Ms, 0, 'f', 3).arg(budgetP99Ms, 0, 'f', 3);
+		return 1;
+	}
+	return 0;
+}
+
+// Hrubka, spoje a konce obrysu noveho tvaru podla volby v paneli Drawing (poradie poloziek v comboboxoch)
+void ImageViewer::applyStrokeStyle(Shape& shape)
+{
+	static const Qt::PenJoinStyle joins[] = { Qt::MiterJoin, Qt::BevelJoin, Qt::RoundJoin };
+	static const Qt::PenCapStyle caps[] = { Qt::FlatCap, Qt::SquareCap, Qt::RoundCap };
+	shape.setStrokeWidth(ui->spinBoxStrokeWidth->value());
+	shape.setJoinStyle(joins[qBound(0, ui->comboBoxJoin->currentIndex(), 2)]);
+	shape.setCapStyle(caps[qBound(0, ui->comboBoxCap->currentIndex(), 2)]);
+}
+
+// Gradient vyplne noveho tvaru (az ked ma vsetky body): z farby vyplne do farby obrysu cez obalku tvaru,
+// linearny zlava doprava, radialny od stredu po roh obalky. Suradnice su relativne k prvemu bodu tvaru.
+void ImageViewer::applyFillStyle(Shape& shape)
+{
+	int style = ui->comboBoxFillStyle->currentIndex();
+	if (style <= 0 || !shape.getIsFilled() || shape.getPoints().isEmpty()) {
+		shape.setFillShader(nullptr);
+		return;
+	}
+
+	QRectF bounds = QRectF(Rasterizer::shapeBounds(shape).translated(-shape.getPoints().first()));
+	QVector<FillShader::Stop> stops = { { 0.0, shape.getFillingColor() }, { 1.0, shape.getBorderColor() } };
+	if (style == 1) {
+		shape.setFillShader(std::make_shared<FillShader>(FillShader::linear(QPointF(bounds.left(), bounds.center().y()),
+			QPointF(bounds.right(), bounds.center().y()), stops)));
+	}
+	else {
+		QPointF corner = bounds.topLeft() - bounds.center();
+		shape.setFillShader(std::make_shared<FillShader>(FillShader::radial(bounds.center(), std::sqrt(QPointF::dotProduct(corner, corner)), stops)));
+	}
+}
+
+// Bod dokumentu pod anchor (suradnice widgetu) ostane po zmene zoomu na rovnakom mieste v okne
+void ImageViewer::zoomView(double factor, const QPoint& anchor)
+{
+	double oldZoom = vW->getZoom();
+	QPointF documentPoint = QPointF(anchor) / oldZoom;
+	QPoint anchorInViewport = anchor + vW->pos();
+
+	vW->setZoom(oldZoom * factor);
+	double newZoom = vW->getZoom();
+	if (newZoom == oldZoom) {
+		return;
+	}
+
+	QPointF newAnchor = documentPoint * newZoom;
+	ui->scrollArea->horizontalScrollBar()->setValue(qRound(newAnchor.x()) - anchorInViewport.x());
+	ui->scrollArea->verticalScrollBar()->setValue(qRound(newAnchor.y()) - anchorInViewport.y());
+	ui->statusBar->showMessage(QString("Zoom %1%").arg(qRound(newZoom * 100)), 2000);
+}
+
 void ImageViewer::on_actionExit_triggered()
 {
 	this->close();
@@ -495,8 +1081,6 @@ void ImageViewer::on_pushButtonLayerDown_clicked() {
 		ui->listWidget->insertItem(newRowIndex, currentItem);
 
 		ui->listWidget->setCurrentRow(newRowIndex);
-
-		vW->redrawAllShapes();
 	}
 	else {
 		QMessageBox::warning(this, "Invalid Depth", "You have reached the minimum depth for Z-Buffer.");
@@ -524,81 +1108,63 @@ void ImageViewer::on_pushButtonSaveImage_clicked() {
 }
 
 void ImageViewer::on_pushButtonLoadImage_clicked() {
-	QString filePath = QFileDialog::getOpenFileName(this, "Load Image State", "C:\\Pocitacova_grafika_projects\\ImageViewer_projekt_zaverecny", "CSV Files (*.csv)");
+	QString filePath = QFileDialog::getOpenFileName(this, "Load Image State", "C:\\Pocitacova_grafika_projects\\ImageViewer_projekt_zaverecny", "Scene Files (*.csv *.cscene);;CSV Files (*.csv);;Compact Scenes (*.cscene)");
 	if (filePath.isEmpty()) {
 		return;
 	}
 
-	QFile file(filePath);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-		QMessageBox::warning(this, "File Error", "Unable to open file for reading.");
+	// Neulozene zmeny aktualnej sceny sa zahodia (inak by sa pri tej istej scene ponukli na obnovu)
+	vW->detachJournal();
+
+	std::vector<std::unique_ptr<Shape>> shapes;
+	QString errorMessage;
+	int skippedShapes = 0;
+	int journalRecords = 0;
+	int unsavedRecords = 0;
+	if (!SceneFile::load(filePath, shapes, &errorMessage, &skippedShapes, &journalRecords, &unsavedRecords)) {
+		QMessageBox::warning(this, "File Error", errorMessage);
 		return;
 	}
 
-	vW->clearZBuffer();
-	ui->listWidget->clear();
-
-	QTextStream in(&file);
-
-	in.readLine();
-
-	while (!in.atEnd()) {
-		QString line = in.readLine();
-		QStringList fields = line.split(',');
-
-		if (fields.size() < 6) {
-			QMessageBox::warning(this, "File Error", "Invalid file format.");
-			return;
-		}
-
-		QString shapeType = fields[0];
-		int zBufferPosition = fields[1].toInt();
-		bool isFilled = (fields[2] == "true");
-		QColor borderColor(fields[3]);
-		QColor fillingColor(fields[4]);
-
-		QVector<QPoint> points;
-		QString pointsStr = fields.mid(5).join(",");
-		QStringList pointPairs = pointsStr.split(' ', Qt::SkipEmptyParts);
-		for (const QString& pair : pointPairs) {
-			QString cleanPair = pair.trimmed().remove('(').remove(')');
-			QStringList coords = cleanPair.split(',');
-			if (coords.size() == 2) {
-				int x = coords[0].toInt();
-				int y = coords[1].toInt();
-				points.append(QPoint(x, y));
+	// Zmeny, ktore sa pred padom nestihli ulozit, sa len ponuknu; bez suhlasu ostane ulozeny stav
+	bool recovered = false;
+	bool partialRecovery = false;
+	if (unsavedRecords > 0) {
+		QMessageBox::StandardButton answer = QMessageBox::question(this, "Recover Changes",
+			QString("%1 unsaved changes from a previous session were found. Recover them?").arg(unsavedRecords));
+		if (answer == QMessageBox::Yes) {
+			int applied = SceneJournal::recover(filePath, shapes);
+			recovered = applied == unsavedRecords;
+			partialRecovery = !recovered;
+			if (partialRecovery) {
+				QMessageBox::warning(this, "File Error", QString("Only %1 of %2 unsaved changes could be recovered.").arg(applied).arg(unsavedRecords));
 			}
 		}
+	}
 
-		Shape* shape = nullptr;
-		if (shapeType == "Line" && points.size() == 2) {
-			shape = new Line(points[0], points[1], zBufferPosition, isFilled, borderColor, fillingColor);
-		}
-		else if (shapeType == "Rectangle" && points.size() == 4) {
-			shape = new MyRectangle(points[0], points[1], points[2], points[3], zBufferPosition, isFilled, borderColor, fillingColor);
-		}
-		else if (shapeType == "Polygon" && points.size() >= 3) {
-			shape = new MyPolygon(points, zBufferPosition, isFilled, borderColor, fillingColor);
-		}
-		else if (shapeType == "Circle" && points.size() == 2) {
-			shape = new Circle(points[0], points[1], zBufferPosition, isFilled, borderColor, fillingColor);
-		}
-		else if (shapeType == "BezierCurve" && points.size() >= 3) {
-			shape = new BezierCurve(points, zBufferPosition, isFilled, borderColor, fillingColor);
-		}
-		else {
-			QMessageBox::warning(this, "File Error", "Invalid shape type or points in file.");
-			continue;
-		}
+	vW->clearZBuffer();
+	ui->listWidget->clear();
 
-		if (shape != nullptr) {
-			vW->addToZBuffer(*shape, zBufferPosition);
-			ui->listWidget->addItem(shapeType + " " + QString::number(zBufferPosition + 1));
-		}
+	for (std::unique_ptr<Shape>& shape : shapes) {
+		int zBufferPosition = shape->getZBufferPosition();
+		ui->listWidget->addItem(SceneFile::shapeTypeName(shape->getType()) + " " + QString::number(zBufferPosition + 1));
+		vW->addToZBuffer(*shape.release(), zBufferPosition, false);
+	}
+
+	if (skippedShapes > 0) {
+		QMessageBox::warning(this, "File Error", "Invalid shape type or points in file.");
 	}
 
-	file.close();
 	vW->redrawAllShapes();
 
+	// Dalsie ulozenia do tohto suboru len dopisu zurnal (snimka zurnalu je CSV, kompaktna scena ho nema).
+	// Po ciastocnej obnove zurnal nesedi so scenou: bez neho sa pri ulozeni zapise cela scena
+	if (!CompactScene::isCompactFile(filePath) && !partialRecovery) {
+		vW->attachJournal(filePath, recovered);
+	}
+	if (journalRecords > 0) {
+		ui->statusBar->showMessage(QString("%1 saved changes replayed from the scene journal.").arg(journalRecords), 5000);
+	}
+
 	QMessageBox::information(this, "Load Successful", "The saved state has been loaded successfully.");
 }
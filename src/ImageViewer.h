@@ -6,6 +6,8 @@
 #include "ViewerWidget.h"
 #include "lighting.h"
 #include "representation.h"
+#include "ImageExporter.h"
+#include "SessionRecording.h"
 
 class ImageViewer : public QMainWindow
 {
@@ -14,6 +16,9 @@ class ImageViewer : public QMainWindow
 public:
 	ImageViewer(QWidget* parent = Q_NULLPTR);
 
+	// Bez okna (QT_QPA_PLATFORM=offscreen): prehra zaznam relacie a vypise latencie; navratovy kod procesu
+	int replaySession(const QString& filePath, bool realTime, double budgetP99Ms, const QString& eventsPath);
+
 private:
 	Ui::ImageViewerClass* ui;
 	ViewerWidget* vW;
@@ -26,6 +31,8 @@ private:
 	bool objectLoaded = false;
 	int currentLayer;
 
+	SessionRecording session;
+
 	MyPolygon* polygon = nullptr;
 	MyRectangle* rectangle = nullptr;
 	BezierCurve* curve = nullptr;
@@ -50,10 +57,32 @@ private:
 	//Image functions
 	bool openImage(QString filename);
 	bool saveImage(QString filename);
+	void zoomView(double factor, const QPoint& anchor);
+	void applyHistoryStep(const EditHistory::Step& step);
+	void applyStrokeStyle(Shape& shape);
+	void applyFillStyle(Shape& shape);
+	void setRenderBackend(RenderBackend::Kind kind);
+	SessionRecording::ToolState currentToolState() const;
+	void applyToolState(const SessionRecording::ToolState& state);
+	void restoreSessionScene(const SessionRecording& recording);
+	void recordSessionEvent(QEvent* event);
 
 private slots:
 	void on_actionSave_as_triggered();
+	void on_actionUndo_triggered();
+	void on_actionRedo_triggered();
 	void on_actionClear_triggered();
+	void on_actionResize_triggered();
+	void on_actionZoomIn_triggered();
+	void on_actionZoomOut_triggered();
+	void on_actionZoomReset_triggered();
+	void on_actionBackendSoftware_triggered();
+	void on_actionBackendQPainter_triggered();
+	void on_actionBackendNull_triggered();
+	void on_actionProfilerOverlay_toggled(bool checked);
+	void on_actionExportProfilerTrace_triggered();
+	void on_actionRecordSession_toggled(bool checked);
+	void on_actionSharedFramebuffer_toggled(bool checked);
 	void on_actionExit_triggered();
 	void layerSelectionChanged(int currentRow);
 	void on_pushButtonSaveImage_clicked();
@@ -5,17 +5,16 @@ ViewerWidget::ViewerWidget(QSize imgSize, QWidget* parent)
 {
 	setAttribute(Qt::WA_StaticContents);
 	setMouseTracking(true);
+	backend = std::make_unique<SoftwareBackend>(&raster);
 	if (imgSize != QSize(0, 0)) {
-		img = new QImage(imgSize, QImage::Format_ARGB32);
-		img->fill(Qt::white);
-		resizeWidget(img->size());
-		setPainter();
-		setDataPtr();
+		documentSize = imgSize;
+		resizeWidget(documentSize);
 	}
 }
 ViewerWidget::~ViewerWidget()
 {
-	delete painter;
+	// QPainter backend drzi img, kym ho neuvolni
+	backend.reset();
 	delete img;
 }
 void ViewerWidget::resizeWidget(QSize size)
@@ -31,28 +30,19 @@ void ViewerWidget::resizeWidget(QSize size)
 
 bool ViewerWidget::setImage(const QImage& inputImg)
 {
-	if (img != nullptr) {
-		delete painter;
-		delete img;
-	}
-	img = new QImage(inputImg);
-	if (!img) {
+	if (inputImg.isNull()) {
 		return false;
 	}
-	resizeWidget(img->size());
-	setPainter();
-	setDataPtr();
-	update();
+	background = inputImg.convertToFormat(QImage::Format_ARGB32);
+	documentSize = background.size();
+	resizeWidget(scaledDocumentSize());
+	invalidateViewport();
 
 	return true;
 }
 bool ViewerWidget::isEmpty()
 {
-	if (img == nullptr) {
-		return true;
-	}
-
-	if (img->size() == QSize(0, 0)) {
+	if (documentSize == QSize(0, 0)) {
 		return true;
 	}
 	return false;
@@ -63,20 +53,10 @@ bool ViewerWidget::changeSize(int width, int height)
 	QSize newSize(width, height);
 
 	if (newSize != QSize(0, 0)) {
-		if (img != nullptr) {
-			delete painter;
-			delete img;
-		}
-
-		img = new QImage(newSize, QImage::Format_ARGB32);
-		if (!img) {
-			return false;
-		}
-		img->fill(Qt::white);
-		resizeWidget(img->size());
-		setPainter();
-		setDataPtr();
-		update();
+		// Pamat editora zavisi od velkosti okna, nie dokumentu: rasterizuje sa len viditelny vyrez
+		documentSize = newSize;
+		resizeWidget(scaledDocumentSize());
+		invalidateViewport();
 	}
 
 	return true;
@@ -84,59 +64,300 @@ bool ViewerWidget::changeSize(int width, int height)
 
 void ViewerWidget::clear()
 {
-	img->fill(Qt::white);
-	update();
+	background = QImage();
+	redrawAllShapes();
 }
 
 void ViewerWidget::paintEvent(QPaintEvent* event)
 {
-	QPainter painter(this);
-	QRect area = event->rect();
-	painter.drawImage(area, *img, area);
+	{
+		PROFILE_SCOPE(FrameProfiler::PaintEvent);
+
+		bool rerendered = false;
+		if (viewRect.isEmpty() || !viewRect.contains(visibleArea())) {
+			renderViewport();
+			rerendered = true;
+		}
+		if (img == nullptr) {
+			return;
+		}
+
+		QPainter painter(this);
+		QRect area = event->rect() & viewRect;
+		painter.drawImage(area.topLeft(), *img, area.translated(-viewRect.topLeft()));
+		// Zverejni sa len zmeneny obsah; prekreslenie kvoli hoveru, prekryvu profilera ci odkrytiu okna nie je novy snimok
+		if (sharedFrames && canvasChanged) {
+			sharedFrames->publish(*img);
+			canvasChanged = false;
+		}
+
+		QRect hover = hoverRect(hoveredShape);
+		if (!hover.isEmpty()) {
+			painter.setPen(QPen(QColor(0, 120, 215), 1, Qt::DashLine));
+			painter.setBrush(Qt::NoBrush);
+			painter.drawRect(hover.adjusted(0, 0, -1, -1));
+		}
+
+		if (profilerOverlay) {
+			drawProfilerOverlay(painter);
+			// Po posune sa prekresli len odkryty pas, prekryvne okno by sa inak rozmazalo
+			if (rerendered) {
+				update();
+			}
+		}
+	}
+
+#ifdef RENDER_PROFILER
+	FrameProfiler::instance().endFrame();
+#endif
 }
 
 //-----------------------------------------
-//		*** Point drawing functions ***
+//		*** View functions ***
 //-----------------------------------------
 
-void ViewerWidget::setPixel(int x, int y, uchar r, uchar g, uchar b, uchar a)
+QSize ViewerWidget::scaledDocumentSize() const
 {
-	r = r > 255 ? 255 : (r < 0 ? 0 : r);
-	g = g > 255 ? 255 : (g < 0 ? 0 : g);
-	b = b > 255 ? 255 : (b < 0 ? 0 : b);
-	a = a > 255 ? 255 : (a < 0 ? 0 : a);
+	return QSize(qMax(1, qRound(documentSize.width() * zoom)), qMax(1, qRound(documentSize.height() * zoom)));
+}
 
-	size_t startbyte = y * img->bytesPerLine() + x * 4;
-	data[startbyte] = b;
-	data[startbyte + 1] = g;
-	data[startbyte + 2] = r;
-	data[startbyte + 3] = a;
+// Cast widgetu viditelna v scroll area (v pixeloch obrazovky)
+QRect ViewerWidget::visibleArea() const
+{
+	QWidget* viewport = parentWidget();
+	if (viewport == nullptr) {
+		return rect();
+	}
+	return QRect(-pos(), viewport->size()) & rect();
 }
-void ViewerWidget::setPixel(int x, int y, double valR, double valG, double valB, double valA)
+
+QPoint ViewerWidget::toDocument(const QPoint& widgetPoint) const
 {
-	valR = valR > 1 ? 1 : (valR < 0 ? 0 : valR);
-	valG = valG > 1 ? 1 : (valG < 0 ? 0 : valG);
-	valB = valB > 1 ? 1 : (valB < 0 ? 0 : valB);
-	valA = valA > 1 ? 1 : (valA < 0 ? 0 : valA);
+	if (zoom == 1.0) {
+		return widgetPoint;
+	}
+	return QPoint(qFloor(widgetPoint.x() / zoom), qFloor(widgetPoint.y() / zoom));
+}
 
-	size_t startbyte = y * img->bytesPerLine() + x * 4;
-	data[startbyte] = static_cast<uchar>(255 * valB);
-	data[startbyte + 1] = static_cast<uchar>(255 * valG);
-	data[startbyte + 2] = static_cast<uchar>(255 * valR);
-	data[startbyte + 3] = static_cast<uchar>(255 * valA);
+void ViewerWidget::setZoom(double newZoom)
+{
+	newZoom = qBound(MinZoom, newZoom, MaxZoom);
+	if (qFuzzyCompare(newZoom, zoom)) {
+		return;
+	}
+
+	zoom = newZoom;
+	resizeWidget(scaledDocumentSize());
+	invalidateViewport();
 }
-void ViewerWidget::setPixel(int x, int y, const QColor& color)
+
+bool ViewerWidget::setSharedFramebuffer(const QString& name, QString* errorMessage)
+{
+	if (name.isEmpty()) {
+		sharedFrames.reset();
+		return true;
+	}
+
+	// Kapacita podla aktualneho vyrezu, vacsi vyrez segment neskor nahradi
+	std::unique_ptr<SharedFramebuffer> frames = std::make_unique<SharedFramebuffer>();
+	QSize capacity = img ? img->size() : size();
+	if (!frames->create(name, capacity, errorMessage)) {
+		return false;
+	}
+	sharedFrames = std::move(frames);
+	canvasChanged = true;
+	update();
+	return true;
+}
+
+void ViewerWidget::setProfilerOverlay(bool enabled)
+{
+#ifdef RENDER_PROFILER
+	profilerOverlay = enabled;
+	FrameProfiler::instance().setEnabled(enabled);
+	if (enabled) {
+		FrameProfiler::instance().reset();
+	}
+	update();
+#else
+	Q_UNUSED(enabled);
+#endif
+}
+
+// Statistiky posledneho dokonceneho snimku v lavom hornom rohu viditelnej casti
+void ViewerWidget::drawProfilerOverlay(QPainter& painter)
+{
+	QString text = FrameProfiler::instance().overlayText();
+	const RenderBackend::Stats& stats = backend->getStats();
+	text += QString("\nbackend %1: %2 shapes, %3 culled").arg(backend->name()).arg(stats.shapes).arg(stats.culled);
+	if (backend->kind() != RenderBackend::Software) {
+		text += QString(", %1 vertices, %2 px bounds").arg(stats.vertices).arg(stats.pixels);
+	}
+	QFont font("Consolas");
+	font.setStyleHint(QFont::Monospace);
+	font.setPointSize(9);
+	painter.setFont(font);
+
+	QRect anchor(visibleArea().topLeft() + QPoint(8, 8), QSize(1000, 1000));
+	QRect textRect = painter.fontMetrics().boundingRect(anchor, Qt::AlignLeft | Qt::AlignTop, text);
+	painter.fillRect(textRect.adjusted(-4, -4, 4, 4), QColor(0, 0, 0, 170));
+	painter.setPen(Qt::white);
+	painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, text);
+}
+
+void ViewerWidget::invalidateViewport()
+{
+	viewRect = QRect();
+	update();
+}
+
+void ViewerWidget::clearViewport()
 {
-	if (!color.isValid() || x < 0 || y < 0 || x >= img->width() || y >= img->height()) {
+	if (background.isNull()) {
+		raster.clear(Qt::white);
 		return;
 	}
 
-	size_t startbyte = y * img->bytesPerLine() + x * 4;
+	depthPlane.clear();
+	idPlane.clear();
+	img->fill(Qt::white);
+	QRectF source(viewRect.x() / zoom, viewRect.y() / zoom, viewRect.width() / zoom, viewRect.height() / zoom);
+	QPainter painter(img);
+	painter.drawImage(QRectF(img->rect()), background, source);
+}
+
+void ViewerWidget::clearViewport(const QRect& targetRect)
+{
+	depthPlane.clear(targetRect);
+	idPlane.clear(targetRect);
+	QPainter painter(img);
+	painter.fillRect(targetRect, Qt::white);
+	if (!background.isNull()) {
+		QRectF source((viewRect.x() + targetRect.x()) / zoom, (viewRect.y() + targetRect.y()) / zoom, targetRect.width() / zoom, targetRect.height() / zoom);
+		painter.drawImage(QRectF(targetRect), background, source);
+	}
+}
 
-	data[startbyte] = color.blue();
-	data[startbyte + 1] = color.green();
-	data[startbyte + 2] = color.red();
-	data[startbyte + 3] = color.alpha();
+// Rasterizuje len viditelny vyrez v rozliseni obrazovky, tvary mimo neho rasterizer vyradi podla obalky
+// Hlbka aj ID tvaru su jeho index + 1 (drawShapes s firstId = 1), rovnako ako shapeDepth
+std::vector<Shape*> ViewerWidget::drawList() const
+{
+	std::vector<Shape*> shapes;
+	shapes.reserve(zBuffer.size());
+	for (const auto& shapePair : zBuffer) {
+		shapes.push_back(&shapePair.first.get());
+	}
+	return shapes;
+}
+
+void ViewerWidget::renderViewport()
+{
+	QRect area = visibleArea();
+	if (area.isEmpty() || documentSize.isEmpty()) {
+		viewRect = QRect();
+		return;
+	}
+
+	if (img == nullptr || img->size() != area.size()) {
+		backend->setTarget(static_cast<QImage*>(nullptr));
+		delete img;
+		img = new QImage(area.size(), QImage::Format_ARGB32);
+		setDataPtr();
+		backend->setTarget(img);
+	}
+	if (depthTest && depthPlane.size() != area.size()) {
+		depthPlane.resize(area.width(), area.height());
+	}
+	if (picking && idPlane.size() != area.size()) {
+		idPlane.resize(area.width(), area.height());
+	}
+
+	viewRect = area;
+	raster.setView(viewRect.topLeft(), zoom);
+	backend->setView(viewRect.topLeft(), zoom);
+	attachPlanes();
+	raster.resetCulledShapes();
+	backend->resetStats();
+	clearViewport();
+	std::vector<Shape*> shapes = drawList();
+	backend->drawShapes(shapes.data(), shapes.size(), 1);
+	backend->finish();
+	canvasChanged = true;
+}
+
+// Prekresli len cast vyrezu pod obdlznikom dokumentu (undo/redo), ostatne pixely aj roviny sa nemenia.
+// Tvary mimo oblasti rasterizer vyradi podla obalky, zapisy orezava scissor
+void ViewerWidget::renderRegion(const QRect& documentRect)
+{
+	if (img == nullptr || viewRect.isEmpty() || img->size() != viewRect.size() || documentRect.isNull()) {
+		redrawAllShapes();
+		return;
+	}
+
+	QRect target = raster.mapToTarget(documentRect).adjusted(-1, -1, 1, 1) & img->rect();
+	if (target.isEmpty()) {
+		return;
+	}
+
+	attachPlanes();
+	backend->setScissor(target);
+	clearViewport(target);
+	std::vector<Shape*> shapes = drawList();
+	backend->drawShapes(shapes.data(), shapes.size(), 1);
+	backend->finish();
+	backend->resetScissor();
+	canvasChanged = true;
+	update(target.translated(viewRect.topLeft()));
+}
+
+// Export je vzdy vyhladeny (analyticke pokrytie), platno v editore zostava ostre.
+// Tvary sa kopiruju ako hodnoty (body su implicitne zdielane), editor ich medzitym moze menit
+ImageExporter::Document ViewerWidget::exportDocument() const
+{
+	ImageExporter::Document document;
+	document.size = documentSize;
+	document.background = background;
+	std::vector<Shape*> shapes = drawList();
+	document.shapes.reserve(shapes.size());
+	for (Shape* shape : shapes) {
+		document.shapes.push_back(toShapeVariant(*shape));
+	}
+	return document;
+}
+
+//-----------------------------------------
+//		*** Point drawing functions ***
+//-----------------------------------------
+
+// Suradnice su v dokumente, do vyrezu sa prepocitaju transformaciou pohladu.
+// Body su len docasne znacky nad scenou, preto idu mimo hlbkoveho testu a ID roviny.
+void ViewerWidget::setPixel(int x, int y, uchar r, uchar g, uchar b, uchar a)
+{
+	QPoint point = raster.mapToTarget(QPoint(x, y));
+	if (raster.isVisible(QRect(point, QSize(1, 1)))) {
+		detachPlanes();
+		raster.setPixel(point.x(), point.y(), r, g, b, a);
+		attachPlanes();
+		canvasChanged = true;
+	}
+}
+void ViewerWidget::setPixel(int x, int y, double valR, double valG, double valB, double valA)
+{
+	QPoint point = raster.mapToTarget(QPoint(x, y));
+	if (raster.isVisible(QRect(point, QSize(1, 1)))) {
+		detachPlanes();
+		raster.setPixel(point.x(), point.y(), valR, valG, valB, valA);
+		attachPlanes();
+		canvasChanged = true;
+	}
+}
+void ViewerWidget::setPixel(int x, int y, const QColor& color)
+{
+	QPoint point = raster.mapToTarget(QPoint(x, y));
+	detachPlanes();
+	raster.setPixel(point.x(), point.y(), color);
+	attachPlanes();
+	canvasChanged = true;
 }
 
 //-----------------------------------------
@@ -146,30 +367,16 @@ void ViewerWidget::changeLayerColor(int zBufferPosition, const QColor& newBorder
 	for (auto& pair : zBuffer) {
 		if (pair.second == zBufferPosition) {
 			Shape& shape = pair.first.get();
+			QColor oldBorderColor = shape.getBorderColor();
+			QColor oldFillingColor = shape.getFillingColor();
 
 			shape.setBorderColor(newBorderColor);
 			shape.setFillingColor(newFillingColor);
+			history.recordColor(shape, oldBorderColor, oldFillingColor);
+			journal.recordColor(static_cast<int>(&pair - zBuffer.data()), newBorderColor, newFillingColor);
 
-			switch (shape.getType()) {
-			case Shape::LINE:
-				drawLine(static_cast<Line&>(shape));
-				break;
-			case Shape::RECTANGLE:
-				drawRectangle(static_cast<MyRectangle&>(shape));
-				break;
-			case Shape::POLYGON:
-				drawPolygon(static_cast<MyPolygon&>(shape));
-				break;
-			case Shape::CIRCLE:
-				drawCircle(static_cast<Circle&>(shape));
-				break;
-			case Shape::BEZIER_CURVE:
-				drawCurve(static_cast<BezierCurve&>(shape));
-				break;
-			default:
-				break;
-			}
-
+			// Typ rozlisi rasterizer (visitShape), tvar v scene uz ma platny pocet bodov
+			drawShape(shape);
 			update();
 			break;
 		}
@@ -177,47 +384,37 @@ void ViewerWidget::changeLayerColor(int zBufferPosition, const QColor& newBorder
 }
 
 void ViewerWidget::drawShape(Shape& shape) {
-	switch (shape.getType()) {
-	case Shape::LINE: {
-		Line& line = static_cast<Line&>(shape);
-		drawLine(line);
-		break;
-	}
-	case Shape::RECTANGLE: {
-		MyRectangle& rectangle = static_cast<MyRectangle&>(shape);
-		drawRectangle(rectangle);
-		break;
-	}
-	case Shape::POLYGON: {
-		MyPolygon& polygon = static_cast<MyPolygon&>(shape);
-		drawPolygon(polygon);
-		break;
-	}
-	case Shape::CIRCLE: {
-		Circle& circle = static_cast<Circle&>(shape);
-		drawCircle(circle);
-		break;
-	}
-	case Shape::BEZIER_CURVE: {
-		BezierCurve& curve = static_cast<BezierCurve&>(shape);
-		drawCurve(curve);
-		break;
-	}
-	default:
-		break;
-	}
+	quint32 depth = shapeDepth(shape);
+	raster.setDepth(depth);
+	raster.setShapeId(depth);
+	backend->drawShape(shape, depth);
+	backend->finish();
+	canvasChanged = true;
 }
 
-void ViewerWidget::addToZBuffer(Shape& shape, int depth) {
+void ViewerWidget::addToZBuffer(Shape& shape, int depth, bool recordUndo) {
 	zBuffer.push_back(std::make_pair(std::ref(shape), depth));
-	std::sort(zBuffer.begin(), zBuffer.end(), [](const std::pair<std::reference_wrapper<Shape>, int>& a, const std::pair<std::reference_wrapper<Shape>, int>& b) {
+	// Stabilne, aby tvary s rovnakou poziciou ostali v poradi ulozenia (indexy zurnalu)
+	std::stable_sort(zBuffer.begin(), zBuffer.end(), [](const std::pair<std::reference_wrapper<Shape>, int>& a, const std::pair<std::reference_wrapper<Shape>, int>& b) {
 		return a.second < b.second;
 		});
+
+	if (recordUndo) {
+		int index = static_cast<int>(shapeDepth(shape)) - 1;
+		history.recordInsert(shape, index, depth);
+		journal.recordAdd(index, shape, depth);
+	}
 }
 
 void ViewerWidget::deleteObjectFromZBuffer(int currentIndex) {
 	if (currentIndex >= 0 && currentIndex < zBuffer.size()) {
+		// Zmazany tvar si drzi historia, kym sa zaznam nezahodi
+		std::unique_ptr<Shape> shape(&zBuffer[currentIndex].first.get());
+		int zBufferPosition = zBuffer[currentIndex].second;
 		zBuffer.erase(zBuffer.begin() + currentIndex);
+		hoveredShape = -1;
+		history.recordRemove(std::move(shape), currentIndex, zBufferPosition);
+		journal.recordRemove(currentIndex);
 	}
 }
 
@@ -230,7 +427,9 @@ void ViewerWidget::moveShapeUp(int zBufferPosition) {
 		auto prevIt = std::prev(it);
 		std::iter_swap(it, prevIt);
 		std::swap(it->second, prevIt->second);
-		redrawAllShapes();
+		history.recordSwap(static_cast<int>(it - zBuffer.begin()));
+		journal.recordSwap(static_cast<int>(it - zBuffer.begin()));
+		redrawShapeOnTop(static_cast<int>(it - zBuffer.begin()));
 	}
 }
 
@@ -243,213 +442,341 @@ void ViewerWidget::moveShapeDown(int zBufferPosition) {
 		auto nextIt = std::next(it);
 		std::iter_swap(it, nextIt);
 		std::swap(it->second, nextIt->second);
-		redrawAllShapes();
+		history.recordSwap(static_cast<int>(nextIt - zBuffer.begin()));
+		journal.recordSwap(static_cast<int>(nextIt - zBuffer.begin()));
+		redrawShapeOnTop(static_cast<int>(nextIt - zBuffer.begin()));
 	}
 }
 
 void ViewerWidget::redrawAllShapes() {
-	clear();
-	for (auto& shapePair : zBuffer) {
-		drawShape(shapePair.first.get());
-	}
+	PROFILE_SCOPE(FrameProfiler::RedrawAllShapes);
+	renderViewport();
 	update();
 }
 
-void ViewerWidget::saveCurrentImageState() {
-	QString filePath = QFileDialog::getSaveFileName(this, "Save Image State", "C:\\Pocitacova_grafika_projects\\ImageViewer_projekt_zaverecny", "CSV Files (*.csv)");
-	if (filePath.isEmpty()) {
-		return;
+// Hlbka aj ID tvaru = jeho index v zBuffer + 1 (jedinecne aj ked sa zBufferPosition opakuje), novy tvar ide navrch
+quint32 ViewerWidget::shapeDepth(Shape& shape) const
+{
+	for (size_t i = 0; i < zBuffer.size(); i++) {
+		if (&zBuffer[i].first.get() == &shape) {
+			return static_cast<quint32>(i + 1);
+		}
 	}
+	return static_cast<quint32>(zBuffer.size() + 1);
+}
 
-	QFile file(filePath);
-	if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-		QMessageBox::warning(this, "File Error", "Unable to open file for writing.");
+// Po vymene dvoch susednych vrstiev staci s hlbkovym testom prekreslit tu, ktora je teraz vyssie:
+// vyhra vsade, kde sa prekryvaju, a pixely nizsej vrstvy mimo prekryvu sa nemenia
+void ViewerWidget::redrawShapeOnTop(int index)
+{
+	if (!depthTest || backend->kind() != RenderBackend::Software || viewRect.isEmpty() || index < 0 || index >= static_cast<int>(zBuffer.size())) {
+		redrawAllShapes();
 		return;
 	}
 
-	QTextStream out(&file);
-
-	out << "ShapeType,ZBufferPosition,IsFilled,BorderColor,FillingColor,Points\n";
-
-	for (const auto& pair : zBuffer) {
-		Shape& shape = pair.first.get();
-		int zBufferPosition = pair.second;
-		QString shapeType;
-		switch (shape.getType()) {
-		case Shape::LINE:
-			shapeType = "Line";
-			break;
-		case Shape::RECTANGLE:
-			shapeType = "Rectangle";
-			break;
-		case Shape::POLYGON:
-			shapeType = "Polygon";
-			break;
-		case Shape::CIRCLE:
-			shapeType = "Circle";
-			break;
-		case Shape::BEZIER_CURVE:
-			shapeType = "BezierCurve";
-			break;
+	// Hlbky aj ID su indexy vrstiev, po vymene ich v rovinach len premenujeme (vymenena je vrstva index-1 a index);
+	// bez toho by znizeny tvar ostal s vyssou hlbkou a neprekreslil by sa cez vlastne stare pixely
+	if (index > 0) {
+		depthPlane.swapDepths(static_cast<quint32>(index), static_cast<quint32>(index + 1));
+		if (picking) {
+			idPlane.swapIds(static_cast<quint32>(index), static_cast<quint32>(index + 1));
 		}
+	}
 
-		QString borderColor = shape.getBorderColor().name();
-		QString fillingColor = shape.getFillingColor().name();
-		QString isFilled = shape.getIsFilled() ? "true" : "false";
+	raster.setDepth(static_cast<quint32>(index + 1));
+	raster.setShapeId(static_cast<quint32>(index + 1));
+	raster.drawShape(zBuffer[index].first.get());
+	canvasChanged = true;
+	update();
+}
 
-		QString points;
-		QVector<QPoint> shapePoints = shape.getPoints();
-		for (const QPoint& point : shapePoints) {
-			points += QString("(%1,%2) ").arg(point.x()).arg(point.y());
-		}
-		points = points.trimmed();
+// Hlbku a ID tvarov zapisuje len vlastny rasterizer; s inym backendom ostanu roviny prazdne (vyber nic nenajde)
+void ViewerWidget::attachPlanes()
+{
+	bool planes = backend->kind() == RenderBackend::Software;
+	raster.setDepthBuffer(planes && depthTest ? &depthPlane : nullptr);
+	raster.setIdBuffer(planes && picking ? &idPlane : nullptr);
+}
+
+void ViewerWidget::detachPlanes()
+{
+	raster.setDepthBuffer(nullptr);
+	raster.setIdBuffer(nullptr);
+}
 
-		out << shapeType << "," << zBufferPosition << "," << isFilled << "," << borderColor << "," << fillingColor << "," << points << "\n";
+void ViewerWidget::setRenderBackend(RenderBackend::Kind kind)
+{
+	if (kind == backend->kind()) {
+		return;
 	}
 
-	file.close();
+	backend.reset();
+	if (kind == RenderBackend::Software) {
+		backend = std::make_unique<SoftwareBackend>(&raster);
+	}
+	else {
+		backend = RenderBackend::create(kind);
+	}
+	backend->setTarget(img);
+	depthPlane.clear();
+	idPlane.clear();
+	hoveredShape = -1;
+	invalidateViewport();
+}
 
-	QMessageBox::information(this, "Save Successful", "The current state has been saved successfully.");
+void ViewerWidget::setPicking(bool enabled)
+{
+	picking = enabled;
+	if (!enabled) {
+		idPlane.resize(0, 0);
+		hoveredShape = -1;
+	}
+	invalidateViewport();
 }
 
-//-----------------------------------------
-//		*** Line functions ***
-//-----------------------------------------
-void ViewerWidget::drawLine(Line& line)
+// Index vrstvy (riadok zoznamu) tvaru navrchu pod bodom widgetu, -1 ak tam ziadny nie je; O(1)
+int ViewerWidget::shapeIndexAt(const QPoint& widgetPoint) const
 {
-	borderColor = line.getBorderColor();
-	painter->setPen(QPen(borderColor));
+	if (!picking || !viewRect.contains(widgetPoint)) {
+		return -1;
+	}
 
-	QVector<QPoint> linePoints = line.getPoints();
+	quint32 id = idPlane.at(widgetPoint - viewRect.topLeft());
+	if (id == 0 || id > zBuffer.size()) {
+		return -1;
+	}
+	return static_cast<int>(id) - 1;
+}
 
-	QVector<QPoint> lineToClip = line.getPoints();
+// Zvyraznenie je len obdlznik kresleny v paintEvent nad vyrezom, tvary sa neprekresluju
+void ViewerWidget::setHoveredShape(int index)
+{
+	if (index == hoveredShape) {
+		return;
+	}
 
-	clipLineWithPolygon(lineToClip);
+	update(hoverRect(hoveredShape));
+	hoveredShape = index;
+	update(hoverRect(hoveredShape));
+}
 
-	if (lineToClip.size() == 2) {
-		linePoints.append(lineToClip[0]);
-		linePoints.append(lineToClip[1]);
-	}
-	else {
-		linePoints.append(line.getPoints()[0]);
-		linePoints.append(line.getPoints()[1]);
+QRect ViewerWidget::hoverRect(int index)
+{
+	if (index < 0 || index >= static_cast<int>(zBuffer.size()) || viewRect.isEmpty()) {
+		return QRect();
 	}
 
-	for (const QPoint& point : linePoints) {
-		qDebug() << point;
-	}
+	QRect bounds = raster.mapToTarget(Rasterizer::shapeBounds(zBuffer[index].first.get()));
+	return bounds.translated(viewRect.topLeft()).adjusted(-2, -2, 2, 2);
+}
 
-	drawLineBresenham(linePoints);
-	line.setPoints(linePoints);
-	update();
+void ViewerWidget::setDepthTest(bool enabled, DepthBuffer::Format format)
+{
+	depthTest = enabled;
+	depthPlane.setFormat(format);
+	if (!enabled) {
+		depthPlane.resize(0, 0);
+	}
+	invalidateViewport();
 }
 
-void ViewerWidget::clipLineWithPolygon(QVector<QPoint> linePoints) {
-	if (linePoints.size() < 2) {
+void ViewerWidget::saveCurrentImageState() {
+	QString filePath = QFileDialog::getSaveFileName(this, "Save Image State", "C:\\Pocitacova_grafika_projects\\ImageViewer_projekt_zaverecny", "CSV Files (*.csv)");
+	if (filePath.isEmpty()) {
 		return;
 	}
 
-	QVector<QPoint> clippedPoints;
-	QPoint P1 = linePoints[0], P2 = linePoints[1];
-	double t_min = 0, t_max = 1;
-	QPoint d = P2 - P1;
+	QString errorMessage;
 
-	QVector<QPoint> E = { QPoint(0,0), QPoint(500,0), QPoint(500,500), QPoint(0,500) };
+	// Ta ista scena: na disku uz je snimka + zurnal, staci oznacit zmeny za ulozene (O(zmena)).
+	// Dlhy zurnal sa radsej zlozi do novej snimky (cela scena nizsie)
+	bool sameScene = journal.isOpen() && QFileInfo(filePath).absoluteFilePath() == QFileInfo(journal.getScenePath()).absoluteFilePath();
+	if (sameScene && !journal.needsCompaction() && journal.commit(&errorMessage)) {
+		QMessageBox::information(this, "Save Successful", "The current state has been saved successfully.");
+		return;
+	}
 
-	for (int i = 0; i < E.size(); i++) {
-		QPoint E1 = E[i];
-		QPoint E2 = E[(i + 1) % E.size()];
+	if (!SceneFile::save(filePath, zBuffer, &errorMessage)) {
+		QMessageBox::warning(this, "File Error", errorMessage);
+		return;
+	}
+	// Stary zurnal patri k predoslej snimke; jeho neulozene zaznamy su uz v novej
+	attachJournal(filePath);
 
-		QPoint normal = QPoint(E2.y() - E1.y(), E1.x() - E2.x());
+	QMessageBox::information(this, "Save Successful", "The current state has been saved successfully.");
+}
 
-		QPoint w = P1 - E1;
+//-----------------------------------------
+//		*** Undo/redo ***
+//-----------------------------------------
 
-		double dn = d.x() * normal.x() + d.y() * normal.y();
-		double wn = w.x() * normal.x() + w.y() * normal.y();
-		if (dn != 0) {
-			double t = -wn / dn;
-			if (dn > 0 && t <= 1) {
-				t_min = std::max(t, t_min);
-			}
-			else if (dn < 0 && t >= 0) {
-				t_max = std::min(t, t_max);
-			}
-		}
+EditHistory::Step ViewerWidget::undo()
+{
+	EditHistory::Edit* edit = history.undoTop();
+	if (edit == nullptr) {
+		return EditHistory::Step();
 	}
 
+	EditHistory::Step step = applyEdit(*edit, false);
+	history.finishUndo();
+	return step;
+}
+
+EditHistory::Step ViewerWidget::redo()
+{
+	EditHistory::Edit* edit = history.redoTop();
+	if (edit == nullptr) {
+		return EditHistory::Step();
+	}
 
-	if (t_min < t_max) {
-		QPoint clippedP1 = P1 + (P2 - P1) * t_min;
-		QPoint clippedP2 = P1 + (P2 - P1) * t_max;
+	EditHistory::Step step = applyEdit(*edit, true);
+	history.finishRedo();
+	return step;
+}
 
-		clippedPoints.push_back(clippedP1);
-		clippedPoints.push_back(clippedP2);
+// Aplikuje zaznam dopredu (redo) alebo spat (undo) a prekresli len oblast, ktorej sa tyka.
+// Vrati zmenu zoznamu vrstiev (Insert/Remove/SwapLayers) pre GUI
+EditHistory::Step ViewerWidget::applyEdit(EditHistory::Edit& edit, bool forward)
+{
+	EditHistory::Step step;
+	step.kind = edit.kind;
+	step.index = edit.index;
+	QRect dirty;
+	bool valid = true;
+
+	switch (edit.kind) {
+	case EditHistory::Translate: {
+		Shape& shape = *edit.shape;
+		dirty = Rasterizer::shapeBounds(shape);
+		QVector<QPoint> points = shape.getPoints();
+		QPoint offset = forward ? edit.offset : -edit.offset;
+		for (QPoint& point : points) {
+			point += offset;
+		}
+		shape.setPoints(points);
+		dirty |= Rasterizer::shapeBounds(shape);
+		journalPoints(static_cast<int>(shapeDepth(shape)) - 1);
+		break;
 	}
-	else {
-		//qDebug() << "Useckovy segment je uplne mimo orezovacej oblasti alebo je neplatny.";
+	case EditHistory::Geometry:
+		dirty = Rasterizer::shapeBounds(*edit.shape);
+		edit.shape->setPoints(forward ? edit.after : edit.before);
+		dirty |= Rasterizer::shapeBounds(*edit.shape);
+		journalPoints(static_cast<int>(shapeDepth(*edit.shape)) - 1);
+		break;
+	case EditHistory::Color:
+		edit.shape->setBorderColor(forward ? edit.borderAfter : edit.borderBefore);
+		edit.shape->setFillingColor(forward ? edit.fillingAfter : edit.fillingBefore);
+		dirty = Rasterizer::shapeBounds(*edit.shape);
+		journal.recordColor(static_cast<int>(shapeDepth(*edit.shape)) - 1, edit.shape->getBorderColor(), edit.shape->getFillingColor());
+		break;
+	case EditHistory::SwapLayers:
+		if (edit.index <= 0 || edit.index >= static_cast<int>(zBuffer.size())) {
+			valid = false;
+			break;
+		}
+		dirty = Rasterizer::shapeBounds(zBuffer[edit.index - 1].first.get()) | Rasterizer::shapeBounds(zBuffer[edit.index].first.get());
+		swapLayers(edit.index);
+		journal.recordSwap(edit.index);
+		break;
+	case EditHistory::Insert:
+	case EditHistory::Remove: {
+		// Vlozenie vratene spat je odstranenie a naopak
+		bool insert = (edit.kind == EditHistory::Insert) == forward;
+		if (insert && edit.detached && edit.index >= 0 && edit.index <= static_cast<int>(zBuffer.size())) {
+			insertLayer(edit.index, *edit.detached.release(), edit.zBufferPosition);
+			step.kind = EditHistory::Insert;
+			dirty = Rasterizer::shapeBounds(*edit.shape);
+			journal.recordAdd(edit.index, *edit.shape, edit.zBufferPosition);
+		}
+		else if (!insert && edit.index >= 0 && edit.index < static_cast<int>(zBuffer.size()) && &zBuffer[edit.index].first.get() == edit.shape) {
+			dirty = Rasterizer::shapeBounds(*edit.shape);
+			removeLayer(edit.index);
+			edit.detached.reset(edit.shape);
+			step.kind = EditHistory::Remove;
+			journal.recordRemove(edit.index);
+		}
+		else {
+			valid = false;
+		}
+		break;
+	}
+	default:
+		break;
 	}
 
-	if (!clippedPoints.isEmpty()) {
-		linePoints = clippedPoints;
+	if (!valid) {
+		// Historia nesedi so scenou (zoznam vrstiev zmeneny mimo nej), radsej ju zahodime
+		RENDER_LOG(Edit, Warning, "undo entry of kind {} at layer {} does not match the scene, history cleared", edit.kind, edit.index);
+		history.clear();
+		redrawAllShapes();
+		return EditHistory::Step();
 	}
-}
 
-void ViewerWidget::drawLineBresenham(QVector<QPoint>& linePoints) {
-	int p, k1, k2;
-	int dx = linePoints.last().x() - linePoints.first().x();
-	int dy = linePoints.last().y() - linePoints.first().y();
+	renderRegion(dirty);
+	update(hoverRect(hoveredShape));
+	return step;
+}
 
-	int adx = abs(dx);
-	int ady = abs(dy);
+// Vymena vrstiev index-1 a index, zBufferPosition zostava na svojom mieste (ako moveShapeUp/Down)
+void ViewerWidget::swapLayers(int index)
+{
+	std::swap(zBuffer[index - 1].first, zBuffer[index].first);
+}
 
-	int x = linePoints.first().x();
-	int y = linePoints.first().y();
+// Hlbky a ID vyrezu su index + 1, vrstvy nad vlozenou/odstranenou sa posunu, aby ostali platne aj mimo prekreslenej oblasti
+void ViewerWidget::insertLayer(int index, Shape& shape, int zBufferPosition)
+{
+	zBuffer.insert(zBuffer.begin() + index, std::make_pair(std::ref(shape), zBufferPosition));
+	depthPlane.shiftDepths(static_cast<quint32>(index + 1), 1);
+	idPlane.shiftIds(static_cast<quint32>(index + 1), 1);
+	hoveredShape = -1;
+}
 
-	int incrementX = (dx > 0) ? 1 : -1;
-	int incrementY = (dy > 0) ? 1 : -1;
+void ViewerWidget::removeLayer(int index)
+{
+	zBuffer.erase(zBuffer.begin() + index);
+	depthPlane.shiftDepths(static_cast<quint32>(index + 2), -1);
+	idPlane.shiftIds(static_cast<quint32>(index + 2), -1);
+	hoveredShape = -1;
+}
 
-	if (adx > ady) {
-		p = 2 * ady - adx;
-		k1 = 2 * ady;
-		k2 = 2 * (ady - adx);
+//-----------------------------------------
+//		*** Scene journal ***
+//-----------------------------------------
 
-		while (x != linePoints.last().x()) {
-			setPixel(x, y, borderColor);
-			x += incrementX;
-			if (p >= 0) {
-				y += incrementY;
-				p += k2;
-			}
-			else {
-				p += k1;
-			}
-		}
+// Dalsie zmeny sa budu pripajat do zurnalu k tejto snimke (po nacitani alebo ulozeni sceny).
+// keepUnsaved: scena obsahuje obnovene neulozene zaznamy, zurnal ich ma ponechat
+bool ViewerWidget::attachJournal(const QString& scenePath, bool keepUnsaved)
+{
+	QString errorMessage;
+	if (!journal.open(scenePath, keepUnsaved, &errorMessage)) {
+		RENDER_LOG(Scene, Warning, "scene journal could not be opened, saves will rewrite the whole file");
+		return false;
 	}
-	else {
-		p = 2 * adx - ady;
-		k1 = 2 * adx;
-		k2 = 2 * (adx - ady);
-
-		while (y != linePoints.last().y()) {
-			setPixel(x, y, borderColor);
-			y += incrementY;
-			if (p >= 0) {
-				x += incrementX;
-				p += k2;
-			}
-			else {
-				p += k1;
-			}
-		}
+	return true;
+}
+
+void ViewerWidget::journalPoints(int index)
+{
+	if (journal.isOpen() && index >= 0 && index < static_cast<int>(zBuffer.size())) {
+		journal.recordPoints(index, zBuffer[index].first.get().getPoints());
 	}
+}
 
-	setPixel(linePoints.last().x(), linePoints.last().y(), borderColor);
+//-----------------------------------------
+//		*** Line functions ***
+//-----------------------------------------
+void ViewerWidget::drawLine(Line& line)
+{
+	drawShape(line);
+	update();
 }
 
 void ViewerWidget::moveLine(const QPoint& offset) {
 	if (currentLayer >= 0 && currentLayer < zBuffer.size()) {
 		auto& pair = zBuffer[currentLayer];
-		qDebug() << "ShapeType: " << pair.first.get().getType();
+		RENDER_LOG(Edit, Trace, "moveLine layer {} type {} offset {}", currentLayer, pair.first.get().getType(), offset);
 		if (pair.first.get().getType() == Shape::LINE) {
 			Line& line = static_cast<Line&>(pair.first.get());
 			QVector<QPoint> points = line.getPoints();
@@ -458,7 +785,9 @@ void ViewerWidget::moveLine(const QPoint& offset) {
 				point += offset;
 			}
 
+			history.recordTranslate(pair.first.get(), offset);
 			pair.first.get().setPoints(points);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -470,7 +799,7 @@ void ViewerWidget::turnLine(int angle) {
 		if (pair.first.get().getType() == Shape::LINE) {
 			Line& line = static_cast<Line&>(pair.first.get());
 			QVector<QPoint> points = line.getPoints();
-			QPoint center = getLineCenter(line);
+			QPointF center = getLineCenter(line);
 
 			double radians = qDegreesToRadians(static_cast<double>(angle));
 			double cosAngle = std::cos(radians);
@@ -479,34 +808,31 @@ void ViewerWidget::turnLine(int angle) {
 			QVector<QPoint> rotatedPoints;
 
 			for (QPoint& point : points) {
-				int translatedX = point.x() - center.x();
-				int translatedY = point.y() - center.y();
-
-				int rotatedX = static_cast<int>(translatedX * cosAngle - translatedY * sinAngle);
-				int rotatedY = static_cast<int>(translatedX * sinAngle + translatedY * cosAngle);
+				double translatedX = point.x() - center.x();
+				double translatedY = point.y() - center.y();
 
-				rotatedX += center.x();
-				rotatedY += center.y();
+				// Zaokruhlenie okolo presneho taziska, orezanie k nule by tvar opakovanym otacanim zmensovalo a posuvalo
+				int rotatedX = qRound(center.x() + translatedX * cosAngle - translatedY * sinAngle);
+				int rotatedY = qRound(center.y() + translatedX * sinAngle + translatedY * cosAngle);
 
 				rotatedPoints.push_back(QPoint(rotatedX, rotatedY));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), rotatedPoints);
 			pair.first.get().setPoints(rotatedPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
 }
 
-QPoint ViewerWidget::getLineCenter(Line& line) const {
+QPointF ViewerWidget::getLineCenter(Line& line) const {
 	QVector<QPoint> points = line.getPoints();
 	if (points.isEmpty()) {
-		return QPoint();
+		return QPointF();
 	}
 
-	double centroidX = (points.first().x() + points.last().x()) / 2;
-	double centroidY = (points.first().y() + points.last().y()) / 2;
-
-	return QPoint(static_cast<int>(centroidX), static_cast<int>(centroidY));
+	return (QPointF(points.first()) + QPointF(points.last())) / 2;
 }
 
 void ViewerWidget::scaleLine(double scaleX, double scaleY) {
@@ -515,7 +841,7 @@ void ViewerWidget::scaleLine(double scaleX, double scaleY) {
 		if (pair.first.get().getType() == Shape::LINE) {
 			Line& line = static_cast<Line&>(pair.first.get());
 			QVector<QPoint> points = line.getPoints();
-			QPoint center = getLineCenter(line);
+			QPointF center = getLineCenter(line);
 
 			QVector<QPoint> scaledPoints;
 
@@ -526,7 +852,9 @@ void ViewerWidget::scaleLine(double scaleX, double scaleY) {
 				scaledPoints.append(QPoint(static_cast<int>(std::round(newX)), static_cast<int>(std::round(newY))));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), scaledPoints);
 			pair.first.get().setPoints(scaledPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -536,73 +864,10 @@ void ViewerWidget::scaleLine(double scaleX, double scaleY) {
 //		*** Circle functions ***
 //-----------------------------------------
 void ViewerWidget::drawCircle(Circle& circle) {
-	borderColor = circle.getBorderColor();
-	fillingColor = circle.getFillingColor();
-	QPoint center = circle.getPoints()[0];
-	QPoint radiusPoint = circle.getPoints()[1];
-	int r = std::sqrt(std::pow(radiusPoint.x() - center.x(), 2) + std::pow(radiusPoint.y() - center.y(), 2));
-	int x = 0;
-	int y = r;
-	int p = 1 - r;
-
-	if (circle.getIsFilled()) {
-		drawSymmetricPoints(center, x, y);
-		drawSymmetricPointsFilled(center, x, y);
-	}
-	else {
-		drawSymmetricPoints(center, x, y);
-	}
-
-	while (x < y) {
-		x++;
-		if (p < 0) {
-			p += 2 * x + 1;
-		}
-		else {
-			y--;
-			p += 2 * (x - y) + 1;
-		}
-
-		if (circle.getIsFilled()) {
-			drawSymmetricPoints(center, x, y);
-			drawSymmetricPointsFilled(center, x, y);
-		}
-		else {
-			drawSymmetricPoints(center, x, y);
-		}
-	}
-
+	drawShape(circle);
 	update();
 }
 
-void ViewerWidget::drawSymmetricPoints(const QPoint& center, int x, int y) {
-	QPoint points[8] = {
-		QPoint(x, y),
-		QPoint(y, x),
-		QPoint(-x, y),
-		QPoint(-y, x),
-		QPoint(-x, -y),
-		QPoint(-y, -x),
-		QPoint(x, -y),
-		QPoint(y, -x)
-	};
-
-	for (auto& point : points) {
-		setPixel(center.x() + point.x(), center.y() + point.y(), borderColor);
-	}
-}
-
-void ViewerWidget::drawSymmetricPointsFilled(const QPoint& center, int x, int y) {
-	for (int i = -x; i <= x; i++) {
-		setPixel(center.x() + i, center.y() + y, fillingColor);
-		setPixel(center.x() + i, center.y() - y, fillingColor);
-	}
-	for (int i = -y; i <= y; i++) {
-		setPixel(center.x() + i, center.y() + x, fillingColor);
-		setPixel(center.x() + i, center.y() - x, fillingColor);
-	}
-}
-
 void ViewerWidget::moveCircle(const QPoint& offset) {
 	if (currentLayer >= 0 && currentLayer < zBuffer.size()) {
 		auto& pair = zBuffer[currentLayer];
@@ -614,7 +879,9 @@ void ViewerWidget::moveCircle(const QPoint& offset) {
 				point += offset;
 			}
 
+			history.recordTranslate(pair.first.get(), offset);
 			pair.first.get().setPoints(points);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -629,11 +896,13 @@ void ViewerWidget::scaleCircle(double scaleX, double scaleY) {
 			QPoint center = points[0];
 			QPoint radiusPoint = points[1];
 
-			int newX = center.x() + static_cast<int>((radiusPoint.x() - center.x()) * scaleX);
-			int newY = center.y() + static_cast<int>((radiusPoint.y() - center.y()) * scaleY);
+			int newX = center.x() + qRound((radiusPoint.x() - center.x()) * scaleX);
+			int newY = center.y() + qRound((radiusPoint.y() - center.y()) * scaleY);
 			points[1] = QPoint(newX, newY);
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), points);
 			pair.first.get().setPoints(points);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -644,58 +913,19 @@ void ViewerWidget::scaleCircle(double scaleX, double scaleY) {
 //		*** Polygon Functions ***
 //-----------------------------------------
 void ViewerWidget::drawPolygon(MyPolygon& polygon) {
-	borderColor = polygon.getBorderColor();
-	fillingColor = polygon.getFillingColor();
-	const QVector<QPoint>& pointsVector = polygon.getPoints();
-
-	if (pointsVector.size() < 2) {
+	if (polygon.getPoints().size() < 2) {
 		QMessageBox::warning(this, "Nizky pocet bodov", "Nebol dosiahnuty minimalny pocet bodov pre vykreslenie polygonu.");
 		return;
 	}
 
-	painter->setPen(QPen(borderColor));
-	QVector<QPoint> polygonPoints = pointsVector;
-
-	bool allPointsOutside = std::all_of(pointsVector.begin(), pointsVector.end(), [this](const QPoint& point) {
-		return !isInside(point);
-		});
-
-	if (allPointsOutside) {
-		qDebug() << "Polygon je mimo hranicu.";
-		return;
-	}
-
-	for (QPoint point : pointsVector) {
-		if (!isInside(point)) {
-			polygonPoints = trimPolygon(polygon);
-			break;
-		}
-	}
-
-	if (polygon.getIsFilled()) {
-		fillPolygon(polygon);
-	}
-	painter->setPen(QPen(borderColor));
-
-	std::vector<Line> lines;
-	if (!polygonPoints.isEmpty()) {
-		for (int i = 0; i < polygonPoints.size() - 1; i++) {
-			lines.emplace_back(polygonPoints.at(i), polygonPoints.at(i + 1), polygon.getZBufferPosition(), polygon.getIsFilled(), borderColor, fillingColor);
-		}
-		lines.emplace_back(polygonPoints.last(), polygonPoints.first(), polygon.getZBufferPosition(), polygon.getIsFilled(), borderColor, fillingColor);
-	}
-
-	for (Line& line : lines) {
-		drawLine(line);
-	}
-
+	drawShape(polygon);
 	update();
 }
 
-QPoint ViewerWidget::getPolygonCenter(Shape& polygon) const {
+QPointF ViewerWidget::getPolygonCenter(Shape& polygon) const {
 	const QVector<QPoint>& points = polygon.getPoints();
 	if (points.isEmpty()) {
-		return QPoint();
+		return QPointF();
 	}
 
 	double centroidX = 0;
@@ -708,7 +938,7 @@ QPoint ViewerWidget::getPolygonCenter(Shape& polygon) const {
 	centroidX /= points.size();
 	centroidY /= points.size();
 
-	return QPoint(static_cast<int>(centroidX), static_cast<int>(centroidY));
+	return QPointF(centroidX, centroidY);
 }
 
 void ViewerWidget::scalePolygon(double scaleX, double scaleY) {
@@ -717,7 +947,7 @@ void ViewerWidget::scalePolygon(double scaleX, double scaleY) {
 		if (pair.first.get().getType() == Shape::POLYGON) {
 			MyPolygon& polygon = static_cast<MyPolygon&>(pair.first.get());
 			const QVector<QPoint>& points = polygon.getPoints();
-			QPoint center = getPolygonCenter(polygon);
+			QPointF center = getPolygonCenter(polygon);
 
 			QVector<QPoint> scaledPoints;
 			for (const QPoint& point : points) {
@@ -727,7 +957,9 @@ void ViewerWidget::scalePolygon(double scaleX, double scaleY) {
 				scaledPoints.append(QPoint(static_cast<int>(std::round(newX)), static_cast<int>(std::round(newY))));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), scaledPoints);
 			pair.first.get().setPoints(scaledPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -736,7 +968,7 @@ void ViewerWidget::scalePolygon(double scaleX, double scaleY) {
 void ViewerWidget::movePolygon(const QPoint& offset) {
 	if (currentLayer >= 0 && currentLayer < zBuffer.size()) {
 		auto& pair = zBuffer[currentLayer];
-		qDebug() << "ShapeType: " << pair.first.get().getType();
+		RENDER_LOG(Edit, Trace, "movePolygon layer {} type {} offset {}", currentLayer, pair.first.get().getType(), offset);
 		if (pair.first.get().getType() == Shape::POLYGON) {
 			MyPolygon& polygon = static_cast<MyPolygon&>(pair.first.get());
 			const QVector<QPoint>& points = polygon.getPoints();
@@ -746,7 +978,9 @@ void ViewerWidget::movePolygon(const QPoint& offset) {
 				movedPoints.append(point + offset);
 			}
 
+			history.recordTranslate(pair.first.get(), offset);
 			pair.first.get().setPoints(movedPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -758,7 +992,7 @@ void ViewerWidget::turnPolygon(int angle) {
 		if (pair.first.get().getType() == Shape::POLYGON) {
 			MyPolygon& polygon = static_cast<MyPolygon&>(pair.first.get());
 			const QVector<QPoint>& points = polygon.getPoints();
-			QPoint center = getPolygonCenter(polygon);
+			QPointF center = getPolygonCenter(polygon);
 
 			double radians = qDegreesToRadians(static_cast<double>(angle));
 			double cosAngle = std::cos(radians);
@@ -767,205 +1001,35 @@ void ViewerWidget::turnPolygon(int angle) {
 			QVector<QPoint> rotatedPoints;
 
 			for (const QPoint& point : points) {
-				int translatedX = point.x() - center.x();
-				int translatedY = point.y() - center.y();
-
-				int rotatedX = static_cast<int>(translatedX * cosAngle - translatedY * sinAngle);
-				int rotatedY = static_cast<int>(translatedX * sinAngle + translatedY * cosAngle);
+				double translatedX = point.x() - center.x();
+				double translatedY = point.y() - center.y();
 
-				rotatedX += center.x();
-				rotatedY += center.y();
+				int rotatedX = qRound(center.x() + translatedX * cosAngle - translatedY * sinAngle);
+				int rotatedY = qRound(center.y() + translatedX * sinAngle + translatedY * cosAngle);
 
 				rotatedPoints.append(QPoint(rotatedX, rotatedY));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), rotatedPoints);
 			pair.first.get().setPoints(rotatedPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
 }
 
-QVector<QPoint> ViewerWidget::trimPolygon(Shape& polygon) {
-	QVector<QPoint> pointsVector = polygon.getPoints();
-
-	if (pointsVector.isEmpty()) {
-		qDebug() << "pointsVector je prazdny";
-		return QVector<QPoint>();
-	}
-
-	QVector<QPoint> W, polygonPoints = pointsVector;
-	QPoint S;
-
-	int xMin[] = { 0,0,-499,-499 };
-
-	for (int i = 0; i < 4; i++) {
-		if (pointsVector.size() == 0) {
-			return polygonPoints;
-		}
-
-		S = polygonPoints[polygonPoints.size() - 1];
-
-		for (int j = 0; j < polygonPoints.size(); j++) {
-			if (polygonPoints[j].x() >= xMin[i]) {
-				if (S.x() >= xMin[i]) {
-					W.push_back(polygonPoints[j]);
-				}
-				else {
-					QPoint P(xMin[i], S.y() + (xMin[i] - S.x()) * ((polygonPoints[j].y() - S.y()) / static_cast<double>((polygonPoints[j].x() - S.x()))));
-					W.push_back(P);
-					W.push_back(polygonPoints[j]);
-				}
-			}
-			else {
-				if (S.x() >= xMin[i]) {
-					QPoint P(xMin[i], S.y() + (xMin[i] - S.x()) * ((polygonPoints[j].y() - S.y()) / static_cast<double>((polygonPoints[j].x() - S.x()))));
-					W.push_back(P);
-				}
-			}
-			S = polygonPoints[j];
-		}
-		polygonPoints = W;
-		W.clear();
-
-		for (int j = 0; j < polygonPoints.size(); j++) {
-			QPoint swappingPoint = polygonPoints[j];
-			polygonPoints[j].setX(swappingPoint.y());
-			polygonPoints[j].setY(-swappingPoint.x());
-		}
-	}
-
-	return polygonPoints;
-}
-
-QVector<ViewerWidget::Edge> ViewerWidget::loadEdges(const QVector<QPoint>& points) {
-	QVector<Edge> edges;
-
-	for (int i = 0; i < points.size(); i++) {
-		QPoint startPoint = points[i];
-		QPoint endPoint = points[(i + 1) % points.size()];
-
-		Edge edge(startPoint, endPoint);
-		edge.adjustEndPoint();
-
-		edges.push_back(edge);
-	}
-
-	std::sort(edges.begin(), edges.end(), compareByY);
-	return edges;
-}
-
-void ViewerWidget::fillPolygon(Shape& polygon) {
-	const QVector<QPoint>& points = polygon.getPoints();
-
-	if (points.isEmpty()) {
-		//qDebug() << "Neobsahuje body pre vyplnanie.";
-		return;
-	}
-	QVector<Edge> edges = loadEdges(points);
-	if (edges.isEmpty()) {
-		//qDebug() << "Vektor hran je prazdny.";
-		return;
-	}
-
-	int yMin = edges.front().startPoint().y();
-	int yMax = edges.front().endPoint().y();
-
-	for (const Edge& edge : edges) {
-		int y1 = edge.startPoint().y();
-		int y2 = edge.endPoint().y();
-		yMin = qMin(yMin, qMin(y1, y2));
-		yMax = qMax(yMax, qMax(y1, y2));
-	}
-
-	if (yMin >= yMax) {
-		//qDebug() << "Neplatne yMin a yMax hodnoty. Mozne nespravne nastavenie hrany.";
-		return;
-	}
-	QVector<QVector<Edge>> TH(yMax - yMin + 1);
-
-	for (const auto& edge : edges) {
-		int index = edge.startPoint().y() - yMin;
-		if (index < 0 || index >= TH.size()) {
-			//qDebug() << "Invalid index:" << index << "for edge start point y:" << edge.startPoint().y();
-			continue;
-		}
-		TH[index].append(edge);
-	}
-
-	QVector<Edge> activeEdgeList;
-
-	for (int y = yMin; y <= yMax; y++) {
-		for (const auto& edge : TH[y - yMin]) {
-			activeEdgeList.append(edge);
-		}
-
-		std::sort(activeEdgeList.begin(), activeEdgeList.end(), [](const Edge& a, const Edge& b) {
-			return a.x() < b.x();
-			});
-
-		for (int i = 0; i < activeEdgeList.size(); i += 2) {
-			if (i + 1 < activeEdgeList.size()) {
-				int startX = qRound(activeEdgeList[i].x());
-				int endX = qRound(activeEdgeList[i + 1].x());
-				for (int x = startX; x <= endX; x++) {
-					setPixel(x, y, fillingColor);
-				}
-			}
-		}
-		
-		QMutableVectorIterator<Edge> it(activeEdgeList);
-		while (it.hasNext()) {
-			Edge& edge = it.next();
-			if (edge.endPoint().y() == y) {
-				it.remove();
-			}
-			else {
-				edge.setX(edge.x() + edge.w());
-			}
-		}
-	}
-}
-
 //-----------------------------------------
 //		*** Curve functions ***
 //-----------------------------------------
 
 void ViewerWidget::drawCurve(BezierCurve& curve) {
-	// << Bezierova krivka >>
-	borderColor = curve.getBorderColor();
-	fillingColor = curve.getFillingColor();
-	const QVector<QPoint>& curvePoints = curve.getPoints();
-	if (curvePoints.size() < 2) {
+	if (curve.getPoints().size() < 2) {
 		QMessageBox::warning(this, "Nedostatocny pocet bodov", "Nemozno nakreslit krivku s menej ako dvomi riadiacimi bodmi.", QMessageBox::Ok);
 		return;
 	}
 
-	painter->setPen(QPen(borderColor));
-	float deltaT = 0.01f;
-	QPoint Q0 = curvePoints[0];
-
-	std::vector<Line> lines;
-
-	for (float t = deltaT; t <= 1; t += deltaT) {
-		QVector<QPoint> tempPoints = curvePoints;
-
-		for (int i = 1; i < tempPoints.size(); i++) {
-			for (int j = 0; j < tempPoints.size() - i; j++) {
-				tempPoints[j] = tempPoints[j] * (1 - t) + tempPoints[j + 1] * t;
-			}
-		}
-
-		lines.emplace_back(Q0, tempPoints[0], curve.getZBufferPosition(), curve.getIsFilled(), borderColor, fillingColor);
-		Q0 = tempPoints[0];
-	}
-
-	if (deltaT * floor(1 / deltaT) < 1) {
-		lines.emplace_back(Q0, curvePoints.last(), curve.getZBufferPosition(), curve.getIsFilled(), borderColor, fillingColor);
-	}
-
-	for (Line& line : lines) {
-		drawLine(line);
-	}
+	drawShape(curve);
+	update();
 }
 
 void ViewerWidget::moveCurve(const QPoint& offset) {
@@ -980,7 +1044,9 @@ void ViewerWidget::moveCurve(const QPoint& offset) {
 				movedPoints.append(point + offset);
 			}
 
+			history.recordTranslate(pair.first.get(), offset);
 			pair.first.get().setPoints(movedPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -992,7 +1058,7 @@ void ViewerWidget::scaleCurve(double scaleX, double scaleY) {
 		if (pair.first.get().getType() == Shape::BEZIER_CURVE) {
 			BezierCurve& curve = static_cast<BezierCurve&>(pair.first.get());
 			const QVector<QPoint>& points = curve.getPoints();
-			QPoint center = calculateCurveCenter(curve);
+			QPointF center = calculateCurveCenter(curve);
 
 			QVector<QPoint> scaledPoints;
 			for (const QPoint& point : points) {
@@ -1002,7 +1068,9 @@ void ViewerWidget::scaleCurve(double scaleX, double scaleY) {
 				scaledPoints.append(QPoint(static_cast<int>(std::round(newX)), static_cast<int>(std::round(newY))));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), scaledPoints);
 			pair.first.get().setPoints(scaledPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -1014,7 +1082,7 @@ void ViewerWidget::turnCurve(int angle) {
 		if (pair.first.get().getType() == Shape::BEZIER_CURVE) {
 			BezierCurve& curve = static_cast<BezierCurve&>(pair.first.get());
 			const QVector<QPoint>& points = curve.getPoints();
-			QPoint center = calculateCurveCenter(curve);
+			QPointF center = calculateCurveCenter(curve);
 
 			double radians = qDegreesToRadians(static_cast<double>(angle));
 			double cosAngle = std::cos(radians);
@@ -1023,28 +1091,27 @@ void ViewerWidget::turnCurve(int angle) {
 			QVector<QPoint> rotatedPoints;
 
 			for (const QPoint& point : points) {
-				int translatedX = point.x() - center.x();
-				int translatedY = point.y() - center.y();
-
-				int rotatedX = static_cast<int>(translatedX * cosAngle - translatedY * sinAngle);
-				int rotatedY = static_cast<int>(translatedX * sinAngle + translatedY * cosAngle);
+				double translatedX = point.x() - center.x();
+				double translatedY = point.y() - center.y();
 
-				rotatedX += center.x();
-				rotatedY += center.y();
+				int rotatedX = qRound(center.x() + translatedX * cosAngle - translatedY * sinAngle);
+				int rotatedY = qRound(center.y() + translatedX * sinAngle + translatedY * cosAngle);
 
 				rotatedPoints.append(QPoint(rotatedX, rotatedY));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), rotatedPoints);
 			pair.first.get().setPoints(rotatedPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
 }
 
-QPoint ViewerWidget::calculateCurveCenter(BezierCurve& curve) const {
+QPointF ViewerWidget::calculateCurveCenter(BezierCurve& curve) const {
 	const QVector<QPoint>& points = curve.getPoints();
 	if (points.isEmpty()) {
-		return QPoint();
+		return QPointF();
 	}
 
 	double centroidX = 0;
@@ -1057,7 +1124,7 @@ QPoint ViewerWidget::calculateCurveCenter(BezierCurve& curve) const {
 	centroidX /= points.size();
 	centroidY /= points.size();
 
-	return QPoint(static_cast<int>(centroidX), static_cast<int>(centroidY));
+	return QPointF(centroidX, centroidY);
 }
 
 //-----------------------------------------
@@ -1065,60 +1132,19 @@ QPoint ViewerWidget::calculateCurveCenter(BezierCurve& curve) const {
 //-----------------------------------------
 
 void ViewerWidget::drawRectangle(MyRectangle& rectangle) {
-	borderColor = rectangle.getBorderColor();
-	fillingColor = rectangle.getFillingColor();
-	const QVector<QPoint>& pointsVector = rectangle.getPoints();
-
-	if (pointsVector.size() < 2) {
+	if (rectangle.getPoints().size() < 2) {
 		QMessageBox::warning(this, "Insufficient Points", "Not enough points to render the rectangle.");
 		return;
 	}
 
-	painter->setPen(QPen(borderColor));
-
-	QVector<QPoint> rectanglePoints = rectangle.getPoints();
-
-	bool allPointsOutside = std::all_of(pointsVector.begin(), pointsVector.end(), [this](const QPoint& point) {
-		return !isInside(point);
-		});
-
-	if (allPointsOutside) {
-		qDebug() << "Rectangle is outside the boundary.";
-		return;
-	}
-
-	for (const QPoint& point : rectanglePoints) {
-		if (!isInside(point)) {
-			rectanglePoints = trimPolygon(rectangle);
-			break;
-		}
-	}
-
-	if (rectangle.getIsFilled()) {
-		fillPolygon(rectangle);
-	}
-	painter->setPen(QPen(borderColor));
-
-	std::vector<Line> lines;
-	if (!rectanglePoints.isEmpty()) {
-		lines.emplace_back(rectanglePoints.at(0), rectanglePoints.at(1), rectangle.getZBufferPosition(), rectangle.getIsFilled(), borderColor, fillingColor);
-		lines.emplace_back(rectanglePoints.at(1), rectanglePoints.at(2), rectangle.getZBufferPosition(), rectangle.getIsFilled(), borderColor, fillingColor);
-		lines.emplace_back(rectanglePoints.at(2), rectanglePoints.at(3), rectangle.getZBufferPosition(), rectangle.getIsFilled(), borderColor, fillingColor);
-		lines.emplace_back(rectanglePoints.at(3), rectanglePoints.at(0), rectangle.getZBufferPosition(), rectangle.getIsFilled(), borderColor, fillingColor);
-	}
-	for (Line& line : lines) {
-		drawLine(line);
-	}
-
+	drawShape(rectangle);
 	update();
 }
 
 void ViewerWidget::moveRectangle(const QPoint& offset) {
-	qDebug() << "Current Layer: " << currentLayer;
-	qDebug() << "Z-Buffer Size: " << zBuffer.size();
+	RENDER_LOG(Edit, Trace, "moveRectangle layer {} of {} offset {}", currentLayer, zBuffer.size(), offset);
 	if (currentLayer >= 0 && currentLayer < zBuffer.size()) {
 		auto& pair = zBuffer[currentLayer];
-		qDebug() << "ShapeType: " << pair.first.get().getType();
 		if (pair.first.get().getType() == Shape::RECTANGLE) {
 			MyRectangle& rectangle = static_cast<MyRectangle&>(pair.first.get());
 			const QVector<QPoint>& points = rectangle.getPoints();
@@ -1128,11 +1154,9 @@ void ViewerWidget::moveRectangle(const QPoint& offset) {
 				movedPoints.append(point + offset);
 			}
 
-			for (const QPoint& point : movedPoints) {
-				qDebug() << "Rectangle Point: " << point.x() << "," << point.y();
-			}
-
+			history.recordTranslate(pair.first.get(), offset);
 			pair.first.get().setPoints(movedPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -1144,7 +1168,7 @@ void ViewerWidget::scaleRectangle(double scaleX, double scaleY) {
 		if (pair.first.get().getType() == Shape::RECTANGLE) {
 			MyRectangle& rectangle = static_cast<MyRectangle&>(pair.first.get());
 			const QVector<QPoint>& points = rectangle.getPoints();
-			QPoint center = getPolygonCenter(rectangle);
+			QPointF center = getPolygonCenter(rectangle);
 
 			QVector<QPoint> scaledPoints;
 			for (const QPoint& point : points) {
@@ -1154,7 +1178,9 @@ void ViewerWidget::scaleRectangle(double scaleX, double scaleY) {
 				scaledPoints.append(QPoint(static_cast<int>(std::round(newX)), static_cast<int>(std::round(newY))));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), scaledPoints);
 			pair.first.get().setPoints(scaledPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
@@ -1166,7 +1192,7 @@ void ViewerWidget::turnRectangle(int angle) {
 		if (pair.first.get().getType() == Shape::RECTANGLE) {
 			MyRectangle& rectangle = static_cast<MyRectangle&>(pair.first.get());
 			const QVector<QPoint>& points = rectangle.getPoints();
-			QPoint center = getPolygonCenter(rectangle);
+			QPointF center = getPolygonCenter(rectangle);
 
 			double radians = qDegreesToRadians(static_cast<double>(angle));
 			double cosAngle = std::cos(radians);
@@ -1175,19 +1201,18 @@ void ViewerWidget::turnRectangle(int angle) {
 			QVector<QPoint> rotatedPoints;
 
 			for (const QPoint& point : points) {
-				int translatedX = point.x() - center.x();
-				int translatedY = point.y() - center.y();
-
-				int rotatedX = static_cast<int>(translatedX * cosAngle - translatedY * sinAngle);
-				int rotatedY = static_cast<int>(translatedX * sinAngle + translatedY * cosAngle);
+				double translatedX = point.x() - center.x();
+				double translatedY = point.y() - center.y();
 
-				rotatedX += center.x();
-				rotatedY += center.y();
+				int rotatedX = qRound(center.x() + translatedX * cosAngle - translatedY * sinAngle);
+				int rotatedY = qRound(center.y() + translatedX * sinAngle + translatedY * cosAngle);
 
 				rotatedPoints.append(QPoint(rotatedX, rotatedY));
 			}
 
+			history.recordGeometry(pair.first.get(), pair.first.get().getPoints(), rotatedPoints);
 			pair.first.get().setPoints(rotatedPoints);
+			journalPoints(currentLayer);
 			redrawAllShapes();
 		}
 	}
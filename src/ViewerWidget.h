@@ -5,6 +5,14 @@
 #include <QVector3D>
 #include "lighting.h"
 #include "representation.h"
+#include "Rasterizer.h"
+#include "RenderBackend.h"
+#include "SceneFile.h"
+#include "TiledFramebuffer.h"
+#include "EditHistory.h"
+#include "SceneJournal.h"
+#include "SharedFramebuffer.h"
+#include "ImageExporter.h"
 
 struct ClippedLine {
 	QVector<QPoint> points;
@@ -15,9 +23,33 @@ class ViewerWidget :public QWidget {
 	Q_OBJECT
 private:
 	QSize areaSize = QSize(0, 0);
-	QImage* img = nullptr;
-	QPainter* painter = nullptr;
+	QSize documentSize = QSize(0, 0);
+	double zoom = 1.0;
+	QImage background;				// volitelny obrazok pod tvarmi (setImage)
+	QImage* img = nullptr;			// framebuffer len pre viditelny vyrez, v rozliseni obrazovky
+	QRect viewRect;					// cast widgetu, ktoru img pokryva
 	uchar* data = nullptr;
+	Rasterizer raster;
+	std::unique_ptr<RenderBackend> backend;	// kresli scenu do img; Software pouziva raster (roviny), ostatne len farby
+	DepthBuffer depthPlane;			// hlbky pixelov vyrezu, poradie kreslenia tvarov potom nehra rolu
+	bool depthTest = true;
+	IdBuffer idPlane;				// index vrstvy + 1 pre kazdy pixel vyrezu (vyber kliknutim)
+	bool picking = true;
+	int hoveredShape = -1;
+	bool profilerOverlay = false;
+	EditHistory history;
+	SceneJournal journal;			// prirastkove ukladanie a obnova po pade otvorenej/ulozenej sceny
+	std::unique_ptr<SharedFramebuffer> sharedFrames;	// hotove snimky vyrezu pre ine procesy (null = vypnute)
+	bool canvasChanged = true;		// img sa zmenil od posledneho zverejnenia snimku
+
+	void attachPlanes();
+	void detachPlanes();
+	QRect hoverRect(int index);
+	void swapLayers(int index);
+	void insertLayer(int index, Shape& shape, int zBufferPosition);
+	void removeLayer(int index);
+	EditHistory::Step applyEdit(EditHistory::Edit& edit, bool forward);
+	void journalPoints(int index);
 
 	bool drawLineActivated = false;
 	bool drawCircleActivated = false;
@@ -30,6 +62,7 @@ private:
 	QVector<QPoint> originalPointsVector;
 
 	std::vector<std::pair<std::reference_wrapper<Shape>, int>> zBuffer;
+	std::vector<Shape*> drawList() const;	// tvary zBuffer v poradi vrstiev pre Rasterizer::drawShapes
 	int currentLayer;
 	QColor borderColor, fillingColor;
 
@@ -41,7 +74,7 @@ public:
 	//Image functions
 	bool setImage(const QImage& inputImg);
 	QImage* getImage() { return img; };
-	QPainter* getPainter() { return painter; }
+	ImageExporter::Document exportDocument() const;	// kopia sceny, kresli sa az vo vlakne exportu
 	bool isEmpty();
 	bool changeSize(int width, int height);
 	void changeLayerColor(int zBufferPosition, const QColor& newBorderColor, const QColor& newFillingColor);
@@ -49,15 +82,69 @@ public:
 	void setPixel(int x, int y, uchar r, uchar g, uchar b, uchar a = 255);
 	void setPixel(int x, int y, double valR, double valG, double valB, double valA = 1.);
 	void setPixel(int x, int y, const QColor& color);
-	bool isInside(QPoint point) { return (point.x() > 0 && point.y() > 0 && point.x() < img->width() - 1 && point.y() < img->height() - 1) ? true : false; }
-	bool isInside(int x, int y) { return (x > 0 && y > 0 && x < img->width() && y < img->height()) ? true : false; }
+	bool isInside(QPoint point) { return isInside(point.x(), point.y()); }
+	bool isInside(int x, int y) { return (x > 0 && y > 0 && x < documentSize.width() && y < documentSize.height()) ? true : false; }
+
+	//View functions
+	static constexpr double MinZoom = 0.0625;
+	static constexpr double MaxZoom = 32.0;
+	double getZoom() const { return zoom; }
+	void setZoom(double newZoom);
+	QPoint toDocument(const QPoint& widgetPoint) const;
+	QRect visibleArea() const;
+	QSize scaledDocumentSize() const;
+	void invalidateViewport();
+	void renderViewport();
+	void renderRegion(const QRect& documentRect);
+	void clearViewport();
+	void clearViewport(const QRect& targetRect);
+
+	//Render backend
+	void setRenderBackend(RenderBackend::Kind kind);
+	RenderBackend::Kind getRenderBackend() const { return backend->kind(); }
+	const RenderBackend::Stats& getBackendStats() const { return backend->getStats(); }
+
+	//Shared-memory framebuffer
+	// Prazdne meno vypne zverejnovanie; kazdy dokresleny snimok vyrezu sa skopiruje do volneho slotu
+	bool setSharedFramebuffer(const QString& name, QString* errorMessage = nullptr);
+	bool isSharingFrames() const { return sharedFrames != nullptr; }
+
+	//Profiler
+	void setProfilerOverlay(bool enabled);
+	bool getProfilerOverlay() const { return profilerOverlay; }
+	void drawProfilerOverlay(QPainter& painter);
 
 	//Draw functions
 	void drawShape(Shape& shape);
 	void moveShapeUp(int zBufferPosition);
 	void moveShapeDown(int zBufferPosition);
-	void addToZBuffer(Shape& shape, int depth);
+	void addToZBuffer(Shape& shape, int depth, bool recordUndo = true);
 	void redrawAllShapes();
+	void redrawShapeOnTop(int index);
+	quint32 shapeDepth(Shape& shape) const;
+	void setDepthTest(bool enabled, DepthBuffer::Format format = DepthBuffer::Depth32);
+	bool getDepthTest() const { return depthTest; }
+
+	//Undo/redo
+	EditHistory::Step undo();
+	EditHistory::Step redo();
+	bool canUndo() const { return history.canUndo(); }
+	bool canRedo() const { return history.canRedo(); }
+	void endEditGroup() { history.closeGroup(); }
+	void setUndoMemoryLimit(qint64 bytes) { history.setMemoryLimit(bytes); }
+	const EditHistory& getHistory() const { return history; }
+
+	//Scene journal
+	bool attachJournal(const QString& scenePath, bool keepUnsaved = false);
+	void detachJournal() { journal.close(); }
+	bool hasJournal() const { return journal.isOpen(); }
+
+	//Picking
+	void setPicking(bool enabled);
+	bool getPicking() const { return picking; }
+	int shapeIndexAt(const QPoint& widgetPoint) const;
+	void setHoveredShape(int index);
+	int getHoveredShape() const { return hoveredShape; }
 
 	//	Lines
 	void drawLine(Line& line);
@@ -65,16 +152,13 @@ public:
 	QPoint getDrawLineBegin() { return drawLineBegin; }
 	void setDrawLineActivated(bool state) { drawLineActivated = state; }
 	bool getDrawLineActivated() { return drawLineActivated; }
-	void drawLineBresenham(QVector<QPoint>& linePoints);
 	void moveLine(const QPoint& offset);
 	void turnLine(int angle);
-	QPoint getLineCenter(Line& line) const;
+	QPointF getLineCenter(Line& line) const;
 	void scaleLine(double scaleX, double scaleY);
 	
 	//	Circles
 	void drawCircle(Circle& circle);
-	void drawSymmetricPoints(const QPoint& center, int x, int y);
-	void drawSymmetricPointsFilled(const QPoint& center, int x, int y);
 	void setDrawCircleActivated(bool state) { drawCircleActivated = state; }
 	bool getDrawCircleActivated() { return drawCircleActivated; }
 	void setDrawCircleCenter(QPoint center) { drawCircleCenter = center; }
@@ -88,87 +172,15 @@ public:
 	QPoint getMoveStart() { return moveStart; }
 	void movePolygon(const QPoint& offset);
 	void turnPolygon(int angle);
-	QPoint getPolygonCenter(Shape& polygon) const;
+	QPointF getPolygonCenter(Shape& polygon) const;
 	void scalePolygon(double scaleX, double scaleY);
 	
-	//  **Trimming functions**
-	QVector<QPoint> trimPolygon(Shape& polygon);
-	void clipLineWithPolygon(QVector<QPoint> linePoints);
-
-	//	**Polygon filling handling**
-
-	//	<Subclass for edges>
-	class Edge {
-	private:
-		QPoint startPoint_;  // Zaciatocny bod hrany
-		QPoint endPoint_;    // Koncovy bod hrany
-		double slope_;       // Sklon hrany
-		double x_;           // Aktualna x pozicia pre vyplnovanie pomocou ScanLine algoritmu
-		double w_;           // Inverzny sklon pre aktualizaciu x
-
-	public:
-		// Konstruktor prijima zaciatocny a koncovy bod hrany a inicializuje clenske premenne
-		Edge() : startPoint_(QPoint(0, 0)), endPoint_(QPoint(0, 0)), slope_(0.0), x_(0.0), w_(0.0) {}
-		Edge(QPoint start, QPoint end) : startPoint_(start), endPoint_(end), x_(0.0), w_(0.0) {
-			calculateAttributes();
-		}
-
-		// Vypocet atributov hrany (sklon, inverzny sklon)
-		void calculateAttributes() {
-			double dx = static_cast<double>(endPoint_.x() - startPoint_.x());
-			double dy = static_cast<double>(endPoint_.y() - startPoint_.y());
-
-			if (dx == 0) {
-				slope_ = std::numeric_limits<double>::max(); // Nastavenie smernice/sklonu na maximalnu hodnotu pre double, reprezentuje vertikalny sklon
-				w_ = 0; // Pre vertikalne hrany je inverzny sklon nulovy
-			}
-			else {
-				slope_ = dy / dx; // Vypocet sklonu ako pomer zmeny y k zmene x
-				w_ = 1.0 / slope_; // Vypocet inverzneho sklonu
-			}
-
-			x_ = static_cast<double>(startPoint_.x());
-
-			// y-ova suradnica zaciatocneho bodu je vzdy mensia ako y-ova suradnica koncoveho bodu
-			if (startPoint_.y() > endPoint_.y()) {
-				swapStartEndPoints();
-				calculateAttributes(); // Rekurzivny prepocet atributov, ak doslo k vymene bodov
-			}
-		}
-
-		// Metoda pre vymenu zaciatocneho a koncoveho bodu
-		void swapStartEndPoints() {
-			std::swap(startPoint_, endPoint_);
-		}
-
-		// Uprava koncoveho bodu hrany o -1 na y-ovej suradnici, pouzitie po nacitani hrán
-		void adjustEndPoint() {
-			endPoint_.setY(endPoint_.y() - 1);
-		}
-
-		// Gettery pre pristup k clenskym premennym
-		QPoint startPoint() const { return startPoint_; }
-		QPoint endPoint() const { return endPoint_; }
-		double slope() const { return slope_; }
-		double x() const { return x_; }
-		double w() const { return w_; }
-
-		// Setter pre nastavenie aktualnej x-ovej pozicie
-		void setX(double x) { x_ = x; }
-	};
-
-	static bool compareByY(const Edge& edge1, const Edge& edge2){ return edge1.startPoint().y() < edge2.startPoint().y(); }
-	static bool compareByX(const Edge& edge1, const Edge& edge2){ return edge1.x() < edge2.x(); }
-	
-	void fillPolygon(Shape& polygon);
-	QVector<Edge> loadEdges(const QVector<QPoint>& points);
-
 	//	** Curve function declarations **
 	void drawCurve(BezierCurve& curve);
 	void moveCurve(const QPoint& offset);
 	void scaleCurve(double scaleX, double scaleY);
 	void turnCurve(int angle);
-	QPoint calculateCurveCenter(BezierCurve& curve) const;
+	QPointF calculateCurveCenter(BezierCurve& curve) const;
 
 	//	Rectangles
 	void drawRectangle(MyRectangle& rectangle);
@@ -178,10 +190,9 @@ public:
 
 	//Get/Set functions
 	uchar* getData() { return data; }
-	void setDataPtr() { data = img->bits(); }
-	void setPainter() { painter = new QPainter(img); }
-	void setBorderColor(QColor border) { borderColor = border; }
-	void setFillingColor(QColor filling) { fillingColor = filling; }
+	void setDataPtr() { data = img->bits(); raster.setTarget(img); }
+	void setBorderColor(QColor border) { borderColor = border; raster.setBorderColor(border); }
+	void setFillingColor(QColor filling) { fillingColor = filling; raster.setFillingColor(filling); }
 	void setLayer(int layer) { currentLayer = layer; }
 
 	void setDrawRectangleActivated(bool state) { drawRectangleActivated = state; }
@@ -189,13 +200,14 @@ public:
 	void setDrawRectangleBegin(QPoint begin) { drawRectangleBegin = begin; }
 	QPoint getDrawRectangleBegin() { return drawRectangleBegin; }
 
-	int getImgWidth() { return img->width(); };
-	int getImgHeight() { return img->height(); };
+	int getImgWidth() { return documentSize.width(); };
+	int getImgHeight() { return documentSize.height(); };
 
-	void clearZBuffer() { zBuffer.clear(); }
+	void clearZBuffer() { zBuffer.clear(); history.clear(); journal.close(); hoveredShape = -1; }
 	void clear();
 	void deleteObjectFromZBuffer(int currentIndex);
 	void saveCurrentImageState();
+	const std::vector<std::pair<std::reference_wrapper<Shape>, int>>& getZBuffer() const { return zBuffer; }
 
 public slots:
 	void paintEvent(QPaintEvent* event) Q_DECL_OVERRIDE;
@@ -0,0 +1,503 @@
+#include "CompactScene.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QStringList>
+#include <algorithm>
+#include <limits>
+#include "FillShader.h"
+#include "SceneFile.h"
+
+namespace {
+
+// Odhad reziu alokacie na halde a hlavicky dat QVector (QArrayData)
+constexpr qint64 HeapBlockOverhead = 16;
+constexpr qint64 ArrayHeader = 16;
+
+bool fitsShort(int value)
+{
+	return value >= std::numeric_limits<qint16>::min() && value <= std::numeric_limits<qint16>::max();
+}
+
+quint32 joinCode(Qt::PenJoinStyle join)
+{
+	return join == Qt::BevelJoin ? 1 : join == Qt::RoundJoin ? 2 : 0;
+}
+
+Qt::PenJoinStyle joinOf(quint32 code)
+{
+	return code == 1 ? Qt::BevelJoin : code == 2 ? Qt::RoundJoin : Qt::MiterJoin;
+}
+
+quint32 capCode(Qt::PenCapStyle cap)
+{
+	return cap == Qt::SquareCap ? 1 : cap == Qt::RoundCap ? 2 : 0;
+}
+
+Qt::PenCapStyle capOf(quint32 code)
+{
+	return code == 1 ? Qt::SquareCap : code == 2 ? Qt::RoundCap : Qt::FlatCap;
+}
+
+// Rohy p1, (p3.x, p1.y), p3, (p1.x, p3.y) - obdlznik z editora aj zo sceny
+bool isAxisRectangle(const QVector<QPoint>& corners)
+{
+	return corners.size() == 4
+		&& corners[1] == QPoint(corners[2].x(), corners[0].y())
+		&& corners[3] == QPoint(corners[0].x(), corners[2].y());
+}
+
+}
+
+//-----------------------------------------
+//		*** Storage ***
+//-----------------------------------------
+
+void CompactScene::reserve(size_t shapes, size_t vertexCount)
+{
+	records.reserve(shapes);
+	points.reserve(vertexCount * 2);
+}
+
+void CompactScene::clear()
+{
+	records.clear();
+	points.clear();
+	shaders.clear();
+	vertices = 0;
+}
+
+void CompactScene::squeeze()
+{
+	records.shrink_to_fit();
+	points.shrink_to_fit();
+	shaders.shrink_to_fit();
+}
+
+bool CompactScene::append(Shape& shape)
+{
+	QVector<QPoint> shapePoints = shape.getPoints();
+	if (shapePoints.size() < 2 || (shape.getType() == Shape::RECTANGLE && shapePoints.size() != 4) || points.size() + static_cast<size_t>(shapePoints.size()) * 4 > std::numeric_limits<quint32>::max()) {
+		return false;
+	}
+
+	quint32 flags = static_cast<quint32>(shape.getType());
+	if (shape.getIsFilled()) {
+		flags |= Filled;
+	}
+	if (shape.hasBorderColor()) {
+		flags |= BorderValid;
+	}
+	if (shape.hasFillingColor()) {
+		flags |= FillingValid;
+	}
+	if (shape.getType() == Shape::POLYGON && static_cast<MyPolygon&>(shape).getFillRule() == Qt::WindingFill) {
+		flags |= WindingFill;
+	}
+	flags |= joinCode(shape.getJoinStyle()) << JoinShift;
+	flags |= capCode(shape.getCapStyle()) << CapShift;
+	flags |= static_cast<quint32>(qMin(shape.getStrokeWidth(), 0xffff)) << StrokeShift;
+	if (shape.getFillShader()) {
+		flags |= HasShader;
+		shaders.emplace_back(static_cast<quint32>(records.size()), shape.getFillShader());
+	}
+
+	vertices += shapePoints.size();
+	if (shape.getType() == Shape::RECTANGLE && isAxisRectangle(shapePoints)) {
+		flags |= AxisRectangle;
+		shapePoints = { shapePoints[0], shapePoints[2] };
+	}
+
+	Record record;
+	record.offset = static_cast<quint32>(points.size());
+	record.border = shape.getBorderRgba();
+	record.filling = shape.getFillingRgba();
+	record.depth = shape.getZBufferPosition();
+	encodePoints(shapePoints, flags);
+	record.flags = flags;
+	records.push_back(record);
+	return true;
+}
+
+void CompactScene::pushWide(int value)
+{
+	quint32 bits = static_cast<quint32>(value);
+	points.push_back(static_cast<qint16>(bits & 0xffff));
+	points.push_back(static_cast<qint16>(bits >> 16));
+}
+
+int CompactScene::readWide(size_t word) const
+{
+	quint32 low = static_cast<quint16>(points[word]);
+	quint32 high = static_cast<quint16>(points[word + 1]);
+	return static_cast<int>(low | (high << 16));
+}
+
+void CompactScene::encodePoints(const QVector<QPoint>& source, quint32& flags)
+{
+	bool shortDeltas = true;
+	for (int i = 1; i < source.size() && shortDeltas; i++) {
+		shortDeltas = fitsShort(source[i].x() - source[i - 1].x()) && fitsShort(source[i].y() - source[i - 1].y());
+	}
+
+	if (!shortDeltas) {
+		flags |= Wide << EncodingShift;
+		for (const QPoint& point : source) {
+			pushWide(point.x());
+			pushWide(point.y());
+		}
+		return;
+	}
+
+	const QPoint& first = source.first();
+	if (fitsShort(first.x()) && fitsShort(first.y())) {
+		flags |= Short << EncodingShift;
+		points.push_back(static_cast<qint16>(first.x()));
+		points.push_back(static_cast<qint16>(first.y()));
+	}
+	else {
+		flags |= Anchored << EncodingShift;
+		pushWide(first.x());
+		pushWide(first.y());
+	}
+	for (int i = 1; i < source.size(); i++) {
+		points.push_back(static_cast<qint16>(source[i].x() - source[i - 1].x()));
+		points.push_back(static_cast<qint16>(source[i].y() - source[i - 1].y()));
+	}
+}
+
+int CompactScene::storedCount(size_t index) const
+{
+	size_t words = pointsEnd(index) - records[index].offset;
+	switch ((records[index].flags >> EncodingShift) & 0x3) {
+	case Short:
+		return static_cast<int>(words / 2);
+	case Anchored:
+		return static_cast<int>((words - 2) / 2);
+	default:
+		return static_cast<int>(words / 4);
+	}
+}
+
+//-----------------------------------------
+//		*** Decoding ***
+//-----------------------------------------
+
+QVector<QPoint> CompactScene::pointsAt(size_t index) const
+{
+	const Record& record = records[index];
+	int count = storedCount(index);
+	QVector<QPoint> result;
+	result.reserve(record.flags & AxisRectangle ? 4 : count);
+
+	size_t word = record.offset;
+	quint32 encoding = (record.flags >> EncodingShift) & 0x3;
+	if (encoding == Wide) {
+		for (int i = 0; i < count; i++, word += 4) {
+			result.append(QPoint(readWide(word), readWide(word + 2)));
+		}
+	}
+	else {
+		QPoint point;
+		if (encoding == Short) {
+			point = QPoint(points[word], points[word + 1]);
+			word += 2;
+		}
+		else {
+			point = QPoint(readWide(word), readWide(word + 2));
+			word += 4;
+		}
+		result.append(point);
+		for (int i = 1; i < count; i++, word += 2) {
+			point += QPoint(points[word], points[word + 1]);
+			result.append(point);
+		}
+	}
+
+	if (record.flags & AxisRectangle) {
+		QPoint p1 = result[0];
+		QPoint p3 = result[1];
+		result = { p1, QPoint(p3.x(), p1.y()), p3, QPoint(p1.x(), p3.y()) };
+	}
+	return result;
+}
+
+ShapeVariant CompactScene::shapeAt(size_t index) const
+{
+	const Record& record = records[index];
+	QVector<QPoint> shapePoints = pointsAt(index);
+	bool filled = record.flags & Filled;
+	QColor border = (record.flags & BorderValid) ? QColor::fromRgba(record.border) : QColor();
+	QColor filling = (record.flags & FillingValid) ? QColor::fromRgba(record.filling) : QColor();
+
+	ShapeVariant shape = [&]() -> ShapeVariant {
+		switch (typeAt(index)) {
+		case Shape::LINE:
+			return Line(shapePoints[0], shapePoints[1], record.depth, filled, border, filling);
+		case Shape::RECTANGLE:
+			return MyRectangle(shapePoints[0], shapePoints[1], shapePoints[2], shapePoints[3], record.depth, filled, border, filling);
+		case Shape::POLYGON:
+			return MyPolygon(shapePoints, record.depth, filled, border, filling);
+		case Shape::CIRCLE:
+			return Circle(shapePoints[0], shapePoints[1], record.depth, filled, border, filling);
+		case Shape::BEZIER_CURVE:
+		default:
+			return BezierCurve(shapePoints, record.depth, filled, border, filling);
+		}
+	}();
+
+	Shape& base = shapeOf(shape);
+	base.setStrokeWidth(static_cast<int>(record.flags >> StrokeShift));
+	base.setJoinStyle(joinOf((record.flags >> JoinShift) & 0x3));
+	base.setCapStyle(capOf((record.flags >> CapShift) & 0x3));
+	if (record.flags & WindingFill) {
+		std::get<MyPolygon>(shape).setFillRule(Qt::WindingFill);
+	}
+	if (record.flags & HasShader) {
+		auto found = std::lower_bound(shaders.begin(), shaders.end(), static_cast<quint32>(index),
+			[](const std::pair<quint32, std::shared_ptr<const FillShader>>& entry, quint32 key) { return entry.first < key; });
+		if (found != shaders.end() && found->first == index) {
+			base.setFillShader(found->second);
+		}
+	}
+	return shape;
+}
+
+void CompactScene::decode(size_t first, size_t count, std::vector<ShapeVariant>& out) const
+{
+	size_t last = qMin(first + count, records.size());
+	for (size_t i = first; i < last; i++) {
+		out.push_back(shapeAt(i));
+	}
+}
+
+//-----------------------------------------
+//		*** Binary file ***
+//-----------------------------------------
+
+bool CompactScene::isCompactFile(const QString& filePath)
+{
+	QFile file(filePath);
+	char magic[4] = {};
+	return file.open(QIODevice::ReadOnly) && file.read(magic, sizeof(magic)) == sizeof(magic) && std::equal(magic, magic + 4, "CSCN");
+}
+
+bool CompactScene::save(const QString& filePath, QString* errorMessage) const
+{
+	QSaveFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly)) {
+		if (errorMessage) {
+			*errorMessage = "Unable to open file for writing.";
+		}
+		return false;
+	}
+
+	FileHeader header = { { 'C', 'S', 'C', 'N' }, FileVersion, 0x01020304, static_cast<quint32>(shaders.size()),
+		records.size(), points.size(), vertices };
+	bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header)
+		&& file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record)) == static_cast<qint64>(records.size() * sizeof(Record))
+		&& file.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(qint16)) == static_cast<qint64>(points.size() * sizeof(qint16));
+
+	// Shader: index tvaru, dlzka a pole fill= (rovnako ako v CSV)
+	for (size_t i = 0; ok && i < shaders.size(); i++) {
+		ShapeVariant shape = shapeAt(shaders[i].first);
+		QByteArray field = SceneFile::fillAttribute(shapeOf(shape)).toUtf8();
+		quint32 entry[2] = { shaders[i].first, static_cast<quint32>(field.size()) };
+		ok = file.write(reinterpret_cast<const char*>(entry), sizeof(entry)) == sizeof(entry) && file.write(field) == field.size();
+	}
+
+	if (!ok || !file.commit()) {
+		if (errorMessage) {
+			*errorMessage = file.errorString();
+		}
+		return false;
+	}
+	return true;
+}
+
+bool CompactScene::load(const QString& filePath, QString* errorMessage)
+{
+	auto fail = [errorMessage](const QString& message) {
+		if (errorMessage) {
+			*errorMessage = message;
+		}
+		return false;
+	};
+
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return fail("Unable to open file for reading.");
+	}
+
+	FileHeader header;
+	if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) || !std::equal(header.magic, header.magic + 4, "CSCN")) {
+		return fail("Invalid file format.");
+	}
+	if (header.version != FileVersion || header.byteOrder != 0x01020304) {
+		return fail("Unsupported compact scene version or byte order.");
+	}
+	quint64 arrayBytes = header.shapeCount * sizeof(Record) + header.pointWords * sizeof(qint16);
+	if (header.shapeCount > std::numeric_limits<quint32>::max() || header.pointWords > std::numeric_limits<quint32>::max()
+		|| static_cast<quint64>(file.size()) < sizeof(header) + arrayBytes) {
+		return fail("Truncated compact scene.");
+	}
+
+	clear();
+	records.resize(header.shapeCount);
+	points.resize(header.pointWords);
+	qint64 recordBytes = static_cast<qint64>(records.size() * sizeof(Record));
+	qint64 pointBytes = static_cast<qint64>(points.size() * sizeof(qint16));
+	if (file.read(reinterpret_cast<char*>(records.data()), recordBytes) != recordBytes
+		|| file.read(reinterpret_cast<char*>(points.data()), pointBytes) != pointBytes) {
+		clear();
+		return fail("Truncated compact scene.");
+	}
+	vertices = header.vertexCount;
+
+	// Poskodeny subor nesmie pri rozbalovani citat mimo zasobnika bodov
+	for (size_t i = 0; i < records.size(); i++) {
+		const Record& record = records[i];
+		size_t end = pointsEnd(i);
+		size_t words = end >= record.offset ? end - record.offset : 0;
+		quint32 encoding = (record.flags >> EncodingShift) & 0x3;
+		bool valid = end >= record.offset && end <= points.size() && (record.flags & TypeMask) <= Shape::BEZIER_CURVE
+			&& (encoding == Short ? words >= 4 && words % 2 == 0
+				: encoding == Anchored ? words >= 6 && words % 2 == 0
+				: encoding == Wide && words >= 8 && words % 4 == 0);
+		// shapeAt cita pevny pocet bodov podla typu a pravidlo vyplne nastavuje len polygonu
+		if (valid) {
+			Shape::ShapeType type = typeAt(i);
+			int count = storedCount(i);
+			bool pointsOk = (record.flags & AxisRectangle) ? type == Shape::RECTANGLE && count == 2
+				: type == Shape::RECTANGLE ? count == 4
+				: count >= 2;
+			valid = pointsOk && (!(record.flags & WindingFill) || type == Shape::POLYGON);
+		}
+		if (!valid) {
+			clear();
+			return fail(QString("Corrupt shape record %1.").arg(i));
+		}
+	}
+
+	for (quint32 i = 0; i < header.shaderCount; i++) {
+		quint32 entry[2];
+		if (file.read(reinterpret_cast<char*>(entry), sizeof(entry)) != sizeof(entry) || entry[0] >= records.size()
+			|| (!shaders.empty() && entry[0] <= shaders.back().first)) {
+			clear();
+			return fail("Corrupt shader table.");
+		}
+		QByteArray field = file.read(entry[1]);
+		Line carrier(QPoint(), QPoint(), 0, false, QColor(), QColor());
+		SceneFile::applyAttribute(carrier, QString::fromUtf8(field));
+		if (carrier.getFillShader()) {
+			shaders.emplace_back(entry[0], carrier.getFillShader());
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------
+//		*** Memory accounting ***
+//-----------------------------------------
+
+qint64 CompactScene::memoryUsage() const
+{
+	return static_cast<qint64>(records.capacity() * sizeof(Record) + points.capacity() * sizeof(qint16)
+		+ shaders.capacity() * sizeof(shaders[0]));
+}
+
+CompactScene::MemoryReport CompactScene::memoryReport() const
+{
+	MemoryReport report;
+	for (size_t i = 0; i < records.size(); i++) {
+		TypeUsage& usage = report.types[typeAt(i)];
+		usage.shapes++;
+		usage.vertices += (records[i].flags & AxisRectangle) ? 4 : storedCount(i);
+		usage.bytes += sizeof(Record) + (pointsEnd(i) - records[i].offset) * sizeof(qint16);
+	}
+	// Shadery su zdielane, zapocita sa len zaznam v zozname; zvysok je nevyuzita kapacita poli
+	report.sharedBytes = memoryUsage() - static_cast<qint64>(records.size() * sizeof(Record) + points.size() * sizeof(qint16));
+	return report;
+}
+
+qint64 CompactScene::heapUsage(Shape& shape)
+{
+	qint64 bytes = HeapBlockOverhead + visitShape(shape, [](auto& typed) { return static_cast<qint64>(sizeof(typed)); });
+	if (shape.getType() == Shape::POLYGON || shape.getType() == Shape::BEZIER_CURVE) {
+		bytes += HeapBlockOverhead + ArrayHeader + static_cast<qint64>(shape.getPoints().capacity()) * sizeof(QPoint);
+	}
+	if (shape.getType() == Shape::POLYGON && static_cast<MyPolygon&>(shape).hasTriangles()) {
+		bytes += HeapBlockOverhead + ArrayHeader + static_cast<qint64>(static_cast<MyPolygon&>(shape).getTriangles().capacity()) * sizeof(int);
+	}
+	if (shape.hasStrokeOutline()) {
+		const QVector<QVector<QPointF>>& outline = shape.getStrokeOutline();
+		bytes += HeapBlockOverhead + ArrayHeader + static_cast<qint64>(outline.capacity()) * sizeof(QVector<QPointF>);
+		for (const QVector<QPointF>& contour : outline) {
+			bytes += HeapBlockOverhead + ArrayHeader + static_cast<qint64>(contour.capacity()) * sizeof(QPointF);
+		}
+	}
+	return bytes;
+}
+
+CompactScene::MemoryReport CompactScene::heapReport(Shape* const* shapes, size_t count)
+{
+	MemoryReport report;
+	for (size_t i = 0; i < count; i++) {
+		TypeUsage& usage = report.types[shapes[i]->getType()];
+		usage.shapes++;
+		usage.vertices += shapes[i]->getPoints().size();
+		usage.bytes += heapUsage(*shapes[i]);
+	}
+	// Zoznam smernikov na tvary
+	report.sharedBytes = static_cast<qint64>(count * sizeof(Shape*));
+	return report;
+}
+
+qint64 CompactScene::MemoryReport::totalShapes() const
+{
+	qint64 total = 0;
+	for (const TypeUsage& usage : types) {
+		total += usage.shapes;
+	}
+	return total;
+}
+
+qint64 CompactScene::MemoryReport::totalVertices() const
+{
+	qint64 total = 0;
+	for (const TypeUsage& usage : types) {
+		total += usage.vertices;
+	}
+	return total;
+}
+
+qint64 CompactScene::MemoryReport::totalBytes() const
+{
+	qint64 total = sharedBytes;
+	for (const TypeUsage& usage : types) {
+		total += usage.bytes;
+	}
+	return total;
+}
+
+QString CompactScene::MemoryReport::toText(const QString& title) const
+{
+	static const char* names[] = { "Line", "Rectangle", "Polygon", "Circle", "BezierCurve" };
+
+	QStringList lines;
+	lines << QString("%1 %2 %3 %4 %5 %6")
+		.arg(title, -12).arg("shapes", 12).arg("vertices", 12).arg("bytes", 14).arg("B/shape", 9).arg("B/vertex", 9);
+	auto row = [&lines](const QString& name, qint64 shapes, qint64 vertexCount, qint64 bytes) {
+		lines << QString("%1 %2 %3 %4 %5 %6")
+			.arg(name, -12).arg(shapes, 12).arg(vertexCount, 12).arg(bytes, 14)
+			.arg(shapes > 0 ? static_cast<double>(bytes) / shapes : 0.0, 9, 'f', 1)
+			.arg(vertexCount > 0 ? static_cast<double>(bytes) / vertexCount : 0.0, 9, 'f', 2);
+	};
+	for (int type = 0; type < 5; type++) {
+		if (types[type].shapes > 0) {
+			row(names[type], types[type].shapes, types[type].vertices, types[type].bytes);
+		}
+	}
+	lines << QString("%1 %2 %3 %4").arg("shared", -12).arg("", 12).arg("", 12).arg(sharedBytes, 14);
+	row("total", totalShapes(), totalVertices(), totalBytes());
+	return lines.join('\n');
+}
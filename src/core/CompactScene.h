@@ -0,0 +1,117 @@
+#pragma once
+#include <QtGlobal>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "representation.h"
+
+// Kompaktne ulozenie velkych scen (miliony tvarov) pre davkove kreslenie a export.
+// Tvar je jeden 20-bajtovy zaznam: posun do spolocneho zasobnika bodov, farby ako 32-bit ARGB, hlbka
+// a priznaky v jednom slove (typ, vypln, platnost farieb, pravidlo vyplne, spoj, koncovka, hrubka tahu).
+// Body lezia v jednom poli 16-bitovych slov: prvy bod absolutne, dalsie ako rozdiel od predchadzajuceho.
+// Ak sa vsetko zmesti do int16, bod ma 4 bajty; inak ma prvy bod 32 bitov, pripadne vsetky body (Wide).
+// Obdlznik rovnobezny s osami sa uklada ako 2 protilahle rohy. Gradienty a vzory su v riedkom zozname.
+// Zapis je len na koniec (append); tvar sa pri kresleni rozbali do ShapeVariant.
+class CompactScene {
+public:
+	// Spotreba pamate podla typu tvaru; vertices su body tvarov (nie ulozene rohy obdlznika)
+	struct TypeUsage {
+		qint64 shapes = 0;
+		qint64 vertices = 0;
+		qint64 bytes = 0;
+	};
+
+	struct MemoryReport {
+		TypeUsage types[5];			// index = Shape::ShapeType
+		qint64 sharedBytes = 0;		// shadery, rezerva kapacity poli
+		qint64 totalShapes() const;
+		qint64 totalVertices() const;
+		qint64 totalBytes() const;
+		// Tabulka "typ, tvary, body, bajty, B/tvar, B/bod" po riadkoch
+		QString toText(const QString& title) const;
+	};
+
+	void reserve(size_t shapes, size_t vertexCount);
+	void clear();
+	void squeeze();
+
+	// Tvar s menej ako 2 bodmi (obdlznik bez 4 rohov) sa neulozi (vrati false), rovnako ked by body presiahli 2^32 slov
+	bool append(Shape& shape);
+
+	size_t size() const { return records.size(); }
+	bool isEmpty() const { return records.empty(); }
+	qint64 vertexCount() const { return vertices; }
+
+	Shape::ShapeType typeAt(size_t index) const { return static_cast<Shape::ShapeType>(records[index].flags & TypeMask); }
+	int depthAt(size_t index) const { return records[index].depth; }
+	QVector<QPoint> pointsAt(size_t index) const;
+	ShapeVariant shapeAt(size_t index) const;
+	// Tvary first .. first + count - 1 na koniec out (out sa nevyprazdnuje)
+	void decode(size_t first, size_t count, std::vector<ShapeVariant>& out) const;
+
+	// Binarny subor (.cscene): hlavicka, zaznamy a zasobnik bodov presne ako v pamati (nacitanie je jedno citanie
+	// poli bez parsovania), shadery ako textove pole fill= zo SceneFile. Poradie bajtov musi sediet s ulozenim
+	static constexpr const char* FileSuffix = "cscene";
+	static bool isCompactFile(const QString& filePath);
+	bool save(const QString& filePath, QString* errorMessage = nullptr) const;
+	bool load(const QString& filePath, QString* errorMessage = nullptr);
+
+	qint64 memoryUsage() const;
+	MemoryReport memoryReport() const;
+	// Odhad pamate toho isteho tvaru na halde (objekt triedy, QVector bodov, cache tahu a trojuholnikov)
+	static qint64 heapUsage(Shape& shape);
+	static MemoryReport heapReport(Shape* const* shapes, size_t count);
+
+private:
+	enum Flags : quint32 {
+		TypeMask = 0x7,
+		Filled = 1u << 3,
+		BorderValid = 1u << 4,
+		FillingValid = 1u << 5,
+		AxisRectangle = 1u << 6,		// ulozene 2 rohy p1, p3
+		WindingFill = 1u << 7,
+		JoinShift = 8,					// 2 bity: miter, bevel, round, svg miter
+		CapShift = 10,					// 2 bity: flat, square, round
+		HasShader = 1u << 12,
+		EncodingShift = 13,				// 2 bity, Encoding
+		StrokeShift = 16				// hrubka tahu 1..65535
+	};
+
+	enum Encoding : quint32 {
+		Short,		// vsetky body int16: prvy absolutne, dalsie rozdiely
+		Anchored,	// prvy bod 2x int32, dalsie rozdiely int16
+		Wide		// vsetky body 2x int32
+	};
+
+	struct FileHeader {
+		char magic[4];
+		quint32 version;
+		quint32 byteOrder;		// 0x01020304 v poradi zapisujuceho stroja
+		quint32 shaderCount;
+		quint64 shapeCount;
+		quint64 pointWords;
+		qint64 vertexCount;
+	};
+	static constexpr quint32 FileVersion = 1;
+
+	struct Record {
+		quint32 offset;		// prvy bod v points (slova)
+		QRgb border;
+		QRgb filling;
+		qint32 depth;
+		quint32 flags;
+	};
+
+	std::vector<Record> records;
+	std::vector<qint16> points;
+	std::vector<std::pair<quint32, std::shared_ptr<const FillShader>>> shaders;	// index tvaru -> shader, podla indexu
+	qint64 vertices = 0;
+
+	size_t pointsEnd(size_t index) const { return index + 1 < records.size() ? records[index + 1].offset : points.size(); }
+	int storedCount(size_t index) const;
+	void encodePoints(const QVector<QPoint>& source, quint32& flags);
+	void pushWide(int value);
+	int readWide(size_t word) const;
+};
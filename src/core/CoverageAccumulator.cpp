@@ -0,0 +1,376 @@
+#include "CoverageAccumulator.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COVERAGE_SIMD_SSE2
+#endif
+
+void CoverageAccumulator::begin(const QRect& clipRect, Qt::FillRule rule, bool antialiasedRows)
+{
+	clip = clipRect;
+	fillRule = rule;
+	antialiased = antialiasedRows;
+	clipWidth = qMax(clip.width(), 0);
+	edges.clear();
+	active.clear();
+	nextEdge = 0;
+	row = INT_MAX;
+	lastRow = -1;
+	sorted = false;
+
+	// Bunky za okrajom: hrany na x == clipWidth zapisuju aj do bunky napravo
+	size_t cellCount = static_cast<size_t>(clipWidth) + 8;
+	if (cells.size() < cellCount) {
+		cells.assign(cellCount, 0.0f);
+		coverageRow.assign(cellCount, 0);
+	}
+}
+
+void CoverageAccumulator::addPolygon(const QVector<QPoint>& points)
+{
+	if (points.size() < 3 || clipWidth <= 0 || clip.height() <= 0) {
+		return;
+	}
+
+	// Pixel (x, y) pokryva stvorec [x, x+1) x [y, y+1), vrchol lezi v jeho strede
+	double offsetX = 0.5 - clip.left();
+	double offsetY = 0.5 - clip.top();
+	for (int i = 0; i < points.size(); i++) {
+		const QPoint& a = points[i];
+		const QPoint& b = points[(i + 1) % points.size()];
+		addEdge(a.x() + offsetX, a.y() + offsetY, b.x() + offsetX, b.y() + offsetY);
+	}
+}
+
+void CoverageAccumulator::addPolygon(const QVector<FixedPoint>& points)
+{
+	if (points.size() < 3 || clipWidth <= 0 || clip.height() <= 0) {
+		return;
+	}
+
+	const double unit = 1.0 / FixedPoint::One;
+	double offsetX = 0.5 - clip.left();
+	double offsetY = 0.5 - clip.top();
+	for (int i = 0; i < points.size(); i++) {
+		const FixedPoint& a = points[i];
+		const FixedPoint& b = points[(i + 1) % points.size()];
+		addEdge(a.x * unit + offsetX, a.y * unit + offsetY, b.x * unit + offsetX, b.y * unit + offsetY);
+	}
+}
+
+void CoverageAccumulator::addPolygon(const QVector<QPointF>& points, double scale, const QPointF& origin)
+{
+	if (points.size() < 3 || clipWidth <= 0 || clip.height() <= 0) {
+		return;
+	}
+
+	double offsetX = 0.5 - clip.left() - origin.x();
+	double offsetY = 0.5 - clip.top() - origin.y();
+	for (int i = 0; i < points.size(); i++) {
+		const QPointF& a = points[i];
+		const QPointF& b = points[(i + 1) % points.size()];
+		addEdge(a.x() * scale + offsetX, a.y() * scale + offsetY, b.x() * scale + offsetX, b.y() * scale + offsetY);
+	}
+}
+
+// Casti hrany nalavo od orezu a napravo od neho sa pritlacia na okraj ako zvisle hrany:
+// vinutie pixelov napravo od nich zostane rovnake a bunky mimo orezu netreba
+void CoverageAccumulator::addEdge(double x0, double y0, double x1, double y1)
+{
+	if (y0 == y1) {
+		return;
+	}
+
+	double splits[4] = { 0.0, 0.0, 0.0, 1.0 };
+	int count = 1;
+	double dx = x1 - x0;
+	if (dx != 0) {
+		for (double bound : { 0.0, static_cast<double>(clipWidth) }) {
+			double t = (bound - x0) / dx;
+			if (t > 0.0 && t < 1.0) {
+				splits[count++] = t;
+			}
+		}
+	}
+	splits[count++] = 1.0;
+	std::sort(splits + 1, splits + count - 1);
+
+	double dy = y1 - y0;
+	for (int i = 0; i + 1 < count; i++) {
+		double ta = splits[i], tb = splits[i + 1];
+		double xa = x0 + ta * dx, xb = x0 + tb * dx;
+		double middle = 0.5 * (xa + xb);
+		if (middle <= 0.0) {
+			xa = xb = 0.0;
+		}
+		else if (middle >= clipWidth) {
+			xa = xb = clipWidth;
+		}
+		else {
+			xa = qBound(0.0, xa, static_cast<double>(clipWidth));
+			xb = qBound(0.0, xb, static_cast<double>(clipWidth));
+		}
+		addClampedEdge(xa, y0 + ta * dy, xb, y0 + tb * dy);
+	}
+}
+
+void CoverageAccumulator::addClampedEdge(double x0, double y0, double x1, double y1)
+{
+	if (y0 == y1) {
+		return;
+	}
+
+	Edge edge;
+	edge.direction = 1.0f;
+	if (y0 > y1) {
+		std::swap(x0, x1);
+		std::swap(y0, y1);
+		edge.direction = -1.0f;
+	}
+	edge.x0 = x0;
+	edge.y0 = y0;
+	edge.x1 = x1;
+	edge.y1 = y1;
+	edge.dxdy = (x1 - x0) / (y1 - y0);
+	edges.push_back(edge);
+
+	int firstRow = qMax(0, static_cast<int>(std::floor(y0)));
+	int endRow = qMin(clip.height() - 1, static_cast<int>(std::ceil(y1)) - 1);
+	if (firstRow <= endRow) {
+		row = qMin(row, firstRow);
+		lastRow = qMax(lastRow, endRow);
+	}
+}
+
+bool CoverageAccumulator::nextRow(int& y, const std::vector<Span>*& spans)
+{
+	if (!sorted) {
+		std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.y0 < b.y0; });
+		sorted = true;
+	}
+
+	while (row <= lastRow) {
+		int current = row++;
+		while (nextEdge < edges.size() && edges[nextEdge].y0 < current + 1) {
+			active.push_back(static_cast<int>(nextEdge++));
+		}
+		active.erase(std::remove_if(active.begin(), active.end(), [this, current](int i) { return edges[i].y1 <= current; }), active.end());
+
+		if (active.empty()) {
+			if (nextEdge >= edges.size()) {
+				row = lastRow + 1;
+				return false;
+			}
+			row = qMax(row, static_cast<int>(std::floor(edges[nextEdge].y0)));
+			continue;
+		}
+
+		if (!antialiased) {
+			sampleRow(current);
+			if (rowSpans.empty()) {
+				continue;
+			}
+			y = clip.top() + current;
+			spans = &rowSpans;
+			return true;
+		}
+
+		touched.clear();
+		for (int i : active) {
+			accumulate(edges[i], current);
+		}
+		if (touched.empty()) {
+			continue;
+		}
+
+		// Zasiahnute useky zoradene a zlucene (blizke aj cez male medzery, tie sa oplati dopocitat)
+		std::sort(touched.begin(), touched.end(), [](const Range& a, const Range& b) { return a.first < b.first; });
+		size_t merged = 0;
+		for (size_t i = 1; i < touched.size(); i++) {
+			if (touched[i].first <= touched[merged].last + 8) {
+				touched[merged].last = qMax(touched[merged].last, touched[i].last);
+			}
+			else {
+				touched[++merged] = touched[i];
+			}
+		}
+		touched.resize(merged + 1);
+
+		rowSpans.clear();
+		float sum = 0.0f;
+		int previous = -1;
+		for (const Range& range : touched) {
+			// Medzi zasiahnutymi usekmi sa vinutie nemeni
+			int value = coverageOf(sum);
+			if (value > 0 && previous + 1 <= range.first - 1) {
+				addSpan(previous + 1, range.first - 1, value, nullptr);
+			}
+			sum = resolve(range.first, range.last, sum);
+			addSpan(range.first, range.last, 0, coverageRow.data() + range.first);
+			previous = range.last;
+		}
+		if (rowSpans.empty()) {
+			continue;
+		}
+		y = clip.top() + current;
+		spans = &rowSpans;
+		return true;
+	}
+	return false;
+}
+
+// Pixel patri do useku, ak jeho stred (x + 0.5) lezi medzi dvoma priesecnikmi, ktore vinutie oddeluju
+void CoverageAccumulator::sampleRow(int y)
+{
+	float center = y + 0.5f;
+	crossings.clear();
+	for (int i : active) {
+		const Edge& edge = edges[i];
+		if (edge.y0 <= center && center < edge.y1) {
+			crossings.push_back({ static_cast<float>(edge.x0 + (center - edge.y0) * edge.dxdy), static_cast<int>(edge.direction) });
+		}
+	}
+	std::sort(crossings.begin(), crossings.end(), [](const Crossing& a, const Crossing& b) { return a.x < b.x; });
+
+	rowSpans.clear();
+	int winding = 0;
+	for (size_t i = 0; i + 1 < crossings.size(); i++) {
+		winding += crossings[i].direction;
+		bool inside = (fillRule == Qt::OddEvenFill) ? (winding & 1) != 0 : winding != 0;
+		if (inside) {
+			addSpan(static_cast<int>(std::ceil(crossings[i].x - 0.5f)), static_cast<int>(std::ceil(crossings[i + 1].x - 0.5f)) - 1, 255, nullptr);
+		}
+	}
+}
+
+// Usek v bunkach orezany na pixely ciela a posunuty do suradnic ciela; susedne plne useky sa spoja
+void CoverageAccumulator::addSpan(int first, int last, int value, const quint8* coverage)
+{
+	last = qMin(last, clipWidth - 1);
+	if (first > last) {
+		return;
+	}
+	first += clip.left();
+	last += clip.left();
+	if (!coverage && !rowSpans.empty() && !rowSpans.back().coverage && rowSpans.back().value == value && first <= rowSpans.back().right + 1) {
+		rowSpans.back().right = qMax(rowSpans.back().right, last);
+		return;
+	}
+	rowSpans.push_back({ first, last, value, coverage });
+}
+
+int CoverageAccumulator::coverageOf(float winding) const
+{
+	float c = std::fabs(winding);
+	if (fillRule == Qt::OddEvenFill) {
+		c -= 2.0f * static_cast<int>(c * 0.5f);
+		c = qMin(c, 2.0f - c);
+	}
+	else {
+		c = qMin(c, 1.0f);
+	}
+	return static_cast<int>(c * 255.0f + 0.5f);
+}
+
+// Cast hrany v riadku y: plocha napravo od nej v kazdej bunke, zapisana ako rozdiel voci bunke nalavo
+void CoverageAccumulator::accumulate(const Edge& edge, int y)
+{
+	double top = qMax(static_cast<double>(y), edge.y0);
+	double bottom = qMin(static_cast<double>(y + 1), edge.y1);
+	double dy = bottom - top;
+	if (dy <= 0) {
+		return;
+	}
+
+	double x = qBound(0.0, edge.x0 + (top - edge.y0) * edge.dxdy, static_cast<double>(clipWidth));
+	double xNext = qBound(0.0, x + edge.dxdy * dy, static_cast<double>(clipWidth));
+	float d = static_cast<float>(dy) * edge.direction;
+	double xa = qMin(x, xNext), xb = qMax(x, xNext);
+	int x0i = static_cast<int>(std::floor(xa));
+	int x1i = static_cast<int>(std::ceil(xb));
+	float* a = cells.data();
+
+	if (x1i <= x0i + 1) {
+		// Cela cast hrany v jednej bunke
+		float xmf = static_cast<float>(0.5 * (x + xNext) - x0i);
+		a[x0i] += d - d * xmf;
+		a[x0i + 1] += d * xmf;
+		touched.push_back({ x0i, x0i + 1 });
+		return;
+	}
+
+	float s = static_cast<float>(1.0 / (xb - xa));
+	float x0f = static_cast<float>(xa - x0i);
+	float a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+	float x1f = static_cast<float>(xb - x1i + 1);
+	float am = 0.5f * s * x1f * x1f;
+	a[x0i] += d * a0;
+	if (x1i == x0i + 2) {
+		a[x0i + 1] += d * (1.0f - a0 - am);
+	}
+	else {
+		float a1 = s * (1.5f - x0f);
+		a[x0i + 1] += d * (a1 - a0);
+		for (int xi = x0i + 2; xi < x1i - 1; xi++) {
+			a[xi] += d * s;
+		}
+		float a2 = a1 + (x1i - x0i - 3) * s;
+		a[x1i - 1] += d * (1.0f - a2 - am);
+	}
+	a[x1i] += d * am;
+	touched.push_back({ x0i, x1i });
+}
+
+// Prefixovy sucet buniek first..last (po 4 so SSE2) -> vinutie -> pokrytie podla pravidla vyplne.
+// Bunky sa zaroven vynuluju, vrati vinutie za poslednou bunkou.
+float CoverageAccumulator::resolve(int first, int last, float sum)
+{
+	float* a = cells.data();
+	quint8* out = coverageRow.data();
+	int i = first;
+
+#if defined(COVERAGE_SIMD_SSE2)
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const bool evenOdd = (fillRule == Qt::OddEvenFill);
+	__m128 carry = _mm_set1_ps(sum);
+	// Len cele bloky v useku, bunky za nim mozu patrit dalsiemu useku
+	for (; i + 3 <= last; i += 4) {
+		__m128 v = _mm_loadu_ps(a + i);
+		v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+		v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+		v = _mm_add_ps(v, carry);
+		carry = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+		_mm_storeu_ps(a + i, _mm_setzero_ps());
+
+		__m128 c = _mm_and_ps(v, absMask);
+		if (evenOdd) {
+			__m128 pairs = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(c, half)));
+			c = _mm_sub_ps(c, _mm_add_ps(pairs, pairs));
+			c = _mm_min_ps(c, _mm_sub_ps(two, c));
+		}
+		else {
+			c = _mm_min_ps(c, one);
+		}
+		__m128i q = _mm_cvtps_epi32(_mm_mul_ps(c, scale));
+		q = _mm_packs_epi32(q, q);
+		q = _mm_packus_epi16(q, q);
+		int packed = _mm_cvtsi128_si32(q);
+		std::memcpy(out + i, &packed, sizeof(packed));
+	}
+	sum = _mm_cvtss_f32(carry);
+#endif
+	for (; i <= last; i++) {
+		sum += a[i];
+		a[i] = 0.0f;
+		out[i] = static_cast<quint8>(coverageOf(sum));
+	}
+	return sum;
+}
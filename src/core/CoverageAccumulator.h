@@ -0,0 +1,80 @@
+#pragma once
+#include <QtGlobal>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QVector>
+#include <vector>
+#include "FixedPoint.h"
+
+// Analyticke pokrytie pixelov polygonom (ako rasterizery pisma): kazda hrana pripise do buniek riadku
+// podiel plochy, ktoru v nich pokryva, a prefixovy sucet riadku da pre kazdy pixel presne pokrytie so znamienkom
+// (vinutie). Riadky sa spracuvaju postupne s aktivnymi hranami, v pamati je vzdy len jeden riadok buniek.
+// Riadok je riedky: prefixovy sucet sa pocita len v bunkach, do ktorych hrana zasiahla, medzi nimi je
+// vinutie konstantne a vrati sa ako jeden usek s jednou hodnotou (vnutro tvaru).
+// Pravidla vyplne: Qt::OddEvenFill (parne-neparne) a Qt::WindingFill (nenulove vinutie).
+// Bez anti-aliasingu sa plocha nepocita: vinutie sa vzorkuje v stredoch pixelov z usporiadanych priesecnikov hran.
+class CoverageAccumulator {
+public:
+	// Usek riadku: pixely left..right, bud s konstantnym pokrytim value, alebo coverage[0..right-left]
+	struct Span {
+		int left;
+		int right;
+		int value;
+		const quint8* coverage;		// nullptr = cely usek ma pokrytie value
+	};
+
+	// clip su pixely ciela, mimo neho sa nic nevrati (hrany nalavo sa ale zapocitaju do vinutia)
+	void begin(const QRect& clip, Qt::FillRule rule, bool antialiased = true);
+	// Vrchol (x, y) je stred pixelu (x, y), rovnako ako pri scanline vyplni
+	void addPolygon(const QVector<QPoint>& points);
+	void addPolygon(const QVector<FixedPoint>& points);
+	// Obrys v suradniciach dokumentu: bod ciela = bod * scale - origin (pohlad rasterizera)
+	void addPolygon(const QVector<QPointF>& points, double scale = 1.0, const QPointF& origin = QPointF());
+
+	// Dalsi riadok s pokrytim, useky zlava doprava (hodnoty 0..255); mimo usekov je pokrytie nulove.
+	// Useky platia do dalsieho volania nextRow.
+	bool nextRow(int& y, const std::vector<Span>*& spans);
+
+private:
+	struct Edge {
+		double x0, y0, x1, y1;	// y0 < y1, suradnice relativne k clip
+		double dxdy;
+		float direction;		// +1 hrana smeruje dole, -1 hore
+	};
+
+	struct Range {
+		int first;
+		int last;
+	};
+
+	struct Crossing {
+		float x;
+		int direction;
+	};
+
+	QRect clip;
+	Qt::FillRule fillRule = Qt::OddEvenFill;
+	bool antialiased = true;
+	int clipWidth = 0;
+	std::vector<Edge> edges;
+	std::vector<int> active;
+	size_t nextEdge = 0;
+	int row = 0;
+	int lastRow = -1;
+	bool sorted = false;
+
+	std::vector<float> cells;			// clipWidth + okraj, po kazdom riadku vynulovane
+	std::vector<quint8> coverageRow;
+	std::vector<Range> touched;			// bunky, do ktorych v riadku zasiahli hrany
+	std::vector<Span> rowSpans;
+	std::vector<Crossing> crossings;	// ostre vykreslenie: priesecniky v strede riadku
+
+	void addEdge(double x0, double y0, double x1, double y1);
+	void addClampedEdge(double x0, double y0, double x1, double y1);
+	void accumulate(const Edge& edge, int y);
+	void sampleRow(int y);
+	float resolve(int first, int last, float sum);
+	int coverageOf(float winding) const;
+	void addSpan(int first, int last, int value, const quint8* coverage);
+};
@@ -0,0 +1,111 @@
+#include "DepthBuffer.h"
+#include <algorithm>
+#include <type_traits>
+
+DepthBuffer::DepthBuffer(int width, int height, Format format)
+	: fmt(format)
+{
+	resize(width, height);
+}
+
+void DepthBuffer::resize(int width, int height)
+{
+	w = qMax(width, 0);
+	h = qMax(height, 0);
+	size_t count = static_cast<size_t>(w) * h;
+	if (fmt == Depth16) {
+		depth16.assign(count, 0);
+		depth32.clear();
+		depth32.shrink_to_fit();
+	}
+	else {
+		depth32.assign(count, 0);
+		depth16.clear();
+		depth16.shrink_to_fit();
+	}
+}
+
+void DepthBuffer::setFormat(Format newFormat)
+{
+	if (newFormat == fmt) {
+		return;
+	}
+	fmt = newFormat;
+	resize(w, h);
+}
+
+void DepthBuffer::clear()
+{
+	std::fill(depth16.begin(), depth16.end(), 0);
+	std::fill(depth32.begin(), depth32.end(), 0);
+}
+
+void DepthBuffer::clear(const QRect& rect)
+{
+	QRect area = rect & QRect(0, 0, w, h);
+	for (int y = area.top(); y <= area.bottom() && !area.isEmpty(); y++) {
+		size_t begin = static_cast<size_t>(y) * w + area.left();
+		if (fmt == Depth16) {
+			std::fill(depth16.begin() + begin, depth16.begin() + begin + area.width(), 0);
+		}
+		else {
+			std::fill(depth32.begin() + begin, depth32.begin() + begin + area.width(), 0);
+		}
+	}
+}
+
+void DepthBuffer::shiftDepths(quint32 first, int delta)
+{
+	first = qMax(first, 1u);	// pozadie zostava pozadim
+	auto shift = [first, delta](auto& values, quint32 limit) {
+		for (auto& d : values) {
+			if (d >= first) {
+				qint64 shifted = qBound<qint64>(1, static_cast<qint64>(d) + delta, limit);
+				d = static_cast<std::remove_reference_t<decltype(d)>>(shifted);
+			}
+		}
+	};
+	if (fmt == Depth16) {
+		shift(depth16, 0xffffu);
+	}
+	else {
+		shift(depth32, 0xffffffffu);
+	}
+}
+
+void DepthBuffer::swapDepths(quint32 a, quint32 b)
+{
+	auto swap = [a, b](auto& values, quint32 limit) {
+		using Value = typename std::remove_reference_t<decltype(values)>::value_type;
+		Value first = static_cast<Value>(qMin(a, limit));
+		Value second = static_cast<Value>(qMin(b, limit));
+		for (auto& d : values) {
+			if (d == first) {
+				d = second;
+			}
+			else if (d == second) {
+				d = first;
+			}
+		}
+	};
+	if (fmt == Depth16) {
+		swap(depth16, 0xffffu);
+	}
+	else {
+		swap(depth32, 0xffffffffu);
+	}
+}
+
+quint32 DepthBuffer::depthAt(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= w || y >= h) {
+		return 0;
+	}
+	size_t i = static_cast<size_t>(y) * w + x;
+	return fmt == Depth16 ? depth16[i] : depth32[i];
+}
+
+qint64 DepthBuffer::memoryUsage() const
+{
+	return static_cast<qint64>(depth16.size()) * sizeof(quint16) + static_cast<qint64>(depth32.size()) * sizeof(quint32);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <QtGlobal>
+#include <QSize>
+#include <QRect>
+#include <vector>
+
+// Hlbkova rovina k farebnemu bufferu (16 alebo 32 bitov na pixel).
+// Pixel prejde testom, ak je jeho hlbka >= ulozenej; rovnaka hlbka vyhrava, takze vlastne pixely tvaru
+// (obrys cez vypln) sa prepisuju rovnako ako pri kresleni v poradi. 0 znamena pozadie.
+class DepthBuffer {
+public:
+	enum Format { Depth16, Depth32 };
+
+	DepthBuffer(int width = 0, int height = 0, Format format = Depth32);
+
+	void resize(int width, int height);
+	void setFormat(Format newFormat);
+	void clear();
+	void clear(const QRect& rect);
+	void shiftDepths(quint32 first, int delta);		// hlbky >= first posunie o delta (vlozenie/odstranenie vrstvy)
+	void swapDepths(quint32 a, quint32 b);			// vymeni hlbky a <-> b, napr. po vymene vrstiev
+
+	int width() const { return w; }
+	int height() const { return h; }
+	QSize size() const { return QSize(w, h); }
+	Format format() const { return fmt; }
+	quint32 maxDepth() const { return fmt == Depth16 ? 0xffffu : 0xffffffffu; }
+	qint64 memoryUsage() const;
+
+	quint32 depthAt(int x, int y) const;
+
+	// Otestuje a pri uspechu zapise hlbku jedneho pixelu
+	bool testAndSet(int x, int y, quint32 depth) {
+		if (x < 0 || y < 0 || x >= w || y >= h) {
+			return false;
+		}
+		size_t i = static_cast<size_t>(y) * w + x;
+		if (fmt == Depth16) {
+			quint16 d = static_cast<quint16>(qMin(depth, 0xffffu));
+			if (d < depth16[i]) {
+				return false;
+			}
+			depth16[i] = d;
+			return true;
+		}
+		if (depth < depth32[i]) {
+			return false;
+		}
+		depth32[i] = depth;
+		return true;
+	}
+
+	// Hlbkovy test pre usek x0..x1 riadku y; pre kazdy suvisly beh pixelov, ktore testom presli,
+	// zapise hlbku a zavola write(start, end)
+	template <typename WriteRun>
+	void testSpan(int y, int x0, int x1, quint32 depth, WriteRun&& write) {
+		if (fmt == Depth16) {
+			testSpanImpl(depth16.data() + static_cast<size_t>(y) * w, x0, x1, static_cast<quint16>(qMin(depth, 0xffffu)), write);
+		}
+		else {
+			testSpanImpl(depth32.data() + static_cast<size_t>(y) * w, x0, x1, depth, write);
+		}
+	}
+
+private:
+	int w = 0;
+	int h = 0;
+	Format fmt = Depth32;
+	std::vector<quint16> depth16;
+	std::vector<quint32> depth32;
+
+	template <typename T, typename WriteRun>
+	static void testSpanImpl(T* row, int x0, int x1, T depth, WriteRun& write) {
+		int x = x0;
+		while (x <= x1) {
+			while (x <= x1 && depth < row[x]) {
+				x++;
+			}
+			int start = x;
+			while (x <= x1 && depth >= row[x]) {
+				row[x] = depth;
+				x++;
+			}
+			if (start < x) {
+				write(start, x - 1);
+			}
+		}
+	}
+};
@@ -0,0 +1,177 @@
+#include "EditHistory.h"
+
+qint64 EditHistory::Edit::memoryUsage() const
+{
+	qint64 bytes = sizeof(Edit);
+	bytes += static_cast<qint64>(before.capacity() + after.capacity()) * sizeof(QPoint);
+	if (detached) {
+		bytes += shapeMemoryUsage(*detached);
+	}
+	return bytes;
+}
+
+qint64 EditHistory::shapeMemoryUsage(Shape& shape)
+{
+	// Odhad: najvacsia trieda tvaru + body, ktore si drzi (polygon, krivka)
+	qint64 bytes = qMax(sizeof(MyRectangle), sizeof(BezierCurve));
+	if (shape.getType() == Shape::POLYGON || shape.getType() == Shape::BEZIER_CURVE) {
+		bytes += static_cast<qint64>(shape.getPoints().size()) * sizeof(QPoint);
+	}
+	return bytes;
+}
+
+//-----------------------------------------
+//		*** Recording ***
+//-----------------------------------------
+
+void EditHistory::recordTranslate(Shape& shape, const QPoint& offset)
+{
+	// Udalosti jedneho tahu mysou sa zlucia do jedneho posunu
+	if (!undoStack.empty() && redoStack.empty()) {
+		Edit& top = undoStack.back();
+		if (top.open && top.kind == Translate && top.shape == &shape) {
+			top.offset += offset;
+			return;
+		}
+	}
+
+	Edit edit;
+	edit.kind = Translate;
+	edit.shape = &shape;
+	edit.offset = offset;
+	edit.open = true;
+	push(std::move(edit));
+}
+
+void EditHistory::recordGeometry(Shape& shape, const QVector<QPoint>& before, const QVector<QPoint>& after)
+{
+	Edit edit;
+	edit.kind = Geometry;
+	edit.shape = &shape;
+	edit.before = before;
+	edit.after = after;
+	push(std::move(edit));
+}
+
+void EditHistory::recordColor(Shape& shape, const QColor& borderBefore, const QColor& fillingBefore)
+{
+	Edit edit;
+	edit.kind = Color;
+	edit.shape = &shape;
+	edit.borderBefore = borderBefore;
+	edit.fillingBefore = fillingBefore;
+	edit.borderAfter = shape.getBorderColor();
+	edit.fillingAfter = shape.getFillingColor();
+	push(std::move(edit));
+}
+
+void EditHistory::recordSwap(int index)
+{
+	Edit edit;
+	edit.kind = SwapLayers;
+	edit.index = index;
+	push(std::move(edit));
+}
+
+void EditHistory::recordInsert(Shape& shape, int index, int zBufferPosition)
+{
+	Edit edit;
+	edit.kind = Insert;
+	edit.shape = &shape;
+	edit.index = index;
+	edit.zBufferPosition = zBufferPosition;
+	push(std::move(edit));
+}
+
+void EditHistory::recordRemove(std::unique_ptr<Shape> shape, int index, int zBufferPosition)
+{
+	Edit edit;
+	edit.kind = Remove;
+	edit.shape = shape.get();
+	edit.index = index;
+	edit.zBufferPosition = zBufferPosition;
+	edit.detached = std::move(shape);
+	push(std::move(edit));
+}
+
+void EditHistory::closeGroup()
+{
+	if (!undoStack.empty()) {
+		undoStack.back().open = false;
+	}
+}
+
+//-----------------------------------------
+//		*** Stacks ***
+//-----------------------------------------
+
+void EditHistory::push(Edit&& edit)
+{
+	// Nova uprava zahodi redo vetvu (aj tvary, ktore patrili vratenym vlozeniam)
+	for (Edit& undone : redoStack) {
+		usedBytes -= undone.accountedBytes;
+	}
+	redoStack.clear();
+
+	closeGroup();
+	account(edit);
+	undoStack.push_back(std::move(edit));
+	enforceLimit();
+}
+
+// Volat az ked ViewerWidget zaznam vratil (a prip. presunul vlastnictvo tvaru do/zo zaznamu)
+void EditHistory::finishUndo()
+{
+	if (undoStack.empty()) {
+		return;
+	}
+
+	Edit edit = std::move(undoStack.back());
+	undoStack.pop_back();
+	edit.open = false;
+	account(edit);
+	redoStack.push_back(std::move(edit));
+}
+
+void EditHistory::finishRedo()
+{
+	if (redoStack.empty()) {
+		return;
+	}
+
+	Edit edit = std::move(redoStack.back());
+	redoStack.pop_back();
+	account(edit);
+	undoStack.push_back(std::move(edit));
+	enforceLimit();
+}
+
+// Velkost zaznamu sa meni, ked tvar prejde zo sceny do zaznamu alebo naopak
+void EditHistory::account(Edit& edit)
+{
+	usedBytes -= edit.accountedBytes;
+	edit.accountedBytes = edit.memoryUsage();
+	usedBytes += edit.accountedBytes;
+}
+
+void EditHistory::clear()
+{
+	undoStack.clear();
+	redoStack.clear();
+	usedBytes = 0;
+}
+
+void EditHistory::setMemoryLimit(qint64 bytes)
+{
+	memoryLimit = qMax<qint64>(bytes, 0);
+	enforceLimit();
+}
+
+// Najstarsie zaznamy idu prec prve; redo vetva sa neorezava, je to najcerstvejsia historia
+void EditHistory::enforceLimit()
+{
+	while (usedBytes > memoryLimit && !undoStack.empty()) {
+		usedBytes -= undoStack.front().accountedBytes;
+		undoStack.pop_front();
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <QColor>
+#include <QPoint>
+#include <QVector>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "representation.h"
+
+// Historia uprav pre undo/redo. Uklada len rozdiely (posun, nove body, farby, vymenu vrstiev,
+// vlozenie/odstranenie tvaru), nie kopie sceny. Pamat je ohranicena limitom, najstarsie zaznamy sa zahadzuju.
+// Zaznamy nic nevykresluju, aplikuje ich ViewerWidget.
+class EditHistory {
+public:
+	enum Kind : quint8 { None, Translate, Geometry, Color, SwapLayers, Insert, Remove };
+
+	struct Edit {
+		Kind kind = None;
+		Shape* shape = nullptr;			// Translate, Geometry, Color, Insert, Remove
+		int index = -1;					// vrstva v zBuffer: SwapLayers (vymena index-1 a index), Insert, Remove
+		int zBufferPosition = 0;		// Insert, Remove
+		QPoint offset;					// Translate
+		QVector<QPoint> before, after;	// Geometry
+		QColor borderBefore, fillingBefore, borderAfter, fillingAfter;	// Color
+		std::unique_ptr<Shape> detached;	// tvar mimo sceny (odstraneny alebo vratene vlozenie) patri zaznamu
+		bool open = false;				// dalsie posuny toho isteho tvaru sa zlucuju do tohto zaznamu
+		qint64 accountedBytes = 0;
+
+		qint64 memoryUsage() const;
+	};
+
+	// Co sa po undo/redo zmenilo, aby GUI vedelo upravit zoznam vrstiev
+	struct Step {
+		Kind kind = None;
+		int index = -1;
+	};
+
+	static constexpr qint64 DefaultMemoryLimit = 32LL * 1024 * 1024;
+
+	EditHistory() = default;
+	EditHistory(const EditHistory&) = delete;
+	EditHistory& operator=(const EditHistory&) = delete;
+
+	void recordTranslate(Shape& shape, const QPoint& offset);
+	void recordGeometry(Shape& shape, const QVector<QPoint>& before, const QVector<QPoint>& after);
+	void recordColor(Shape& shape, const QColor& borderBefore, const QColor& fillingBefore);
+	void recordSwap(int index);
+	void recordInsert(Shape& shape, int index, int zBufferPosition);
+	void recordRemove(std::unique_ptr<Shape> shape, int index, int zBufferPosition);
+
+	// Koniec tahu mysou, dalsi posun zacne novy zaznam
+	void closeGroup();
+
+	bool canUndo() const { return !undoStack.empty(); }
+	bool canRedo() const { return !redoStack.empty(); }
+	int undoCount() const { return static_cast<int>(undoStack.size()); }
+	int redoCount() const { return static_cast<int>(redoStack.size()); }
+
+	// Zaznam, ktory treba vratit/zopakovat; po aplikovani ho presunie finishUndo/finishRedo
+	Edit* undoTop() { return undoStack.empty() ? nullptr : &undoStack.back(); }
+	Edit* redoTop() { return redoStack.empty() ? nullptr : &redoStack.back(); }
+	void finishUndo();
+	void finishRedo();
+
+	void clear();
+
+	void setMemoryLimit(qint64 bytes);
+	qint64 getMemoryLimit() const { return memoryLimit; }
+	qint64 memoryUsage() const { return usedBytes; }
+
+	static qint64 shapeMemoryUsage(Shape& shape);
+
+private:
+	std::deque<Edit> undoStack;
+	std::vector<Edit> redoStack;
+	qint64 memoryLimit = DefaultMemoryLimit;
+	qint64 usedBytes = 0;
+
+	void push(Edit&& edit);
+	void account(Edit& edit);
+	void enforceLimit();
+};
@@ -0,0 +1,289 @@
+#include "FillShader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SHADER_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHADER_SIMD_SSE2
+#endif
+
+namespace {
+	const int LastIndex = FillShader::LutSize - 1;
+
+	// Index do tabulky z pozicie v pevnej desatinnej ciarke 16.16 (jednotky = polozky tabulky)
+	inline int lutIndex(qint64 fixed)
+	{
+		return static_cast<int>(qBound<qint64>(0, (fixed + 0x8000) >> 16, LastIndex));
+	}
+
+	inline qint64 toFixed(double value)
+	{
+		return static_cast<qint64>(std::floor(qBound(-1.0e12, value, 1.0e12) * 65536.0));
+	}
+}
+
+FillShader FillShader::linear(const QPointF& start, const QPointF& end, const QVector<Stop>& stops)
+{
+	FillShader shader;
+	shader.type = LinearGradient;
+	shader.start = start;
+	shader.end = end;
+	shader.stops = stops;
+	shader.buildLut();
+	return shader;
+}
+
+FillShader FillShader::radial(const QPointF& center, double radius, const QVector<Stop>& stops)
+{
+	FillShader shader;
+	shader.type = RadialGradient;
+	shader.start = center;
+	shader.radius = qMax(radius, 0.0);
+	shader.stops = stops;
+	shader.buildLut();
+	return shader;
+}
+
+FillShader FillShader::pattern(const QImage& image, const QPointF& origin, const QString& source)
+{
+	FillShader shader;
+	shader.type = ImagePattern;
+	shader.start = origin;
+	shader.image = image.convertToFormat(QImage::Format_ARGB32);
+	shader.source = source;
+	return shader;
+}
+
+// Farby zastavok linearne interpolovane po kanaloch (aj alfa); pred prvou a za poslednou zastavkou ich krajna farba
+void FillShader::buildLut()
+{
+	std::stable_sort(stops.begin(), stops.end(), [](const Stop& a, const Stop& b) { return a.position < b.position; });
+	for (Stop& stop : stops) {
+		stop.position = qBound(0.0, stop.position, 1.0);
+	}
+	lut.clear();
+	if (stops.isEmpty()) {
+		return;
+	}
+
+	lut.resize(LutSize);
+	int segment = 0;
+	for (int i = 0; i < LutSize; i++) {
+		double t = static_cast<double>(i) / LastIndex;
+		while (segment + 1 < stops.size() && stops[segment + 1].position < t) {
+			segment++;
+		}
+		const Stop& from = stops[segment];
+		const Stop& to = stops[qMin(segment + 1, static_cast<int>(stops.size()) - 1)];
+		double span = to.position - from.position;
+		double f = (span > 0) ? qBound(0.0, (t - from.position) / span, 1.0) : (t >= to.position ? 1.0 : 0.0);
+		auto mix = [f](int a, int b) { return qRound(a + (b - a) * f); };
+		lut[i] = qRgba(mix(from.color.red(), to.color.red()), mix(from.color.green(), to.color.green()),
+			mix(from.color.blue(), to.color.blue()), mix(from.color.alpha(), to.color.alpha()));
+	}
+}
+
+void FillShader::shadeSpan(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const
+{
+	if (count <= 0 || !isValid()) {
+		return;
+	}
+	switch (type) {
+	case LinearGradient:
+		shadeLinear(y, x0, count, zoom, origin, out);
+		break;
+	case RadialGradient:
+		shadeRadial(y, x0, count, zoom, origin, out);
+		break;
+	case ImagePattern:
+		shadePattern(y, x0, count, zoom, origin, out);
+		break;
+	}
+}
+
+QRgb FillShader::shadePixel(int x, int y, double zoom, const QPoint& origin) const
+{
+	QRgb color = 0;
+	shadeSpan(y, x, 1, zoom, origin, &color);
+	return color;
+}
+
+//-----------------------------------------
+//		*** Span evaluation ***
+//-----------------------------------------
+
+// Pozicia v tabulke je v riadku linearna: t(x) = base + step * (x - x0). Bloky drah sa kotvia z base (bez
+// kumulovanej chyby), v bloku sa index ziska orezanim a zaokruhlenim a farby sa vyberu z tabulky (AVX2 gather).
+void FillShader::shadeLinear(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const
+{
+	const QRgb* table = lut.constData();
+	QPointF d = end - start;
+	double length2 = d.x() * d.x() + d.y() * d.y();
+	if (length2 <= 0) {
+		std::fill(out, out + count, table[LastIndex]);
+		return;
+	}
+
+	double scale = LastIndex / (length2 * zoom);
+	double step = d.x() * scale;
+	double base = (x0 + origin.x()) * step + (y + origin.y()) * d.y() * scale
+		- LastIndex * (start.x() * d.x() + start.y() * d.y()) / length2;
+
+	// Cely usek na jednej strane gradientu (alebo vodorovne konstantny) je jedna farba
+	double last = base + step * (count - 1);
+	if (qMax(base, last) <= 0.5 || qMin(base, last) >= LastIndex - 0.5 || std::abs(step * count) < 0.5) {
+		std::fill(out, out + count, table[lutIndex(toFixed(base + 0.5 * step * (count - 1)))]);
+		return;
+	}
+
+	int i = 0;
+#if defined(SHADER_SIMD_AVX2)
+	const __m256 laneSteps = _mm256_mul_ps(_mm256_set1_ps(static_cast<float>(step)), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+	const __m256 low = _mm256_setzero_ps();
+	const __m256 high = _mm256_set1_ps(static_cast<float>(LastIndex));
+	for (; i + 8 <= count; i += 8) {
+		__m256 t = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(base + step * i)), laneSteps);
+		__m256i index = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(t, low), high));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4));
+	}
+#elif defined(SHADER_SIMD_SSE2)
+	const __m128 laneSteps = _mm_mul_ps(_mm_set1_ps(static_cast<float>(step)), _mm_setr_ps(0, 1, 2, 3));
+	const __m128 low = _mm_setzero_ps();
+	const __m128 high = _mm_set1_ps(static_cast<float>(LastIndex));
+	alignas(16) qint32 index[4];
+	for (; i + 4 <= count; i += 4) {
+		__m128 t = _mm_add_ps(_mm_set1_ps(static_cast<float>(base + step * i)), laneSteps);
+		_mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(t, low), high)));
+		out[i] = table[index[0]];
+		out[i + 1] = table[index[1]];
+		out[i + 2] = table[index[2]];
+		out[i + 3] = table[index[3]];
+	}
+#endif
+
+	// Zvysok (a cesta bez SIMD): pozicia v 16.16 sa krokuje celociselnym pripocitanim
+	qint64 position = toFixed(base + step * i);
+	qint64 positionStep = toFixed(step);
+	for (; i < count; i++) {
+		out[i] = table[lutIndex(position)];
+		position += positionStep;
+	}
+}
+
+// t = vzdialenost od stredu / polomer. V SIMD drahach sa z dx^2 + dy^2 pocita odmocnina naraz pre cely blok,
+// skalarne sa dx^2 krokuje diferenciami ((dx + 1)^2 = dx^2 + 2dx + 1).
+void FillShader::shadeRadial(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const
+{
+	const QRgb* table = lut.constData();
+	double targetRadius = radius * zoom;
+	if (targetRadius <= 0) {
+		std::fill(out, out + count, table[LastIndex]);
+		return;
+	}
+
+	double centerX = start.x() * zoom - origin.x();
+	double dy = y - (start.y() * zoom - origin.y());
+	double scale = LastIndex / targetRadius;
+
+	// Usek cely za polomerom ma farbu poslednej zastavky
+	double nearestX = qBound<double>(x0, centerX, x0 + count - 1) - centerX;
+	if (std::sqrt(nearestX * nearestX + dy * dy) * scale >= LastIndex - 0.5) {
+		std::fill(out, out + count, table[LastIndex]);
+		return;
+	}
+
+	double dx0 = x0 - centerX;
+	int i = 0;
+#if defined(SHADER_SIMD_AVX2)
+	const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256 dy2 = _mm256_set1_ps(static_cast<float>(dy * dy));
+	const __m256 factor = _mm256_set1_ps(static_cast<float>(scale));
+	const __m256 high = _mm256_set1_ps(static_cast<float>(LastIndex));
+	for (; i + 8 <= count; i += 8) {
+		__m256 dx = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(dx0 + i)), lanes);
+		__m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), dy2));
+		__m256i index = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_mul_ps(distance, factor), high));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4));
+	}
+#elif defined(SHADER_SIMD_SSE2)
+	const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+	const __m128 dy2 = _mm_set1_ps(static_cast<float>(dy * dy));
+	const __m128 factor = _mm_set1_ps(static_cast<float>(scale));
+	const __m128 high = _mm_set1_ps(static_cast<float>(LastIndex));
+	alignas(16) qint32 index[4];
+	for (; i + 4 <= count; i += 4) {
+		__m128 dx = _mm_add_ps(_mm_set1_ps(static_cast<float>(dx0 + i)), lanes);
+		__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2));
+		_mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvtps_epi32(_mm_min_ps(_mm_mul_ps(distance, factor), high)));
+		out[i] = table[index[0]];
+		out[i + 1] = table[index[1]];
+		out[i + 2] = table[index[2]];
+		out[i + 3] = table[index[3]];
+	}
+#endif
+
+	double dx = dx0 + i;
+	double distance2 = dx * dx + dy * dy;
+	for (; i < count; i++) {
+		out[i] = table[qMin(static_cast<int>(std::sqrt(distance2) * scale + 0.5), LastIndex)];
+		distance2 += 2 * dx + 1;
+		dx += 1;
+	}
+}
+
+// Dlazdice bez filtrovania (najblizsi texel). Stlpec vzoru sa krokuje v 16.16 a pretecie cez sirku obrazku;
+// pri zoome 1 sa kopiruju cele kusy riadku obrazku.
+void FillShader::shadePattern(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const
+{
+	int w = image.width();
+	int h = image.height();
+	qint64 v = static_cast<qint64>(std::floor((y + origin.y()) / zoom - start.y()));
+	int row = static_cast<int>(((v % h) + h) % h);
+	const QRgb* texels = reinterpret_cast<const QRgb*>(image.constScanLine(row));
+
+	const qint64 limit = static_cast<qint64>(w) << 16;
+	qint64 u = toFixed((x0 + origin.x()) / zoom - start.x());
+	u = ((u % limit) + limit) % limit;
+	qint64 step = toFixed(1.0 / zoom);
+
+	if (step == 0x10000) {
+		int column = static_cast<int>(u >> 16);
+		int i = 0;
+		while (i < count) {
+			int n = qMin(w - column, count - i);
+			std::memcpy(out + i, texels + column, n * sizeof(QRgb));
+			i += n;
+			column = 0;
+		}
+		return;
+	}
+
+	// Behy medzi pretecenim cez okraj dlazdice idu bez podmienky v cykle; v behu je pozicia < sirka << 16,
+	// takze sa zmesti do 32 bitov (sirka vzoru do 32767)
+	step = qMax<qint64>(step % limit, 1);
+	const quint32 increment = static_cast<quint32>(step);
+#if defined(SHADER_SIMD_AVX2)
+	const __m256i laneSteps = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(increment)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+#endif
+	int i = 0;
+	while (i < count) {
+		int n = static_cast<int>(qMin<qint64>((limit - u + step - 1) / step, count - i));
+		quint32 position = static_cast<quint32>(u);
+		int k = 0;
+#if defined(SHADER_SIMD_AVX2)
+		for (; k + 8 <= n; k += 8) {
+			__m256i index = _mm256_srli_epi32(_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(position + k * increment)), laneSteps), 16);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + k), _mm256_i32gather_epi32(reinterpret_cast<const int*>(texels), index, 4));
+		}
+#endif
+		for (; k < n; k++) {
+			out[i + k] = texels[(position + k * increment) >> 16];
+		}
+		i += n;
+		u = (u + n * step) % limit;
+	}
+}
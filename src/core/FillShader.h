@@ -0,0 +1,62 @@
+#pragma once
+#include <QColor>
+#include <QImage>
+#include <QPoint>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+// Vypln tvaru inou nez jednou farbou: linearny alebo radialny gradient, alebo dlazdicovy obrazok (vzor).
+// Geometria je relativna ku kotve - prvemu bodu tvaru - takze sa pri posune tvaru posuva s nim;
+// rasterizer kotvu a pohlad (zoom) zapocita az pri vyhodnoteni useku.
+// Gradient sa pri vytvoreni predpocita do tabulky LutSize farieb; usek riadku potom krokuje index do tabulky
+// (linearny pripocitanim kroku, radialny vzdialenostou v SIMD drahach), bez miesania farieb po pixeloch.
+// Mimo rozsahu 0..1 gradient opakuje krajnu farbu (pad). Shader je po vytvoreni nemenny a tvary ho zdielaju.
+class FillShader {
+public:
+	enum Type : quint8 { LinearGradient, RadialGradient, ImagePattern };
+
+	struct Stop {
+		double position;	// 0..1
+		QColor color;
+	};
+
+	static constexpr int LutSize = 256;
+
+	static FillShader linear(const QPointF& start, const QPointF& end, const QVector<Stop>& stops);
+	static FillShader radial(const QPointF& center, double radius, const QVector<Stop>& stops);
+	// source = cesta k suboru obrazku (uklada sa do sceny), origin = lavy horny roh jednej dlazdice
+	static FillShader pattern(const QImage& image, const QPointF& origin, const QString& source = QString());
+
+	Type getType() const { return type; }
+	// Vzor s neplatnym obrazkom (subor sa nenasiel) sa nekresli, tvar sa vyplni farbou vyplne
+	bool isValid() const { return type == ImagePattern ? !image.isNull() : !lut.isEmpty(); }
+
+	QPointF getStart() const { return start; }
+	QPointF getEnd() const { return end; }
+	QPointF getCenter() const { return start; }
+	double getRadius() const { return radius; }
+	const QVector<Stop>& getStops() const { return stops; }
+	const QImage& getImage() const { return image; }
+	QPointF getOrigin() const { return start; }
+	QString getSource() const { return source; }
+
+	// Pixely x0..x0+count-1 riadku y ciela do out; bod shadera = (pixel + origin) / zoom
+	void shadeSpan(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const;
+	QRgb shadePixel(int x, int y, double zoom, const QPoint& origin) const;
+
+private:
+	Type type = LinearGradient;
+	QPointF start;		// zaciatok linearneho gradientu, stred radialneho, pociatok vzoru
+	QPointF end;
+	double radius = 0;
+	QVector<Stop> stops;
+	QVector<QRgb> lut;
+	QImage image;
+	QString source;
+
+	void buildLut();
+	void shadeLinear(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const;
+	void shadeRadial(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const;
+	void shadePattern(int y, int x0, int count, double zoom, const QPoint& origin, QRgb* out) const;
+};
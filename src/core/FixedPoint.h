@@ -0,0 +1,58 @@
+#pragma once
+#include <QtGlobal>
+#include <QPoint>
+#include <QPointF>
+#include <QVector>
+
+// Bod s pevnou desatinnou ciarkou 24.8 (1/256 pixelu): geometria vyplni ide od transformacie pohladu az po
+// rasterizaciu bez zaokruhlenia na cele pixely. Cele suradnice su stredy pixelov, rovnako ako vrcholy QPoint.
+// Rozsah je +-Limit (4M pixelov), vzdialenejsie body sa pritlacia na hranicu.
+struct FixedPoint {
+	static constexpr int Shift = 8;
+	static constexpr qint32 One = 1 << Shift;
+	static constexpr qint64 Limit = qint64(1) << 30;
+
+	qint32 x = 0;
+	qint32 y = 0;
+
+	FixedPoint() = default;
+	FixedPoint(qint32 fixedX, qint32 fixedY) : x(fixedX), y(fixedY) {}
+
+	static qint32 clamp(qint64 value) { return static_cast<qint32>(qBound(-Limit, value, Limit)); }
+	static FixedPoint fromPoint(const QPoint& point) { return FixedPoint(clamp(qint64(point.x()) << Shift), clamp(qint64(point.y()) << Shift)); }
+	static FixedPoint fromPointF(const QPointF& point) { return FixedPoint(clamp(qRound64(point.x() * One)), clamp(qRound64(point.y() * One))); }
+	static QVector<FixedPoint> fromPoints(const QVector<QPoint>& points) {
+		QVector<FixedPoint> result;
+		result.reserve(points.size());
+		for (const QPoint& point : points) {
+			result.append(fromPoint(point));
+		}
+		return result;
+	}
+
+	// Cele pixely: floor/ceil aj pre zaporne hodnoty (aritmeticky posun), round polovicu nahor
+	static int floorToInt(qint64 value) { return static_cast<int>(value >> Shift); }
+	static int ceilToInt(qint64 value) { return static_cast<int>((value + One - 1) >> Shift); }
+	static int roundToInt(qint64 value) { return static_cast<int>((value + One / 2) >> Shift); }
+
+	// Podiel zaokruhleny nadol (aj pre zaporny citatel), delitel je kladny
+	static qint64 divideFloor(qint64 numerator, qint64 denominator) {
+		qint64 quotient = numerator / denominator;
+		return (numerator % denominator < 0) ? quotient - 1 : quotient;
+	}
+
+	// Podiel zaokruhleny na najblizsie cele cislo (polovica nahor), delitel moze byt zaporny
+	static qint64 divideRounded(qint64 numerator, qint64 denominator) {
+		if (denominator < 0) {
+			numerator = -numerator;
+			denominator = -denominator;
+		}
+		return divideFloor(2 * numerator + denominator, 2 * denominator);
+	}
+
+	QPoint toPoint() const { return QPoint(roundToInt(x), roundToInt(y)); }
+	QPointF toPointF() const { return QPointF(x / double(One), y / double(One)); }
+
+	bool operator==(const FixedPoint& other) const { return x == other.x && y == other.y; }
+	bool operator!=(const FixedPoint& other) const { return !(*this == other); }
+};
@@ -0,0 +1,226 @@
+#include "FrameProfiler.h"
+#include <QSaveFile>
+#include <QTextStream>
+#include <cmath>
+
+FrameProfiler::FrameProfiler()
+{
+	clock.start();
+	frames.reserve(MaxFrames);
+}
+
+FrameProfiler& FrameProfiler::instance()
+{
+	static FrameProfiler profiler;
+	return profiler;
+}
+
+const char* FrameProfiler::sectionName(Section section)
+{
+	static const char* names[SectionCount] = { "redrawAllShapes", "drawShape", "fillPolygon", "trimPolygon", "fillTriangles", "triangulate", "fillCoverage", "drawStroke", "drawCurve", "drawLineBresenham", "paintEvent" };
+	return (section >= 0 && section < SectionCount) ? names[section] : "?";
+}
+
+const char* FrameProfiler::counterName(Counter counter)
+{
+	static const char* names[CounterCount] = { "shapes drawn", "pixels written" };
+	return (counter >= 0 && counter < CounterCount) ? names[counter] : "?";
+}
+
+void FrameProfiler::setEnabled(bool enable)
+{
+	enabled = enable;
+	threadRecording = enable;
+	threadDepth = 0;
+	if (!enable) {
+		frameOpen = false;
+		current = Frame();
+	}
+}
+
+void FrameProfiler::reset()
+{
+	frames.clear();
+	oldest = 0;
+	frameOpen = false;
+	current = Frame();
+	busyHistogram.fill(0);
+	for (Histogram& histogram : sectionHistograms) {
+		histogram.fill(0);
+	}
+}
+
+const FrameProfiler::Frame& FrameProfiler::frame(int i) const
+{
+	return frames[(oldest + i) % frames.size()];
+}
+
+void FrameProfiler::record(Section section, int depth, qint64 startNs, qint64 endNs)
+{
+	if (!frameOpen) {
+		current = Frame();
+		current.index = nextFrameIndex++;
+		current.startNs = startNs;
+		frameOpen = true;
+	}
+	current.startNs = qMin(current.startNs, startNs);
+
+	qint64 duration = endNs - startNs;
+	current.sectionNs[section] += duration;
+	current.sectionCalls[section]++;
+	if (depth == 0) {
+		current.busyNs += duration;
+	}
+
+	if (static_cast<int>(current.events.size()) < MaxEventsPerFrame) {
+		current.events.push_back({ section, depth, startNs, duration });
+	}
+	else {
+		current.truncated = true;
+	}
+}
+
+void FrameProfiler::count(Counter counter, qint64 amount)
+{
+	if (!frameOpen) {
+		current = Frame();
+		current.index = nextFrameIndex++;
+		current.startNs = now();
+		frameOpen = true;
+	}
+	current.counters[counter] += amount;
+}
+
+void FrameProfiler::endFrame()
+{
+	if (!frameOpen) {
+		return;
+	}
+	frameOpen = false;
+	current.durationNs = now() - current.startNs;
+
+	addToHistogram(busyHistogram, current.busyNs);
+	for (int s = 0; s < SectionCount; s++) {
+		if (current.sectionCalls[s] > 0) {
+			addToHistogram(sectionHistograms[s], current.sectionNs[s]);
+		}
+	}
+
+	if (static_cast<int>(frames.size()) < MaxFrames) {
+		frames.push_back(std::move(current));
+	}
+	else {
+		frames[oldest] = std::move(current);
+		oldest = (oldest + 1) % MaxFrames;
+	}
+	current = Frame();
+}
+
+void FrameProfiler::addToHistogram(Histogram& histogram, qint64 ns)
+{
+	qint64 us = ns / 1000;
+	int bucket = 0;
+	while (bucket < HistogramBuckets - 1 && us >= (1LL << bucket)) {
+		bucket++;
+	}
+	histogram[bucket]++;
+}
+
+// Priblizny percentil z histogramu (horna hranica kosa)
+double FrameProfiler::percentileMs(const Histogram& histogram, double percentile) const
+{
+	quint64 total = 0;
+	for (quint32 n : histogram) {
+		total += n;
+	}
+	if (total == 0) {
+		return 0.0;
+	}
+
+	quint64 target = static_cast<quint64>(std::ceil(total * percentile / 100.0));
+	quint64 seen = 0;
+	for (int i = 0; i < HistogramBuckets; i++) {
+		seen += histogram[i];
+		if (seen >= target) {
+			return (1LL << i) / 1000.0;
+		}
+	}
+	return (1LL << (HistogramBuckets - 1)) / 1000.0;
+}
+
+QString FrameProfiler::overlayText() const
+{
+	const Frame* last = lastFrame();
+	if (last == nullptr) {
+		return QString("profiler: no frames yet");
+	}
+
+	double averageMs = 0.0;
+	for (int i = 0; i < frameCount(); i++) {
+		averageMs += frame(i).busyNs / 1e6;
+	}
+	averageMs /= frameCount();
+
+	QString text = QString("frame %1: %2 ms (avg %3 ms, p50 < %4 ms, p95 < %5 ms)\n")
+		.arg(last->index)
+		.arg(last->busyNs / 1e6, 0, 'f', 2)
+		.arg(averageMs, 0, 'f', 2)
+		.arg(percentileMs(busyHistogram, 50), 0, 'f', 3)
+		.arg(percentileMs(busyHistogram, 95), 0, 'f', 3);
+	text += QString("shapes drawn %1, pixels written %2\n")
+		.arg(last->counters[ShapesDrawn])
+		.arg(last->counters[PixelsWritten]);
+	for (int s = 0; s < SectionCount; s++) {
+		if (last->sectionCalls[s] == 0) {
+			continue;
+		}
+		text += QString("%1 %2 ms (%3x)\n")
+			.arg(sectionName(static_cast<Section>(s)), -18)
+			.arg(last->sectionNs[s] / 1e6, 8, 'f', 3)
+			.arg(last->sectionCalls[s]);
+	}
+	if (last->truncated) {
+		text += QString("(events truncated at %1)\n").arg(MaxEventsPerFrame);
+	}
+	return text.trimmed();
+}
+
+// Format Trace Event: udalosti "X" (complete) v mikrosekundach, pocitadla ako "C"
+bool FrameProfiler::exportChromeTrace(const QString& fileName, QString* errorMessage) const
+{
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+		if (errorMessage) {
+			*errorMessage = file.errorString();
+		}
+		return false;
+	}
+
+	QTextStream out(&file);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"render\"}}";
+
+	for (int i = 0; i < frameCount(); i++) {
+		const Frame& f = frame(i);
+		out << QString(",\n{\"name\":\"frame %1\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%2,\"dur\":%3}")
+			.arg(f.index).arg(f.startNs / 1000.0, 0, 'f', 3).arg(f.durationNs / 1000.0, 0, 'f', 3);
+		for (const Event& e : f.events) {
+			out << QString(",\n{\"name\":\"%1\",\"cat\":\"render\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%2,\"dur\":%3}")
+				.arg(sectionName(e.section)).arg(e.startNs / 1000.0, 0, 'f', 3).arg(e.durationNs / 1000.0, 0, 'f', 3);
+		}
+		for (int c = 0; c < CounterCount; c++) {
+			out << QString(",\n{\"name\":\"%1\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%2,\"args\":{\"value\":%3}}")
+				.arg(counterName(static_cast<Counter>(c))).arg(f.startNs / 1000.0, 0, 'f', 3).arg(f.counters[c]);
+		}
+	}
+	out << "\n]}\n";
+	out.flush();
+
+	if (!file.commit()) {
+		if (errorMessage) {
+			*errorMessage = file.errorString();
+		}
+		return false;
+	}
+	return true;
+}
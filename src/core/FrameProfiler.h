@@ -0,0 +1,116 @@
+#pragma once
+#include <QtGlobal>
+#include <QString>
+#include <QElapsedTimer>
+#include <array>
+#include <vector>
+
+// Jednoduchy profiler snimok: meria casy vybranych sekcii renderera, agreguje ich po snimkach do histogramov
+// a vie ich exportovat ako Chrome trace (chrome://tracing, Perfetto).
+// Zaznamenava sa len na vlakne, ktore profiler zaplo (editor: GUI vlakno).
+// Bez RENDER_PROFILER sa makra PROFILE_SCOPE/PROFILE_COUNT prelozia na nic.
+class FrameProfiler {
+public:
+	enum Section { RedrawAllShapes, DrawShape, FillPolygon, TrimPolygon, FillTriangles, Triangulate, FillCoverage, DrawStroke, DrawCurve, DrawLineBresenham, PaintEvent, SectionCount };
+	enum Counter { ShapesDrawn, PixelsWritten, CounterCount };
+
+	static constexpr int HistogramBuckets = 24;		// kos i: < 2^i mikrosekund
+	static constexpr int MaxFrames = 240;
+	static constexpr int MaxEventsPerFrame = 50000;	// dalsie udalosti sa uz len agreguju
+
+	using Histogram = std::array<quint32, HistogramBuckets>;
+
+	struct Event {
+		Section section;
+		int depth;
+		qint64 startNs;
+		qint64 durationNs;
+	};
+
+	struct Frame {
+		quint64 index = 0;
+		qint64 startNs = 0;
+		qint64 durationNs = 0;		// od prvej udalosti po endFrame
+		qint64 busyNs = 0;			// sucet sekcii na najvyssej urovni
+		std::array<qint64, SectionCount> sectionNs{};
+		std::array<int, SectionCount> sectionCalls{};
+		std::array<qint64, CounterCount> counters{};
+		std::vector<Event> events;
+		bool truncated = false;
+	};
+
+	class Scope {
+	public:
+		explicit Scope(Section section) : section(section) {
+			if (threadRecording) {
+				depth = threadDepth++;
+				startNs = instance().now();
+			}
+		}
+		~Scope() {
+			if (startNs >= 0) {
+				threadDepth--;
+				instance().record(section, depth, startNs, instance().now());
+			}
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Section section;
+		int depth = 0;
+		qint64 startNs = -1;
+	};
+
+	static FrameProfiler& instance();
+	static const char* sectionName(Section section);
+	static const char* counterName(Counter counter);
+	static bool recording() { return threadRecording; }
+
+	void setEnabled(bool enable);		// zapne/vypne zaznam pre volajuce vlakno
+	bool isEnabled() const { return enabled; }
+	void reset();
+
+	qint64 now() const { return clock.nsecsElapsed(); }
+	void record(Section section, int depth, qint64 startNs, qint64 endNs);
+	void count(Counter counter, qint64 amount);
+	void endFrame();
+
+	int frameCount() const { return static_cast<int>(frames.size()); }
+	const Frame& frame(int i) const;	// 0 = najstarsi zachovany snimok
+	const Frame* lastFrame() const { return frames.empty() ? nullptr : &frame(frameCount() - 1); }
+	const Histogram& frameHistogram() const { return busyHistogram; }
+	const Histogram& sectionHistogram(Section section) const { return sectionHistograms[section]; }
+	double percentileMs(const Histogram& histogram, double percentile) const;
+
+	QString overlayText() const;
+	bool exportChromeTrace(const QString& fileName, QString* errorMessage = nullptr) const;
+
+private:
+	FrameProfiler();
+
+	static inline thread_local bool threadRecording = false;
+	static inline thread_local int threadDepth = 0;
+
+	QElapsedTimer clock;
+	bool enabled = false;
+	bool frameOpen = false;
+	quint64 nextFrameIndex = 0;
+	Frame current;
+	std::vector<Frame> frames;			// kruhovy buffer poslednych MaxFrames snimok
+	int oldest = 0;
+	Histogram busyHistogram{};
+	std::array<Histogram, SectionCount> sectionHistograms{};
+
+	static void addToHistogram(Histogram& histogram, qint64 ns);
+};
+
+#ifdef RENDER_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(section) FrameProfiler::Scope PROFILE_CONCAT(profileScope_, __LINE__)(section)
+#define PROFILE_COUNT(counter, amount) do { if (FrameProfiler::recording()) { FrameProfiler::instance().count(counter, amount); } } while (0)
+#else
+#define PROFILE_SCOPE(section) do {} while (0)
+#define PROFILE_COUNT(counter, amount) do {} while (0)
+#endif
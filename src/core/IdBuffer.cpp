@@ -0,0 +1,50 @@
+#include "IdBuffer.h"
+#include <algorithm>
+
+void IdBuffer::resize(int width, int height)
+{
+	w = qMax(width, 0);
+	h = qMax(height, 0);
+	ids.assign(static_cast<size_t>(w) * h, 0);
+}
+
+void IdBuffer::clear()
+{
+	std::fill(ids.begin(), ids.end(), 0);
+}
+
+void IdBuffer::clear(const QRect& rect)
+{
+	QRect area = rect & QRect(0, 0, w, h);
+	for (int y = area.top(); y <= area.bottom() && !area.isEmpty(); y++) {
+		fillSpan(y, area.left(), area.right(), 0);
+	}
+}
+
+void IdBuffer::fillSpan(int y, int x0, int x1, quint32 id)
+{
+	quint32* row = ids.data() + static_cast<size_t>(y) * w;
+	std::fill(row + x0, row + x1 + 1, id);
+}
+
+void IdBuffer::swapIds(quint32 a, quint32 b)
+{
+	for (quint32& id : ids) {
+		if (id == a) {
+			id = b;
+		}
+		else if (id == b) {
+			id = a;
+		}
+	}
+}
+
+void IdBuffer::shiftIds(quint32 first, int delta)
+{
+	first = qMax(first, 1u);
+	for (quint32& id : ids) {
+		if (id >= first) {
+			id = static_cast<quint32>(qMax<qint64>(1, static_cast<qint64>(id) + delta));
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <QtGlobal>
+#include <QPoint>
+#include <QSize>
+#include <QRect>
+#include <vector>
+
+// Rovina identifikatorov tvarov: pre kazdy pixel handle tvaru, ktory ho naposledy zapisal (0 = pozadie).
+// Zapisuju ju tie iste rasterizery ako farbu, takze vyber tvaru pod kurzorom je jedno citanie.
+class IdBuffer {
+public:
+	IdBuffer(int width = 0, int height = 0) { resize(width, height); }
+
+	void resize(int width, int height);
+	void clear();
+	void clear(const QRect& rect);
+
+	int width() const { return w; }
+	int height() const { return h; }
+	QSize size() const { return QSize(w, h); }
+	qint64 memoryUsage() const { return static_cast<qint64>(ids.size()) * sizeof(quint32); }
+
+	quint32 at(int x, int y) const {
+		return (x < 0 || y < 0 || x >= w || y >= h) ? 0 : ids[static_cast<size_t>(y) * w + x];
+	}
+	quint32 at(const QPoint& point) const { return at(point.x(), point.y()); }
+
+	void set(int x, int y, quint32 id) {
+		if (x < 0 || y < 0 || x >= w || y >= h) {
+			return;
+		}
+		ids[static_cast<size_t>(y) * w + x] = id;
+	}
+	void fillSpan(int y, int x0, int x1, quint32 id);	// x0..x1 vratane, uz orezane na rovinu
+
+	void swapIds(quint32 a, quint32 b);					// premenuje handle a <-> b, napr. po vymene vrstiev
+	void shiftIds(quint32 first, int delta);			// handle >= first posunie o delta, napr. po vlozeni vrstvy
+
+private:
+	int w = 0;
+	int h = 0;
+	std::vector<quint32> ids;
+};
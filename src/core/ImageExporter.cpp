@@ -0,0 +1,343 @@
+#include "ImageExporter.h"
+#include "PngStreamWriter.h"
+#include "Rasterizer.h"
+#include <QFileInfo>
+#include <QPainter>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QMetaObject>
+
+namespace {
+	// Vyska pasu pri kresleni dokumentu (nasobok TiledFramebuffer::TileSize)
+	const int RenderBandRows = 256;
+
+	// Vsetky tvary sa kreslia cez scissor jedneho pasu; tvar mimo pasu sa len vyradi, pixely su rovnake ako naraz
+	bool renderBands(Rasterizer& raster, std::vector<ShapeVariant>& shapes, const QSize& size, const std::atomic<bool>* canceled, const std::function<void(int)>& progress)
+	{
+		raster.setAntialiasing(true);
+		for (int top = 0; top < size.height(); top += RenderBandRows) {
+			if (canceled && canceled->load(std::memory_order_relaxed)) {
+				return false;
+			}
+			raster.setScissor(QRect(0, top, size.width(), RenderBandRows));
+			raster.drawShapes(shapes);
+			if (progress) {
+				progress(qMin(top + RenderBandRows, size.height()) * 100 / size.height());
+			}
+		}
+		raster.resetScissor();
+		return true;
+	}
+
+	// Vracia ukazovatel na riadok y; ak zdroj nema riadky v pamati, naplni a vrati scratch
+	using RowSource = std::function<const QRgb*(int y, QRgb* scratch)>;
+
+	bool writePpm(int width, int height, const RowSource& rows, QIODevice& device, const std::atomic<bool>* canceled, const std::function<void(int)>& progress, QString* errorMessage)
+	{
+		QByteArray header = QString("P6\n%1 %2\n255\n").arg(width).arg(height).toLatin1();
+		if (device.write(header) != header.size()) {
+			*errorMessage = device.errorString();
+			return false;
+		}
+
+		std::vector<QRgb> scratch(width);
+		QByteArray row(width * 3, 0);
+		for (int y = 0; y < height; y++) {
+			if (canceled && canceled->load(std::memory_order_relaxed)) {
+				return false;
+			}
+
+			const QRgb* pixels = rows(y, scratch.data());
+			char* out = row.data();
+			for (int x = 0; x < width; x++) {
+				out[3 * x] = static_cast<char>(qRed(pixels[x]));
+				out[3 * x + 1] = static_cast<char>(qGreen(pixels[x]));
+				out[3 * x + 2] = static_cast<char>(qBlue(pixels[x]));
+			}
+			if (device.write(row) != row.size()) {
+				*errorMessage = device.errorString();
+				return false;
+			}
+			if (progress) {
+				progress((y + 1) * 100 / height);
+			}
+		}
+		return true;
+	}
+
+	bool writePng(int width, int height, bool hasAlpha, const RowSource& rows, QIODevice& device, const std::atomic<bool>* canceled, const std::function<void(int)>& progress, QString* errorMessage)
+	{
+		PngStreamWriter writer(&device);
+		if (!writer.begin(width, height, hasAlpha)) {
+			*errorMessage = writer.errorString();
+			return false;
+		}
+
+		std::vector<QRgb> scratch(width);
+		for (int y = 0; y < height; y++) {
+			if (canceled && canceled->load(std::memory_order_relaxed)) {
+				return false;
+			}
+			if (!writer.writeRow(rows(y, scratch.data()))) {
+				*errorMessage = writer.errorString();
+				return false;
+			}
+			if (progress) {
+				progress((y + 1) * 100 / height);
+			}
+		}
+
+		if (!writer.finish()) {
+			*errorMessage = writer.errorString();
+			return false;
+		}
+		return true;
+	}
+
+	bool finishFile(QSaveFile& file, bool success, const std::atomic<bool>* canceled, QString& error)
+	{
+		if (canceled && canceled->load()) {
+			file.cancelWriting();
+			error = "Export canceled.";
+			return false;
+		}
+		if (!success) {
+			file.cancelWriting();
+			return false;
+		}
+		if (!file.commit()) {
+			error = file.errorString();
+			return false;
+		}
+		return true;
+	}
+}
+
+ImageExporter::ImageExporter(QObject* parent)
+	: QObject(parent)
+{
+}
+
+ImageExporter::~ImageExporter()
+{
+	cancel();
+	if (done.valid()) {
+		done.wait();
+	}
+}
+
+bool ImageExporter::isRunning() const
+{
+	return done.valid() && done.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+void ImageExporter::cancel()
+{
+	if (task) {
+		task->canceled.store(true);
+	}
+}
+
+bool ImageExporter::start(const QImage& snapshot, const QString& fileName)
+{
+	if (snapshot.isNull()) {
+		return false;
+	}
+
+	std::shared_ptr<Task> newTask = std::make_shared<Task>();
+	newTask->image = snapshot;
+	newTask->fileName = fileName;
+	return startTask(newTask);
+}
+
+bool ImageExporter::start(std::shared_ptr<const TiledFramebuffer> snapshot, const QString& fileName)
+{
+	if (!snapshot) {
+		return false;
+	}
+
+	std::shared_ptr<Task> newTask = std::make_shared<Task>();
+	newTask->tiledImage = snapshot;
+	newTask->fileName = fileName;
+	return startTask(newTask);
+}
+
+bool ImageExporter::start(Document document, const QString& fileName)
+{
+	if (document.size.isEmpty()) {
+		return false;
+	}
+
+	std::shared_ptr<Task> newTask = std::make_shared<Task>();
+	newTask->document = std::make_unique<Document>(std::move(document));
+	newTask->fileName = fileName;
+	return startTask(newTask);
+}
+
+bool ImageExporter::startTask(std::shared_ptr<Task> newTask)
+{
+	if (isRunning()) {
+		return false;
+	}
+
+	task = newTask;
+
+	auto promise = std::make_shared<std::promise<void>>();
+	done = promise->get_future();
+
+	std::shared_ptr<Task> job = task;
+	QThreadPool::globalInstance()->start([this, job, promise]() {
+		int lastPercent = -1;
+		auto reportProgress = [this, &lastPercent](int percent) {
+			if (percent != lastPercent) {
+				lastPercent = percent;
+				QMetaObject::invokeMethod(this, [this, percent]() { emit progressChanged(percent); }, Qt::QueuedConnection);
+			}
+		};
+
+		QString errorMessage;
+		bool success = run(*job, errorMessage, reportProgress);
+		bool canceled = job->canceled.load();
+		QString fileName = job->fileName;
+
+		// Snapshot uvolnime este vo vlakne, aby sa pamat vratila hned po zakodovani
+		job->image = QImage();
+		job->tiledImage.reset();
+		job->document.reset();
+
+		QMetaObject::invokeMethod(this, [this, success, canceled, fileName, errorMessage]() {
+			emit finished(success, canceled, fileName, errorMessage);
+			}, Qt::QueuedConnection);
+		promise->set_value();
+		});
+
+	return true;
+}
+
+bool ImageExporter::run(Task& job, QString& errorMessage, const std::function<void(int)>& progress)
+{
+	if (job.tiledImage) {
+		return encode(*job.tiledImage, job.fileName, &errorMessage, &job.canceled, progress);
+	}
+	if (!job.document) {
+		return encode(job.image, job.fileName, &errorMessage, &job.canceled, progress);
+	}
+
+	// Dokument: prva polovica priebehu je kreslenie, druha kodovanie
+	auto renderProgress = [&progress](int percent) { progress(percent / 2); };
+	auto encodeProgress = [&progress](int percent) { progress(50 + percent / 2); };
+	Document& document = *job.document;
+	if (TiledFramebuffer::preferredFor(document.size.width(), document.size.height())) {
+		TiledFramebuffer image(document.size.width(), document.size.height());
+		return render(document, image, &job.canceled, renderProgress)
+			&& encode(image, job.fileName, &errorMessage, &job.canceled, encodeProgress);
+	}
+
+	QImage image(document.size, QImage::Format_ARGB32);
+	if (image.isNull()) {
+		errorMessage = "Not enough memory to render the image.";
+		return false;
+	}
+	return render(document, image, &job.canceled, renderProgress)
+		&& encode(image, job.fileName, &errorMessage, &job.canceled, encodeProgress);
+}
+
+bool ImageExporter::render(Document& document, QImage& target, const std::atomic<bool>* canceled, const std::function<void(int)>& progress)
+{
+	target.fill(Qt::white);
+	if (!document.background.isNull()) {
+		QPainter backgroundPainter(&target);
+		backgroundPainter.drawImage(0, 0, document.background);
+	}
+
+	Rasterizer documentRaster(&target);
+	return renderBands(documentRaster, document.shapes, target.size(), canceled, progress);
+}
+
+bool ImageExporter::render(Document& document, TiledFramebuffer& target, const std::atomic<bool>* canceled, const std::function<void(int)>& progress)
+{
+	target.clear(QColor(Qt::white).rgba());
+	const QImage& background = document.background;
+	if (!background.isNull()) {
+		QImage source = background.convertToFormat(QImage::Format_ARGB32);
+		for (int y = 0; y < qMin(source.height(), target.height()); y++) {
+			const QRgb* row = reinterpret_cast<const QRgb*>(source.constScanLine(y));
+			target.writeSpan(y, 0, qMin(source.width(), target.width()) - 1, row);
+		}
+	}
+
+	Rasterizer documentRaster(&target);
+	return renderBands(documentRaster, document.shapes, target.size(), canceled, progress);
+}
+
+bool ImageExporter::encode(const QImage& image, const QString& fileName, QString* errorMessage, const std::atomic<bool>* canceled, const std::function<void(int)>& progress)
+{
+	QString localError;
+	QString& error = errorMessage ? *errorMessage : localError;
+
+	QString extension = QFileInfo(fileName).suffix().toLower();
+	QImage source = image;
+	if (source.format() != QImage::Format_ARGB32 && source.format() != QImage::Format_RGB32) {
+		source = image.convertToFormat(QImage::Format_ARGB32);
+	}
+	RowSource rows = [&source](int y, QRgb*) {
+		return reinterpret_cast<const QRgb*>(source.constScanLine(y));
+	};
+
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		error = file.errorString();
+		return false;
+	}
+
+	bool success = false;
+	if (extension == "png") {
+		success = writePng(source.width(), source.height(), source.hasAlphaChannel(), rows, file, canceled, progress, &error);
+	}
+	else if (extension == "ppm") {
+		success = writePpm(source.width(), source.height(), rows, file, canceled, progress, &error);
+	}
+	else {
+		if (progress) {
+			progress(0);
+		}
+		success = source.save(&file, extension.toUpper().toLatin1().constData());
+		if (!success) {
+			error = "Unable to encode image.";
+		}
+		else if (progress) {
+			progress(100);
+		}
+	}
+
+	return finishFile(file, success, canceled, error);
+}
+
+bool ImageExporter::encode(const TiledFramebuffer& image, const QString& fileName, QString* errorMessage, const std::atomic<bool>* canceled, const std::function<void(int)>& progress)
+{
+	QString localError;
+	QString& error = errorMessage ? *errorMessage : localError;
+
+	QString extension = QFileInfo(fileName).suffix().toLower();
+	if (extension != "png" && extension != "ppm") {
+		error = "Large canvases can only be exported as PNG or PPM.";
+		return false;
+	}
+
+	RowSource rows = [&image](int y, QRgb* scratch) {
+		image.readRow(y, scratch);
+		return static_cast<const QRgb*>(scratch);
+	};
+
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		error = file.errorString();
+		return false;
+	}
+
+	bool success = (extension == "png")
+		? writePng(image.width(), image.height(), true, rows, file, canceled, progress, &error)
+		: writePpm(image.width(), image.height(), rows, file, canceled, progress, &error);
+
+	return finishFile(file, success, canceled, error);
+}
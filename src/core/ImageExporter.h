@@ -0,0 +1,64 @@
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QString>
+#include "TiledFramebuffer.h"
+#include "representation.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Asynchronny export obrazka: kreslenie dokumentu aj kodovanie bezi vo vlakne z QThreadPool, priebeh a vysledok
+// sa hlasia signalmi do vlakna, v ktorom objekt zije. PNG a PPM sa zapisuju po riadkoch.
+class ImageExporter : public QObject {
+	Q_OBJECT
+public:
+	// Scena na export: kopie tvarov v poradi kreslenia (nezavisle od editora), pozadie a velkost dokumentu
+	struct Document {
+		QSize size;
+		QImage background;
+		std::vector<ShapeVariant> shapes;
+	};
+
+	explicit ImageExporter(QObject* parent = nullptr);
+	~ImageExporter();
+
+	// snapshot musi byt samostatna kopia framebufferu (napr. QImage::copy), do ktorej uz nikto nezapisuje
+	bool start(const QImage& snapshot, const QString& fileName);
+	bool start(std::shared_ptr<const TiledFramebuffer> snapshot, const QString& fileName);
+	// Dokument sa vykresli (vyhladene) az vo vlakne exportu, velke platno do TiledFramebuffer
+	bool start(Document document, const QString& fileName);
+	void cancel();
+	bool isRunning() const;
+
+	// Synchronne vyhladene kreslenie dokumentu po pasoch riadkov; medzi pasmi sa hlasi priebeh
+	// a kontroluje zrusenie (vtedy vrati false a obrazok je neuplny)
+	static bool render(Document& document, QImage& target, const std::atomic<bool>* canceled = nullptr, const std::function<void(int)>& progress = nullptr);
+	static bool render(Document& document, TiledFramebuffer& target, const std::atomic<bool>* canceled = nullptr, const std::function<void(int)>& progress = nullptr);
+
+	// Synchronne kodovanie, pouziva ho aj davkovy renderer
+	static bool encode(const QImage& image, const QString& fileName, QString* errorMessage = nullptr, const std::atomic<bool>* canceled = nullptr, const std::function<void(int)>& progress = nullptr);
+	// Dlazdicovy framebuffer sa cita po riadkoch, podporovane su len PNG a PPM
+	static bool encode(const TiledFramebuffer& image, const QString& fileName, QString* errorMessage = nullptr, const std::atomic<bool>* canceled = nullptr, const std::function<void(int)>& progress = nullptr);
+
+signals:
+	void progressChanged(int percent);
+	void finished(bool success, bool canceled, const QString& fileName, const QString& errorMessage);
+
+private:
+	struct Task {
+		QImage image;
+		std::shared_ptr<const TiledFramebuffer> tiledImage;
+		std::unique_ptr<Document> document;
+		QString fileName;
+		std::atomic<bool> canceled{ false };
+	};
+
+	std::shared_ptr<Task> task;
+	std::future<void> done;
+
+	bool startTask(std::shared_ptr<Task> newTask);
+	static bool run(Task& job, QString& errorMessage, const std::function<void(int)>& progress);
+};
@@ -0,0 +1,316 @@
+#include "PngStreamWriter.h"
+#include <cstdlib>
+#include <cstring>
+#ifdef RENDER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+	const int IdatChunkSize = 64 * 1024;
+	const int StoredBlockSize = 65535;
+
+	const quint32* crcTable()
+	{
+		static const std::vector<quint32> table = []() {
+			std::vector<quint32> t(256);
+			for (quint32 n = 0; n < 256; n++) {
+				quint32 c = n;
+				for (int k = 0; k < 8; k++) {
+					c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				}
+				t[n] = c;
+			}
+			return t;
+		}();
+		return table.data();
+	}
+
+	quint32 updateCrc(quint32 crc, const uchar* bytes, int length)
+	{
+		const quint32* table = crcTable();
+		for (int i = 0; i < length; i++) {
+			crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+	void putBigEndian(uchar* out, quint32 value)
+	{
+		out[0] = static_cast<uchar>(value >> 24);
+		out[1] = static_cast<uchar>(value >> 16);
+		out[2] = static_cast<uchar>(value >> 8);
+		out[3] = static_cast<uchar>(value);
+	}
+
+	int paeth(int a, int b, int c)
+	{
+		int p = a + b - c;
+		int pa = std::abs(p - a);
+		int pb = std::abs(p - b);
+		int pc = std::abs(p - c);
+		if (pa <= pb && pa <= pc) {
+			return a;
+		}
+		return (pb <= pc) ? b : c;
+	}
+}
+
+struct PngStreamWriter::Deflater {
+#ifdef RENDER_HAVE_ZLIB
+	z_stream stream;
+	bool initialized = false;
+
+	~Deflater() {
+		if (initialized) {
+			deflateEnd(&stream);
+		}
+	}
+#else
+	QByteArray stored;
+	quint32 adlerA = 1;
+	quint32 adlerB = 0;
+	bool headerWritten = false;
+#endif
+};
+
+PngStreamWriter::PngStreamWriter(QIODevice* device)
+	: device(device), deflater(new Deflater)
+{
+}
+
+PngStreamWriter::~PngStreamWriter() = default;
+
+bool PngStreamWriter::begin(int width, int height, bool hasAlpha)
+{
+	if (device == nullptr || !device->isOpen()) {
+		error = "Output device is not open.";
+		return false;
+	}
+	if (width <= 0 || height <= 0) {
+		error = "Invalid image size.";
+		return false;
+	}
+
+	this->width = width;
+	this->height = height;
+	bytesPerPixel = hasAlpha ? 4 : 3;
+	currentRow = 0;
+
+	size_t rowBytes = static_cast<size_t>(width) * bytesPerPixel;
+	previousRow.assign(rowBytes, 0);
+	currentRaw.assign(rowBytes, 0);
+	for (std::vector<uchar>& f : filtered) {
+		f.assign(rowBytes, 0);
+	}
+
+#ifdef RENDER_HAVE_ZLIB
+	std::memset(&deflater->stream, 0, sizeof(deflater->stream));
+	if (deflateInit(&deflater->stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+		error = "Unable to initialize zlib.";
+		return false;
+	}
+	deflater->initialized = true;
+#endif
+
+	static const uchar signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	if (device->write(reinterpret_cast<const char*>(signature), 8) != 8) {
+		error = device->errorString();
+		return false;
+	}
+
+	uchar header[13];
+	putBigEndian(header, static_cast<quint32>(width));
+	putBigEndian(header + 4, static_cast<quint32>(height));
+	header[8] = 8;						// bitova hlbka
+	header[9] = hasAlpha ? 6 : 2;		// RGBA / RGB
+	header[10] = 0;						// deflate
+	header[11] = 0;						// adaptivne filtre
+	header[12] = 0;						// bez prekladania
+	return writeChunk("IHDR", header, 13);
+}
+
+int PngStreamWriter::chooseFilter()
+{
+	const int rowBytes = static_cast<int>(currentRaw.size());
+	const uchar* raw = currentRaw.data();
+	const uchar* prior = previousRow.data();
+	const int bpp = bytesPerPixel;
+
+	for (int i = 0; i < rowBytes; i++) {
+		int left = (i >= bpp) ? raw[i - bpp] : 0;
+		int up = prior[i];
+		int upLeft = (i >= bpp) ? prior[i - bpp] : 0;
+
+		filtered[0][i] = raw[i];
+		filtered[1][i] = static_cast<uchar>(raw[i] - left);
+		filtered[2][i] = static_cast<uchar>(raw[i] - up);
+		filtered[3][i] = static_cast<uchar>(raw[i] - ((left + up) >> 1));
+		filtered[4][i] = static_cast<uchar>(raw[i] - paeth(left, up, upLeft));
+	}
+
+	// Heuristika z PNG specifikacie: minimalny sucet absolutnych hodnot (ako signed bajty)
+	int best = 0;
+	quint64 bestSum = ~0ull;
+	for (int f = 0; f < 5; f++) {
+		quint64 sum = 0;
+		for (int i = 0; i < rowBytes; i++) {
+			sum += static_cast<quint64>(std::abs(static_cast<int>(static_cast<signed char>(filtered[f][i]))));
+		}
+		if (sum < bestSum) {
+			bestSum = sum;
+			best = f;
+		}
+	}
+	return best;
+}
+
+bool PngStreamWriter::writeRow(const QRgb* row)
+{
+	if (currentRow >= height) {
+		error = "Too many rows written.";
+		return false;
+	}
+
+	uchar* raw = currentRaw.data();
+	if (bytesPerPixel == 4) {
+		for (int x = 0; x < width; x++) {
+			raw[4 * x] = static_cast<uchar>(qRed(row[x]));
+			raw[4 * x + 1] = static_cast<uchar>(qGreen(row[x]));
+			raw[4 * x + 2] = static_cast<uchar>(qBlue(row[x]));
+			raw[4 * x + 3] = static_cast<uchar>(qAlpha(row[x]));
+		}
+	}
+	else {
+		for (int x = 0; x < width; x++) {
+			raw[3 * x] = static_cast<uchar>(qRed(row[x]));
+			raw[3 * x + 1] = static_cast<uchar>(qGreen(row[x]));
+			raw[3 * x + 2] = static_cast<uchar>(qBlue(row[x]));
+		}
+	}
+
+	uchar filterType = static_cast<uchar>(chooseFilter());
+	if (!appendCompressed(&filterType, 1, false)) {
+		return false;
+	}
+	if (!appendCompressed(filtered[filterType].data(), static_cast<int>(filtered[filterType].size()), false)) {
+		return false;
+	}
+
+	std::swap(previousRow, currentRaw);
+	currentRow++;
+	return flushIdat(false);
+}
+
+bool PngStreamWriter::finish()
+{
+	if (currentRow != height) {
+		error = QString("Only %1 of %2 rows were written.").arg(currentRow).arg(height);
+		return false;
+	}
+
+	if (!appendCompressed(nullptr, 0, true) || !flushIdat(true)) {
+		return false;
+	}
+	return writeChunk("IEND", nullptr, 0);
+}
+
+#ifdef RENDER_HAVE_ZLIB
+bool PngStreamWriter::appendCompressed(const uchar* bytes, int length, bool last)
+{
+	z_stream& z = deflater->stream;
+	z.next_in = const_cast<Bytef*>(bytes);
+	z.avail_in = static_cast<uInt>(length);
+
+	uchar out[16384];
+	do {
+		z.next_out = out;
+		z.avail_out = sizeof(out);
+		if (deflate(&z, last ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+			error = "zlib compression failed.";
+			return false;
+		}
+		pendingIdat.append(reinterpret_cast<const char*>(out), static_cast<int>(sizeof(out) - z.avail_out));
+	} while (z.avail_out == 0);
+
+	return true;
+}
+#else
+bool PngStreamWriter::appendCompressed(const uchar* bytes, int length, bool last)
+{
+	Deflater& d = *deflater;
+	if (!d.headerWritten) {
+		pendingIdat.append(static_cast<char>(0x78));
+		pendingIdat.append(static_cast<char>(0x01));
+		d.headerWritten = true;
+	}
+
+	for (int i = 0; i < length; i++) {
+		d.adlerA = (d.adlerA + bytes[i]) % 65521;
+		d.adlerB = (d.adlerB + d.adlerA) % 65521;
+	}
+
+	auto emitBlock = [this, &d](int blockLength, bool finalBlock) {
+		uchar header[5];
+		header[0] = finalBlock ? 1 : 0;
+		header[1] = static_cast<uchar>(blockLength & 0xff);
+		header[2] = static_cast<uchar>(blockLength >> 8);
+		header[3] = static_cast<uchar>(~blockLength & 0xff);
+		header[4] = static_cast<uchar>((~blockLength >> 8) & 0xff);
+		pendingIdat.append(reinterpret_cast<const char*>(header), 5);
+		pendingIdat.append(d.stored.constData(), blockLength);
+		d.stored.remove(0, blockLength);
+	};
+
+	int offset = 0;
+	while (offset < length) {
+		int take = qMin(length - offset, StoredBlockSize - static_cast<int>(d.stored.size()));
+		d.stored.append(reinterpret_cast<const char*>(bytes + offset), take);
+		offset += take;
+		if (d.stored.size() == StoredBlockSize) {
+			emitBlock(StoredBlockSize, false);
+		}
+	}
+
+	if (last) {
+		emitBlock(static_cast<int>(d.stored.size()), true);
+		uchar adler[4];
+		putBigEndian(adler, (d.adlerB << 16) | d.adlerA);
+		pendingIdat.append(reinterpret_cast<const char*>(adler), 4);
+	}
+	return true;
+}
+#endif
+
+bool PngStreamWriter::flushIdat(bool force)
+{
+	while (pendingIdat.size() >= IdatChunkSize || (force && !pendingIdat.isEmpty())) {
+		int length = qMin(static_cast<int>(pendingIdat.size()), IdatChunkSize);
+		if (!writeChunk("IDAT", reinterpret_cast<const uchar*>(pendingIdat.constData()), length)) {
+			return false;
+		}
+		pendingIdat.remove(0, length);
+	}
+	return true;
+}
+
+bool PngStreamWriter::writeChunk(const char type[4], const uchar* payload, int length)
+{
+	uchar header[8];
+	putBigEndian(header, static_cast<quint32>(length));
+	std::memcpy(header + 4, type, 4);
+
+	quint32 crc = updateCrc(0xffffffffu, header + 4, 4);
+	if (length > 0) {
+		crc = updateCrc(crc, payload, length);
+	}
+	uchar trailer[4];
+	putBigEndian(trailer, crc ^ 0xffffffffu);
+
+	if (device->write(reinterpret_cast<const char*>(header), 8) != 8
+		|| (length > 0 && device->write(reinterpret_cast<const char*>(payload), length) != length)
+		|| device->write(reinterpret_cast<const char*>(trailer), 4) != 4) {
+		error = device->errorString();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QColor>
+#include <memory>
+#include <vector>
+
+// Zapis PNG po riadkoch: riadok sa hned prefiltruje, skomprimuje a odosle do zariadenia,
+// takze pamat enkodera je O(sirka) a nie O(sirka x vyska).
+// Ak je k dispozicii zlib (RENDER_HAVE_ZLIB), pouzije sa deflate, inak sa zapisu nekomprimovane (stored) bloky.
+class PngStreamWriter {
+public:
+	explicit PngStreamWriter(QIODevice* device);
+	~PngStreamWriter();
+
+	bool begin(int width, int height, bool hasAlpha = true);
+	bool writeRow(const QRgb* row);	// jeden riadok vo formate ARGB32 (nie premultiplied)
+	bool finish();
+
+	int rowsWritten() const { return currentRow; }
+	QString errorString() const { return error; }
+
+private:
+	struct Deflater;
+
+	QIODevice* device = nullptr;
+	std::unique_ptr<Deflater> deflater;
+	int width = 0;
+	int height = 0;
+	int bytesPerPixel = 4;
+	int currentRow = 0;
+	QString error;
+
+	std::vector<uchar> previousRow;
+	std::vector<uchar> currentRaw;
+	std::vector<uchar> filtered[5];
+	QByteArray pendingIdat;
+
+	bool writeChunk(const char type[4], const uchar* payload, int length);
+	bool appendCompressed(const uchar* bytes, int length, bool last);
+	bool flushIdat(bool force);
+	int chooseFilter();
+};
@@ -0,0 +1,1914 @@
+#include "Rasterizer.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RASTER_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTER_SIMD_SSE2
+#endif
+
+namespace {
+	// Pixely usecky a -> b v poradi Bresenhamovho algoritmu, koncovy bod ako posledny
+	template <typename Plot>
+	inline void bresenhamLine(const QPoint& a, const QPoint& b, Plot&& plot)
+	{
+		int p, k1, k2;
+		int dx = b.x() - a.x();
+		int dy = b.y() - a.y();
+
+		int adx = abs(dx);
+		int ady = abs(dy);
+
+		int x = a.x();
+		int y = a.y();
+
+		int incrementX = (dx > 0) ? 1 : -1;
+		int incrementY = (dy > 0) ? 1 : -1;
+
+		if (adx > ady) {
+			p = 2 * ady - adx;
+			k1 = 2 * ady;
+			k2 = 2 * (ady - adx);
+
+			while (x != b.x()) {
+				plot(x, y);
+				x += incrementX;
+				if (p >= 0) {
+					y += incrementY;
+					p += k2;
+				}
+				else {
+					p += k1;
+				}
+			}
+		}
+		else {
+			p = 2 * adx - ady;
+			k1 = 2 * adx;
+			k2 = 2 * (adx - ady);
+
+			while (y != b.y()) {
+				plot(x, y);
+				y += incrementY;
+				if (p >= 0) {
+					x += incrementX;
+					p += k2;
+				}
+				else {
+					p += k1;
+				}
+			}
+		}
+
+		plot(b.x(), b.y());
+	}
+
+	// Kroky 0..lastStep usecky a -> b (posledny krok je b), ktorych pixely lezia v clip, s pixelmi ako bresenhamLine.
+	// Po i krokoch v hlavnej osi (dlzka L) je krokov vo vedlajsej osi (dlzka S) m(i) = floor((2 i S + L) / (2 L)),
+	// takze rozsah krokov vnutri clip aj stav Bresenhama v jeho zaciatku sa vypocitaju priamo (orezanie bez posunu bodov).
+	template <typename Plot>
+	void bresenhamClipped(const QPoint& a, const QPoint& b, const QRect& clip, int lastStep, Plot&& plot)
+	{
+		int dx = b.x() - a.x();
+		int dy = b.y() - a.y();
+		bool xMajor = abs(dx) > abs(dy);
+		int L = xMajor ? abs(dx) : abs(dy);
+		int S = xMajor ? abs(dy) : abs(dx);
+		if (L == 0) {
+			if (lastStep >= 0 && clip.contains(a)) {
+				plot(a.x(), a.y());
+			}
+			return;
+		}
+		int incrementMajor = ((xMajor ? dx : dy) > 0) ? 1 : -1;
+		int incrementMinor = ((xMajor ? dy : dx) > 0) ? 1 : -1;
+		int major0 = xMajor ? a.x() : a.y();
+		int minor0 = xMajor ? a.y() : a.x();
+		int majorLow = xMajor ? clip.left() : clip.top(), majorHigh = xMajor ? clip.right() : clip.bottom();
+		int minorLow = xMajor ? clip.top() : clip.left(), minorHigh = xMajor ? clip.bottom() : clip.right();
+
+		// Hlavna os: major0 + incrementMajor * i
+		qint64 first = 0, last = lastStep;
+		if (incrementMajor > 0) {
+			first = qMax<qint64>(first, majorLow - major0);
+			last = qMin<qint64>(last, majorHigh - major0);
+		}
+		else {
+			first = qMax<qint64>(first, major0 - majorHigh);
+			last = qMin<qint64>(last, major0 - majorLow);
+		}
+		// Vedlajsia os: minor0 + incrementMinor * m(i), m neklesa
+		qint64 mLow = (incrementMinor > 0) ? minorLow - minor0 : minor0 - minorHigh;
+		qint64 mHigh = (incrementMinor > 0) ? minorHigh - minor0 : minor0 - minorLow;
+		if (mHigh < 0 || (S == 0 && mLow > 0)) {
+			return;
+		}
+		if (S > 0) {
+			if (mLow > 0) {
+				first = qMax(first, (2 * L * mLow - L + 2 * S - 1) / (2 * S));
+			}
+			last = qMin(last, (2 * L * (mHigh + 1) - L + 2 * S - 1) / (2 * S) - 1);
+		}
+		if (first > last) {
+			return;
+		}
+
+		qint64 m = (2 * first * S + L) / (2 * L);
+		int p = static_cast<int>(2 * (first + 1) * S - L - 2 * L * m);
+		int k1 = 2 * S;
+		int k2 = 2 * (S - L);
+		int major = major0 + incrementMajor * static_cast<int>(first);
+		int minor = minor0 + incrementMinor * static_cast<int>(m);
+		auto walk = [&](auto&& plotMajorMinor) {
+			for (qint64 i = first; i <= last; i++) {
+				plotMajorMinor(major, minor);
+				major += incrementMajor;
+				if (p >= 0) {
+					minor += incrementMinor;
+					p += k2;
+				}
+				else {
+					p += k1;
+				}
+			}
+		};
+		if (xMajor) {
+			walk([&plot](int u, int v) { plot(u, v); });
+		}
+		else {
+			walk([&plot](int u, int v) { plot(v, u); });
+		}
+	}
+
+	// Bresenham pre viac usecok naraz: kazda draha registra krokuje jednu usecku s rovnakymi rozhodnutiami ako
+	// bresenhamLine (rovnake pixely, bez vetvenia podla p), pixely drah sa zapisuju jednotlivo.
+	// Skupina bezi tolko krokov, kolko ma jej najdlhsia usecka, preto dlhsie nez LaneMaxSteps idu skalarne.
+#if defined(RASTER_SIMD_AVX2)
+	const int LineLanes = 8;
+#elif defined(RASTER_SIMD_SSE2)
+	const int LineLanes = 4;
+#else
+	const int LineLanes = 1;
+#endif
+	const int LaneMaxSteps = 64;
+
+	inline int bresenhamSteps(const QPoint& a, const QPoint& b)
+	{
+		return qMax(abs(b.x() - a.x()), abs(b.y() - a.y()));
+	}
+
+	// plot(i, x, y), i = index usecky a[i] -> b[i]; kazda ma najviac LaneMaxSteps krokov.
+	// ends = false vynecha koncovy bod (v lomenej ciare ho nakresli nasledujuci usek)
+	template <typename Plot>
+	void bresenhamLanes(const QPoint* a, const QPoint* b, int count, bool ends, Plot&& plot)
+	{
+#if defined(RASTER_SIMD_AVX2) || defined(RASTER_SIMD_SSE2)
+		struct alignas(32) Lanes {
+			qint32 x[LineLanes], y[LineLanes], p[LineLanes], k1[LineLanes], k2[LineLanes];
+			qint32 majorX[LineLanes], majorY[LineLanes], minorX[LineLanes], minorY[LineLanes], steps[LineLanes];
+		};
+
+		for (int first = 0; first < count; first += LineLanes) {
+			int lanes = qMin(LineLanes, count - first);
+			Lanes s = {};
+			int maxSteps = 0;
+			for (int lane = 0; lane < lanes; lane++) {
+				const QPoint& from = a[first + lane];
+				const QPoint& to = b[first + lane];
+				int dx = to.x() - from.x(), dy = to.y() - from.y();
+				int adx = abs(dx), ady = abs(dy);
+				int incrementX = (dx > 0) ? 1 : -1;
+				int incrementY = (dy > 0) ? 1 : -1;
+				s.x[lane] = from.x();
+				s.y[lane] = from.y();
+				if (adx > ady) {
+					s.p[lane] = 2 * ady - adx;
+					s.k1[lane] = 2 * ady;
+					s.k2[lane] = 2 * (ady - adx);
+					s.majorX[lane] = incrementX;
+					s.minorY[lane] = incrementY;
+					s.steps[lane] = adx;
+				}
+				else {
+					s.p[lane] = 2 * adx - ady;
+					s.k1[lane] = 2 * adx;
+					s.k2[lane] = 2 * (adx - ady);
+					s.majorY[lane] = incrementY;
+					s.minorX[lane] = incrementX;
+					s.steps[lane] = ady;
+				}
+				maxSteps = qMax(maxSteps, s.steps[lane]);
+			}
+
+#if defined(RASTER_SIMD_AVX2)
+			auto load = [](const qint32* v) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(v)); };
+			__m256i x = load(s.x), y = load(s.y), p = load(s.p), k1 = load(s.k1), k2 = load(s.k2);
+			__m256i majorX = load(s.majorX), majorY = load(s.majorY), minorX = load(s.minorX), minorY = load(s.minorY);
+			__m256i steps = load(s.steps);
+			const __m256i minusOne = _mm256_set1_epi32(-1);
+			for (int step = 0; step < maxSteps; step++) {
+				unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(steps, _mm256_set1_epi32(step)))));
+				_mm256_store_si256(reinterpret_cast<__m256i*>(s.x), x);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(s.y), y);
+				while (mask) {
+					int lane = static_cast<int>(qCountTrailingZeroBits(mask));
+					plot(first + lane, s.x[lane], s.y[lane]);
+					mask &= mask - 1;
+				}
+				__m256i minor = _mm256_cmpgt_epi32(p, minusOne);	// p >= 0
+				x = _mm256_add_epi32(_mm256_add_epi32(x, majorX), _mm256_and_si256(minor, minorX));
+				y = _mm256_add_epi32(_mm256_add_epi32(y, majorY), _mm256_and_si256(minor, minorY));
+				p = _mm256_add_epi32(p, _mm256_blendv_epi8(k1, k2, minor));
+			}
+#else
+			auto load = [](const qint32* v) { return _mm_load_si128(reinterpret_cast<const __m128i*>(v)); };
+			__m128i x = load(s.x), y = load(s.y), p = load(s.p), k1 = load(s.k1), k2 = load(s.k2);
+			__m128i majorX = load(s.majorX), majorY = load(s.majorY), minorX = load(s.minorX), minorY = load(s.minorY);
+			__m128i steps = load(s.steps);
+			const __m128i minusOne = _mm_set1_epi32(-1);
+			for (int step = 0; step < maxSteps; step++) {
+				unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(steps, _mm_set1_epi32(step)))));
+				_mm_store_si128(reinterpret_cast<__m128i*>(s.x), x);
+				_mm_store_si128(reinterpret_cast<__m128i*>(s.y), y);
+				while (mask) {
+					int lane = static_cast<int>(qCountTrailingZeroBits(mask));
+					plot(first + lane, s.x[lane], s.y[lane]);
+					mask &= mask - 1;
+				}
+				__m128i minor = _mm_cmpgt_epi32(p, minusOne);	// p >= 0
+				x = _mm_add_epi32(_mm_add_epi32(x, majorX), _mm_and_si128(minor, minorX));
+				y = _mm_add_epi32(_mm_add_epi32(y, majorY), _mm_and_si128(minor, minorY));
+				p = _mm_add_epi32(p, _mm_or_si128(_mm_and_si128(minor, k2), _mm_andnot_si128(minor, k1)));
+			}
+#endif
+			// Koncovy bod ako v bresenhamLine
+			for (int lane = 0; ends && lane < lanes; lane++) {
+				plot(first + lane, b[first + lane].x(), b[first + lane].y());
+			}
+		}
+#else
+		// Hlavna suradnica rastie v kazdom kroku, koncovy bod je preto medzi pixelmi usecky len raz
+		for (int i = 0; i < count; i++) {
+			const QPoint& end = b[i];
+			bresenhamLine(a[i], end, [&plot, i, ends, &end](int x, int y) {
+				if (ends || x != end.x() || y != end.y()) {
+					plot(i, x, y);
+				}
+				});
+		}
+#endif
+	}
+
+	// Hranove funkcie trojuholnika vyhodnocovane v bloku susednych pixelov jedneho riadku
+#if defined(RASTER_SIMD_AVX2)
+	const int TriangleLanes = 8;
+#else
+	const int TriangleLanes = 4;
+#endif
+
+	struct TriangleLaneSteps {
+		alignas(32) qint32 offsets[3][TriangleLanes];	// a * lane pre kazdu hranu
+	};
+
+	// Maska pixelov x..x+TriangleLanes-1, v ktorych su vsetky tri hranove funkcie >= 0 (e = hodnoty v x)
+	inline unsigned insideLanes(const qint32 e[3], const TriangleLaneSteps& steps)
+	{
+#if defined(RASTER_SIMD_AVX2)
+		__m256i e0 = _mm256_add_epi32(_mm256_set1_epi32(e[0]), _mm256_load_si256(reinterpret_cast<const __m256i*>(steps.offsets[0])));
+		__m256i e1 = _mm256_add_epi32(_mm256_set1_epi32(e[1]), _mm256_load_si256(reinterpret_cast<const __m256i*>(steps.offsets[1])));
+		__m256i e2 = _mm256_add_epi32(_mm256_set1_epi32(e[2]), _mm256_load_si256(reinterpret_cast<const __m256i*>(steps.offsets[2])));
+		__m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), e2);
+		return ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(any))) & 0xffu;
+#elif defined(RASTER_SIMD_SSE2)
+		__m128i e0 = _mm_add_epi32(_mm_set1_epi32(e[0]), _mm_load_si128(reinterpret_cast<const __m128i*>(steps.offsets[0])));
+		__m128i e1 = _mm_add_epi32(_mm_set1_epi32(e[1]), _mm_load_si128(reinterpret_cast<const __m128i*>(steps.offsets[1])));
+		__m128i e2 = _mm_add_epi32(_mm_set1_epi32(e[2]), _mm_load_si128(reinterpret_cast<const __m128i*>(steps.offsets[2])));
+		__m128i any = _mm_or_si128(_mm_or_si128(e0, e1), e2);
+		return ~static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(any))) & 0xfu;
+#else
+		unsigned mask = 0;
+		for (int lane = 0; lane < TriangleLanes; lane++) {
+			qint32 any = (e[0] + steps.offsets[0][lane]) | (e[1] + steps.offsets[1][lane]) | (e[2] + steps.offsets[2][lane]);
+			mask |= static_cast<unsigned>(any >= 0) << lane;
+		}
+		return mask;
+#endif
+	}
+
+	// Najjemnejsie prichytenie vrcholov (najviac maxShift bitov pod pixel), pri ktorom hranove funkcie trojuholnikov
+	// s obalkou extent (24.8) vojdu do 32-bitovych drah: |E| <= 2 * (obalka v jednotkach prichytenia)^2 < 2^30
+	inline int triangleSubpixelShift(qint64 extent, int maxShift)
+	{
+		qint64 pixels = (extent >> FixedPoint::Shift) + 2 * TriangleLanes + 1;
+		int shift = maxShift;
+		while (shift > 0 && (pixels << shift) > (qint64(1) << 14)) {
+			shift--;
+		}
+		return shift;
+	}
+
+	// Bod 24.8 zaokruhleny na jednotky 2^-shift pixelu
+	inline QPoint snapTriangleVertex(const FixedPoint& point, int shift)
+	{
+		int drop = FixedPoint::Shift - shift;
+		qint32 half = 1 << (drop - 1);
+		return QPoint((point.x + half) >> drop, (point.y + half) >> drop);
+	}
+}
+
+void Rasterizer::setTarget(QImage* target)
+{
+	img = target;
+	tiles = nullptr;
+	data = (img != nullptr) ? img->bits() : nullptr;
+	width = (img != nullptr) ? img->width() : 0;
+	height = (img != nullptr) ? img->height() : 0;
+	bytesPerLine = (img != nullptr) ? img->bytesPerLine() : 0;
+}
+
+void Rasterizer::setTarget(TiledFramebuffer* target)
+{
+	img = nullptr;
+	data = nullptr;
+	tiles = target;
+	width = (tiles != nullptr) ? tiles->width() : 0;
+	height = (tiles != nullptr) ? tiles->height() : 0;
+	bytesPerLine = 0;
+}
+
+void Rasterizer::clear(const QColor& color)
+{
+	if (tiles) {
+		tiles->clear(color.rgba());
+	}
+	else if (img) {
+		img->fill(color);
+	}
+	if (depthTestActive()) {
+		depthBuffer->clear();
+	}
+	if (idWriteActive()) {
+		idBuffer->clear();
+	}
+}
+
+//-----------------------------------------
+//		*** View functions ***
+//-----------------------------------------
+
+void Rasterizer::setView(const QPoint& origin, double zoom)
+{
+	viewOrigin = origin;
+	viewZoom = (zoom > 0) ? zoom : 1.0;
+}
+
+QPoint Rasterizer::mapToTarget(const QPoint& point) const
+{
+	if (viewZoom == 1.0) {
+		return point - viewOrigin;
+	}
+	return QPoint(qRound(point.x() * viewZoom) - viewOrigin.x(), qRound(point.y() * viewZoom) - viewOrigin.y());
+}
+
+FixedPoint Rasterizer::mapToTargetFixed(const QPoint& point) const
+{
+	if (viewZoom == 1.0) {
+		return FixedPoint::fromPoint(point - viewOrigin);
+	}
+	double scale = viewZoom * FixedPoint::One;
+	return FixedPoint(FixedPoint::clamp(qRound64(point.x() * scale) - (static_cast<qint64>(viewOrigin.x()) << FixedPoint::Shift)),
+		FixedPoint::clamp(qRound64(point.y() * scale) - (static_cast<qint64>(viewOrigin.y()) << FixedPoint::Shift)));
+}
+
+QRect Rasterizer::mapToTarget(const QRect& rect) const
+{
+	if (rect.isNull()) {
+		return QRect();
+	}
+	// Pri priblizeni pokryva jeden pixel dokumentu viac pixelov ciela
+	int extent = qMax(0, static_cast<int>(std::ceil(viewZoom)) - 1);
+	return QRect(mapToTarget(rect.topLeft()), mapToTarget(rect.bottomRight()) + QPoint(extent, extent));
+}
+
+QRect Rasterizer::shapeBounds(Shape& shape)
+{
+	return visitShape(shape, [](auto& typed) { return typedBounds(typed); });
+}
+
+template <typename T>
+QRect Rasterizer::typedBounds(const T& shape)
+{
+	const auto& points = shape.getPointArray();
+	if (points.empty()) {
+		return QRect();
+	}
+
+	// Hruby tah presahuje body tvaru (polovica hrubky, hroty spojov, rohy koncov); usecka spoje nema
+	int reach = 0;
+	if (shape.hasThickStroke()) {
+		Qt::PenJoinStyle join = std::is_same_v<T, Line> ? Qt::BevelJoin : shape.getJoinStyle();
+		reach = std::is_same_v<T, Circle> ? (shape.getStrokeWidth() + 1) / 2
+			: static_cast<int>(std::ceil(Stroker::extent(shape.getStrokeWidth(), join, shape.getCapStyle())));
+	}
+
+	if constexpr (std::is_same_v<T, Circle>) {
+		QPoint center = points[0];
+		int r = std::sqrt(std::pow(points[1].x() - center.x(), 2) + std::pow(points[1].y() - center.y(), 2));
+		return QRect(center.x() - r, center.y() - r, 2 * r + 1, 2 * r + 1).adjusted(-reach, -reach, reach, reach);
+	}
+
+	int minX = points[0].x(), maxX = points[0].x();
+	int minY = points[0].y(), maxY = points[0].y();
+	for (const QPoint& point : points) {
+		minX = qMin(minX, point.x());
+		maxX = qMax(maxX, point.x());
+		minY = qMin(minY, point.y());
+		maxY = qMax(maxY, point.y());
+	}
+	return QRect(QPoint(minX, minY), QPoint(maxX, maxY)).adjusted(-reach, -reach, reach, reach);
+}
+
+//-----------------------------------------
+//		*** Point drawing functions ***
+//-----------------------------------------
+
+void Rasterizer::setPixel(int x, int y, uchar r, uchar g, uchar b, uchar a)
+{
+	r = r > 255 ? 255 : (r < 0 ? 0 : r);
+	g = g > 255 ? 255 : (g < 0 ? 0 : g);
+	b = b > 255 ? 255 : (b < 0 ? 0 : b);
+	a = a > 255 ? 255 : (a < 0 ? 0 : a);
+
+	if (!insideScissor(x, y)) {
+		return;
+	}
+	if (depthTestActive() && !depthBuffer->testAndSet(x, y, currentDepth)) {
+		return;
+	}
+	PROFILE_COUNT(FrameProfiler::PixelsWritten, 1);
+	if (idWriteActive()) {
+		idBuffer->set(x, y, currentShapeId);
+	}
+
+	if (tiles) {
+		tiles->setPixel(x, y, qRgba(r, g, b, a));
+		return;
+	}
+
+	size_t startbyte = y * bytesPerLine + x * 4;
+	data[startbyte] = b;
+	data[startbyte + 1] = g;
+	data[startbyte + 2] = r;
+	data[startbyte + 3] = a;
+}
+void Rasterizer::setPixel(int x, int y, double valR, double valG, double valB, double valA)
+{
+	valR = valR > 1 ? 1 : (valR < 0 ? 0 : valR);
+	valG = valG > 1 ? 1 : (valG < 0 ? 0 : valG);
+	valB = valB > 1 ? 1 : (valB < 0 ? 0 : valB);
+	valA = valA > 1 ? 1 : (valA < 0 ? 0 : valA);
+
+	if (!insideScissor(x, y)) {
+		return;
+	}
+	if (depthTestActive() && !depthBuffer->testAndSet(x, y, currentDepth)) {
+		return;
+	}
+	PROFILE_COUNT(FrameProfiler::PixelsWritten, 1);
+	if (idWriteActive()) {
+		idBuffer->set(x, y, currentShapeId);
+	}
+
+	if (tiles) {
+		tiles->setPixel(x, y, qRgba(static_cast<int>(255 * valR), static_cast<int>(255 * valG), static_cast<int>(255 * valB), static_cast<int>(255 * valA)));
+		return;
+	}
+
+	size_t startbyte = y * bytesPerLine + x * 4;
+	data[startbyte] = static_cast<uchar>(255 * valB);
+	data[startbyte + 1] = static_cast<uchar>(255 * valG);
+	data[startbyte + 2] = static_cast<uchar>(255 * valR);
+	data[startbyte + 3] = static_cast<uchar>(255 * valA);
+}
+void Rasterizer::setPixel(int x, int y, const QColor& color)
+{
+	if (!color.isValid() || x < 0 || y < 0 || x >= width || y >= height) {
+		return;
+	}
+	if (!insideScissor(x, y)) {
+		return;
+	}
+	if (depthTestActive() && !depthBuffer->testAndSet(x, y, currentDepth)) {
+		return;
+	}
+	PROFILE_COUNT(FrameProfiler::PixelsWritten, 1);
+	if (idWriteActive()) {
+		idBuffer->set(x, y, currentShapeId);
+	}
+
+	if (tiles) {
+		tiles->setPixel(x, y, color.rgba());
+		return;
+	}
+
+	size_t startbyte = y * bytesPerLine + x * 4;
+
+	data[startbyte] = color.blue();
+	data[startbyte + 1] = color.green();
+	data[startbyte + 2] = color.red();
+	data[startbyte + 3] = color.alpha();
+}
+
+// Vodorovny usek x0..x1 (vratane) jednou farbou, orezany na platno
+void Rasterizer::drawSpan(int y, int x0, int x1, const QColor& color)
+{
+	if (!color.isValid() || y < 0 || y >= height) {
+		return;
+	}
+	x0 = qMax(x0, 0);
+	x1 = qMin(x1, width - 1);
+	if (scissorActive) {
+		if (y < scissor.top() || y > scissor.bottom()) {
+			return;
+		}
+		x0 = qMax(x0, scissor.left());
+		x1 = qMin(x1, scissor.right());
+	}
+	if (x0 > x1) {
+		return;
+	}
+
+	QRgb value = color.rgba();
+	if (depthTestActive()) {
+		// Zapisuju sa (a pocitaju) len behy pixelov, ktore presli hlbkovym testom
+		depthBuffer->testSpan(y, x0, x1, currentDepth, [this, y, value](int start, int end) {
+			PROFILE_COUNT(FrameProfiler::PixelsWritten, end - start + 1);
+			if (idWriteActive()) {
+				idBuffer->fillSpan(y, start, end, currentShapeId);
+			}
+			if (tiles) {
+				tiles->fillSpan(y, start, end, value);
+			}
+			else {
+				QRgb* row = reinterpret_cast<QRgb*>(data + y * bytesPerLine);
+				std::fill(row + start, row + end + 1, value);
+			}
+			});
+		return;
+	}
+
+	PROFILE_COUNT(FrameProfiler::PixelsWritten, x1 - x0 + 1);
+	if (idWriteActive()) {
+		idBuffer->fillSpan(y, x0, x1, currentShapeId);
+	}
+	if (tiles) {
+		tiles->fillSpan(y, x0, x1, value);
+		return;
+	}
+
+	QRgb* row = reinterpret_cast<QRgb*>(data + y * bytesPerLine);
+	std::fill(row + x0, row + x1 + 1, value);
+}
+
+// Vodorovny usek x0..x1 s farbami zo shadera: orezany usek sa vyhodnoti naraz, zapis ako v drawSpan.
+// Bod shadera = (pixel - anchor) / zoom, geometria shadera je v pixeloch dokumentu.
+void Rasterizer::drawShadedSpan(int y, int x0, int x1, const FillShader& shader, const QPoint& anchor)
+{
+	if (y < 0 || y >= height) {
+		return;
+	}
+	x0 = qMax(x0, 0);
+	x1 = qMin(x1, width - 1);
+	if (scissorActive) {
+		if (y < scissor.top() || y > scissor.bottom()) {
+			return;
+		}
+		x0 = qMax(x0, scissor.left());
+		x1 = qMin(x1, scissor.right());
+	}
+	if (x0 > x1) {
+		return;
+	}
+
+	size_t count = static_cast<size_t>(x1 - x0 + 1);
+	if (shadedSpan.size() < count) {
+		shadedSpan.resize(count);
+	}
+	shader.shadeSpan(y, x0, static_cast<int>(count), viewZoom, -anchor, shadedSpan.data());
+
+	auto write = [this, y, x0](int start, int end) {
+		PROFILE_COUNT(FrameProfiler::PixelsWritten, end - start + 1);
+		const QRgb* colors = shadedSpan.data() + (start - x0);
+		if (idWriteActive()) {
+			idBuffer->fillSpan(y, start, end, currentShapeId);
+		}
+		if (tiles) {
+			tiles->writeSpan(y, start, end, colors);
+		}
+		else {
+			QRgb* row = reinterpret_cast<QRgb*>(data + y * bytesPerLine);
+			std::copy(colors, colors + (end - start + 1), row + start);
+		}
+	};
+	if (depthTestActive()) {
+		depthBuffer->testSpan(y, x0, x1, currentDepth, write);
+		return;
+	}
+	write(x0, x1);
+}
+
+// Ciastocne pokryty pixel: linearny prechod od povodnej farby k farbe tvaru (aj alfa), pri 255 ju prepise
+void Rasterizer::blendPixel(int x, int y, QRgb color, int coverage)
+{
+	if (coverage <= 0 || x < 0 || y < 0 || x >= width || y >= height || !insideScissor(x, y)) {
+		return;
+	}
+	if (depthTestActive() && !depthBuffer->testAndSet(x, y, currentDepth)) {
+		return;
+	}
+	PROFILE_COUNT(FrameProfiler::PixelsWritten, 1);
+	// Pixel patri tvaru v ID rovine, ak ho pokryva aspon z polovice
+	if (idWriteActive() && coverage >= 128) {
+		idBuffer->set(x, y, currentShapeId);
+	}
+
+	QRgb* target = tiles ? nullptr : reinterpret_cast<QRgb*>(data + y * bytesPerLine) + x;
+	QRgb destination = tiles ? tiles->pixel(x, y) : *target;
+	auto mix = [coverage](int from, int to) { return from + ((to - from) * coverage + 127) / 255; };
+	QRgb blended = qRgba(mix(qRed(destination), qRed(color)), mix(qGreen(destination), qGreen(color)),
+		mix(qBlue(destination), qBlue(color)), mix(qAlpha(destination), qAlpha(color)));
+
+	if (tiles) {
+		tiles->setPixel(x, y, blended);
+	}
+	else {
+		*target = blended;
+	}
+}
+
+//-----------------------------------------
+//		*** Drawing functions ***
+//-----------------------------------------
+// Spolocna cesta pre konkretny typ tvaru (bez virtualnych volani): orezanie obalkou a pri posunutom/zoomovanom
+// pohlade docasna kopia s bodmi v pixeloch ciela, aby sa suradnice dokumentu v povodnom tvare nemenili
+template <typename T>
+void Rasterizer::drawTypedShape(T& shape) {
+	// Tvary, ktorych obalka po transformacii pohladu nezasahuje do ciela, vobec nerasterizujeme
+	QRect targetBounds = mapToTarget(shapeBounds(shape));
+	if (!isVisible(targetBounds.adjusted(-1, -1, 1, 1))) {
+		culledShapes++;
+		return;
+	}
+	drawVisibleShape(shape, targetBounds);
+}
+
+template <typename T>
+void Rasterizer::drawVisibleShape(T& shape, const QRect& targetBounds) {
+	PROFILE_SCOPE(FrameProfiler::DrawShape);
+	PROFILE_COUNT(FrameProfiler::ShapesDrawn, 1);
+
+	if (hasIdentityView()) {
+		drawShapeInTarget(shape);
+		return;
+	}
+
+	// Vyplne a krivky dostanu vrcholy aj bez zaokruhlenia na pixely ciela (subpixelPoints)
+	QVector<QPoint> points = shape.getPoints();
+	QVector<FixedPoint> subpixel;
+	constexpr bool subpixelShape = !std::is_same_v<T, Line> && !std::is_same_v<T, Circle>;
+	if constexpr (subpixelShape) {
+		subpixel.reserve(points.size());
+	}
+	for (QPoint& point : points) {
+		if constexpr (subpixelShape) {
+			subpixel.append(mapToTargetFixed(point));
+		}
+		point = mapToTarget(point);
+	}
+
+	// Trianguluje sa v suradniciach dokumentu, indexy platia aj pre body kopie a ostanu v povodnom tvare
+	if constexpr (std::is_same_v<T, MyPolygon>) {
+		if (shape.getIsFilled() && useTriangleFill(points.size(), targetBounds)) {
+			polygonTriangles(shape);
+		}
+	}
+
+	T copy(shape);
+	copy.setPoints(points);
+	// Obrys tahu ostava v suradniciach dokumentu (mapuje sa az pri vyplni), kopia ho prevezme od povodneho tvaru
+	if (shape.hasThickStroke()) {
+		copy.setStrokeOutline(strokeOutline(shape));
+	}
+	if constexpr (std::is_same_v<T, MyPolygon>) {
+		if (shape.hasTriangles()) {
+			copy.setTriangles(shape.getTriangles());
+		}
+	}
+	subpixelPoints = subpixelShape ? &subpixel : nullptr;
+	drawShapeInTarget(copy);
+	subpixelPoints = nullptr;
+}
+
+template <typename T>
+void Rasterizer::drawShapeInTarget(T& shape) {
+	if constexpr (std::is_same_v<T, Line>) {
+		drawLine(shape);
+	}
+	else if constexpr (std::is_same_v<T, MyRectangle>) {
+		drawRectangle(shape);
+	}
+	else if constexpr (std::is_same_v<T, MyPolygon>) {
+		drawPolygon(shape);
+	}
+	else if constexpr (std::is_same_v<T, Circle>) {
+		drawCircle(shape);
+	}
+	else {
+		drawCurve(shape);
+	}
+	// Shader patri tvaru (pri pohlade jeho docasnej kopii), dalsie vyplne uz idu farbou
+	fillShader = nullptr;
+}
+
+void Rasterizer::drawShape(Shape& shape) {
+	visitShape(shape, [this](auto& typed) { drawTypedShape(typed); });
+}
+
+void Rasterizer::drawShape(ShapeVariant& shape) {
+	std::visit([this](auto& typed) { drawTypedShape(typed); }, shape);
+}
+
+//-----------------------------------------
+//		*** Draw list batching ***
+//-----------------------------------------
+// Zoznam tvarov v poradi vrstiev sa deli na behy po sebe iducich malych tvarov s rovnakym jadrom (tenke usecky,
+// tenke kruznice/kruhy), ktorych obalky v cieli sa neprekryvaju. Taky beh moze jadro kreslit v lubovolnom poradi
+// bez zmeny vysledku; odpadne pri nom kopia tvaru pre pohlad, docasne vektory bodov a vetvenie podla typu.
+// Ostatne tvary (a velke tvary) beh ukoncia a kreslia sa samostatne ako v drawShape.
+// Typ sa rozhodne raz na tvar, batchShape a jadra uz pracuju s konkretnou triedou a jej bodmi bez kopie.
+void Rasterizer::drawShapes(Shape* const* shapes, size_t count, quint32 firstId) {
+	for (size_t i = 0; i < count; i++) {
+		quint32 id = firstId != 0 ? firstId + static_cast<quint32>(i) : 0;
+		visitShape(*shapes[i], [this, id](auto& typed) { batchShape(typed, id); });
+	}
+	flushBatch();
+}
+
+void Rasterizer::drawShapes(std::vector<ShapeVariant>& shapes, quint32 firstId) {
+	for (size_t i = 0; i < shapes.size(); i++) {
+		quint32 id = firstId != 0 ? firstId + static_cast<quint32>(i) : 0;
+		std::visit([this, id](auto& typed) { batchShape(typed, id); }, shapes[i]);
+	}
+	flushBatch();
+}
+
+void Rasterizer::drawShapes(const CompactScene& scene, quint32 firstId) {
+	for (size_t first = 0; first < scene.size(); first += CompactChunk) {
+		compactChunk.clear();
+		scene.decode(first, CompactChunk, compactChunk);
+		drawShapes(compactChunk, firstId != 0 ? firstId + static_cast<quint32>(first) : 0);
+	}
+	compactChunk.clear();
+}
+
+// Oznaci bunky mriezky pod obalkou znackou aktualneho behu; false ak niektoru uz beh obsadil
+// (obalky sa mozno prekryvaju) alebo je tvar na davku privelky
+bool Rasterizer::reserveBatchCells(const QRect& targetBounds) {
+	QRect area = targetBounds & QRect(0, 0, width, height);
+	if (area.isEmpty()) {
+		return true;
+	}
+	int left = area.left() >> BatchCellShift, right = area.right() >> BatchCellShift;
+	int top = area.top() >> BatchCellShift, bottom = area.bottom() >> BatchCellShift;
+	if ((right - left + 1) * (bottom - top + 1) > BatchMaxCells) {
+		return false;
+	}
+	for (int row = top; row <= bottom; row++) {
+		for (int column = left; column <= right; column++) {
+			if (batchCells[static_cast<size_t>(row) * batchColumns + column] == batchStamp) {
+				return false;
+			}
+		}
+	}
+	for (int row = top; row <= bottom; row++) {
+		std::fill_n(batchCells.begin() + static_cast<size_t>(row) * batchColumns + left, right - left + 1, batchStamp);
+	}
+	return true;
+}
+
+template <typename T>
+void Rasterizer::batchShape(T& shape, quint32 id) {
+	QRect targetBounds = mapToTarget(typedBounds(shape));
+	if (!isVisible(targetBounds.adjusted(-1, -1, 1, 1))) {
+		culledShapes++;
+		return;
+	}
+	BatchItem item = { &shape, id != 0 ? id : currentDepth, id != 0 ? id : currentShapeId };
+
+	// Polomer kruznice sa pocita az z bodov v cieli, pri zoome moze obalku prekrocit o zaokruhlenie
+	int slack = 1 + static_cast<int>(std::ceil(viewZoom));
+	QRect reserved = targetBounds.adjusted(-slack, -slack, slack, slack);
+
+	// Jadro podla typu: tenke usecky a tenke kruznice
+	constexpr BatchKernel typeKernel = std::is_same_v<T, Line> ? LineKernel : (std::is_same_v<T, Circle> ? CircleKernel : NoKernel);
+	BatchKernel kernel = shape.hasThickStroke() ? NoKernel : typeKernel;
+	if (kernel != NoKernel) {
+		int columns = (width + (1 << BatchCellShift) - 1) >> BatchCellShift;
+		int rows = (height + (1 << BatchCellShift) - 1) >> BatchCellShift;
+		if (columns != batchColumns || rows != batchRows) {
+			flushBatch();
+			batchColumns = columns;
+			batchRows = rows;
+			batchCells.assign(static_cast<size_t>(columns) * rows, 0);
+			batchStamp = 0;
+		}
+		if (kernel == batchKernel && batch.size() < BatchMaxShapes && reserveBatchCells(reserved)) {
+			batch.push_back(item);
+			return;
+		}
+		flushBatch();
+		if (++batchStamp == 0) {
+			std::fill(batchCells.begin(), batchCells.end(), 0);
+			batchStamp = 1;
+		}
+		if (reserveBatchCells(reserved)) {
+			batchKernel = kernel;
+			batch.push_back(item);
+			return;
+		}
+	}
+
+	flushBatch();
+	currentDepth = item.depth;
+	currentShapeId = item.id;
+	drawVisibleShape(shape, targetBounds);
+}
+
+void Rasterizer::flushBatch() {
+	if (batch.empty()) {
+		return;
+	}
+	PROFILE_SCOPE(FrameProfiler::DrawShape);
+	PROFILE_COUNT(FrameProfiler::ShapesDrawn, static_cast<int>(batch.size()));
+	RENDER_LOG(Raster, Trace, "batch of {} shapes (kernel {})", batch.size(), static_cast<int>(batchKernel));
+	if (batchKernel == LineKernel) {
+		drawLineBatch();
+	}
+	else {
+		drawCircleBatch();
+	}
+	batch.clear();
+	batchKernel = NoKernel;
+	if (++batchStamp == 0) {
+		std::fill(batchCells.begin(), batchCells.end(), 0);
+		batchStamp = 1;
+	}
+}
+
+// Tenke usecky: konce priamo v cieli (bez kopie tvaru a docasnych QVector), rovnake pixely ako drawLine.
+// Kratke usecky cele vnutri ciela QImage (a scissoru) sa krokuju spolu v SIMD drahach, kazda s farbou, hlbkou
+// a ID svojho tvaru; ostatne idu po jednej cez drawPolyline.
+void Rasterizer::drawLineBatch() {
+	PROFILE_SCOPE(FrameProfiler::DrawLineBresenham);
+	QRect clip = scissorActive ? scissor : QRect(0, 0, width, height);
+	batchSegments.clear();
+
+	for (int i = 0; i < static_cast<int>(batch.size()); i++) {
+		const BatchItem& item = batch[i];
+		const Line& line = static_cast<const Line&>(*item.shape);
+		const std::array<QPoint, 2>& points = line.getPointArray();
+		QPoint ends[2] = { mapToTarget(points[0]), mapToTarget(points[1]) };
+		borderColor = line.getBorderColor();
+		if (!borderColor.isValid()) {
+			continue;
+		}
+
+		int steps = bresenhamSteps(ends[0], ends[1]);
+		if (data != nullptr && steps <= LaneMaxSteps && clip.contains(ends[0]) && clip.contains(ends[1])) {
+			// S hlbkou alebo ID rovinou pocita pixely zapisovac nizsie (len tie, ktore prejdu hlbkovym testom)
+			PROFILE_COUNT(FrameProfiler::PixelsWritten, depthTestActive() || idWriteActive() ? 0 : steps + 1);
+			batchSegments.push(ends[0], ends[1], i);
+			continue;
+		}
+		currentDepth = item.depth;
+		currentShapeId = item.id;
+		drawPolyline(ends, 2, false);
+	}
+	if (batchSegments.sources.empty()) {
+		return;
+	}
+
+	batchColors.resize(batch.size());
+	for (int source : batchSegments.sources) {
+		batchColors[source] = batch[source].shape->getBorderRgba();
+	}
+	const int* sources = batchSegments.sources.data();
+	const QPoint* starts = batchSegments.starts.data();
+	const QPoint* ends = batchSegments.ends.data();
+	int count = static_cast<int>(batchSegments.sources.size());
+	DepthBuffer* depth = depthTestActive() ? depthBuffer : nullptr;
+	IdBuffer* ids = idWriteActive() ? idBuffer : nullptr;
+	if (!depth && !ids) {
+		bresenhamLanes(starts, ends, count, true, [this, sources](int i, int x, int y) {
+			reinterpret_cast<QRgb*>(data + y * bytesPerLine)[x] = batchColors[sources[i]];
+			});
+		return;
+	}
+	bresenhamLanes(starts, ends, count, true, [this, sources, depth, ids](int i, int x, int y) {
+		const BatchItem& item = batch[sources[i]];
+		if (depth && !depth->testAndSet(x, y, item.depth)) {
+			return;
+		}
+		PROFILE_COUNT(FrameProfiler::PixelsWritten, 1);
+		if (ids) {
+			ids->set(x, y, item.id);
+		}
+		reinterpret_cast<QRgb*>(data + y * bytesPerLine)[x] = batchColors[sources[i]];
+		});
+}
+
+// Tenke kruznice a kruhy. Vypln kruhu prekryje vsetky body obrysu (lezia na koncoch jej usekov), takze sa pri
+// platnej vyplni obrys vynecha a kazdy riadok sa vyplni raz najsirsim usekom zo stredoveho algoritmu.
+void Rasterizer::drawCircleBatch() {
+	QRect clip = scissorActive ? scissor : QRect(0, 0, width, height);
+	bool direct = data != nullptr && !depthTestActive() && !idWriteActive();
+
+	for (const BatchItem& item : batch) {
+		const Circle& circle = static_cast<const Circle&>(*item.shape);
+		const std::array<QPoint, 2>& points = circle.getPointArray();
+		QPoint center = mapToTarget(points[0]);
+		QPoint radiusPoint = mapToTarget(points[1]);
+		int r = std::sqrt(std::pow(radiusPoint.x() - center.x(), 2) + std::pow(radiusPoint.y() - center.y(), 2));
+		borderColor = circle.getBorderColor();
+		fillingColor = circle.getFillingColor();
+		setFillShader(circle.getFillShader().get(), center);
+		currentDepth = item.depth;
+		currentShapeId = item.id;
+
+		int x = 0;
+		int y = r;
+		int p = 1 - r;
+
+		if (circle.getIsFilled() && (fillShader || fillingColor.isValid())) {
+			circleRows.assign(r + 1, 0);
+			circleRows[0] = r;
+			while (x < y) {
+				x++;
+				if (p < 0) {
+					p += 2 * x + 1;
+				}
+				else {
+					y--;
+					p += 2 * (x - y) + 1;
+				}
+				circleRows[y] = qMax(circleRows[y], x);
+				circleRows[x] = qMax(circleRows[x], y);
+			}
+			for (int row = r; row > 0; row--) {
+				fillSpan(center.y() - row, center.x() - circleRows[row], center.x() + circleRows[row]);
+			}
+			for (int row = 0; row <= r; row++) {
+				fillSpan(center.y() + row, center.x() - circleRows[row], center.x() + circleRows[row]);
+			}
+			fillShader = nullptr;
+			continue;
+		}
+		fillShader = nullptr;
+
+		// Ostava obrys (vypln s neplatnou farbou nic nezapise)
+		if (!borderColor.isValid()) {
+			continue;
+		}
+		QRect bounds(center.x() - r, center.y() - r, 2 * r + 1, 2 * r + 1);
+		if (!direct || !clip.contains(bounds)) {
+			// Cez setPixel: orezanie, hlbka, ID, dlazdice
+			drawSymmetricPoints(center, x, y);
+			while (x < y) {
+				x++;
+				if (p < 0) {
+					p += 2 * x + 1;
+				}
+				else {
+					y--;
+					p += 2 * (x - y) + 1;
+				}
+				drawSymmetricPoints(center, x, y);
+			}
+			continue;
+		}
+
+		QRgb value = borderColor.rgba();
+		auto plot = [this, value](int px, int py) { reinterpret_cast<QRgb*>(data + py * bytesPerLine)[px] = value; };
+		auto plotSymmetric = [&]() {
+			plot(center.x() + x, center.y() + y);
+			plot(center.x() + y, center.y() + x);
+			plot(center.x() - x, center.y() + y);
+			plot(center.x() - y, center.y() + x);
+			plot(center.x() - x, center.y() - y);
+			plot(center.x() - y, center.y() - x);
+			plot(center.x() + x, center.y() - y);
+			plot(center.x() + y, center.y() - x);
+		};
+		plotSymmetric();
+		while (x < y) {
+			x++;
+			if (p < 0) {
+				p += 2 * x + 1;
+			}
+			else {
+				y--;
+				p += 2 * (x - y) + 1;
+			}
+			plotSymmetric();
+		}
+		PROFILE_COUNT(FrameProfiler::PixelsWritten, 8 * (x + 1));
+	}
+}
+
+//-----------------------------------------
+//		*** Line functions ***
+//-----------------------------------------
+void Rasterizer::drawLine(Line& line)
+{
+	borderColor = line.getBorderColor();
+	if (line.hasThickStroke()) {
+		drawStroke(line);
+		return;
+	}
+	const std::array<QPoint, 2>& points = line.getPointArray();
+	QPoint ends[2] = { points[0], points[1] };
+	RENDER_LOG(Raster, Trace, "line {} -> {}", ends[0], ends[1]);
+	drawPolyline(ends, 2, false);
+}
+
+void Rasterizer::drawLineBresenham(QVector<QPoint>& linePoints) {
+	PROFILE_SCOPE(FrameProfiler::DrawLineBresenham);
+	bresenhamLine(linePoints.first(), linePoints.last(), [this](int x, int y) { setPixel(x, y, borderColor); });
+}
+
+// Zapis pixelu, ktory uz lezi v orezanom cieli (ciel a scissor): hlbka, ID a farba bez kontrol hranic.
+// draw(plot) dostane zapisovac pre aktualnu hlbku a ID
+template <typename Draw>
+void Rasterizer::withClippedWriter(QRgb value, Draw&& draw) {
+	DepthBuffer* depth = depthTestActive() ? depthBuffer : nullptr;
+	IdBuffer* ids = idWriteActive() ? idBuffer : nullptr;
+	if (!tiles && !depth && !ids) {
+		draw([this, value](int x, int y) {
+			PROFILE_COUNT(FrameProfiler::PixelsWritten, 1);
+			reinterpret_cast<QRgb*>(data + y * bytesPerLine)[x] = value;
+			});
+		return;
+	}
+	draw([this, value, depth, ids](int x, int y) {
+		if (depth && !depth->testAndSet(x, y, currentDepth)) {
+			return;
+		}
+		PROFILE_COUNT(FrameProfiler::PixelsWritten, 1);
+		if (ids) {
+			ids->set(x, y, currentShapeId);
+		}
+		if (tiles) {
+			tiles->setPixel(x, y, value);
+		}
+		else {
+			reinterpret_cast<QRgb*>(data + y * bytesPerLine)[x] = value;
+		}
+		});
+}
+
+// Useky a[i] -> b[i] orezane na ciel a scissor. Useky mimo neho sa nekrokuju, kratke useky cele vnutri idu do
+// SIMD drah, ostatne skalarne len v krokoch vnutri orezu. ends = false vynecha koncove body.
+template <typename Plot>
+void Rasterizer::rasterizeSegments(const QPoint* a, const QPoint* b, int count, bool ends, Plot&& plot) {
+	QRect clip = scissorActive ? scissor : QRect(0, 0, width, height);
+	if (clip.isEmpty()) {
+		return;
+	}
+	laneSegments.clear();
+	for (int i = 0; i < count; i++) {
+		const QPoint& from = a[i];
+		const QPoint& to = b[i];
+		if (qMax(from.x(), to.x()) < clip.left() || qMin(from.x(), to.x()) > clip.right()
+			|| qMax(from.y(), to.y()) < clip.top() || qMin(from.y(), to.y()) > clip.bottom()) {
+			continue;
+		}
+		int steps = bresenhamSteps(from, to);
+		if (steps <= LaneMaxSteps && clip.contains(from) && clip.contains(to)) {
+			laneSegments.push(from, to, i);
+		}
+		else {
+			bresenhamClipped(from, to, clip, ends ? steps : steps - 1, plot);
+		}
+	}
+	bresenhamLanes(laneSegments.starts.data(), laneSegments.ends.data(), static_cast<int>(laneSegments.sources.size()), ends,
+		[&plot](int, int x, int y) { plot(x, y); });
+}
+
+// Useky jedneho tvaru (rovnaka farba, hlbka a ID), takze na poradi pixelov nezalezi
+void Rasterizer::drawSegments(const QPoint* a, const QPoint* b, int count) {
+	PROFILE_SCOPE(FrameProfiler::DrawLineBresenham);
+	if (!borderColor.isValid() || count <= 0) {
+		return;
+	}
+	withClippedWriter(borderColor.rgba(), [&](auto&& plot) { rasterizeSegments(a, b, count, true, plot); });
+}
+
+// Lomena ciara cez susedne vrcholy (closed = aj posledny -> prvy). Kazdy usek kresli svoj zaciatok bez konca,
+// spolocny vrchol susednych usekov sa tak zapise raz; koniec otvorenej ciary sa dokresli osobitne.
+void Rasterizer::drawPolyline(const QPoint* points, int count, bool closed) {
+	PROFILE_SCOPE(FrameProfiler::DrawLineBresenham);
+	if (!borderColor.isValid() || count <= 0) {
+		return;
+	}
+	QRect clip = scissorActive ? scissor : QRect(0, 0, width, height);
+	withClippedWriter(borderColor.rgba(), [&](auto&& plot) {
+		const QPoint& last = points[count - 1];
+		bool degenerate = std::all_of(points + 1, points + count, [points](const QPoint& point) { return point == points[0]; });
+		if (degenerate) {
+			if (clip.contains(last)) {
+				plot(last.x(), last.y());
+			}
+			return;
+		}
+		rasterizeSegments(points, points + 1, count - 1, false, plot);
+		if (closed) {
+			rasterizeSegments(&last, points, 1, false, plot);
+		}
+		else if (clip.contains(last)) {
+			plot(last.x(), last.y());
+		}
+		});
+}
+
+//-----------------------------------------
+//		*** Circle functions ***
+//-----------------------------------------
+void Rasterizer::drawCircle(Circle& circle) {
+	borderColor = circle.getBorderColor();
+	fillingColor = circle.getFillingColor();
+	QPoint center = circle.getPointArray()[0];
+	setFillShader(circle.getFillShader().get(), center);
+	QPoint radiusPoint = circle.getPointArray()[1];
+	int r = std::sqrt(std::pow(radiusPoint.x() - center.x(), 2) + std::pow(radiusPoint.y() - center.y(), 2));
+	int x = 0;
+	int y = r;
+	int p = 1 - r;
+
+	// Hruby obrys sa kresli az po vyplni, kruznica Bresenhamom len pre tenky
+	if (circle.hasThickStroke()) {
+		if (circle.getIsFilled()) {
+			drawSymmetricPointsFilled(center, x, y);
+			while (x < y) {
+				x++;
+				if (p < 0) {
+					p += 2 * x + 1;
+				}
+				else {
+					y--;
+					p += 2 * (x - y) + 1;
+				}
+				drawSymmetricPointsFilled(center, x, y);
+			}
+		}
+		drawStroke(circle);
+		return;
+	}
+
+	if (circle.getIsFilled()) {
+		drawSymmetricPoints(center, x, y);
+		drawSymmetricPointsFilled(center, x, y);
+	}
+	else {
+		drawSymmetricPoints(center, x, y);
+	}
+
+	while (x < y) {
+		x++;
+		if (p < 0) {
+			p += 2 * x + 1;
+		}
+		else {
+			y--;
+			p += 2 * (x - y) + 1;
+		}
+
+		if (circle.getIsFilled()) {
+			drawSymmetricPoints(center, x, y);
+			drawSymmetricPointsFilled(center, x, y);
+		}
+		else {
+			drawSymmetricPoints(center, x, y);
+		}
+	}
+}
+
+void Rasterizer::drawSymmetricPoints(const QPoint& center, int x, int y) {
+	QPoint points[8] = {
+		QPoint(x, y),
+		QPoint(y, x),
+		QPoint(-x, y),
+		QPoint(-y, x),
+		QPoint(-x, -y),
+		QPoint(-y, -x),
+		QPoint(x, -y),
+		QPoint(y, -x)
+	};
+
+	for (auto& point : points) {
+		setPixel(center.x() + point.x(), center.y() + point.y(), borderColor);
+	}
+}
+
+void Rasterizer::drawSymmetricPointsFilled(const QPoint& center, int x, int y) {
+	fillSpan(center.y() + y, center.x() - x, center.x() + x);
+	fillSpan(center.y() - y, center.x() - x, center.x() + x);
+	fillSpan(center.y() + x, center.x() - y, center.x() + y);
+	fillSpan(center.y() - x, center.x() - y, center.x() + y);
+}
+
+//-----------------------------------------
+//		*** Polygon Functions ***
+//-----------------------------------------
+void Rasterizer::drawPolygon(MyPolygon& polygon) {
+	borderColor = polygon.getBorderColor();
+	fillingColor = polygon.getFillingColor();
+	const QVector<QPoint>& pointsVector = polygon.getPointArray();
+
+	if (pointsVector.size() < 2) {
+		return;
+	}
+	setFillShader(polygon.getFillShader().get(), pointsVector.first());
+
+	// Vsetky vrcholy mimo ciela este neznamenaju, ze je polygon neviditelny (moze ciel prekryvat),
+	// preto rozhoduje obalka
+	QRect bounds = shapeBounds(polygon);
+	if (!isVisible(bounds)) {
+		RENDER_LOG(Clip, Debug, "polygon with {} points culled (outside target)", pointsVector.size());
+		return;
+	}
+
+	// Vypln ide z vrcholov s presnostou FixedPoint, obrys po celych pixeloch.
+	// Pokrytie ani trojuholniky netreba orezavat, orezu sa na ciel same; netriangulovatelny polygon ide scanline
+	if (polygon.getIsFilled()) {
+		QVector<FixedPoint> vertices = targetVertices(pointsVector);
+		bool filled = false;
+		if (antialiasing || polygon.getFillRule() == Qt::WindingFill) {
+			fillPolygonCoverage(vertices, polygon.getFillRule(), antialiasing);
+			filled = true;
+		}
+		else if (useTriangleFill(pointsVector.size(), bounds)) {
+			const QVector<int>& triangles = polygonTriangles(polygon);
+			if (!triangles.isEmpty()) {
+				fillTriangles(vertices, triangles);
+				filled = true;
+			}
+		}
+
+		if (!filled) {
+			for (const FixedPoint& vertex : vertices) {
+				if (!isInside(vertex.toPoint())) {
+					vertices = trimPolygon(vertices);
+					break;
+				}
+			}
+			fillPolygon(vertices);
+		}
+	}
+
+	if (polygon.hasThickStroke()) {
+		drawStroke(polygon);
+		return;
+	}
+
+	// Obrys z povodnych vrcholov: usecky sa orezu samy, orezany polygon by pridal hrany po okraji ciela
+	drawPolyline(pointsVector.constData(), pointsVector.size(), true);
+}
+
+QVector<QPoint> Rasterizer::trimPolygon(Shape& polygon) {
+	return trimPolygon(polygon.getPoints());
+}
+
+QVector<QPoint> Rasterizer::trimPolygon(const QVector<QPoint>& pointsVector) {
+	QVector<QPoint> polygonPoints;
+	for (const FixedPoint& point : trimPolygon(FixedPoint::fromPoints(pointsVector))) {
+		polygonPoints.append(point.toPoint());
+	}
+	return polygonPoints;
+}
+
+QVector<FixedPoint> Rasterizer::trimPolygon(const QVector<FixedPoint>& pointsVector) {
+	PROFILE_SCOPE(FrameProfiler::TrimPolygon);
+	if (pointsVector.isEmpty()) {
+		RENDER_LOG(Clip, Debug, "trimPolygon: empty point list");
+		return QVector<FixedPoint>();
+	}
+
+	QVector<FixedPoint> W, polygonPoints = pointsVector;
+	FixedPoint S;
+
+	// Orez o pixel za ciel (-1..width x -1..height): pixely na okrajoch ciela tak ostanu vyplnene a zdvojene hrany
+	// po okraji orezu (nekonvexny polygon) padnu mimo ciela
+	const qint64 one = FixedPoint::One;
+	qint64 xMin[] = { -one, -one, -width * one, -height * one };
+
+	// Priesecnik hrany s hranicou zaokruhleny na 1/256 pixelu; hrana sa pocita vzdy od lavejsieho bodu,
+	// takze spolocna hrana dvoch polygonov sa oreze rovnako v oboch smeroch
+	auto intersection = [](FixedPoint from, FixedPoint to, qint64 boundary) {
+		if (from.x > to.x) {
+			std::swap(from, to);
+		}
+		qint64 y = from.y + FixedPoint::divideRounded((boundary - from.x) * (static_cast<qint64>(to.y) - from.y), static_cast<qint64>(to.x) - from.x);
+		return FixedPoint(static_cast<qint32>(boundary), FixedPoint::clamp(y));
+	};
+
+	for (int i = 0; i < 4; i++) {
+		if (polygonPoints.isEmpty()) {
+			return polygonPoints;
+		}
+
+		S = polygonPoints.last();
+
+		for (const FixedPoint& P : polygonPoints) {
+			if (P.x >= xMin[i]) {
+				if (S.x < xMin[i]) {
+					W.push_back(intersection(S, P, xMin[i]));
+				}
+				W.push_back(P);
+			}
+			else if (S.x >= xMin[i]) {
+				W.push_back(intersection(S, P, xMin[i]));
+			}
+			S = P;
+		}
+		polygonPoints = W;
+		W.clear();
+
+		// Otocenie o 90 stupnov, dalsia hranica je opat lava
+		for (FixedPoint& point : polygonPoints) {
+			point = FixedPoint(point.y, -point.x);
+		}
+	}
+
+	return polygonPoints;
+}
+
+QVector<Rasterizer::Edge> Rasterizer::loadEdges(const QVector<FixedPoint>& points) {
+	QVector<Edge> edges;
+
+	for (int i = 0; i < points.size(); i++) {
+		Edge edge(points[i], points[(i + 1) % points.size()]);
+		// Hrana, ktora nepretina stred ziadneho riadku (aj vodorovna), by v zozname aktivnych hran ostala navzdy
+		if (!edge.crossesRows()) {
+			continue;
+		}
+		edges.push_back(edge);
+	}
+
+	std::sort(edges.begin(), edges.end(), compareByY);
+	return edges;
+}
+
+void Rasterizer::fillPolygon(Shape& polygon) {
+	fillPolygon(polygon.getPoints());
+}
+
+void Rasterizer::fillPolygon(const QVector<QPoint>& points) {
+	fillPolygon(FixedPoint::fromPoints(points));
+}
+
+void Rasterizer::fillPolygon(const QVector<FixedPoint>& points) {
+	PROFILE_SCOPE(FrameProfiler::FillPolygon);
+	if (points.isEmpty()) {
+		//qDebug() << "Neobsahuje body pre vyplnanie.";
+		return;
+	}
+	QVector<Edge> edges = loadEdges(points);
+	if (edges.isEmpty()) {
+		//qDebug() << "Vektor hran je prazdny.";
+		return;
+	}
+
+	int yMin = edges.front().firstRow();
+	int yMax = edges.front().lastRow();
+	for (const Edge& edge : edges) {
+		yMax = qMax(yMax, edge.lastRow());
+	}
+
+	QVector<QVector<Edge>> TH(yMax - yMin + 1);
+	for (const auto& edge : edges) {
+		TH[edge.firstRow() - yMin].append(edge);
+	}
+
+	QVector<Edge> activeEdgeList;
+
+	for (int y = yMin; y <= yMax; y++) {
+		for (const auto& edge : TH[y - yMin]) {
+			activeEdgeList.append(edge);
+		}
+
+		std::sort(activeEdgeList.begin(), activeEdgeList.end(), [](const Edge& a, const Edge& b) {
+			return a.ceilX() < b.ceilX();
+			});
+
+		// Useky medzi parmi hran: pixel patri useku, ak jeho stred lezi v [lava hrana, prava hrana)
+		for (int i = 0; i + 1 < activeEdgeList.size(); i += 2) {
+			int startX = activeEdgeList[i].ceilX();
+			int endX = activeEdgeList[i + 1].ceilX() - 1;
+			if (startX <= endX) {
+				fillSpan(y, startX, endX);
+			}
+		}
+
+		QMutableVectorIterator<Edge> it(activeEdgeList);
+		while (it.hasNext()) {
+			Edge& edge = it.next();
+			if (edge.lastRow() == y) {
+				it.remove();
+			}
+			else {
+				edge.step();
+			}
+		}
+	}
+}
+
+//-----------------------------------------
+//		*** Coverage functions ***
+//-----------------------------------------
+
+void Rasterizer::fillPolygonCoverage(const QVector<QPoint>& points, Qt::FillRule rule, bool antialiased)
+{
+	PROFILE_SCOPE(FrameProfiler::FillCoverage);
+	if (points.size() < 3 || (!fillShader && !fillingColor.isValid())) {
+		return;
+	}
+
+	coverage.begin(scissorActive ? scissor : QRect(0, 0, width, height), rule, antialiased);
+	coverage.addPolygon(points);
+	fillCoverageRows(fillingColor, fillShader, antialiased);
+}
+
+void Rasterizer::fillPolygonCoverage(const QVector<FixedPoint>& points, Qt::FillRule rule, bool antialiased)
+{
+	PROFILE_SCOPE(FrameProfiler::FillCoverage);
+	if (points.size() < 3 || (!fillShader && !fillingColor.isValid())) {
+		return;
+	}
+
+	coverage.begin(scissorActive ? scissor : QRect(0, 0, width, height), rule, antialiased);
+	coverage.addPolygon(points);
+	fillCoverageRows(fillingColor, fillShader, antialiased);
+}
+
+// Riadky z CoverageAccumulator: vnutro a plne pokryte behy idu cez drawSpan, okraje sa miesaju po pixeloch.
+// Bez anti-aliasingu su vsetky useky plne (vinutie vzorkovane v stredoch pixelov).
+// So shaderom sa plne behy vyhodnotia po usekoch a okrajove pixely po jednom.
+void Rasterizer::fillCoverageRows(const QColor& color, const FillShader* shader, bool antialiased)
+{
+	QRgb rgba = color.rgba();
+	const int solid = antialiased ? 255 : 128;
+	auto run = [this, &color, shader](int y, int x0, int x1) {
+		if (shader) {
+			drawShadedSpan(y, x0, x1, *shader, fillAnchor);
+		}
+		else {
+			drawSpan(y, x0, x1, color);
+		}
+	};
+	auto blend = [this, rgba, shader](int x, int y, int value) {
+		blendPixel(x, y, shader ? shader->shadePixel(x, y, viewZoom, -fillAnchor) : rgba, value);
+	};
+	int y;
+	const std::vector<CoverageAccumulator::Span>* spans;
+	while (coverage.nextRow(y, spans)) {
+		for (const CoverageAccumulator::Span& span : *spans) {
+			if (!span.coverage) {
+				if (span.value >= solid) {
+					run(y, span.left, span.right);
+				}
+				else if (antialiased) {
+					for (int x = span.left; x <= span.right; x++) {
+						blend(x, y, span.value);
+					}
+				}
+				continue;
+			}
+
+			int count = span.right - span.left + 1;
+			int i = 0;
+			while (i < count) {
+				int value = span.coverage[i];
+				if (value >= solid) {
+					int end = i + 1;
+					while (end < count && span.coverage[end] >= solid) {
+						end++;
+					}
+					run(y, span.left + i, span.left + end - 1);
+					i = end;
+					continue;
+				}
+				if (antialiased && value > 0) {
+					blend(span.left + i, y, value);
+				}
+				i++;
+			}
+		}
+	}
+}
+
+//-----------------------------------------
+//		*** Stroke functions ***
+//-----------------------------------------
+
+// Cely obrys tahu jednou vyplnou (nenulove vinutie zjednoti segmenty, spoje aj konce), bez orezavania
+void Rasterizer::drawStroke(Shape& shape)
+{
+	PROFILE_SCOPE(FrameProfiler::DrawStroke);
+	QColor color = shape.getBorderColor();
+	if (!color.isValid()) {
+		return;
+	}
+
+	const Stroker::Outline& outline = strokeOutline(shape);
+	coverage.begin(scissorActive ? scissor : QRect(0, 0, width, height), Qt::WindingFill, antialiasing);
+	for (const QVector<QPointF>& contour : outline) {
+		coverage.addPolygon(contour, viewZoom, QPointF(viewOrigin));
+	}
+	fillCoverageRows(color, nullptr, antialiasing);
+}
+
+const Stroker::Outline& Rasterizer::strokeOutline(Shape& shape)
+{
+	if (shape.hasStrokeOutline()) {
+		return shape.getStrokeOutline();
+	}
+
+	QVector<QPoint> points = shape.getPoints();
+	double strokeWidth = shape.getStrokeWidth();
+	Stroker::Outline outline;
+	switch (shape.getType()) {
+	case Shape::LINE:
+		outline = Stroker::stroke({ QPointF(points[0]), QPointF(points[1]) }, false, strokeWidth, shape.getJoinStyle(), shape.getCapStyle());
+		break;
+	case Shape::RECTANGLE:
+	case Shape::POLYGON: {
+		QVector<QPointF> corners;
+		for (const QPoint& point : points) {
+			corners.append(QPointF(point));
+		}
+		outline = Stroker::stroke(corners, true, strokeWidth, shape.getJoinStyle(), shape.getCapStyle());
+		break;
+	}
+	case Shape::CIRCLE: {
+		QPointF center(points[0]);
+		QPointF edge(points[1]);
+		double radius = std::floor(std::hypot(edge.x() - center.x(), edge.y() - center.y()));
+		outline = Stroker::strokeCircle(center, radius, strokeWidth);
+		break;
+	}
+	case Shape::BEZIER_CURVE:
+		outline = Stroker::stroke(Stroker::flattenBezier(points, CurveSegments), false, strokeWidth, shape.getJoinStyle(), shape.getCapStyle());
+		break;
+	default:
+		break;
+	}
+	shape.setStrokeOutline(outline);
+	return shape.getStrokeOutline();
+}
+
+//-----------------------------------------
+//		*** Triangle functions ***
+//-----------------------------------------
+
+bool Rasterizer::useTriangleFill(int vertexCount, const QRect& targetBounds) const
+{
+	if (fillPath != AutoFill) {
+		return fillPath == TriangleFill;
+	}
+	if (vertexCount <= TriangleFillVertices) {
+		return true;
+	}
+	if (vertexCount > TriangleFillSmallVertices) {
+		return false;
+	}
+
+	// Rozhoduje viditelna cast, neviditelne riadky trojuholnikova cesta vobec neprechadza
+	QRect visible = targetBounds & (scissorActive ? scissor : QRect(0, 0, width, height));
+	return static_cast<qint64>(visible.width()) * visible.height() <= TriangleFillSmallArea;
+}
+
+const QVector<int>& Rasterizer::polygonTriangles(MyPolygon& polygon)
+{
+	if (!polygon.hasTriangles()) {
+		PROFILE_SCOPE(FrameProfiler::Triangulate);
+		polygon.setTriangles(Triangulator::triangulate(polygon.getPoints()));
+	}
+	return polygon.getTriangles();
+}
+
+void Rasterizer::fillTriangles(const QVector<QPoint>& points, const QVector<int>& triangles)
+{
+	PROFILE_SCOPE(FrameProfiler::FillTriangles);
+	for (int i = 0; i + 2 < triangles.size(); i += 3) {
+		int a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+		if (a < 0 || b < 0 || c < 0 || a >= points.size() || b >= points.size() || c >= points.size()) {
+			continue;
+		}
+		fillSnappedTriangle(points[a], points[b], points[c], 0);
+	}
+}
+
+// Vsetky trojuholniky polygonu sa prichytia rovnako jemne, spolocne hrany tak ostanu spolocne.
+// Vrcholy na celych pixeloch (pohlad bez zoomu) sa kreslia bez zjemnenia, ako fillTriangles pre QPoint
+void Rasterizer::fillTriangles(const QVector<FixedPoint>& points, const QVector<int>& triangles)
+{
+	PROFILE_SCOPE(FrameProfiler::FillTriangles);
+	if (points.isEmpty()) {
+		return;
+	}
+
+	qint64 minX = points[0].x, maxX = points[0].x, minY = points[0].y, maxY = points[0].y;
+	qint32 fraction = 0;
+	for (const FixedPoint& point : points) {
+		minX = qMin<qint64>(minX, point.x);
+		maxX = qMax<qint64>(maxX, point.x);
+		minY = qMin<qint64>(minY, point.y);
+		maxY = qMax<qint64>(maxY, point.y);
+		fraction |= (point.x | point.y) & (FixedPoint::One - 1);
+	}
+	int shift = fraction ? triangleSubpixelShift(qMax(maxX - minX, maxY - minY), TriangleSubpixelShift) : 0;
+	QVector<QPoint> snapped;
+	snapped.reserve(points.size());
+	for (const FixedPoint& point : points) {
+		snapped.append(snapTriangleVertex(point, shift));
+	}
+
+	for (int i = 0; i + 2 < triangles.size(); i += 3) {
+		int a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+		if (a < 0 || b < 0 || c < 0 || a >= snapped.size() || b >= snapped.size() || c >= snapped.size()) {
+			continue;
+		}
+		fillSnappedTriangle(snapped[a], snapped[b], snapped[c], shift);
+	}
+}
+
+void Rasterizer::fillTriangle(const QPoint& v0, const QPoint& v1, const QPoint& v2)
+{
+	fillSnappedTriangle(v0, v1, v2, 0);
+}
+
+void Rasterizer::fillTriangle(const FixedPoint& v0, const FixedPoint& v1, const FixedPoint& v2)
+{
+	qint64 extent = qMax(qMax<qint64>(v0.x, qMax(v1.x, v2.x)) - qMin<qint64>(v0.x, qMin(v1.x, v2.x)),
+		qMax<qint64>(v0.y, qMax(v1.y, v2.y)) - qMin<qint64>(v0.y, qMin(v1.y, v2.y)));
+	qint32 fraction = (v0.x | v0.y | v1.x | v1.y | v2.x | v2.y) & (FixedPoint::One - 1);
+	int shift = fraction ? triangleSubpixelShift(extent, TriangleSubpixelShift) : 0;
+	fillSnappedTriangle(snapTriangleVertex(v0, shift), snapTriangleVertex(v1, shift), snapTriangleVertex(v2, shift), shift);
+}
+
+// Half-space rasterizacia: pixel (x, y) patri trojuholniku, ked su vsetky tri hranove funkcie E = a*x + b*y + c >= 0.
+// Pixel presne na hrane patri len lavej alebo hornej hrane, takze spolocne hrany susednych trojuholnikov sa kreslia raz.
+// Zaciatok a koniec behu v riadku sa odhadne z hran a presne dohlada blokmi TriangleLanes pixelov.
+// Vrcholy su v jednotkach 2^-shift pixelu, stred pixelu (x, y) je bod (x << shift, y << shift).
+void Rasterizer::fillSnappedTriangle(const QPoint& v0, const QPoint& v1, const QPoint& v2, int shift)
+{
+	qint64 area2 = static_cast<qint64>(v1.x() - v0.x()) * (v2.y() - v0.y()) - static_cast<qint64>(v1.y() - v0.y()) * (v2.x() - v0.x());
+	if (area2 == 0 || (!fillShader && !fillingColor.isValid())) {
+		return;
+	}
+	QPoint p[3] = { v0, v1, v2 };
+	if (area2 < 0) {
+		std::swap(p[1], p[2]);
+	}
+
+	// Obalka v pixeloch: prvy a posledny stred pixelu medzi vrcholmi
+	const int unit = 1 << shift;
+	QRect clip = scissorActive ? scissor : QRect(0, 0, width, height);
+	int left = qMax((qMin(p[0].x(), qMin(p[1].x(), p[2].x())) + unit - 1) >> shift, clip.left());
+	int right = qMin(qMax(p[0].x(), qMax(p[1].x(), p[2].x())) >> shift, clip.right());
+	int top = qMax((qMin(p[0].y(), qMin(p[1].y(), p[2].y())) + unit - 1) >> shift, clip.top());
+	int bottom = qMin(qMax(p[0].y(), qMax(p[1].y(), p[2].y())) >> shift, clip.bottom());
+	if (left > right || top > bottom) {
+		return;
+	}
+
+	qint64 a[3], b[3], c[3];
+	bool fits32 = true;
+	for (int i = 0; i < 3; i++) {
+		const QPoint& from = p[i];
+		const QPoint& to = p[(i + 1) % 3];
+		a[i] = from.y() - to.y();
+		b[i] = to.x() - from.x();
+		c[i] = -(a[i] * from.x() + b[i] * from.y());
+		if (!(a[i] > 0 || (a[i] == 0 && b[i] > 0))) {
+			c[i] -= 1;	// prava/dolna hrana: E == 0 uz nepatri dnu
+		}
+		// Koeficienty na cely pixel
+		a[i] <<= shift;
+		b[i] <<= shift;
+
+		// Bloky mozu presahovat obalku o TriangleLanes pixelov, hodnoty v rohoch musia vojst do 32 bitov
+		for (qint64 x : { static_cast<qint64>(left) - TriangleLanes, static_cast<qint64>(right) + TriangleLanes }) {
+			for (qint64 y : { static_cast<qint64>(top), static_cast<qint64>(bottom) }) {
+				qint64 e = a[i] * x + b[i] * y + c[i];
+				fits32 = fits32 && e > std::numeric_limits<qint32>::min() / 2 && e < std::numeric_limits<qint32>::max() / 2;
+			}
+		}
+	}
+
+	// Obrovske trojuholniky (silny zoom) idu po jednom pixeli v 64 bitoch
+	const int lanes = fits32 ? TriangleLanes : 1;
+	TriangleLaneSteps steps;
+	for (int i = 0; i < 3; i++) {
+		for (int lane = 0; lane < TriangleLanes; lane++) {
+			steps.offsets[i][lane] = fits32 ? static_cast<qint32>(a[i] * lane) : 0;
+		}
+	}
+
+	qint64 rowE[3];
+	auto inside = [&](int x) -> unsigned {
+		unsigned mask;
+		if (fits32) {
+			qint32 e[3];
+			for (int i = 0; i < 3; i++) {
+				e[i] = static_cast<qint32>(rowE[i] + a[i] * x);
+			}
+			mask = insideLanes(e, steps);
+		}
+		else {
+			mask = (rowE[0] + a[0] * x >= 0 && rowE[1] + a[1] * x >= 0 && rowE[2] + a[2] * x >= 0) ? 1u : 0u;
+		}
+		// Pixely za pravym okrajom obalky sa nepocitaju
+		int valid = right - x + 1;
+		return valid >= lanes ? mask : mask & ((1u << qMax(valid, 0)) - 1u);
+	};
+
+	// Priesecnik hrany s riadkom (E = 0) sa posuva o -b/a na riadok; je to len odhad, presne rozhoduju bloky
+	double crossing[3], crossingStep[3];
+	for (int i = 0; i < 3; i++) {
+		crossing[i] = (a[i] != 0) ? -static_cast<double>(b[i] * top + c[i]) / a[i] : 0.0;
+		crossingStep[i] = (a[i] != 0) ? -static_cast<double>(b[i]) / a[i] : 0.0;
+	}
+
+	for (int y = top; y <= bottom; y++) {
+		double startEstimate = left;
+		double endEstimate = right;
+		bool empty = false;
+		for (int i = 0; i < 3; i++) {
+			rowE[i] = b[i] * y + c[i];
+			if (a[i] > 0) {
+				startEstimate = qMax(startEstimate, crossing[i]);
+			}
+			else if (a[i] < 0) {
+				endEstimate = qMin(endEstimate, crossing[i]);
+			}
+			else if (rowE[i] < 0) {
+				empty = true;
+			}
+			crossing[i] += crossingStep[i];
+		}
+		if (empty || startEstimate > endEstimate + 2) {
+			continue;
+		}
+
+		// Zaciatok: prvy blok s pixelom vnutri (odhad moze byt o pixel vedla)
+		int limit = static_cast<int>(qMin<double>(endEstimate + 2, right));
+		int x = static_cast<int>(qMax<double>(startEstimate - 2, left));
+		unsigned mask = inside(x);
+		while ((mask & 1u) && x > left) {
+			x = qMax(x - lanes, left);
+			mask = inside(x);
+		}
+		while (mask == 0 && x + lanes <= limit) {
+			x += lanes;
+			mask = inside(x);
+		}
+		if (mask == 0) {
+			continue;
+		}
+		int spanStart = x + static_cast<int>(qCountTrailingZeroBits(mask));
+
+		// Koniec: posledny pixel vnutri v bloku okolo odhadu konca
+		x = qMax(static_cast<int>(qMin<double>(endEstimate + 2, right)) - (lanes - 1), spanStart);
+		mask = inside(x);
+		while (x + lanes <= right && (mask >> (lanes - 1)) & 1u) {
+			x += lanes;
+			mask = inside(x);
+		}
+		while (mask == 0 && x > spanStart) {
+			x = qMax(x - lanes, spanStart);
+			mask = inside(x);
+		}
+		int spanEnd = x + 31 - static_cast<int>(qCountLeadingZeroBits(mask));
+
+		fillSpan(y, spanStart, spanEnd);
+	}
+}
+
+//-----------------------------------------
+//		*** Curve functions ***
+//-----------------------------------------
+
+void Rasterizer::drawCurve(BezierCurve& curve) {
+	PROFILE_SCOPE(FrameProfiler::DrawCurve);
+	// << Bezierova krivka >>
+	borderColor = curve.getBorderColor();
+	fillingColor = curve.getFillingColor();
+	const QVector<QPoint>& curvePoints = curve.getPointArray();
+	if (curvePoints.size() < 2) {
+		return;
+	}
+	if (curve.hasThickStroke()) {
+		drawStroke(curve);
+		return;
+	}
+
+	// Body lomenej ciary (de Casteljau pre t = deltaT, 2 deltaT, ...), kresli sa naraz cez drawPolyline
+	float deltaT = 0.01f;
+	curveVertices.clear();
+	curveVertices.push_back(curvePoints[0]);
+	// Medzivysledky v QPointF, zaokruhluje sa az bod krivky (inak sa chyby zaokruhlenia scitaju po urovniach).
+	// Riadiace body idu s presnostou FixedPoint, pri zoome teda nie su zaokruhlene na pixely ciela
+	std::vector<QPointF>& tempPoints = curveScratch;
+	curveControls.clear();
+	for (const FixedPoint& control : targetVertices(curvePoints)) {
+		curveControls.push_back(control.toPointF());
+	}
+
+	for (float t = deltaT; t <= 1; t += deltaT) {
+		tempPoints.assign(curveControls.begin(), curveControls.end());
+
+		for (int i = 1; i < static_cast<int>(tempPoints.size()); i++) {
+			for (int j = 0; j < static_cast<int>(tempPoints.size()) - i; j++) {
+				tempPoints[j] = tempPoints[j] * (1 - t) + tempPoints[j + 1] * t;
+			}
+		}
+		curveVertices.push_back(tempPoints[0].toPoint());
+	}
+
+	if (deltaT * floor(1 / deltaT) < 1) {
+		curveVertices.push_back(curvePoints.last());
+	}
+
+	drawPolyline(curveVertices.data(), static_cast<int>(curveVertices.size()), false);
+}
+
+//-----------------------------------------
+//		*** Rectangle functions ***
+//-----------------------------------------
+
+void Rasterizer::drawRectangle(MyRectangle& rectangle) {
+	borderColor = rectangle.getBorderColor();
+	fillingColor = rectangle.getFillingColor();
+	const QVector<QPoint>& pointsVector = rectangle.getPoints();
+
+	if (pointsVector.size() < 2) {
+		return;
+	}
+	setFillShader(rectangle.getFillShader().get(), pointsVector.first());
+
+	QRect bounds = shapeBounds(rectangle);
+	if (!isVisible(bounds)) {
+		RENDER_LOG(Clip, Debug, "rectangle culled (outside target)");
+		return;
+	}
+
+	// Styri vrcholy sa trianguluju rychlou cestou (vejar), netreba ich ukladat
+	if (rectangle.getIsFilled()) {
+		QVector<FixedPoint> vertices = targetVertices(pointsVector);
+		bool filled = false;
+		if (antialiasing) {
+			fillPolygonCoverage(vertices, Qt::OddEvenFill, true);
+			filled = true;
+		}
+		else if (useTriangleFill(pointsVector.size(), bounds)) {
+			QVector<int> triangles = Triangulator::triangulate(pointsVector);
+			if (!triangles.isEmpty()) {
+				fillTriangles(vertices, triangles);
+				filled = true;
+			}
+		}
+
+		if (!filled) {
+			for (const FixedPoint& vertex : vertices) {
+				if (!isInside(vertex.toPoint())) {
+					vertices = trimPolygon(vertices);
+					break;
+				}
+			}
+			fillPolygon(vertices);
+		}
+	}
+
+	if (rectangle.hasThickStroke()) {
+		drawStroke(rectangle);
+		return;
+	}
+
+	drawPolyline(pointsVector.constData(), pointsVector.size(), true);
+}
@@ -0,0 +1,347 @@
+#pragma once
+#include <QImage>
+#include <QColor>
+#include <QVector>
+#include <QDebug>
+#include <limits>
+#include "representation.h"
+#include "TiledFramebuffer.h"
+#include "DepthBuffer.h"
+#include "IdBuffer.h"
+#include "FrameProfiler.h"
+#include "RenderLog.h"
+#include "Triangulator.h"
+#include "CoverageAccumulator.h"
+#include "Stroker.h"
+#include "FillShader.h"
+#include "CompactScene.h"
+#include "FixedPoint.h"
+
+// Softverovy rasterizer nezavisly od QWidget, pouzivany editorom aj davkovym rendererom
+class Rasterizer {
+private:
+	QImage* img = nullptr;
+	uchar* data = nullptr;
+	TiledFramebuffer* tiles = nullptr;
+	int width = 0;
+	int height = 0;
+	qsizetype bytesPerLine = 0;
+	QColor borderColor, fillingColor;
+
+	// Gradient/vzor vyplne kresleneho tvaru (nullptr = fillingColor) s kotvou v cieli (prvy bod tvaru);
+	// useky vyplne sa vyhodnocuju do shadedSpan
+	const FillShader* fillShader = nullptr;
+	QPoint fillAnchor;
+	std::vector<QRgb> shadedSpan;
+	void fillSpan(int y, int x0, int x1) {
+		if (fillShader) {
+			drawShadedSpan(y, x0, x1, *fillShader, fillAnchor);
+		}
+		else {
+			drawSpan(y, x0, x1, fillingColor);
+		}
+	}
+
+	// Transformacia pohladu: pixel ciela = round(bod dokumentu * viewZoom) - viewOrigin
+	QPoint viewOrigin = QPoint(0, 0);
+	double viewZoom = 1.0;
+	int culledShapes = 0;
+
+	// Vrcholy kresleneho tvaru v cieli s presnostou FixedPoint pri posunutom/zoomovanom pohlade (body docasnej
+	// kopie su uz zaokruhlene); nullptr = body tvaru su priamo v cieli
+	const QVector<FixedPoint>* subpixelPoints = nullptr;
+	QVector<FixedPoint> targetVertices(const QVector<QPoint>& points) const {
+		return (subpixelPoints && subpixelPoints->size() == points.size()) ? *subpixelPoints : FixedPoint::fromPoints(points);
+	}
+
+	// Volitelna hlbkova rovina rovnakej velkosti ako ciel; kazdy zapis pixelu/useku je hlbkovo testovany
+	DepthBuffer* depthBuffer = nullptr;
+	quint32 currentDepth = 0;
+	bool depthTestActive() const { return depthBuffer != nullptr && depthBuffer->width() == width && depthBuffer->height() == height; }
+
+	// Volitelna rovina ID tvarov, zapisuje sa spolu s farbou (po hlbkovom teste)
+	IdBuffer* idBuffer = nullptr;
+	quint32 currentShapeId = 0;
+	bool idWriteActive() const { return idBuffer != nullptr && idBuffer->width() == width && idBuffer->height() == height; }
+
+	// Volitelny orezovy obdlznik v cieli (prekreslenie casti vyrezu), mimo neho sa nic nezapise
+	QRect scissor;
+	bool scissorActive = false;
+	bool insideScissor(int x, int y) const { return !scissorActive || scissor.contains(x, y); }
+
+	template <typename T> static QRect typedBounds(const T& shape);	// ako shapeBounds, body cez getPointArray
+	template <typename T> void drawTypedShape(T& shape);
+	template <typename T> void drawVisibleShape(T& shape, const QRect& targetBounds);
+	template <typename T> void drawShapeInTarget(T& shape);
+
+	// Draw list po davkach: beh po sebe iducich tvarov s rovnakym davkovym jadrom, ktorych obalky v cieli
+	// sa neprekryvaju (poradie v behu preto nemeni vysledok), sa nakresli naraz jednym jadrom
+	enum BatchKernel : quint8 { NoKernel, LineKernel, CircleKernel };
+	struct BatchItem {
+		const Shape* shape;		// Line alebo Circle podla jadra, jadro ho pretypuje
+		quint32 depth;
+		quint32 id;
+	};
+	static constexpr int BatchCellShift = 3;		// mriezka obsadenosti behu, bunky 8x8 pixelov ciela
+	static constexpr int BatchMaxCells = 64;		// vacsie tvary sa kreslia samostatne
+	static constexpr int BatchMaxShapes = 256;
+	BatchKernel batchKernel = NoKernel;
+	std::vector<BatchItem> batch;
+	std::vector<quint32> batchCells;		// znacka behu, ktory bunku obsadil
+	int batchColumns = 0;
+	int batchRows = 0;
+	quint32 batchStamp = 0;
+	std::vector<int> circleRows;			// polovicne sirky riadkov vyplne kruhu
+	std::vector<QRgb> batchColors;			// farby obrysov tvarov davky pri priamom zapise
+
+	// Kratke useky pre SIMD Bresenham (cele vnutri orezu); source = index useku/tvaru
+	struct SegmentQueue {
+		std::vector<QPoint> starts;
+		std::vector<QPoint> ends;
+		std::vector<int> sources;
+		void clear() { starts.clear(); ends.clear(); sources.clear(); }
+		void push(const QPoint& a, const QPoint& b, int source) { starts.push_back(a); ends.push_back(b); sources.push_back(source); }
+	};
+	SegmentQueue laneSegments, batchSegments;		// useky rasterizeSegments, useky davky ciar
+	std::vector<QPoint> curveVertices;
+	std::vector<QPointF> curveScratch;
+	std::vector<QPointF> curveControls;
+	static constexpr size_t CompactChunk = 4096;
+	std::vector<ShapeVariant> compactChunk;
+
+	bool reserveBatchCells(const QRect& targetBounds);
+	template <typename T> void batchShape(T& shape, quint32 id);
+	void flushBatch();
+	void drawLineBatch();
+	void drawCircleBatch();
+
+	// Orezane useky bez docasnych tvarov: plot(x, y) dostane len pixely vnutri ciela a scissoru
+	template <typename Plot> void rasterizeSegments(const QPoint* a, const QPoint* b, int count, bool ends, Plot&& plot);
+	template <typename Draw> void withClippedWriter(QRgb value, Draw&& draw);
+
+public:
+	// Vyplna polygonov: scanline (aktivne hrany) alebo trojuholniky z triangulacie ulozenej v tvare
+	enum FillPath : quint8 { AutoFill, ScanlineFill, TriangleFill };
+
+	// Hranice automatickej volby (namerane cez RasterBench --fill): trojuholnik a stvoruholnik su trojuholnikmi
+	// rychlejsie pri kazdej velkosti; s viac vrcholmi kazdy riadok kresli viac usekov, takze vyhraju uz len male polygony
+	static constexpr int TriangleFillVertices = 4;
+	static constexpr int TriangleFillSmallVertices = 6;
+	static constexpr qint64 TriangleFillSmallArea = 256;
+
+	// Hruba Bezierova krivka sa obtiahne po rovnakom pocte usekov ako tenka (krok t = 0.01)
+	static constexpr int CurveSegments = 100;
+
+private:
+	FillPath fillPath = AutoFill;
+
+	// Vyplne polygonov s analytickym pokrytim hran (export); bez neho sa pouziva len pre nenulove vinutie
+	bool antialiasing = false;
+	CoverageAccumulator coverage;
+
+	bool useTriangleFill(int vertexCount, const QRect& targetBounds) const;
+	const QVector<int>& polygonTriangles(MyPolygon& polygon);
+	// Half-space vypln trojuholnika s vrcholmi v jednotkach 2^-shift pixelu
+	void fillSnappedTriangle(const QPoint& v0, const QPoint& v1, const QPoint& v2, int shift);
+
+	// Obrys hrubeho tahu v suradniciach dokumentu, vytvori sa raz a ulozi do tvaru
+	const Stroker::Outline& strokeOutline(Shape& shape);
+	void fillCoverageRows(const QColor& color, const FillShader* shader, bool antialiased);
+
+public:
+	Rasterizer() = default;
+	explicit Rasterizer(QImage* target) { setTarget(target); }
+	explicit Rasterizer(TiledFramebuffer* target) { setTarget(target); }
+
+	void setTarget(QImage* target);
+	void setTarget(TiledFramebuffer* target);
+	QImage* getTarget() { return img; }
+	TiledFramebuffer* getTiledTarget() { return tiles; }
+	bool hasTarget() const { return data != nullptr || tiles != nullptr; }
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+
+	//	View transform (pan + zoom)
+	void setView(const QPoint& origin, double zoom);
+	void resetView() { setView(QPoint(0, 0), 1.0); }
+	QPoint getViewOrigin() const { return viewOrigin; }
+	double getViewZoom() const { return viewZoom; }
+	bool hasIdentityView() const { return viewOrigin.isNull() && viewZoom == 1.0; }
+	QPoint mapToTarget(const QPoint& point) const;
+	FixedPoint mapToTargetFixed(const QPoint& point) const;	// bez zaokruhlenia na cele pixely
+	QRect mapToTarget(const QRect& rect) const;
+	bool isVisible(const QRect& targetRect) const { return targetRect.intersects(scissorActive ? scissor : QRect(0, 0, width, height)); }
+	static QRect shapeBounds(Shape& shape);
+	int getCulledShapes() const { return culledShapes; }
+	void resetCulledShapes() { culledShapes = 0; }
+
+	//	Scissor (suradnice ciela)
+	void setScissor(const QRect& rect) { scissor = rect & QRect(0, 0, width, height); scissorActive = !rect.isNull(); }
+	void resetScissor() { scissor = QRect(); scissorActive = false; }
+	QRect getScissor() const { return scissor; }
+
+	//	Depth test
+	void setDepthBuffer(DepthBuffer* buffer) { depthBuffer = buffer; }
+	DepthBuffer* getDepthBuffer() { return depthBuffer; }
+	void setDepth(quint32 depth) { currentDepth = depth; }
+	quint32 getDepth() const { return currentDepth; }
+
+	//	Shape ID plane (picking)
+	void setIdBuffer(IdBuffer* buffer) { idBuffer = buffer; }
+	IdBuffer* getIdBuffer() { return idBuffer; }
+	void setShapeId(quint32 id) { currentShapeId = id; }
+	quint32 getShapeId() const { return currentShapeId; }
+
+	void setPixel(int x, int y, uchar r, uchar g, uchar b, uchar a = 255);
+	void setPixel(int x, int y, double valR, double valG, double valB, double valA = 1.);
+	void setPixel(int x, int y, const QColor& color);
+	void drawSpan(int y, int x0, int x1, const QColor& color);
+	void drawShadedSpan(int y, int x0, int x1, const FillShader& shader, const QPoint& anchor);	// anchor = pociatok shadera v cieli
+	void blendPixel(int x, int y, QRgb color, int coverage);	// coverage 0..255, 255 = ako setPixel
+	bool isInside(QPoint point) { return (point.x() > 0 && point.y() > 0 && point.x() < width - 1 && point.y() < height - 1) ? true : false; }
+	bool isInside(int x, int y) { return (x > 0 && y > 0 && x < width && y < height) ? true : false; }
+
+	void setFillPath(FillPath path) { fillPath = path; }
+	FillPath getFillPath() const { return fillPath; }
+	void setAntialiasing(bool enable) { antialiasing = enable; }
+	bool getAntialiasing() const { return antialiasing; }
+
+	void setBorderColor(QColor border) { borderColor = border; }
+	void setFillingColor(QColor filling) { fillingColor = filling; fillShader = nullptr; }
+	// Shader musi zit, kym sa nim vyplna (tvary ho drzia v shared_ptr); neplatny vzor = fillingColor
+	void setFillShader(const FillShader* shader, const QPoint& anchor = QPoint()) {
+		fillShader = (shader && shader->isValid()) ? shader : nullptr;
+		fillAnchor = anchor;
+	}
+
+	void clear(const QColor& color = Qt::white);
+	void drawShape(Shape& shape);
+	void drawShape(ShapeVariant& shape);
+
+	//	Draw list (typove davky). firstId != 0: hlbka aj ID i-teho tvaru = firstId + i, inak plati setDepth/setShapeId
+	void drawShapes(Shape* const* shapes, size_t count, quint32 firstId = 0);
+	void drawShapes(std::vector<ShapeVariant>& shapes, quint32 firstId = 0);
+	// Kompaktna scena sa rozbaluje po CompactChunk tvaroch, v pamati je naraz len jeden usek hodnot
+	void drawShapes(const CompactScene& scene, quint32 firstId = 0);
+
+	//	Lines
+	void drawLine(Line& line);
+	void drawLineBresenham(QVector<QPoint>& linePoints);
+	// Useky a[i] -> b[i] farbou borderColor (jeden tvar), kratke krokovane po niekolkych naraz v SIMD drahach
+	void drawSegments(const QPoint* a, const QPoint* b, int count);
+	// Lomena ciara farbou borderColor (closed = uzavrety obrys), spolocne vrcholy usekov sa kreslia raz
+	void drawPolyline(const QPoint* points, int count, bool closed);
+
+	//	Circles
+	void drawCircle(Circle& circle);
+	void drawSymmetricPoints(const QPoint& center, int x, int y);
+	void drawSymmetricPointsFilled(const QPoint& center, int x, int y);
+
+	//	Polygons
+	void drawPolygon(MyPolygon& polygon);
+	QVector<QPoint> trimPolygon(Shape& polygon);
+	QVector<QPoint> trimPolygon(const QVector<QPoint>& pointsVector);
+	QVector<FixedPoint> trimPolygon(const QVector<FixedPoint>& pointsVector);
+
+	//	**Polygon filling handling**
+
+	//	<Subclass for edges>
+	// Hrana scanline vyplne s vrcholmi v 24.8. Priesecnik so stredom riadku sa krokuje presne ako v Bresenhamovi:
+	// cela cast a zvysok zlomku, len celociselne scitanie a porovnanie (bez chyby, ktora by sa nazbierala po riadkoch).
+	// Pravidlo hore-vlavo: hrana patri riadkom so stredom v [horny bod, dolny bod), pixel patri useku so stredom
+	// v [lava hrana, prava hrana) - spolocne hrany susednych polygonov sa kreslia prave raz.
+	class Edge {
+	private:
+		FixedPoint startPoint_;  // Horny bod hrany
+		FixedPoint endPoint_;    // Dolny bod hrany
+		int firstRow_;           // Prvy riadok, ktory hrana pretina
+		int lastRow_;            // Posledny riadok (vratane), pri hrane bez riadku mensi ako firstRow_
+		qint64 x_;               // x v strede aktualneho riadku zaokruhlene nahor (pixely) = prvy pixel useku za hranou
+		qint64 remainder_;       // x = x_ + remainder_ / denominator_, -denominator_ < remainder_ <= 0
+		qint64 denominator_;     // 256 * dy
+		qint64 w_;               // Cela cast zmeny x na riadok
+		qint64 remainderStep_;   // Zlomkova cast zmeny x na riadok (v jednotkach 1 / denominator_)
+
+	public:
+		Edge() : firstRow_(0), lastRow_(-1), x_(0), remainder_(0), denominator_(1), w_(0), remainderStep_(0) {}
+		Edge(const FixedPoint& start, const FixedPoint& end) : startPoint_(start), endPoint_(end) {
+			// y-ova suradnica zaciatocneho bodu je vzdy mensia ako y-ova suradnica koncoveho bodu
+			if (startPoint_.y > endPoint_.y) {
+				std::swap(startPoint_, endPoint_);
+			}
+			calculateAttributes();
+		}
+
+		// Riadky hrany, x v strede prveho z nich a krok na riadok:
+		// x = (x0 * dy + (y - y0) * dx) / (256 * dy) pixelov pre stred riadku y (v 24.8)
+		void calculateAttributes() {
+			qint64 dx = static_cast<qint64>(endPoint_.x) - startPoint_.x;
+			qint64 dy = static_cast<qint64>(endPoint_.y) - startPoint_.y;
+			firstRow_ = FixedPoint::ceilToInt(startPoint_.y);
+			lastRow_ = FixedPoint::ceilToInt(endPoint_.y) - 1;
+			if (dy == 0) {
+				dx = 0;
+				dy = 1;
+			}
+
+			denominator_ = dy << FixedPoint::Shift;
+			qint64 rowOffset = (static_cast<qint64>(firstRow_) << FixedPoint::Shift) - startPoint_.y;
+			qint64 numerator = startPoint_.x * dy + rowOffset * dx;
+			x_ = -FixedPoint::divideFloor(-numerator, denominator_);
+			remainder_ = numerator - x_ * denominator_;
+
+			// Dalsi riadok ma y vacsie o 256, citatel teda o 256 * dx
+			qint64 stepNumerator = dx << FixedPoint::Shift;
+			w_ = FixedPoint::divideFloor(stepNumerator, denominator_);
+			remainderStep_ = stepNumerator - w_ * denominator_;
+		}
+
+		bool crossesRows() const { return firstRow_ <= lastRow_; }
+
+		// Gettery pre pristup k clenskym premennym
+		FixedPoint startPoint() const { return startPoint_; }
+		FixedPoint endPoint() const { return endPoint_; }
+		int firstRow() const { return firstRow_; }
+		int lastRow() const { return lastRow_; }
+		// Prvy pixel, ktoreho stred je na hrane alebo napravo od nej
+		int ceilX() const { return static_cast<int>(x_); }
+
+		// Posun na dalsi riadok; prenos zo zvysku bez vetvenia (carry = -1, ak zvysok vysiel kladny)
+		void step() {
+			remainder_ += remainderStep_;
+			qint64 carry = -remainder_ >> 63;
+			x_ += w_ - carry;
+			remainder_ -= denominator_ & carry;
+		}
+	};
+
+	static bool compareByY(const Edge& edge1, const Edge& edge2){ return edge1.firstRow() < edge2.firstRow(); }
+	// Useky zavisia len od prvych pixelov za hranami, poradie hran s rovnakym ceilX je jedno
+	static bool compareByX(const Edge& edge1, const Edge& edge2){ return edge1.ceilX() < edge2.ceilX(); }
+
+	void fillPolygon(Shape& polygon);
+	void fillPolygon(const QVector<QPoint>& points);
+	void fillPolygon(const QVector<FixedPoint>& points);
+	QVector<Edge> loadEdges(const QVector<FixedPoint>& points);
+
+	//	Coverage fill (anti-aliasing, parne-neparne aj nenulove vinutie)
+	void fillPolygonCoverage(const QVector<QPoint>& points, Qt::FillRule rule, bool antialiased);
+	void fillPolygonCoverage(const QVector<FixedPoint>& points, Qt::FillRule rule, bool antialiased);
+
+	//	Thick strokes (obrys tahu vyplneny cez pokrytie, farba obrysu)
+	void drawStroke(Shape& shape);
+
+	//	Triangles (half-space, top-left pravidlo)
+	// Vrcholy sa prichytia na 1/16 pixelu (28.4): hranove funkcie beznych trojuholnikov tak vojdu do 32-bitovych drah
+	static constexpr int TriangleSubpixelShift = 4;
+	void fillTriangles(const QVector<QPoint>& points, const QVector<int>& triangles);
+	void fillTriangles(const QVector<FixedPoint>& points, const QVector<int>& triangles);
+	void fillTriangle(const QPoint& v0, const QPoint& v1, const QPoint& v2);
+	void fillTriangle(const FixedPoint& v0, const FixedPoint& v1, const FixedPoint& v2);
+
+	//	Curves
+	void drawCurve(BezierCurve& curve);
+
+	//	Rectangles
+	void drawRectangle(MyRectangle& rectangle);
+};
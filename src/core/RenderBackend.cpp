@@ -0,0 +1,407 @@
+#include "RenderBackend.h"
+#include <QLinearGradient>
+#include <QPainterPath>
+#include <QRadialGradient>
+#include <cmath>
+#include "FillShader.h"
+
+//-----------------------------------------
+//		*** Backend selection ***
+//-----------------------------------------
+
+std::unique_ptr<RenderBackend> RenderBackend::create(Kind kind)
+{
+	switch (kind) {
+	case Painter:
+		return std::make_unique<PainterBackend>();
+	case Null:
+		return std::make_unique<NullBackend>();
+	case Software:
+	default:
+		return std::make_unique<SoftwareBackend>();
+	}
+}
+
+const char* RenderBackend::kindName(Kind kind)
+{
+	static const char* names[] = { "software", "qpainter", "null" };
+	return kind < KindCount ? names[kind] : "unknown";
+}
+
+bool RenderBackend::parseKind(const QString& name, Kind& kind)
+{
+	QString key = name.trimmed().toLower();
+	if (key == "painter") {
+		key = "qpainter";
+	}
+	for (int i = 0; i < KindCount; i++) {
+		if (key == kindName(static_cast<Kind>(i))) {
+			kind = static_cast<Kind>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------
+//		*** Common state ***
+//-----------------------------------------
+
+void RenderBackend::setTarget(QImage* target)
+{
+	img = target;
+	width = target ? target->width() : 0;
+	height = target ? target->height() : 0;
+}
+
+void RenderBackend::setView(const QPoint& origin, double zoom)
+{
+	viewOrigin = origin;
+	viewZoom = (zoom > 0) ? zoom : 1.0;
+}
+
+void RenderBackend::setScissor(const QRect& rect)
+{
+	scissor = rect & QRect(0, 0, width, height);
+	scissorActive = !rect.isNull();
+}
+
+void RenderBackend::clear(const QColor& color)
+{
+	if (img) {
+		img->fill(color);
+	}
+}
+
+// Painter a Null kreslia cez Shape& (body aj tak kopiruju na mapovanie), staci im zoznam ukazovatelov
+void RenderBackend::drawShapes(std::vector<ShapeVariant>& shapes, quint32 firstId)
+{
+	variantPointers.clear();
+	for (ShapeVariant& shape : shapes) {
+		variantPointers.push_back(&shapeOf(shape));
+	}
+	drawShapes(variantPointers.data(), variantPointers.size(), firstId);
+}
+
+// Po usekoch ako Rasterizer::drawShapes(CompactScene), naraz je rozbalenych najviac CompactChunk tvarov
+void RenderBackend::drawShapes(const CompactScene& scene, quint32 firstId)
+{
+	static constexpr size_t CompactChunk = 4096;
+	for (size_t first = 0; first < scene.size(); first += CompactChunk) {
+		size_t count = qMin(CompactChunk, scene.size() - first);
+		compactChunk.clear();
+		scene.decode(first, count, compactChunk);
+		drawShapes(compactChunk, firstId != 0 ? firstId + static_cast<quint32>(first) : 0);
+	}
+}
+
+QPoint RenderBackend::mapToTarget(const QPoint& point) const
+{
+	if (viewZoom == 1.0) {
+		return point - viewOrigin;
+	}
+	return QPoint(qRound(point.x() * viewZoom) - viewOrigin.x(), qRound(point.y() * viewZoom) - viewOrigin.y());
+}
+
+QRect RenderBackend::visibleBounds(Shape& shape) const
+{
+	QRect bounds = Rasterizer::shapeBounds(shape);
+	if (bounds.isNull()) {
+		return QRect();
+	}
+	int extent = qMax(0, static_cast<int>(std::ceil(viewZoom)) - 1);
+	QRect target = QRect(mapToTarget(bounds.topLeft()), mapToTarget(bounds.bottomRight()) + QPoint(extent, extent)).adjusted(-1, -1, 1, 1);
+	return target & (scissorActive ? scissor : QRect(0, 0, width, height));
+}
+
+void RenderBackend::countShape(Shape& shape, int vertexCount, const QRect& bounds)
+{
+	stats.shapes++;
+	stats.typeShapes[shape.getType()]++;
+	stats.vertices += vertexCount;
+	stats.pixels += static_cast<qint64>(bounds.width()) * bounds.height();
+}
+
+//-----------------------------------------
+//		*** Software backend ***
+//-----------------------------------------
+
+void SoftwareBackend::setTarget(QImage* target)
+{
+	RenderBackend::setTarget(target);
+	raster->setTarget(target);
+}
+
+bool SoftwareBackend::setTarget(TiledFramebuffer* target)
+{
+	RenderBackend::setTarget(static_cast<QImage*>(nullptr));
+	width = target ? target->width() : 0;
+	height = target ? target->height() : 0;
+	raster->setTarget(target);
+	return true;
+}
+
+void SoftwareBackend::setView(const QPoint& origin, double zoom)
+{
+	RenderBackend::setView(origin, zoom);
+	raster->setView(origin, zoom);
+}
+
+void SoftwareBackend::setScissor(const QRect& rect)
+{
+	RenderBackend::setScissor(rect);
+	if (rect.isNull()) {
+		raster->resetScissor();
+	}
+	else {
+		raster->setScissor(rect);
+	}
+}
+
+void SoftwareBackend::setAntialiasing(bool enable)
+{
+	RenderBackend::setAntialiasing(enable);
+	raster->setAntialiasing(enable);
+}
+
+void SoftwareBackend::clear(const QColor& color)
+{
+	raster->clear(color);
+}
+
+void SoftwareBackend::drawShapes(Shape* const* shapes, size_t count, quint32 firstId)
+{
+	int culledBefore = raster->getCulledShapes();
+	raster->drawShapes(shapes, count, firstId);
+	int culled = raster->getCulledShapes() - culledBefore;
+	stats.shapes += static_cast<qint64>(count) - culled;
+	stats.culled += culled;
+}
+
+void SoftwareBackend::drawShapes(std::vector<ShapeVariant>& shapes, quint32 firstId)
+{
+	int culledBefore = raster->getCulledShapes();
+	raster->drawShapes(shapes, firstId);
+	int culled = raster->getCulledShapes() - culledBefore;
+	stats.shapes += static_cast<qint64>(shapes.size()) - culled;
+	stats.culled += culled;
+}
+
+void SoftwareBackend::drawShapes(const CompactScene& scene, quint32 firstId)
+{
+	int culledBefore = raster->getCulledShapes();
+	raster->drawShapes(scene, firstId);
+	int culled = raster->getCulledShapes() - culledBefore;
+	stats.shapes += static_cast<qint64>(scene.size()) - culled;
+	stats.culled += culled;
+}
+
+//-----------------------------------------
+//		*** QPainter backend ***
+//-----------------------------------------
+
+void PainterBackend::setTarget(QImage* target)
+{
+	finish();
+	RenderBackend::setTarget(target);
+}
+
+void PainterBackend::setScissor(const QRect& rect)
+{
+	RenderBackend::setScissor(rect);
+	if (painter.isActive()) {
+		if (scissorActive) {
+			painter.setClipRect(scissor);
+		}
+		else {
+			painter.setClipping(false);
+		}
+	}
+}
+
+void PainterBackend::setAntialiasing(bool enable)
+{
+	RenderBackend::setAntialiasing(enable);
+	if (painter.isActive()) {
+		painter.setRenderHint(QPainter::Antialiasing, enable);
+	}
+}
+
+void PainterBackend::clear(const QColor& color)
+{
+	finish();
+	RenderBackend::clear(color);
+}
+
+void PainterBackend::finish()
+{
+	if (painter.isActive()) {
+		painter.end();
+	}
+}
+
+// Painter ostava otvoreny cez viac volani drawShapes (snimok), zatvori ho finish
+bool PainterBackend::beginPainting()
+{
+	if (img == nullptr || img->isNull()) {
+		return false;
+	}
+	if (!painter.isActive()) {
+		if (!painter.begin(img)) {
+			RENDER_LOG(Raster, Warning, "QPainter backend: unable to paint on target {}x{}", width, height);
+			return false;
+		}
+		painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+		if (scissorActive) {
+			painter.setClipRect(scissor);
+		}
+	}
+	return true;
+}
+
+void PainterBackend::drawShapes(Shape* const* shapes, size_t count, quint32 firstId)
+{
+	if (!beginPainting()) {
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		Shape& shape = *shapes[i];
+		QRect bounds = visibleBounds(shape);
+		if (bounds.isEmpty()) {
+			stats.culled++;
+			continue;
+		}
+
+		points = shape.getPoints();
+		for (QPoint& point : points) {
+			point = mapToTarget(point);
+		}
+		countShape(shape, points.size(), bounds);
+		paintShape(painter, shape, points, viewZoom);
+	}
+}
+
+// Suradnice shadera su relativne ku kotve (prvy bod tvaru) v pixeloch dokumentu: pixel = kotva + bod * zoom
+QBrush PainterBackend::fillBrush(Shape& shape, const QPoint& anchor, double zoom)
+{
+	const FillShader* shader = shape.getFillShader().get();
+	if (shader == nullptr || !shader->isValid()) {
+		return QBrush(shape.getFillingColor());
+	}
+
+	QTransform view(zoom, 0, 0, zoom, anchor.x(), anchor.y());
+	if (shader->getType() == FillShader::ImagePattern) {
+		QBrush brush(shader->getImage());
+		brush.setTransform(QTransform::fromTranslate(shader->getOrigin().x(), shader->getOrigin().y()) * view);
+		return brush;
+	}
+
+	QGradientStops stops;
+	for (const FillShader::Stop& stop : shader->getStops()) {
+		stops.append(QGradientStop(stop.position, stop.color));
+	}
+	QBrush brush;
+	if (shader->getType() == FillShader::RadialGradient) {
+		QRadialGradient gradient(shader->getCenter(), shader->getRadius());
+		gradient.setStops(stops);
+		brush = QBrush(gradient);
+	}
+	else {
+		QLinearGradient gradient(shader->getStart(), shader->getEnd());
+		gradient.setStops(stops);
+		brush = QBrush(gradient);
+	}
+	brush.setTransform(view);
+	return brush;
+}
+
+void PainterBackend::paintShape(QPainter& painter, Shape& shape, const QVector<QPoint>& targetPoints, double zoom)
+{
+	if (targetPoints.size() < 2) {
+		return;
+	}
+
+	QPen pen = shape.hasBorderColor() ? QPen(shape.getBorderColor()) : QPen(Qt::NoPen);
+	if (shape.hasThickStroke()) {
+		pen.setWidthF(shape.getStrokeWidth() * zoom);
+		pen.setJoinStyle(shape.getJoinStyle());
+		pen.setCapStyle(shape.getCapStyle());
+	}
+	painter.setPen(pen);
+	painter.setBrush(Qt::NoBrush);
+
+	switch (shape.getType()) {
+	case Shape::LINE:
+		painter.drawLine(targetPoints[0], targetPoints[1]);
+		break;
+	case Shape::CIRCLE: {
+		// Polomer orezany na cele pixely ako v Rasterizer::drawCircle, kruh je elipsa vpisana do stvorca
+		QPoint delta = targetPoints[1] - targetPoints[0];
+		int r = static_cast<int>(std::sqrt(static_cast<double>(delta.x()) * delta.x() + static_cast<double>(delta.y()) * delta.y()));
+		if (shape.getIsFilled()) {
+			painter.setBrush(fillBrush(shape, targetPoints[0], zoom));
+			// Tenky vyplneny kruh rasterizer kresli len vyplnou
+			if (!shape.hasThickStroke()) {
+				painter.setPen(shape.getFillShader() ? QPen(Qt::NoPen) : QPen(shape.getFillingColor()));
+			}
+		}
+		painter.drawEllipse(QRect(targetPoints[0].x() - r, targetPoints[0].y() - r, 2 * r, 2 * r));
+		break;
+	}
+	case Shape::BEZIER_CURVE: {
+		QPainterPath path(targetPoints[0]);
+		if (targetPoints.size() == 3) {
+			path.quadTo(targetPoints[1], targetPoints[2]);
+		}
+		else if (targetPoints.size() == 4) {
+			path.cubicTo(targetPoints[1], targetPoints[2], targetPoints[3]);
+		}
+		else {
+			// Vyssi stupen QPainterPath nema, krivka sa rozlozi na lomenu ciaru ako v Rasterizer
+			QVector<QPointF> flattened = Stroker::flattenBezier(targetPoints, Rasterizer::CurveSegments);
+			for (int i = 1; i < flattened.size(); i++) {
+				path.lineTo(flattened[i]);
+			}
+		}
+		painter.drawPath(path);
+		break;
+	}
+	case Shape::POLYGON:
+	case Shape::RECTANGLE:
+	default: {
+		Qt::FillRule rule = Qt::OddEvenFill;
+		if (shape.getType() == Shape::POLYGON) {
+			rule = static_cast<MyPolygon&>(shape).getFillRule();
+		}
+		if (shape.getIsFilled()) {
+			painter.setBrush(fillBrush(shape, targetPoints[0], zoom));
+		}
+		painter.drawPolygon(QPolygon(targetPoints), rule);
+		break;
+	}
+	}
+}
+
+//-----------------------------------------
+//		*** Null backend ***
+//-----------------------------------------
+
+// Rovnaky prechod ako pri kresleni (body, mapovanie, obalka, orezanie), ale bez zapisu pixelov
+void NullBackend::drawShapes(Shape* const* shapes, size_t count, quint32 firstId)
+{
+	for (size_t i = 0; i < count; i++) {
+		Shape& shape = *shapes[i];
+		QRect bounds = visibleBounds(shape);
+		if (bounds.isEmpty()) {
+			stats.culled++;
+			continue;
+		}
+
+		QVector<QPoint> points = shape.getPoints();
+		for (QPoint& point : points) {
+			point = mapToTarget(point);
+		}
+		countShape(shape, points.size(), bounds);
+	}
+}
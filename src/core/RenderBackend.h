@@ -0,0 +1,150 @@
+#pragma once
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPoint>
+#include <QRect>
+#include <memory>
+#include <vector>
+#include "representation.h"
+#include "Rasterizer.h"
+#include "CompactScene.h"
+
+// Rozhranie, cez ktore sa kresli scena: editor aj nastroje davaju backendu zoznam tvarov v poradi vrstiev
+// s transformaciou pohladu a volitelnym scissorom. Implementacie:
+//  - Software: vlastny Rasterizer (hlbkovy test, ID rovina, davky, SIMD) - predvolena
+//  - Painter: raster engine QPainter, rovnaka geometria (body sa mapuju ako v Rasterizer), poradie kreslenia
+//    nahradza hlbkovy test, ID rovina sa nezapisuje
+//  - Null: nic nekresli, len prejde scenu (body, obalky, orezanie) a spocita pracu - cista rezia prechodu scenou
+// Backend sa vybera za behu (RenderBackend::create).
+class RenderBackend {
+public:
+	enum Kind : quint8 { Software, Painter, Null, KindCount };
+
+	// Praca od posledneho resetStats; pixels = plocha obaliek viditelnych tvarov v cieli (horny odhad zapisov).
+	// Software pocita len tvary a vyradene (body by zdrzovali), ostatne vsetko
+	struct Stats {
+		qint64 shapes = 0;
+		qint64 culled = 0;
+		qint64 vertices = 0;
+		qint64 pixels = 0;
+		qint64 typeShapes[5] = {};		// index = Shape::ShapeType
+	};
+
+	virtual ~RenderBackend() = default;
+
+	static std::unique_ptr<RenderBackend> create(Kind kind);
+	static const char* kindName(Kind kind);
+	// "software", "qpainter" (aj "painter"), "null"; bez ohladu na velkost pismen
+	static bool parseKind(const QString& name, Kind& kind);
+
+	virtual Kind kind() const = 0;
+	const char* name() const { return kindName(kind()); }
+
+	virtual void setTarget(QImage* target);
+	// Dlazdicovy ciel vie len Software, ostatne vratia false
+	virtual bool setTarget(TiledFramebuffer* target) { return false; }
+	// Ciel bez pixelov, len rozmery pre orezanie (Null backend meria prechod scenou bez framebufferu)
+	void setTargetSize(const QSize& size) { setTarget(static_cast<QImage*>(nullptr)); width = size.width(); height = size.height(); }
+	QImage* getTarget() { return img; }
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+
+	virtual void setView(const QPoint& origin, double zoom);
+	virtual void setScissor(const QRect& rect);
+	void resetScissor() { setScissor(QRect()); }
+	virtual void setAntialiasing(bool enable) { antialiasing = enable; }
+	bool getAntialiasing() const { return antialiasing; }
+
+	virtual void clear(const QColor& color = Qt::white);
+	// firstId != 0: hlbka aj ID i-teho tvaru = firstId + i (Software), ostatne backendy kreslia v poradi zoznamu
+	virtual void drawShapes(Shape* const* shapes, size_t count, quint32 firstId = 0) = 0;
+	// Tvary ako hodnoty (aj rozbalena kompaktna scena); Software ich kresli priamo, ostatne cez ukazovatele na zaklad
+	virtual void drawShapes(std::vector<ShapeVariant>& shapes, quint32 firstId = 0);
+	virtual void drawShapes(const CompactScene& scene, quint32 firstId = 0);
+	void drawShape(Shape& shape, quint32 id = 0) { Shape* pointer = &shape; drawShapes(&pointer, 1, id); }
+	// Dokonci snimok (QPainter uvolni ciel); pred citanim ciela alebo kreslenim do neho inou cestou
+	virtual void finish() {}
+
+	const Stats& getStats() const { return stats; }
+	void resetStats() { stats = Stats(); }
+
+protected:
+	QImage* img = nullptr;
+	int width = 0;
+	int height = 0;
+	QPoint viewOrigin = QPoint(0, 0);
+	double viewZoom = 1.0;
+	QRect scissor;
+	bool scissorActive = false;
+	bool antialiasing = false;
+	Stats stats;
+
+	// Rovnake mapovanie a orezanie obalkou ako Rasterizer::mapToTarget / isVisible
+	QPoint mapToTarget(const QPoint& point) const;
+	QRect visibleBounds(Shape& shape) const;	// prazdny = tvar mimo ciela
+	void countShape(Shape& shape, int vertexCount, const QRect& bounds);
+
+private:
+	std::vector<ShapeVariant> compactChunk;
+	std::vector<Shape*> variantPointers;
+};
+
+class SoftwareBackend : public RenderBackend {
+public:
+	// Bez rasterizera si backend vytvori vlastny; editor mu poziciava svoj (roviny, setPixel)
+	explicit SoftwareBackend(Rasterizer* rasterizer = nullptr) : raster(rasterizer ? rasterizer : &ownRaster) {}
+
+	Kind kind() const override { return Software; }
+	Rasterizer& rasterizer() { return *raster; }
+
+	void setTarget(QImage* target) override;
+	bool setTarget(TiledFramebuffer* target) override;
+	void setView(const QPoint& origin, double zoom) override;
+	void setScissor(const QRect& rect) override;
+	void setAntialiasing(bool enable) override;
+	void clear(const QColor& color = Qt::white) override;
+	void drawShapes(Shape* const* shapes, size_t count, quint32 firstId = 0) override;
+	void drawShapes(std::vector<ShapeVariant>& shapes, quint32 firstId = 0) override;
+	void drawShapes(const CompactScene& scene, quint32 firstId = 0) override;
+
+private:
+	Rasterizer ownRaster;
+	Rasterizer* raster;
+};
+
+// Bez vyhladzovania zodpoveda tenky obrys peru hrubky 1, hruby tah peru so spojmi a koncami tvaru,
+// vyplneny kruh len vyplni (ako Rasterizer). Gradienty a vzory sa prevedu na QBrush.
+class PainterBackend : public RenderBackend {
+public:
+	~PainterBackend() override { finish(); }
+
+	Kind kind() const override { return Painter; }
+	using RenderBackend::setTarget;
+	using RenderBackend::drawShapes;
+
+	void setTarget(QImage* target) override;
+	void setScissor(const QRect& rect) override;
+	void setAntialiasing(bool enable) override;
+	void clear(const QColor& color = Qt::white) override;
+	void drawShapes(Shape* const* shapes, size_t count, quint32 firstId = 0) override;
+	void finish() override;
+
+	// Jeden tvar na aktivny painter v suradniciach ciela (pouziva aj RasterDiff)
+	static void paintShape(QPainter& painter, Shape& shape, const QVector<QPoint>& targetPoints, double zoom = 1.0);
+
+private:
+	QPainter painter;
+	QVector<QPoint> points;
+
+	bool beginPainting();
+	static QBrush fillBrush(Shape& shape, const QPoint& anchor, double zoom);
+};
+
+class NullBackend : public RenderBackend {
+public:
+	Kind kind() const override { return Null; }
+	using RenderBackend::drawShapes;
+	void clear(const QColor& color = Qt::white) override {}
+	void drawShapes(Shape* const* shapes, size_t count, quint32 firstId = 0) override;
+};
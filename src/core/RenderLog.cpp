@@ -0,0 +1,316 @@
+#include "RenderLog.h"
+#include <QFile>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+	// Ohraniceny kruhovy buffer pre viac zapisovatelov a jedneho citatela (sekvencne cisla v slotoch, bez zamku)
+	class LogRing {
+	public:
+		static constexpr quint64 Capacity = 8192;
+
+		LogRing() : cells(new Slot[Capacity]) {
+			for (quint64 i = 0; i < Capacity; i++) {
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		bool tryPush(const RenderLog::Record& record) {
+			quint64 pos = enqueuePos.load(std::memory_order_relaxed);
+			for (;;) {
+				Slot& slot = cells[pos & (Capacity - 1)];
+				quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+				qint64 diff = static_cast<qint64>(sequence) - static_cast<qint64>(pos);
+				if (diff == 0) {
+					if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						slot.record = record;
+						slot.sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0) {
+					return false;
+				}
+				else {
+					pos = enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// Len jedno vlakno (drainer)
+		bool tryPop(RenderLog::Record& record) {
+			Slot& slot = cells[dequeuePos & (Capacity - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+				return false;
+			}
+			record = slot.record;
+			slot.sequence.store(dequeuePos + Capacity, std::memory_order_release);
+			dequeuePos++;
+			consumed.store(dequeuePos, std::memory_order_release);
+			return true;
+		}
+
+		quint64 produced() const { return enqueuePos.load(std::memory_order_acquire); }
+		quint64 consumedCount() const { return consumed.load(std::memory_order_acquire); }
+
+	private:
+		struct Slot {
+			std::atomic<quint64> sequence;
+			RenderLog::Record record;
+		};
+
+		std::unique_ptr<Slot[]> cells;
+		alignas(64) std::atomic<quint64> enqueuePos{ 0 };
+		alignas(64) quint64 dequeuePos = 0;
+		std::atomic<quint64> consumed{ 0 };
+	};
+
+	// Vlakno na pozadi, ktore zaznamy formatuje a vypisuje
+	class LogDrainer {
+	public:
+		LogRing ring;
+		std::atomic<quint64> dropped{ 0 };
+
+		static LogDrainer& instance() {
+			static LogDrainer drainer;
+			return drainer;
+		}
+
+		~LogDrainer() {
+			stop.store(true);
+			wake.notify_all();
+			if (worker.joinable()) {
+				worker.join();
+			}
+			if (output != stderr && output != nullptr) {
+				std::fclose(output);
+			}
+		}
+
+		void flush() {
+			quint64 target = ring.produced();
+			wake.notify_all();
+			while (ring.consumedCount() < target && worker.joinable()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			std::lock_guard<std::mutex> lock(outputMutex);
+			std::fflush(output);
+		}
+
+		bool setOutputFile(const QString& fileName) {
+			std::lock_guard<std::mutex> lock(outputMutex);
+			std::FILE* file = stderr;
+			if (!fileName.isEmpty()) {
+				file = std::fopen(QFile::encodeName(fileName).constData(), "a");
+				if (file == nullptr) {
+					return false;
+				}
+			}
+			if (output != stderr && output != nullptr) {
+				std::fclose(output);
+			}
+			output = file;
+			return true;
+		}
+
+	private:
+		std::thread worker;
+		std::atomic<bool> stop{ false };
+		std::mutex wakeMutex;
+		std::condition_variable wake;
+		std::mutex outputMutex;
+		std::FILE* output = stderr;
+		quint64 reportedDropped = 0;
+
+		LogDrainer() {
+			worker = std::thread([this]() { run(); });
+		}
+
+		void run() {
+			RenderLog::Record record;
+			for (;;) {
+				bool wrote = false;
+				{
+					std::lock_guard<std::mutex> lock(outputMutex);
+					while (ring.tryPop(record)) {
+						QByteArray line = RenderLog::format(record).toLocal8Bit();
+						line.append('\n');
+						std::fwrite(line.constData(), 1, line.size(), output);
+						wrote = true;
+					}
+					quint64 droppedNow = dropped.load(std::memory_order_relaxed);
+					if (droppedNow != reportedDropped) {
+						std::fprintf(output, "[log] %llu records dropped (ring buffer full)\n", static_cast<unsigned long long>(droppedNow - reportedDropped));
+						reportedDropped = droppedNow;
+						wrote = true;
+					}
+					if (wrote) {
+						std::fflush(output);
+					}
+				}
+
+				if (stop.load()) {
+					if (ring.consumedCount() >= ring.produced()) {
+						return;
+					}
+					continue;
+				}
+				if (!wrote) {
+					// Zapisovatelia nikoho nebudia (bolo by to drahe), vlakno sa preto prebudza samo
+					std::unique_lock<std::mutex> lock(wakeMutex);
+					wake.wait_for(lock, std::chrono::milliseconds(20));
+				}
+			}
+		}
+	};
+
+	qint64 timestampNs()
+	{
+		static const auto start = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	quint64 threadTag()
+	{
+		static thread_local quint64 tag = static_cast<quint64>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		return tag;
+	}
+
+	// Konfiguracia z premennej prostredia RENDER_LOG pri prvom pouziti
+	struct EnvironmentConfig {
+		EnvironmentConfig() {
+			QString rules = qEnvironmentVariable("RENDER_LOG");
+			if (!rules.isEmpty()) {
+				RenderLog::configure(rules);
+			}
+		}
+	};
+	const EnvironmentConfig environmentConfig;
+}
+
+void RenderLog::push(Record& record)
+{
+	record.timestampNs = timestampNs();
+	record.thread = threadTag();
+
+	LogDrainer& drainer = LogDrainer::instance();
+	if (!drainer.ring.tryPush(record)) {
+		drainer.dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void RenderLog::setLevel(Level level)
+{
+	for (int c = 0; c < CategoryCount; c++) {
+		setLevel(static_cast<Category>(c), level);
+	}
+}
+
+bool RenderLog::configure(const QString& rules)
+{
+	bool ok = true;
+	const QStringList entries = rules.split(',', Qt::SkipEmptyParts);
+	for (const QString& entry : entries) {
+		QStringList parts = entry.trimmed().toLower().split('=');
+		if (parts.size() != 2) {
+			ok = false;
+			continue;
+		}
+
+		int level = -1;
+		for (int l = Trace; l <= Off; l++) {
+			if (parts[1] == levelName(static_cast<Level>(l))) {
+				level = l;
+			}
+		}
+		if (level < 0) {
+			ok = false;
+			continue;
+		}
+
+		if (parts[0] == "*") {
+			setLevel(static_cast<Level>(level));
+			continue;
+		}
+
+		bool found = false;
+		for (int c = 0; c < CategoryCount; c++) {
+			if (parts[0] == categoryName(static_cast<Category>(c))) {
+				setLevel(static_cast<Category>(c), static_cast<Level>(level));
+				found = true;
+			}
+		}
+		ok = ok && found;
+	}
+	return ok;
+}
+
+bool RenderLog::setOutputFile(const QString& fileName)
+{
+	return LogDrainer::instance().setOutputFile(fileName);
+}
+
+void RenderLog::flush()
+{
+	LogDrainer::instance().flush();
+}
+
+quint64 RenderLog::droppedRecords()
+{
+	return LogDrainer::instance().dropped.load(std::memory_order_relaxed);
+}
+
+const char* RenderLog::categoryName(Category category)
+{
+	static const char* names[CategoryCount] = { "raster", "clip", "edit", "scene", "export" };
+	return (category < CategoryCount) ? names[category] : "?";
+}
+
+const char* RenderLog::levelName(Level level)
+{
+	static const char* names[] = { "trace", "debug", "info", "warning", "off" };
+	return (level <= Off) ? names[level] : "?";
+}
+
+QString RenderLog::format(const Record& record)
+{
+	QString message;
+	const char* f = record.format ? record.format : "";
+	int arg = 0;
+	while (*f) {
+		if (f[0] == '{' && f[1] == '}' && arg < record.argCount) {
+			qint64 value = record.values[arg];
+			switch (record.types[arg]) {
+			case Record::Double: {
+				double d;
+				std::memcpy(&d, &value, sizeof(d));
+				message += QString::number(d);
+				break;
+			}
+			case Record::Point:
+				message += QString("(%1, %2)").arg(static_cast<qint32>(value >> 32)).arg(static_cast<qint32>(value & 0xffffffff));
+				break;
+			default:
+				message += QString::number(value);
+				break;
+			}
+			arg++;
+			f += 2;
+			continue;
+		}
+		message += QLatin1Char(*f);
+		f++;
+	}
+
+	return QString("%1 [%2] %3 %4: %5")
+		.arg(record.timestampNs / 1e9, 0, 'f', 6)
+		.arg(record.thread & 0xffff, 4, 16, QLatin1Char('0'))
+		.arg(categoryName(record.category))
+		.arg(levelName(record.level))
+		.arg(message);
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <QtGlobal>
+#include <QPoint>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+// Najnizsia prelozena uroven (0 trace, 1 debug, 2 info, 3 warning, 4 nic) a maska prelozenych kategorii.
+// Volania pod touto hranicou sa vobec neprelozia, argumenty sa ani nevyhodnotia.
+#ifndef RENDER_LOG_MIN_LEVEL
+#define RENDER_LOG_MIN_LEVEL 1
+#endif
+#ifndef RENDER_LOG_CATEGORY_MASK
+#define RENDER_LOG_CATEGORY_MASK 0xffffffffu
+#endif
+
+// Strukturovany log s kategoriami: zaznam je binarny (ukazovatel na staticky format + ciselne argumenty),
+// zapisuje sa bez zamku do kruhoveho buffera a formatuje ho az vlakno na pozadi.
+// Plny buffer zaznam zahodi (pocita sa), kresliace vlakno nikdy neblokuje.
+class RenderLog {
+public:
+	enum Category : quint8 { Raster, Clip, Edit, Scene, Export, CategoryCount };
+	enum Level : quint8 { Trace, Debug, Info, Warning, Off };
+
+	static constexpr int MaxArgs = 6;
+
+	struct Record {
+		enum ArgType : quint8 { Int, Double, Point };
+
+		qint64 timestampNs = 0;
+		const char* format = nullptr;	// retazcovy literal, "{}" su miesta pre argumenty
+		quint64 thread = 0;
+		std::array<qint64, MaxArgs> values{};
+		std::array<ArgType, MaxArgs> types{};
+		quint8 argCount = 0;
+		Category category = Raster;
+		Level level = Debug;
+	};
+
+	static constexpr bool compiledIn(Category category, Level level) {
+		return level >= RENDER_LOG_MIN_LEVEL && level < Off && ((RENDER_LOG_CATEGORY_MASK >> category) & 1u);
+	}
+	static bool isEnabled(Category category, Level level) {
+		return level >= runtimeLevels[category].load(std::memory_order_relaxed);
+	}
+
+	static void setLevel(Category category, Level level) { runtimeLevels[category].store(level, std::memory_order_relaxed); }
+	static void setLevel(Level level);				// pre vsetky kategorie
+	static Level level(Category category) { return static_cast<Level>(runtimeLevels[category].load(std::memory_order_relaxed)); }
+	static bool configure(const QString& rules);	// napr. "raster=debug,edit=trace" alebo "*=info"
+	static bool setOutputFile(const QString& fileName);	// prazdne = stderr
+	static void flush();							// pocka, kym vlakno na pozadi vypise vsetko zapisane
+	static quint64 droppedRecords();
+
+	static const char* categoryName(Category category);
+	static const char* levelName(Level level);
+	static QString format(const Record& record);
+
+	template <typename... Args>
+	static void write(Category category, Level level, const char* format, const Args&... args) {
+		static_assert(sizeof...(Args) <= MaxArgs, "Too many log arguments");
+		Record record;
+		record.category = category;
+		record.level = level;
+		record.format = format;
+		int index = 0;
+		(pack(record, index, args), ...);
+		record.argCount = static_cast<quint8>(index);
+		push(record);
+	}
+
+private:
+	// Bez konfiguracie (RENDER_LOG, configure) sa vypisuju len varovania
+	static inline std::atomic<quint8> runtimeLevels[CategoryCount] = { Warning, Warning, Warning, Warning, Warning };
+
+	template <typename T>
+	static void pack(Record& record, int& index, const T& value) {
+		if constexpr (std::is_floating_point_v<T>) {
+			double d = static_cast<double>(value);
+			std::memcpy(&record.values[index], &d, sizeof(d));
+			record.types[index] = Record::Double;
+		}
+		else if constexpr (std::is_same_v<T, QPoint>) {
+			record.values[index] = static_cast<qint64>((static_cast<quint64>(static_cast<quint32>(value.x())) << 32) | static_cast<quint32>(value.y()));
+			record.types[index] = Record::Point;
+		}
+		else {
+			static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "Log arguments must be numbers or QPoint");
+			record.values[index] = static_cast<qint64>(value);
+			record.types[index] = Record::Int;
+		}
+		index++;
+	}
+
+	static void push(Record& record);
+};
+
+#define RENDER_LOG(category, level, ...) \
+	do { \
+		if constexpr (RenderLog::compiledIn(RenderLog::category, RenderLog::level)) { \
+			if (RenderLog::isEnabled(RenderLog::category, RenderLog::level)) { \
+				RenderLog::write(RenderLog::category, RenderLog::level, __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
@@ -0,0 +1,315 @@
+#include "SceneFile.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QStringList>
+#include "SceneJournal.h"
+#include "FillShader.h"
+#include "CompactScene.h"
+
+QString SceneFile::shapeTypeName(Shape::ShapeType type)
+{
+	switch (type) {
+	case Shape::LINE:
+		return "Line";
+	case Shape::RECTANGLE:
+		return "Rectangle";
+	case Shape::POLYGON:
+		return "Polygon";
+	case Shape::CIRCLE:
+		return "Circle";
+	case Shape::BEZIER_CURVE:
+		return "BezierCurve";
+	}
+	return QString();
+}
+
+Shape* SceneFile::createShape(const QString& shapeType, const QVector<QPoint>& points, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor)
+{
+	if (shapeType == "Line" && points.size() == 2) {
+		return new Line(points[0], points[1], zBufferPosition, isFilled, borderColor, fillingColor);
+	}
+	else if (shapeType == "Rectangle" && points.size() == 4) {
+		return new MyRectangle(points[0], points[1], points[2], points[3], zBufferPosition, isFilled, borderColor, fillingColor);
+	}
+	else if (shapeType == "Polygon" && points.size() >= 3) {
+		return new MyPolygon(points, zBufferPosition, isFilled, borderColor, fillingColor);
+	}
+	else if (shapeType == "Circle" && points.size() == 2) {
+		return new Circle(points[0], points[1], zBufferPosition, isFilled, borderColor, fillingColor);
+	}
+	else if (shapeType == "BezierCurve" && points.size() >= 3) {
+		return new BezierCurve(points, zBufferPosition, isFilled, borderColor, fillingColor);
+	}
+	return nullptr;
+}
+
+// Jeden riadok CSV: typ, zBufferPosition, vypln, farby a body "(x,y) (x,y) ..."
+QString SceneFile::toCsvRow(Shape& shape, int zBufferPosition)
+{
+	QString points;
+	QVector<QPoint> shapePoints = shape.getPoints();
+	for (const QPoint& point : shapePoints) {
+		points += QString("(%1,%2) ").arg(point.x()).arg(point.y());
+	}
+	points = points.trimmed();
+
+	QString row = QString("%1,%2,%3,%4,%5,%6")
+		.arg(shapeTypeName(shape.getType()))
+		.arg(zBufferPosition)
+		.arg(shape.getIsFilled() ? "true" : "false")
+		.arg(shape.getBorderColor().name())
+		.arg(shape.getFillingColor().name())
+		.arg(points);
+
+	QString stroke = strokeAttribute(shape);
+	if (!stroke.isEmpty()) {
+		row += "," + stroke;
+	}
+	QString fill = fillAttribute(shape);
+	if (!fill.isEmpty()) {
+		row += "," + fill;
+	}
+	return row;
+}
+
+// "stroke=hrubka:spoj:koniec", pre tenky obrys s predvolenymi spojmi prazdne (subor ostane v starom formate)
+QString SceneFile::strokeAttribute(Shape& shape)
+{
+	if (!shape.hasThickStroke() && shape.getJoinStyle() == Qt::MiterJoin && shape.getCapStyle() == Qt::FlatCap) {
+		return QString();
+	}
+
+	QString join = (shape.getJoinStyle() == Qt::RoundJoin) ? "round" : (shape.getJoinStyle() == Qt::BevelJoin) ? "bevel" : "miter";
+	QString cap = (shape.getCapStyle() == Qt::RoundCap) ? "round" : (shape.getCapStyle() == Qt::SquareCap) ? "square" : "butt";
+	return QString("stroke=%1:%2:%3").arg(shape.getStrokeWidth()).arg(join).arg(cap);
+}
+
+// "fill=linear:x0:y0:x1:y1:zastavky", "fill=radial:cx:cy:r:zastavky" alebo "fill=pattern:ox:oy:cesta";
+// zastavky su "pozicia@#AARRGGBB" oddelene '/', cesta k obrazku je percentovo kodovana (bez ',' a ':')
+QString SceneFile::fillAttribute(Shape& shape)
+{
+	const std::shared_ptr<const FillShader>& shader = shape.getFillShader();
+	if (!shader) {
+		return QString();
+	}
+
+	if (shader->getType() == FillShader::ImagePattern) {
+		return QString("fill=pattern:%1:%2:%3").arg(shader->getOrigin().x()).arg(shader->getOrigin().y())
+			.arg(QString::fromLatin1(shader->getSource().toUtf8().toPercentEncoding()));
+	}
+
+	QStringList stops;
+	for (const FillShader::Stop& stop : shader->getStops()) {
+		stops << QString("%1@%2").arg(stop.position).arg(stop.color.name(QColor::HexArgb));
+	}
+	if (shader->getType() == FillShader::RadialGradient) {
+		return QString("fill=radial:%1:%2:%3:%4").arg(shader->getCenter().x()).arg(shader->getCenter().y())
+			.arg(shader->getRadius()).arg(stops.join('/'));
+	}
+	return QString("fill=linear:%1:%2:%3:%4:%5").arg(shader->getStart().x()).arg(shader->getStart().y())
+		.arg(shader->getEnd().x()).arg(shader->getEnd().y()).arg(stops.join('/'));
+}
+
+// Nezname polia sa ignoruju, aby novsie subory isli otvorit aj so starsou verziou formatu
+void SceneFile::applyAttribute(Shape& shape, const QString& field)
+{
+	QString key = field.section('=', 0, 0).trimmed();
+	QString value = field.section('=', 1).trimmed();
+	if (key == "fill") {
+		QStringList parts = value.split(':');
+		QString kind = parts.value(0);
+		auto parseStops = [](const QString& text) {
+			QVector<FillShader::Stop> stops;
+			for (const QString& stop : text.split('/', Qt::SkipEmptyParts)) {
+				stops.append({ stop.section('@', 0, 0).toDouble(), QColor(stop.section('@', 1)) });
+			}
+			return stops;
+		};
+
+		if (kind == "linear" && parts.size() == 6) {
+			shape.setFillShader(std::make_shared<FillShader>(FillShader::linear(QPointF(parts[1].toDouble(), parts[2].toDouble()),
+				QPointF(parts[3].toDouble(), parts[4].toDouble()), parseStops(parts[5]))));
+		}
+		else if (kind == "radial" && parts.size() == 5) {
+			shape.setFillShader(std::make_shared<FillShader>(FillShader::radial(QPointF(parts[1].toDouble(), parts[2].toDouble()),
+				parts[3].toDouble(), parseStops(parts[4]))));
+		}
+		else if (kind == "pattern" && parts.size() == 4) {
+			// Chybajuci obrazok: shader si cestu ponecha (ulozi sa znova), tvar sa vyplni farbou
+			QString source = QString::fromUtf8(QByteArray::fromPercentEncoding(parts[3].toLatin1()));
+			shape.setFillShader(std::make_shared<FillShader>(FillShader::pattern(QImage(source),
+				QPointF(parts[1].toDouble(), parts[2].toDouble()), source)));
+		}
+		return;
+	}
+	if (key != "stroke") {
+		return;
+	}
+
+	QStringList parts = value.split(':');
+	shape.setStrokeWidth(parts.value(0).toInt());
+	QString join = parts.value(1);
+	shape.setJoinStyle(join == "round" ? Qt::RoundJoin : join == "bevel" ? Qt::BevelJoin : Qt::MiterJoin);
+	QString cap = parts.value(2);
+	shape.setCapStyle(cap == "round" ? Qt::RoundCap : cap == "square" ? Qt::SquareCap : Qt::FlatCap);
+}
+
+QVector<QPoint> SceneFile::parsePoints(const QString& pointsStr)
+{
+	QVector<QPoint> points;
+	QStringList pointPairs = pointsStr.split(' ', Qt::SkipEmptyParts);
+	for (const QString& pair : pointPairs) {
+		QString cleanPair = pair.trimmed().remove('(').remove(')');
+		QStringList coords = cleanPair.split(',');
+		if (coords.size() == 2) {
+			int x = coords[0].toInt();
+			int y = coords[1].toInt();
+			points.append(QPoint(x, y));
+		}
+	}
+	return points;
+}
+
+Shape* SceneFile::fromCsvRow(const QString& line, bool* formatOk)
+{
+	QStringList fields = line.split(',');
+	if (fields.size() < 6) {
+		if (formatOk) {
+			*formatOk = false;
+		}
+		return nullptr;
+	}
+	if (formatOk) {
+		*formatOk = true;
+	}
+
+	QString shapeType = fields[0];
+	int zBufferPosition = fields[1].toInt();
+	bool isFilled = (fields[2] == "true");
+	QColor borderColor(fields[3]);
+	QColor fillingColor(fields[4]);
+
+	// Volitelne polia "kluc=hodnota" su na konci riadku za bodmi
+	QStringList attributes;
+	while (fields.size() > 6 && fields.last().contains('=')) {
+		attributes.prepend(fields.takeLast());
+	}
+	QVector<QPoint> points = parsePoints(fields.mid(5).join(","));
+
+	Shape* shape = createShape(shapeType, points, zBufferPosition, isFilled, borderColor, fillingColor);
+	if (shape) {
+		for (const QString& attribute : attributes) {
+			applyAttribute(*shape, attribute);
+		}
+	}
+	return shape;
+}
+
+QByteArray SceneFile::serialize(const std::vector<ZBufferEntry>& zBuffer)
+{
+	QByteArray bytes;
+	bytes.append(CsvHeader);
+	bytes.append('\n');
+	for (const auto& pair : zBuffer) {
+		bytes.append(toCsvRow(pair.first.get(), pair.second).toUtf8());
+		bytes.append('\n');
+	}
+	return bytes;
+}
+
+bool SceneFile::load(const QString& filePath, std::vector<std::unique_ptr<Shape>>& shapes, QString* errorMessage, int* skippedShapes, int* journalRecords, int* unsavedRecords)
+{
+	// Binarna kompaktna scena (napr. zo SceneGen) sa rozbali do tvarov na halde; zurnal k nej nepatri
+	if (CompactScene::isCompactFile(filePath)) {
+		CompactScene scene;
+		if (!scene.load(filePath, errorMessage)) {
+			return false;
+		}
+		if (skippedShapes) {
+			*skippedShapes = 0;
+		}
+		if (journalRecords) {
+			*journalRecords = 0;
+		}
+		if (unsavedRecords) {
+			*unsavedRecords = 0;
+		}
+		shapes.reserve(shapes.size() + scene.size());
+		for (size_t i = 0; i < scene.size(); i++) {
+			ShapeVariant shape = scene.shapeAt(i);
+			shapes.emplace_back(std::visit([](auto& typed) -> Shape* { return new std::decay_t<decltype(typed)>(typed); }, shape));
+		}
+		return true;
+	}
+
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		if (errorMessage) {
+			*errorMessage = "Unable to open file for reading.";
+		}
+		return false;
+	}
+
+	if (skippedShapes) {
+		*skippedShapes = 0;
+	}
+	if (journalRecords) {
+		*journalRecords = 0;
+	}
+
+	QTextStream in(&file);
+
+	in.readLine();
+
+	while (!in.atEnd()) {
+		QString line = in.readLine();
+
+		bool formatOk = true;
+		Shape* shape = fromCsvRow(line, &formatOk);
+		if (!formatOk) {
+			if (errorMessage) {
+				*errorMessage = "Invalid file format.";
+			}
+			return false;
+		}
+		if (shape == nullptr) {
+			if (skippedShapes) {
+				(*skippedShapes)++;
+			}
+			continue;
+		}
+
+		shapes.emplace_back(shape);
+	}
+
+	file.close();
+
+	// Zmeny ulozene po poslednej snimke su v zurnale vedla suboru, za nimi pripadne neulozene (pad)
+	int replayed = SceneJournal::replay(filePath, shapes, unsavedRecords);
+	if (journalRecords) {
+		*journalRecords = qMax(replayed, 0);
+	}
+	return true;
+}
+
+bool SceneFile::save(const QString& filePath, const std::vector<ZBufferEntry>& zBuffer, QString* errorMessage)
+{
+	// QSaveFile: pri chybe alebo pade zostane povodny subor cely
+	QSaveFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly)) {
+		if (errorMessage) {
+			*errorMessage = "Unable to open file for writing.";
+		}
+		return false;
+	}
+
+	QByteArray bytes = serialize(zBuffer);
+	if (file.write(bytes) != bytes.size() || !file.commit()) {
+		if (errorMessage) {
+			*errorMessage = file.errorString();
+		}
+		return false;
+	}
+	return true;
+}
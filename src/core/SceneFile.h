@@ -0,0 +1,35 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QPoint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "representation.h"
+
+// Nacitanie a ulozenie stavu sceny vo formate CSV (rovnaky format pouziva editor aj davkovy renderer)
+class SceneFile {
+public:
+	using ZBufferEntry = std::pair<std::reference_wrapper<Shape>, int>;
+
+	static constexpr const char* CsvHeader = "ShapeType,ZBufferPosition,IsFilled,BorderColor,FillingColor,Points";
+
+	static QString shapeTypeName(Shape::ShapeType type);
+	static Shape* createShape(const QString& shapeType, const QVector<QPoint>& points, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor);
+
+	// Za bodmi mozu byt volitelne polia "kluc=hodnota" (napr. stroke=9:miter:butt, fill=linear:...), zapisuju sa len ak nie su predvolene
+	static QString toCsvRow(Shape& shape, int zBufferPosition);
+	static Shape* fromCsvRow(const QString& line, bool* formatOk = nullptr);	// nullptr aj pri neznamom type / zlych bodoch
+	static QVector<QPoint> parsePoints(const QString& pointsStr);
+	static QString strokeAttribute(Shape& shape);
+	static QString fillAttribute(Shape& shape);
+	static void applyAttribute(Shape& shape, const QString& field);
+	static QByteArray serialize(const std::vector<ZBufferEntry>& zBuffer);
+
+	// Vracia false, ak sa subor neda otvorit alebo ma neplatny format. Neznamy typ objektu sa preskoci a zapocita do skippedShapes.
+	// Ak vedla suboru existuje platny zurnal (SceneJournal), jeho ulozene zaznamy sa prehraju nad snimkou;
+	// neulozene sa len spocitaju do unsavedRecords (obnova cez SceneJournal::recover).
+	static bool load(const QString& filePath, std::vector<std::unique_ptr<Shape>>& shapes, QString* errorMessage = nullptr, int* skippedShapes = nullptr, int* journalRecords = nullptr, int* unsavedRecords = nullptr);
+	static bool save(const QString& filePath, const std::vector<ZBufferEntry>& zBuffer, QString* errorMessage = nullptr);
+};
@@ -0,0 +1,175 @@
+#include "SceneGenerator.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+//-----------------------------------------
+//		*** Settings ***
+//-----------------------------------------
+
+qint64 SceneGenerator::Settings::totalShapes() const
+{
+	qint64 total = 0;
+	for (qint64 count : counts) {
+		total += count;
+	}
+	return total;
+}
+
+QString SceneGenerator::Settings::validate() const
+{
+	if (canvasSize.width() <= 0 || canvasSize.height() <= 0) {
+		return "Canvas size must be positive.";
+	}
+	for (qint64 count : counts) {
+		if (count < 0) {
+			return "Shape counts must not be negative.";
+		}
+	}
+	if (totalShapes() == 0) {
+		return "The scene has no shapes.";
+	}
+	if (minVertices < 3 || maxVertices < minVertices) {
+		return "Polygon vertex range must be at least 3 and ordered (MIN:MAX).";
+	}
+	// SceneFile nacita krivku az od 3 bodov, kratsie by sa z vygenerovaneho CSV stratili
+	if (minCurvePoints < 3 || maxCurvePoints < minCurvePoints) {
+		return "Curve point range must be at least 3 and ordered (MIN:MAX).";
+	}
+	if (fillRatio < 0 || fillRatio > 1 || offCanvas < 0 || offCanvas > 1) {
+		return "Fill ratio and off-canvas fraction must be between 0 and 1.";
+	}
+	if (overlap <= 0) {
+		return "Overlap must be positive.";
+	}
+	return QString();
+}
+
+//-----------------------------------------
+//		*** Generation ***
+//-----------------------------------------
+
+// Obalky vsetkych tvarov na platne pokryju overlap-nasobok jeho plochy: priemerna obalka ma stranu
+// sqrt(overlap * plocha / pocet tvarov na platne)
+SceneGenerator::SceneGenerator(const Settings& settings)
+	: settings(settings), random(settings.seed)
+{
+	double onCanvas = qMax(1.0, settings.totalShapes() * (1.0 - settings.offCanvas));
+	double area = static_cast<double>(settings.canvasSize.width()) * settings.canvasSize.height();
+	shapeSize = qMax(2.0, std::sqrt(settings.overlap * area / onCanvas));
+}
+
+QColor SceneGenerator::color()
+{
+	quint32 bits = random();
+	return QColor(bits & 0xff, (bits >> 8) & 0xff, (bits >> 16) & 0xff);
+}
+
+// Stred tvaru: na platne rovnomerne, mimo platna v pase za nahodnym okrajom tak daleko, aby tam bol cely tvar
+QPoint SceneGenerator::anchor(double extent)
+{
+	int width = settings.canvasSize.width();
+	int height = settings.canvasSize.height();
+	if (unit() >= settings.offCanvas) {
+		return QPoint(range(0, width - 1), range(0, height - 1));
+	}
+
+	int gap = static_cast<int>(std::ceil(extent)) + 1;
+	int depth = range(gap, gap + qMax(width, height));
+	switch (random() % 4) {
+	case 0:
+		return QPoint(-depth, range(-gap, height + gap));
+	case 1:
+		return QPoint(width - 1 + depth, range(-gap, height + gap));
+	case 2:
+		return QPoint(range(-gap, width + gap), -depth);
+	default:
+		return QPoint(range(-gap, width + gap), height - 1 + depth);
+	}
+}
+
+ShapeVariant SceneGenerator::makeShape(Shape::ShapeType type, int zBufferPosition)
+{
+	// Velkost tvaru 0.5 .. 1.5 nasobok priemeru; anchor je stred obalky
+	double size = shapeSize * (0.5 + unit());
+	double half = size / 2;
+	QColor border = color();
+	QColor filling = color();
+	bool filled = unit() < settings.fillRatio;
+	QPoint center = anchor(half);
+	auto offset = [this, half]() { return QPoint(qRound((unit() * 2 - 1) * half), qRound((unit() * 2 - 1) * half)); };
+
+	switch (type) {
+	case Shape::LINE:
+		return Line(center + offset(), center + offset(), zBufferPosition, false, border, filling);
+	case Shape::RECTANGLE: {
+		int w = qMax(1, qRound(size * (0.5 + unit())));
+		int h = qMax(1, qRound(size * size / w));
+		QPoint p1 = center - QPoint(w / 2, h / 2);
+		QPoint p3 = p1 + QPoint(w, h);
+		return MyRectangle(p1, QPoint(p3.x(), p1.y()), p3, QPoint(p1.x(), p3.y()), zBufferPosition, filled, border, filling);
+	}
+	case Shape::POLYGON: {
+		// Hviezdicovy polygon (vrcholy podla uhla okolo stredu) je vzdy jednoduchy, konvexny aj nekonvexny
+		int count = range(settings.minVertices, settings.maxVertices);
+		std::vector<double> angles(count);
+		for (double& angle : angles) {
+			angle = unit() * 2 * M_PI;
+		}
+		std::sort(angles.begin(), angles.end());
+		QVector<QPoint> points;
+		points.reserve(count);
+		for (double angle : angles) {
+			double radius = half * (0.4 + 0.6 * unit());
+			points.append(center + QPoint(qRound(radius * std::cos(angle)), qRound(radius * std::sin(angle))));
+		}
+		return MyPolygon(points, zBufferPosition, filled, border, filling);
+	}
+	case Shape::CIRCLE:
+		return Circle(center, center + QPoint(qMax(1, qRound(half)), 0), zBufferPosition, filled, border, filling);
+	case Shape::BEZIER_CURVE:
+	default: {
+		int count = range(settings.minCurvePoints, settings.maxCurvePoints);
+		QVector<QPoint> points;
+		points.reserve(count);
+		for (int i = 0; i < count; i++) {
+			points.append(center + offset());
+		}
+		return BezierCurve(points, zBufferPosition, false, border, filling);
+	}
+	}
+}
+
+// Typ dalsieho tvaru sa losuje podla zostavajucich poctov (bez vratenia), takze pocty sedia presne
+void SceneGenerator::generate(const std::function<void(Shape&)>& sink)
+{
+	random.seed(settings.seed);
+	qint64 remaining[5];
+	std::copy(settings.counts, settings.counts + 5, remaining);
+	qint64 total = settings.totalShapes();
+
+	for (qint64 index = 0; index < total; index++) {
+		qint64 pick = static_cast<qint64>(unit() * (total - index));
+		int type = 0;
+		while (type < 4 && (remaining[type] == 0 || pick >= remaining[type])) {
+			pick -= remaining[type];
+			type++;
+		}
+		remaining[type]--;
+
+		ShapeVariant shape = makeShape(static_cast<Shape::ShapeType>(type), static_cast<int>(qMin<qint64>(index, std::numeric_limits<int>::max())));
+		sink(shapeOf(shape));
+	}
+}
+
+void SceneGenerator::generate(CompactScene& scene)
+{
+	// Odhad bodov: obdlznik sa uklada ako 2 rohy, polygony a krivky stredom rozsahu
+	qint64 points = 2 * (settings.counts[Shape::LINE] + settings.counts[Shape::RECTANGLE] + settings.counts[Shape::CIRCLE])
+		+ settings.counts[Shape::POLYGON] * (settings.minVertices + settings.maxVertices) / 2
+		+ settings.counts[Shape::BEZIER_CURVE] * (settings.minCurvePoints + settings.maxCurvePoints) / 2;
+	scene.reserve(scene.size() + static_cast<size_t>(settings.totalShapes()), scene.vertexCount() + static_cast<size_t>(points));
+	generate([&scene](Shape& shape) { scene.append(shape); });
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <QSize>
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <random>
+#include "representation.h"
+#include "CompactScene.h"
+
+// Proceduralne sceny pre zatazove a skalovacie testy (10k .. 10M tvarov): pocty tvarov kazdeho typu, pocty
+// vrcholov, podiel vyplnenych, hustota prekryvu a podiel tvarov mimo platna. Rovnaky seed da rovnaku scenu
+// na kazdej platforme - cisla idu priamo z mt19937 (jeho vystup je dany normou), nie cez std distribucie.
+// Tvary su v poradi vrstiev (zBufferPosition = index), typy su nahodne premiesane.
+class SceneGenerator {
+public:
+	struct Settings {
+		QSize canvasSize = QSize(1920, 1080);
+		qint64 counts[5] = { 0, 0, 0, 0, 0 };	// index = Shape::ShapeType
+		int minVertices = 3;					// polygony
+		int maxVertices = 8;
+		int minCurvePoints = 3;					// riadiace body Bezierovych kriviek
+		int maxCurvePoints = 4;
+		double fillRatio = 0.5;					// podiel vyplnenych obdlznikov, polygonov a kruhov
+		double overlap = 2.0;					// sucet ploch obaliek / plocha platna (priemerna hlbka prekryvu)
+		double offCanvas = 0.0;					// podiel tvarov cely mimo platna (orezanie obalkou)
+		quint32 seed = 1;
+
+		qint64 totalShapes() const;
+		// Prazdny retazec = v poriadku, inak popis chyby (CLI ho vypise)
+		QString validate() const;
+	};
+
+	explicit SceneGenerator(const Settings& settings);
+
+	// Tvar po tvare bez uchovania sceny (napr. priamy zapis CSV); tvar plati len pocas volania
+	void generate(const std::function<void(Shape&)>& sink);
+	void generate(CompactScene& scene);
+
+	// Priemerna strana obalky tvaru odvodena z hustoty prekryvu
+	double getShapeSize() const { return shapeSize; }
+
+private:
+	Settings settings;
+	std::mt19937 random;
+	double shapeSize = 1.0;
+
+	double unit() { return random() / 4294967296.0; }		// 0 <= x < 1
+	int range(int low, int high) { return low + static_cast<int>(unit() * (high - low + 1)); }
+	QColor color();
+	QPoint anchor(double extent);
+	ShapeVariant makeShape(Shape::ShapeType type, int zBufferPosition);
+};
@@ -0,0 +1,437 @@
+#include "SceneJournal.h"
+#include <QSaveFile>
+#include <QStringList>
+#include <chrono>
+#include "SceneFile.h"
+#include "RenderLog.h"
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace {
+	// FNV-1a: kontrolny sucet riadku (odhali odrezany/poskodeny koniec po pade) a odtlacok snimky
+	quint32 hash32(const QByteArray& bytes)
+	{
+		quint32 h = 2166136261u;
+		for (char c : bytes) {
+			h = (h ^ static_cast<uchar>(c)) * 16777619u;
+		}
+		return h;
+	}
+
+	quint64 hash64(quint64 h, const char* bytes, qint64 length)
+	{
+		for (qint64 i = 0; i < length; i++) {
+			h = (h ^ static_cast<uchar>(bytes[i])) * 1099511628211ull;
+		}
+		return h;
+	}
+
+	const quint64 Hash64Seed = 14695981039346656037ull;
+
+	// Zaznam bez indexu: vsetko pred nim je ulozene
+	const char* const SavedMarker = "saved";
+
+	QByteArray headerFor(qint64 size, quint64 fingerprint)
+	{
+		return QString("#journal,%1,%2\n").arg(size).arg(fingerprint, 16, 16, QChar('0')).toUtf8();
+	}
+
+	void syncToDisk(QFile& file)
+	{
+		file.flush();
+#ifdef Q_OS_UNIX
+		::fsync(file.handle());
+#endif
+	}
+}
+
+SceneJournal::~SceneJournal()
+{
+	close();
+}
+
+//-----------------------------------------
+//		*** Open / close ***
+//-----------------------------------------
+
+bool SceneJournal::open(const QString& path, bool keepUnsaved, QString* errorMessage)
+{
+	close();
+
+	QByteArray expected = fileHeader(path);
+	if (expected.isEmpty()) {
+		if (errorMessage) {
+			*errorMessage = "Scene file does not exist.";
+		}
+		return false;
+	}
+
+	// Platny zurnal tejto snimky sa pouzije dalej, za poslednym celym (alebo ulozenym) zaznamom sa odreze
+	QString journalName = journalPath(path);
+	Scan existing;
+	bool reuse = scan(journalName, expected, existing);
+	if (!reuse) {
+		QSaveFile fresh(journalName);
+		if (!fresh.open(QIODevice::WriteOnly) || fresh.write(expected) != expected.size() || !fresh.commit()) {
+			if (errorMessage) {
+				*errorMessage = fresh.errorString();
+			}
+			return false;
+		}
+		existing.validBytes = existing.savedBytes = expected.size();
+	}
+
+	journalFile.setFileName(journalName);
+	qint64 keptBytes = keepUnsaved ? existing.validBytes : existing.savedBytes;
+	if (!journalFile.open(QIODevice::WriteOnly | QIODevice::Append) || !journalFile.resize(keptBytes)) {
+		if (errorMessage) {
+			*errorMessage = journalFile.errorString();
+		}
+		journalFile.close();
+		return false;
+	}
+
+	scenePath = path;
+	records = existing.saved.size() + (keepUnsaved ? existing.unsaved.size() : 0);
+	savedBytes = existing.savedBytes;
+	pending.clear();
+	pendingRecords = 0;
+	lastRecordStart = -1;
+	lastPointsIndex = -1;
+	writing = false;
+	flushRequested = false;
+	stopRequested = false;
+	error.clear();
+	worker = std::thread([this]() { run(); });
+	return true;
+}
+
+// Zastavi vlakno a zahodi neulozene zaznamy: zatvorenie bez ulozenia sa nema v scene prejavit
+void SceneJournal::close()
+{
+	if (!worker.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.clear();
+		pendingRecords = 0;
+		stopRequested = true;
+	}
+	wake.notify_all();
+	worker.join();
+	journalFile.resize(savedBytes);
+	journalFile.close();
+	scenePath.clear();
+	records = 0;
+	savedBytes = 0;
+}
+
+//-----------------------------------------
+//		*** Records ***
+//-----------------------------------------
+
+void SceneJournal::recordAdd(int index, Shape& shape, int zBufferPosition)
+{
+	append(QString("A,%1,%2").arg(index).arg(SceneFile::toCsvRow(shape, zBufferPosition)));
+}
+
+void SceneJournal::recordRemove(int index)
+{
+	append(QString("R,%1").arg(index));
+}
+
+void SceneJournal::recordPoints(int index, const QVector<QPoint>& points)
+{
+	QString text;
+	for (const QPoint& point : points) {
+		text += QString("(%1,%2) ").arg(point.x()).arg(point.y());
+	}
+	append(QString("P,%1,%2").arg(index).arg(text.trimmed()), index);
+}
+
+void SceneJournal::recordColor(int index, const QColor& borderColor, const QColor& fillingColor)
+{
+	append(QString("C,%1,%2,%3").arg(index).arg(borderColor.name()).arg(fillingColor.name()));
+}
+
+void SceneJournal::recordSwap(int index)
+{
+	append(QString("S,%1").arg(index));
+}
+
+// Riadok: zaznam;kontrolny sucet. Nove body tej istej vrstvy (tah mysou) nahradia este nezapisany predosly zaznam
+void SceneJournal::append(const QString& payload, int pointsIndex)
+{
+	if (!isOpen()) {
+		return;
+	}
+
+	QByteArray line = payload.toUtf8();
+	line += QString(";%1\n").arg(hash32(line), 8, 16, QChar('0')).toUtf8();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (pointsIndex >= 0 && pointsIndex == lastPointsIndex && lastRecordStart >= 0) {
+		pending.truncate(lastRecordStart);
+		pendingRecords--;
+		records--;
+	}
+	lastRecordStart = static_cast<int>(pending.size());
+	lastPointsIndex = pointsIndex;
+	pending += line;
+	pendingRecords++;
+	records++;
+
+	if (pendingRecords >= BatchRecords) {
+		wake.notify_one();
+	}
+}
+
+// Znacka "ulozene" za posledny zaznam; vrati sa az ked je vsetko na disku
+bool SceneJournal::commit(QString* errorMessage)
+{
+	if (!isOpen()) {
+		if (errorMessage) {
+			*errorMessage = "Journal is not open.";
+		}
+		return false;
+	}
+
+	QByteArray marker(SavedMarker);
+	marker += QString(";%1\n").arg(hash32(marker), 8, 16, QChar('0')).toUtf8();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	pending += marker;
+	lastRecordStart = -1;
+	lastPointsIndex = -1;
+	flushRequested = true;
+	wake.notify_one();
+	idle.wait(lock, [this]() { return pending.isEmpty() && !writing; });
+
+	if (!error.isEmpty()) {
+		if (errorMessage) {
+			*errorMessage = error;
+		}
+		return false;
+	}
+	// Vlakno stoji (pending je prazdne a drzime zamok), velkost suboru je koniec znacky
+	savedBytes = journalFile.size();
+	return true;
+}
+
+//-----------------------------------------
+//		*** Background writer ***
+//-----------------------------------------
+
+void SceneJournal::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		wake.wait_for(lock, std::chrono::milliseconds(FlushIntervalMs), [this]() {
+			return stopRequested || flushRequested || pendingRecords >= BatchRecords;
+			});
+
+		// Aj bez podnetu sa po FlushIntervalMs zapise, co sa nazbieralo
+		if (!pending.isEmpty()) {
+			QByteArray batch = pending;
+			pending.clear();
+			pendingRecords = 0;
+			lastRecordStart = -1;
+			lastPointsIndex = -1;
+			writing = true;
+			lock.unlock();
+
+			bool written = journalFile.write(batch) == batch.size();
+			QString batchError = written ? QString() : journalFile.errorString();
+			syncToDisk(journalFile);
+
+			lock.lock();
+			writing = false;
+			if (!written) {
+				error = batchError;
+				RENDER_LOG(Scene, Warning, "journal write failed ({} bytes)", static_cast<int>(batch.size()));
+			}
+		}
+
+		flushRequested = false;
+		idle.notify_all();
+		if (stopRequested && pending.isEmpty()) {
+			return;
+		}
+	}
+}
+
+//-----------------------------------------
+//		*** Replay ***
+//-----------------------------------------
+
+QByteArray SceneJournal::fileHeader(const QString& path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return QByteArray();
+	}
+
+	quint64 fingerprint = Hash64Seed;
+	QByteArray chunk;
+	while (!(chunk = file.read(1 << 20)).isEmpty()) {
+		fingerprint = hash64(fingerprint, chunk.constData(), chunk.size());
+	}
+	return headerFor(file.size(), fingerprint);
+}
+
+bool SceneJournal::parseRecord(const QByteArray& line, QString& payload)
+{
+	int separator = line.lastIndexOf(';');
+	if (separator <= 0) {
+		return false;
+	}
+
+	QByteArray body = line.left(separator);
+	bool ok = false;
+	quint32 checksum = line.mid(separator + 1).toUInt(&ok, 16);
+	if (!ok || checksum != hash32(body)) {
+		return false;
+	}
+	payload = QString::fromUtf8(body);
+	return true;
+}
+
+bool SceneJournal::applyRecord(const QString& payload, std::vector<std::unique_ptr<Shape>>& shapes)
+{
+	if (payload.size() < 3 || payload[1] != ',') {
+		return false;
+	}
+
+	int comma = payload.indexOf(',', 2);
+	bool ok = false;
+	int index = payload.mid(2, comma < 0 ? -1 : comma - 2).toInt(&ok);
+	QString rest = comma < 0 ? QString() : payload.mid(comma + 1);
+	int count = static_cast<int>(shapes.size());
+	if (!ok || index < 0) {
+		return false;
+	}
+
+	switch (payload[0].toLatin1()) {
+	case 'A': {
+		Shape* shape = SceneFile::fromCsvRow(rest);
+		if (shape == nullptr || index > count) {
+			delete shape;
+			return false;
+		}
+		shapes.emplace(shapes.begin() + index, shape);
+		return true;
+	}
+	case 'R':
+		if (index >= count) {
+			return false;
+		}
+		shapes.erase(shapes.begin() + index);
+		return true;
+	case 'P':
+		if (index >= count) {
+			return false;
+		}
+		shapes[index]->setPoints(SceneFile::parsePoints(rest));
+		return true;
+	case 'C': {
+		QStringList colors = rest.split(',');
+		if (index >= count || colors.size() != 2) {
+			return false;
+		}
+		shapes[index]->setBorderColor(QColor(colors[0]));
+		shapes[index]->setFillingColor(QColor(colors[1]));
+		return true;
+	}
+	case 'S': {
+		// Ako v editore: tvary sa vymenia, zBufferPosition zostava na svojom mieste
+		if (index < 1 || index >= count) {
+			return false;
+		}
+		std::swap(shapes[index - 1], shapes[index]);
+		int position = shapes[index - 1]->getZBufferPosition();
+		shapes[index - 1]->setZBufferPosition(shapes[index]->getZBufferPosition());
+		shapes[index]->setZBufferPosition(position);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+// Nacita platne zaznamy zurnalu a rozdeli ich podla poslednej znacky "ulozene"; false ak zurnal neexistuje
+// alebo patri k inej snimke
+bool SceneJournal::scan(const QString& journalName, const QByteArray& expectedHeader, Scan& result)
+{
+	QFile file(journalName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	QByteArray first = file.readLine();
+	if (first != expectedHeader) {
+		RENDER_LOG(Scene, Info, "journal belongs to an older snapshot, ignored");
+		return false;
+	}
+
+	result.validBytes = result.savedBytes = first.size();
+	while (!file.atEnd()) {
+		QByteArray line = file.readLine();
+		QString payload;
+		if (!line.endsWith('\n') || !parseRecord(line.left(line.size() - 1), payload)) {
+			// Nedopisany posledny riadok (pad pocas zapisu), vsetko pred nim plati
+			break;
+		}
+		result.validBytes += line.size();
+		if (payload == SavedMarker) {
+			result.saved += result.unsaved;
+			result.unsaved.clear();
+			result.savedBytes = result.validBytes;
+		}
+		else {
+			result.unsaved.append(payload);
+		}
+	}
+	return true;
+}
+
+int SceneJournal::apply(const QStringList& payloads, std::vector<std::unique_ptr<Shape>>& shapes)
+{
+	int applied = 0;
+	for (const QString& payload : payloads) {
+		if (!applyRecord(payload, shapes)) {
+			RENDER_LOG(Scene, Warning, "journal record {} does not match the scene, replay stopped", applied + 1);
+			break;
+		}
+		applied++;
+	}
+	return applied;
+}
+
+int SceneJournal::replay(const QString& path, std::vector<std::unique_ptr<Shape>>& shapes, int* unsavedRecords)
+{
+	if (unsavedRecords) {
+		*unsavedRecords = 0;
+	}
+	Scan journal;
+	if (!scan(journalPath(path), fileHeader(path), journal)) {
+		return -1;
+	}
+
+	int applied = apply(journal.saved, shapes);
+	// Neulozene zmeny maju zmysel len nad celym ulozenym stavom
+	if (unsavedRecords && applied == journal.saved.size()) {
+		*unsavedRecords = journal.unsaved.size();
+	}
+	return applied;
+}
+
+int SceneJournal::recover(const QString& path, std::vector<std::unique_ptr<Shape>>& shapes)
+{
+	Scan journal;
+	if (!scan(journalPath(path), fileHeader(path), journal)) {
+		return 0;
+	}
+	return apply(journal.unsaved, shapes);
+}
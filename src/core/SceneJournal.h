@@ -0,0 +1,95 @@
+#pragma once
+#include <QByteArray>
+#include <QColor>
+#include <QFile>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+#include <QStringList>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "representation.h"
+
+// Zurnal uprav sceny vedla CSV snimky (<scena>.csv.journal). Kazda zmena (pridanie, odstranenie, nove body,
+// farba, vymena vrstiev) je jeden riadok s kontrolnym suctom, ktory sa len pripaja na koniec.
+// Riadky zapisuje vlakno na pozadi v davkach, takze po pade sa da prist o najviac FlushIntervalMs prace.
+// Ulozenie do tej istej sceny dopise znacku "ulozene", takze stoji O(zmena) a nie O(scena); snimka + zaznamy
+// po poslednu znacku = ulozeny stav. Zaznamy za znackou su neulozene: pri nacitani sa len ponuknu na obnovu
+// a pri zatvoreni bez ulozenia sa zahodia. Snimku prepisuje len ulozenie (po CompactRecords zaznamoch cela
+// scena), nikdy zurnal sam. Hlavicka zurnalu nesie odtlacok snimky, ku ktorej patri.
+class SceneJournal {
+public:
+	static constexpr int BatchRecords = 64;
+	static constexpr int FlushIntervalMs = 200;
+	static constexpr int CompactRecords = 4096;
+
+	SceneJournal() = default;
+	~SceneJournal();
+	SceneJournal(const SceneJournal&) = delete;
+	SceneJournal& operator=(const SceneJournal&) = delete;
+
+	static QString journalPath(const QString& scenePath) { return scenePath + ".journal"; }
+
+	// Nadviaze na existujuci platny zurnal snimky (poskodeny koniec odreze), inak zacne novy.
+	// Neulozene zaznamy z minulej relacie ostanu len s keepUnsaved (boli obnovene do sceny), inak sa zahodia.
+	bool open(const QString& scenePath, bool keepUnsaved = false, QString* errorMessage = nullptr);
+	void close();					// neulozene zaznamy zahodi
+	bool isOpen() const { return worker.joinable(); }
+	QString getScenePath() const { return scenePath; }
+
+	//	Zaznamy (indexy su vrstvy v poradi zBuffer)
+	void recordAdd(int index, Shape& shape, int zBufferPosition);
+	void recordRemove(int index);
+	void recordPoints(int index, const QVector<QPoint>& points);
+	void recordColor(int index, const QColor& borderColor, const QColor& fillingColor);
+	void recordSwap(int index);
+
+	int recordCount() const { return records; }
+	bool needsCompaction() const { return records >= CompactRecords; }	// ulozenie ma radsej zapisat celu scenu
+
+	// Ulozenie: vsetky zaznamy oznaci za ulozene a pocka, kym su na disku
+	bool commit(QString* errorMessage = nullptr);
+
+	// Prehra ulozene zaznamy zurnalu nad nacitanou snimkou. Vrati pocet prehranych zaznamov,
+	// -1 ak zurnal neexistuje alebo patri k inej snimke; unsavedRecords = pocet neulozenych zaznamov za nimi.
+	static int replay(const QString& scenePath, std::vector<std::unique_ptr<Shape>>& shapes, int* unsavedRecords = nullptr);
+	// Obnova po pade: prehra neulozene zaznamy nad scenou nacitanou cez replay
+	static int recover(const QString& scenePath, std::vector<std::unique_ptr<Shape>>& shapes);
+
+private:
+	QString scenePath;
+	QFile journalFile;				// pouziva len vlakno na pozadi
+	int records = 0;
+	qint64 savedBytes = 0;			// koniec poslednej znacky "ulozene" (alebo hlavicky)
+
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+	QByteArray pending;				// zaznamy este neodovzdane vlaknu
+	int pendingRecords = 0;
+	int lastRecordStart = -1;		// posledny zaznam v pending (na zlucenie posunov)
+	int lastPointsIndex = -1;
+	bool writing = false;
+	bool flushRequested = false;
+	bool stopRequested = false;
+	QString error;
+
+	void append(const QString& payload, int pointsIndex = -1);
+	void run();
+
+	struct Scan {
+		qint64 validBytes = 0;		// koniec posledneho celeho zaznamu
+		qint64 savedBytes = 0;		// koniec poslednej znacky "ulozene"
+		QStringList saved;			// zaznamy po poslednu znacku
+		QStringList unsaved;		// zaznamy za nou
+	};
+	static bool scan(const QString& journalName, const QByteArray& expectedHeader, Scan& result);
+	static int apply(const QStringList& payloads, std::vector<std::unique_ptr<Shape>>& shapes);
+	static QByteArray fileHeader(const QString& scenePath);
+	static bool parseRecord(const QByteArray& line, QString& payload);
+	static bool applyRecord(const QString& payload, std::vector<std::unique_ptr<Shape>>& shapes);
+};
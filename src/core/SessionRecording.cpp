@@ -0,0 +1,257 @@
+#include "SessionRecording.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include "SceneFile.h"
+
+static const char* const FileHeader = "ImageViewerSession,1";
+static const char* const EventTypeNames[] = { "press", "release", "move", "wheel", "enter", "leave" };
+
+bool SessionRecording::ToolState::operator==(const ToolState& other) const
+{
+	return tools == other.tools && move == other.move && scale == other.scale && filling == other.filling
+		&& borderColor == other.borderColor && fillingColor == other.fillingColor && strokeWidth == other.strokeWidth
+		&& join == other.join && cap == other.cap && fillStyle == other.fillStyle && layer == other.layer && zoom == other.zoom;
+}
+
+const char* SessionRecording::eventTypeName(EventType type)
+{
+	return type < EventTypeCount ? EventTypeNames[type] : "unknown";
+}
+
+SessionRecording::LatencySummary SessionRecording::summarize(std::vector<qint64> samplesNs)
+{
+	LatencySummary summary;
+	if (samplesNs.empty()) {
+		return summary;
+	}
+
+	std::sort(samplesNs.begin(), samplesNs.end());
+	double total = 0.0;
+	for (qint64 sample : samplesNs) {
+		total += sample;
+	}
+
+	// Percentil p = najmensia vzorka, pod ktorou (vratane) je aspon p % vzoriek
+	auto percentile = [&samplesNs](double p) {
+		size_t rank = static_cast<size_t>(std::ceil(samplesNs.size() * p / 100.0));
+		return samplesNs[qMax<size_t>(rank, 1) - 1] / 1e6;
+	};
+	summary.count = static_cast<int>(samplesNs.size());
+	summary.meanMs = total / samplesNs.size() / 1e6;
+	summary.p50Ms = percentile(50);
+	summary.p99Ms = percentile(99);
+	summary.maxMs = samplesNs.back() / 1e6;
+	return summary;
+}
+
+//-----------------------------------------
+//		*** Recording ***
+//-----------------------------------------
+
+void SessionRecording::start(const QSize& size, const QByteArray& sceneSnapshot)
+{
+	canvasSize = size;
+	scene = sceneSnapshot;
+	toolStates.clear();
+	events.clear();
+	recording = true;
+	clock.start();
+}
+
+void SessionRecording::record(EventType type, const QPoint& pos, int button, int buttons, int modifiers, int wheelDelta, const ToolState& state)
+{
+	if (!recording) {
+		return;
+	}
+
+	if (toolStates.empty() || toolStates.back() != state) {
+		toolStates.push_back(state);
+	}
+
+	Event event;
+	event.timeNs = clock.nsecsElapsed();
+	event.type = type;
+	event.pos = pos;
+	event.button = static_cast<quint8>(button);
+	event.buttons = static_cast<quint8>(buttons);
+	event.modifiers = static_cast<quint32>(modifiers);
+	event.wheelDelta = wheelDelta;
+	event.toolState = static_cast<int>(toolStates.size()) - 1;
+	events.push_back(event);
+}
+
+//-----------------------------------------
+//		*** File ***
+//-----------------------------------------
+
+// tool,<nastroje ToolFlag>,<posun>,<skalovanie>,<vypln>,<obrys ARGB>,<vypln ARGB>,<hrubka>,<spoj>,<koniec>,<styl vyplne>,<vrstva>,<zoom>
+// event,<cas ns>,<typ>,<x>,<y>,<tlacidlo>,<tlacidla>,<modifikatory>,<delta kolieska>
+// Za riadkom "scene" nasleduje snimka sceny (CSV) az po koniec suboru
+bool SessionRecording::save(const QString& filePath, QString* errorMessage) const
+{
+	QSaveFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly)) {
+		if (errorMessage) {
+			*errorMessage = file.errorString();
+		}
+		return false;
+	}
+
+	QByteArray bytes;
+	bytes.append(FileHeader);
+	bytes.append(QString("\ncanvas,%1,%2\n").arg(canvasSize.width()).arg(canvasSize.height()).toUtf8());
+
+	int writtenState = -1;
+	for (const Event& event : events) {
+		if (event.toolState != writtenState) {
+			const ToolState& state = toolStates[event.toolState];
+			bytes.append(QString("tool,%1,%2,%3,%4,%5,%6,%7,%8,%9,")
+				.arg(int(state.tools)).arg(int(state.move)).arg(int(state.scale)).arg(int(state.filling))
+				.arg(state.borderColor, 8, 16, QChar('0')).arg(state.fillingColor, 8, 16, QChar('0'))
+				.arg(state.strokeWidth).arg(state.join).arg(state.cap).toUtf8());
+			bytes.append(QString("%1,%2,%3\n").arg(state.fillStyle).arg(state.layer).arg(state.zoom, 0, 'g', 17).toUtf8());
+			writtenState = event.toolState;
+		}
+		bytes.append(QString("event,%1,%2,%3,%4,%5,%6,%7,%8\n")
+			.arg(event.timeNs).arg(eventTypeName(event.type)).arg(event.pos.x()).arg(event.pos.y())
+			.arg(event.button).arg(event.buttons).arg(event.modifiers).arg(event.wheelDelta).toUtf8());
+	}
+	bytes.append("scene\n");
+	bytes.append(scene);
+
+	if (file.write(bytes) != bytes.size() || !file.commit()) {
+		if (errorMessage) {
+			*errorMessage = file.errorString();
+		}
+		return false;
+	}
+	return true;
+}
+
+bool SessionRecording::load(const QString& filePath, QString* errorMessage)
+{
+	auto fail = [errorMessage](const QString& message) {
+		if (errorMessage) {
+			*errorMessage = message;
+		}
+		return false;
+	};
+
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return fail(file.errorString());
+	}
+	QByteArray bytes = file.readAll();
+
+	recording = false;
+	canvasSize = QSize();
+	scene.clear();
+	toolStates.clear();
+	events.clear();
+
+	int lineNumber = 0;
+	qsizetype position = 0;
+	while (position < bytes.size()) {
+		qsizetype end = bytes.indexOf('\n', position);
+		if (end < 0) {
+			end = bytes.size();
+		}
+		QString line = QString::fromUtf8(bytes.mid(position, end - position)).trimmed();
+		position = end + 1;
+		lineNumber++;
+
+		if (lineNumber == 1) {
+			if (line != FileHeader) {
+				return fail("Not an ImageViewer session file.");
+			}
+			continue;
+		}
+		if (line.isEmpty()) {
+			continue;
+		}
+		if (line == "scene") {
+			scene = bytes.mid(position);
+			break;
+		}
+
+		QStringList fields = line.split(',');
+		bool ok = true;
+		auto number = [&fields, &ok](int index) {
+			bool fieldOk = false;
+			qint64 value = index < fields.size() ? fields[index].toLongLong(&fieldOk) : 0;
+			ok = ok && fieldOk;
+			return value;
+		};
+
+		if (fields[0] == "canvas" && fields.size() == 3) {
+			canvasSize = QSize(static_cast<int>(number(1)), static_cast<int>(number(2)));
+		}
+		else if (fields[0] == "tool" && fields.size() == 13) {
+			ToolState state;
+			state.tools = static_cast<quint8>(number(1) & 0x1f);
+			state.move = number(2) != 0;
+			state.scale = number(3) != 0;
+			state.filling = number(4) != 0;
+			bool colorsOk = false, fillingOk = false, zoomOk = false;
+			state.borderColor = fields[5].toUInt(&colorsOk, 16);
+			state.fillingColor = fields[6].toUInt(&fillingOk, 16);
+			state.strokeWidth = static_cast<int>(number(7));
+			state.join = static_cast<int>(number(8));
+			state.cap = static_cast<int>(number(9));
+			state.fillStyle = static_cast<int>(number(10));
+			state.layer = static_cast<int>(number(11));
+			state.zoom = fields[12].toDouble(&zoomOk);
+			ok = ok && colorsOk && fillingOk && zoomOk && state.zoom > 0;
+			toolStates.push_back(state);
+		}
+		else if (fields[0] == "event" && fields.size() == 9 && !toolStates.empty()) {
+			Event event;
+			event.timeNs = number(1);
+			const char* const* name = std::find(EventTypeNames, EventTypeNames + EventTypeCount, fields[2]);
+			ok = ok && name != EventTypeNames + EventTypeCount;
+			event.type = static_cast<EventType>(name - EventTypeNames);
+			event.pos = QPoint(static_cast<int>(number(3)), static_cast<int>(number(4)));
+			event.button = static_cast<quint8>(number(5));
+			event.buttons = static_cast<quint8>(number(6));
+			event.modifiers = static_cast<quint32>(number(7));
+			event.wheelDelta = static_cast<int>(number(8));
+			event.toolState = static_cast<int>(toolStates.size()) - 1;
+			ok = ok && (events.empty() || event.timeNs >= events.back().timeNs);
+			events.push_back(event);
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			return fail(QString("Invalid session record on line %1.").arg(lineNumber));
+		}
+	}
+
+	if (!canvasSize.isValid() || canvasSize.isEmpty()) {
+		return fail("Session file has no canvas size.");
+	}
+	return true;
+}
+
+int SessionRecording::sceneShapes(std::vector<std::unique_ptr<Shape>>& shapes) const
+{
+	int skipped = 0;
+	QList<QByteArray> lines = scene.split('\n');
+	for (int i = 1; i < lines.size(); i++) {	// prvy riadok je hlavicka CSV
+		QString line = QString::fromUtf8(lines[i]).trimmed();
+		if (line.isEmpty()) {
+			continue;
+		}
+		Shape* shape = SceneFile::fromCsvRow(line);
+		if (shape == nullptr) {
+			skipped++;
+			continue;
+		}
+		shapes.emplace_back(shape);
+	}
+	return skipped;
+}
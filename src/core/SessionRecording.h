@@ -0,0 +1,90 @@
+#pragma once
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QPoint>
+#include <QRgb>
+#include <QSize>
+#include <QString>
+#include <memory>
+#include <vector>
+#include "representation.h"
+
+// Zaznam interakcie s editorom pre regresne testy latencie: vstupne udalosti nad platnom s casom od zaciatku
+// zaznamu, stav nastrojov pri kazdej udalosti a snimka sceny zo zaciatku. Prehravac (ImageViewer --replay)
+// obnovi scenu, podava udalosti editoru v povodnom tempe alebo bez cakania a meria cas spracovania a snimky.
+// Subor je textovy (jeden zaznam na riadok), nove stavy nastrojov sa zapisuju len pri zmene.
+class SessionRecording {
+public:
+	static constexpr const char* FileSuffix = "session";
+
+	enum EventType : quint8 { Press, Release, Move, Wheel, Enter, Leave, EventTypeCount };
+	enum ToolFlag : quint8 { LineTool = 1, CircleTool = 2, PolygonTool = 4, CurveTool = 8, RectangleTool = 16 };
+
+	// Vsetko z panela nastrojov, od coho zavisi spracovanie udalosti
+	struct ToolState {
+		quint8 tools = 0;		// ToolFlag, tlacidla nastrojov sa nevylucuju
+		bool move = false;
+		bool scale = false;
+		bool filling = false;
+		QRgb borderColor = 0xff0000ff;
+		QRgb fillingColor = 0xff0000ff;
+		int strokeWidth = 1;
+		int join = 0;			// indexy v comboboxoch panela Drawing
+		int cap = 0;
+		int fillStyle = 0;
+		int layer = -1;
+		double zoom = 1.0;
+
+		bool operator==(const ToolState& other) const;
+		bool operator!=(const ToolState& other) const { return !(*this == other); }
+	};
+
+	// Pozicia je v suradniciach widgetu (ako QMouseEvent::pos), delta je angleDelta().y() kolieska
+	struct Event {
+		qint64 timeNs = 0;
+		EventType type = Move;
+		QPoint pos;
+		quint8 button = 0;
+		quint8 buttons = 0;
+		quint32 modifiers = 0;
+		int wheelDelta = 0;
+		int toolState = 0;		// index do getToolStates()
+	};
+
+	// Percentily z presnych (zoradenych) vzoriek, v milisekundach
+	struct LatencySummary {
+		int count = 0;
+		double meanMs = 0.0;
+		double p50Ms = 0.0;
+		double p99Ms = 0.0;
+		double maxMs = 0.0;
+	};
+
+	static const char* eventTypeName(EventType type);
+	static LatencySummary summarize(std::vector<qint64> samplesNs);
+
+	//	Nahravanie
+	void start(const QSize& canvasSize, const QByteArray& sceneSnapshot);
+	void record(EventType type, const QPoint& pos, int button, int buttons, int modifiers, int wheelDelta, const ToolState& state);
+	void stop() { recording = false; }
+	bool isRecording() const { return recording; }
+
+	bool save(const QString& filePath, QString* errorMessage = nullptr) const;
+	bool load(const QString& filePath, QString* errorMessage = nullptr);
+
+	QSize getCanvasSize() const { return canvasSize; }
+	const std::vector<ToolState>& getToolStates() const { return toolStates; }
+	const std::vector<Event>& getEvents() const { return events; }
+	qint64 durationNs() const { return events.empty() ? 0 : events.back().timeNs; }
+
+	// Tvary snimky sceny v poradi suboru; vrati pocet riadkov, ktore sa nedali nacitat
+	int sceneShapes(std::vector<std::unique_ptr<Shape>>& shapes) const;
+
+private:
+	QSize canvasSize;
+	QByteArray scene;				// SceneFile::serialize na zaciatku zaznamu
+	std::vector<ToolState> toolStates;
+	std::vector<Event> events;
+	QElapsedTimer clock;
+	bool recording = false;
+};
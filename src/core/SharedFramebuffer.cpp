@@ -0,0 +1,324 @@
+#include "SharedFramebuffer.h"
+#include <cstring>
+#include <new>
+#include "RenderLog.h"
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Atomicke premenne v zdielanej pamati musia byt bez zamkov (adresa nezavisi od procesu)
+static_assert(std::atomic<quint64>::is_always_lock_free, "shared framebuffer needs lock-free 64-bit atomics");
+static_assert(std::atomic<quint32>::is_always_lock_free, "shared framebuffer needs lock-free 32-bit atomics");
+
+namespace {
+	const size_t PixelAlignment = 4096;
+
+	size_t alignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	bool fail(QString* errorMessage, const QString& message)
+	{
+		if (errorMessage) {
+			*errorMessage = message;
+		}
+		return false;
+	}
+}
+
+SharedFramebuffer::~SharedFramebuffer()
+{
+	close();
+}
+
+size_t SharedFramebuffer::headerBytes()
+{
+	return alignUp(sizeof(Header), PixelAlignment);
+}
+
+qint64 SharedFramebuffer::monotonicNs()
+{
+#ifdef Q_OS_UNIX
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<qint64>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
+//-----------------------------------------
+//		*** Mapping ***
+//-----------------------------------------
+
+bool SharedFramebuffer::map(int fd, size_t bytes, bool writable, QString* errorMessage)
+{
+#ifdef Q_OS_UNIX
+	void* address = ::mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (address == MAP_FAILED) {
+		return fail(errorMessage, QString("mmap failed: %1").arg(QString::fromLocal8Bit(std::strerror(errno))));
+	}
+	base = static_cast<uchar*>(address);
+	header = reinterpret_cast<Header*>(base);
+	mappedBytes = bytes;
+	return true;
+#else
+	Q_UNUSED(fd);
+	Q_UNUSED(bytes);
+	Q_UNUSED(writable);
+	return fail(errorMessage, "Shared-memory framebuffer requires POSIX shared memory.");
+#endif
+}
+
+void SharedFramebuffer::unmap()
+{
+#ifdef Q_OS_UNIX
+	if (base != nullptr) {
+		::munmap(base, mappedBytes);
+	}
+#endif
+	base = nullptr;
+	header = nullptr;
+	mappedBytes = 0;
+}
+
+void SharedFramebuffer::close()
+{
+	backImage = QImage();
+	backSlot = -1;
+	if (header == nullptr) {
+		return;
+	}
+
+#ifdef Q_OS_UNIX
+	if (writer) {
+		// Pripojeni citatelia si segment drzia, kym ho neodmapuju; novy s rovnakym menom uz bude iny
+		header->replaced.store(1, std::memory_order_release);
+		::shm_unlink(name.toLocal8Bit().constData());
+	}
+#endif
+	unmap();
+	writer = false;
+}
+
+//-----------------------------------------
+//		*** Writer ***
+//-----------------------------------------
+
+bool SharedFramebuffer::create(const QString& segmentName, const QSize& capacitySize, QString* errorMessage)
+{
+	close();
+#ifdef Q_OS_UNIX
+	if (!segmentName.startsWith('/') || segmentName.indexOf('/', 1) >= 0) {
+		return fail(errorMessage, QString("Invalid shared memory name %1 (expected /name).").arg(segmentName));
+	}
+
+	size_t capacity = alignUp(static_cast<size_t>(qMax(1, capacitySize.width())) * qMax(1, capacitySize.height()) * 4, PixelAlignment);
+	size_t bytes = headerBytes() + capacity * SlotCount;
+	QByteArray nativeName = segmentName.toLocal8Bit();
+
+	// Zvysok po spadnutom procese sa nahradi (O_EXCL po shm_unlink)
+	::shm_unlink(nativeName.constData());
+	int fd = ::shm_open(nativeName.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) {
+		return fail(errorMessage, QString("shm_open %1 failed: %2").arg(segmentName).arg(QString::fromLocal8Bit(std::strerror(errno))));
+	}
+	if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+		QString message = QString("Unable to size shared memory to %1 bytes: %2").arg(bytes).arg(QString::fromLocal8Bit(std::strerror(errno)));
+		::close(fd);
+		::shm_unlink(nativeName.constData());
+		return fail(errorMessage, message);
+	}
+	bool mapped = map(fd, bytes, true, errorMessage);
+	::close(fd);
+	if (!mapped) {
+		::shm_unlink(nativeName.constData());
+		return false;
+	}
+
+	name = segmentName;
+	writer = true;
+
+	// ftruncate vynuluje obsah; atomicke polia sa len skonstruuju na mieste
+	new (header) Header();
+	header->magic = Magic;
+	header->version = Version;
+	header->headerSize = static_cast<quint32>(headerBytes());
+	header->slotCount = SlotCount;
+	header->capacity = capacity;
+	header->replaced.store(0, std::memory_order_relaxed);
+	header->front.store(0, std::memory_order_relaxed);
+	for (int i = 0; i < SlotCount; i++) {
+		Slot& slot = header->buffers[i];
+		slot.sequence.store(0, std::memory_order_relaxed);
+		slot.offset = headerBytes() + capacity * i;
+	}
+	header->frameSequence.store(0, std::memory_order_release);
+
+	RENDER_LOG(Export, Info, "shared framebuffer created, {} slots of {} bytes", SlotCount, static_cast<qint64>(capacity));
+	return true;
+#else
+	Q_UNUSED(segmentName);
+	Q_UNUSED(capacitySize);
+	return fail(errorMessage, "Shared-memory framebuffer requires POSIX shared memory.");
+#endif
+}
+
+QImage* SharedFramebuffer::beginFrame(const QSize& size, QImage::Format format)
+{
+	if (!writer || size.isEmpty()) {
+		return nullptr;
+	}
+
+	// Len 32-bitove formaty (stride = 4 * sirka)
+	if (format != QImage::Format_ARGB32 && format != QImage::Format_RGB32 && format != QImage::Format_ARGB32_Premultiplied) {
+		return nullptr;
+	}
+	int stride = size.width() * 4;
+	quint64 bytes = static_cast<quint64>(stride) * size.height();
+
+	// Vacsi snimok: novy segment s rovnakym menom, stary dostane priznak Replaced
+	if (bytes > header->capacity) {
+		// Cisla snimkov pokracuju, citatel po znovupripojeni nevidi skok spat
+		QString segmentName = name;
+		quint64 published = header->frameSequence.load(std::memory_order_relaxed);
+		if (!create(segmentName, size)) {
+			RENDER_LOG(Export, Warning, "shared framebuffer resize to {}x{} failed", size.width(), size.height());
+			return nullptr;
+		}
+		header->frameSequence.store(published, std::memory_order_release);
+	}
+
+	backSlot = (header->front.load(std::memory_order_relaxed) + 1) % SlotCount;
+	Slot& slot = header->buffers[backSlot];
+
+	// Seqlock: neparne = zapis; release fence zaruci, ze citatel neuvidi nove pixely so starym cislom
+	slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.width = static_cast<quint32>(size.width());
+	slot.height = static_cast<quint32>(size.height());
+	slot.stride = static_cast<quint32>(stride);
+	slot.format = static_cast<quint32>(format);
+	backImage = QImage(base + slot.offset, size.width(), size.height(), stride, format);
+	return &backImage;
+}
+
+void SharedFramebuffer::publish()
+{
+	if (!writer || backSlot < 0) {
+		return;
+	}
+
+	Slot& slot = header->buffers[backSlot];
+	quint64 number = header->frameSequence.load(std::memory_order_relaxed) + 1;
+	slot.frameNumber = number;
+	slot.timestampNs = monotonicNs();
+	slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+	header->front.store(static_cast<quint32>(backSlot), std::memory_order_release);
+	header->frameSequence.store(number, std::memory_order_release);
+	backImage = QImage();
+	backSlot = -1;
+}
+
+bool SharedFramebuffer::publish(const QImage& image)
+{
+	if (image.isNull()) {
+		return false;
+	}
+	QImage source = image.format() == QImage::Format_ARGB32 || image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32_Premultiplied
+		? image : image.convertToFormat(QImage::Format_ARGB32);
+
+	QImage* target = beginFrame(source.size(), source.format());
+	if (target == nullptr) {
+		return false;
+	}
+	size_t rowBytes = static_cast<size_t>(source.width()) * 4;
+	for (int y = 0; y < source.height(); y++) {
+		std::memcpy(target->scanLine(y), source.constScanLine(y), rowBytes);
+	}
+	publish();
+	return true;
+}
+
+//-----------------------------------------
+//		*** Reader ***
+//-----------------------------------------
+
+bool SharedFramebuffer::open(const QString& segmentName, QString* errorMessage)
+{
+	close();
+#ifdef Q_OS_UNIX
+	QByteArray nativeName = segmentName.toLocal8Bit();
+	int fd = ::shm_open(nativeName.constData(), O_RDONLY, 0);
+	if (fd < 0) {
+		return fail(errorMessage, QString("shm_open %1 failed: %2").arg(segmentName).arg(QString::fromLocal8Bit(std::strerror(errno))));
+	}
+
+	struct stat info;
+	if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < headerBytes()) {
+		::close(fd);
+		return fail(errorMessage, QString("Shared memory %1 is not a framebuffer.").arg(segmentName));
+	}
+	bool mapped = map(fd, static_cast<size_t>(info.st_size), false, errorMessage);
+	::close(fd);
+	if (!mapped) {
+		return false;
+	}
+
+	if (header->magic != Magic || header->version != Version || header->slotCount != SlotCount
+		|| header->headerSize + header->capacity * SlotCount > mappedBytes) {
+		unmap();
+		return fail(errorMessage, QString("Shared memory %1 has an unsupported framebuffer layout.").arg(segmentName));
+	}
+	name = segmentName;
+	return true;
+#else
+	Q_UNUSED(segmentName);
+	return fail(errorMessage, "Shared-memory framebuffer requires POSIX shared memory.");
+#endif
+}
+
+bool SharedFramebuffer::acquire(Frame& frame) const
+{
+	if (header == nullptr || header->frameSequence.load(std::memory_order_acquire) == 0) {
+		return false;
+	}
+
+	int index = static_cast<int>(header->front.load(std::memory_order_acquire) % SlotCount);
+	const Slot& slot = header->buffers[index];
+	quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+	if (sequence & 1) {
+		return false;
+	}
+
+	frame.width = static_cast<int>(slot.width);
+	frame.height = static_cast<int>(slot.height);
+	frame.stride = static_cast<int>(slot.stride);
+	frame.format = static_cast<QImage::Format>(slot.format);
+	frame.number = slot.frameNumber;
+	frame.timestampNs = slot.timestampNs;
+	frame.slot = index;
+	frame.slotSequence = sequence;
+	// Po nahradeni segmentu este nemusi byt v novom zverejneny ziadny snimok
+	if (frame.number == 0 || slot.offset + static_cast<quint64>(frame.stride) * frame.height > mappedBytes) {
+		return false;
+	}
+	frame.bits = base + slot.offset;
+	return isValid(frame);
+}
+
+bool SharedFramebuffer::isValid(const Frame& frame) const
+{
+	if (header == nullptr || frame.slot < 0) {
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return header->buffers[frame.slot].sequence.load(std::memory_order_relaxed) == frame.slotSequence;
+}
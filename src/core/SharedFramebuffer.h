@@ -0,0 +1,105 @@
+#pragma once
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// Hotove snimky platna v POSIX zdielanej pamati (shm_open) pre ine procesy na tom istom stroji (kompozitor,
+// nahravanie). Citatel si segment namapuje a cita pixely priamo, bez kopie a kodovania.
+//
+// Segment: hlavicka (Header) a dva sloty po capacity bajtov. Zapisovatel kresli vzdy do slotu, ktory nie je
+// front, a po dokonceni ho zverejni (front, frameSequence). Kazdy slot ma vlastny seqlock: neparne sequence
+// = slot sa prave zapisuje. Citatel ma na spracovanie frontu cely dalsi snimok; isValid po spracovani povie,
+// ci ho zapisovatel medzitym neprepisal. Ked snimok nevojde do kapacity, zapisovatel segment nahradi vacsim
+// pod rovnakym menom a stary oznaci Replaced - citatel sa znova pripoji (open).
+// Len Unix; inde create/open vratia chybu.
+class SharedFramebuffer {
+public:
+	static constexpr quint32 Magic = 0x42465649;	// "IVFB"
+	static constexpr quint32 Version = 1;
+	static constexpr int SlotCount = 2;
+	static constexpr const char* DefaultName = "/imageviewer-canvas";
+
+	struct Slot {
+		std::atomic<quint64> sequence;		// seqlock, neparne = zapis prebieha
+		quint32 width;
+		quint32 height;
+		quint32 stride;						// bajty na riadok
+		quint32 format;						// QImage::Format (ARGB32 = 5: 0xAARRGGBB v poradi bajtov stroja)
+		quint64 frameNumber;
+		qint64 timestampNs;					// CLOCK_MONOTONIC pri zverejneni
+		quint64 offset;						// zaciatok pixelov od zaciatku segmentu
+	};
+
+	struct Header {
+		quint32 magic;
+		quint32 version;
+		quint32 headerSize;
+		quint32 slotCount;
+		quint64 capacity;					// bajty pixelov na slot
+		std::atomic<quint32> replaced;		// 1 = segment bol nahradeny novym s rovnakym menom
+		std::atomic<quint32> front;			// slot posledneho zverejneneho snimku
+		std::atomic<quint64> frameSequence;	// pocet zverejnenych snimkov, 0 = zatial ziadny
+		Slot buffers[SlotCount];
+	};
+
+	// Snimok namapovany u citatela; bits ukazuje priamo do zdielanej pamate
+	struct Frame {
+		const uchar* bits = nullptr;
+		int width = 0;
+		int height = 0;
+		int stride = 0;
+		QImage::Format format = QImage::Format_Invalid;
+		quint64 number = 0;
+		qint64 timestampNs = 0;
+		int slot = -1;
+		quint64 slotSequence = 0;
+
+		// QImage nad zdielanou pamatou bez kopie; plati len kym isValid
+		QImage image() const { return QImage(bits, width, height, stride, format); }
+	};
+
+	SharedFramebuffer() = default;
+	~SharedFramebuffer();
+	SharedFramebuffer(const SharedFramebuffer&) = delete;
+	SharedFramebuffer& operator=(const SharedFramebuffer&) = delete;
+
+	static qint64 monotonicNs();
+
+	//	Zapisovatel (vlastnik segmentu, pri zatvoreni ho odstrani)
+	bool create(const QString& name, const QSize& capacitySize, QString* errorMessage = nullptr);
+	// QImage nad volnym slotom; po nakresleni publish(). nullptr ak sa nepodari zvacsit segment
+	QImage* beginFrame(const QSize& size, QImage::Format format = QImage::Format_ARGB32);
+	void publish();
+	// Jedna kopia obrazu do volneho slotu a zverejnenie (editor, ktory kresli do vlastneho img)
+	bool publish(const QImage& image);
+
+	//	Citatel
+	bool open(const QString& name, QString* errorMessage = nullptr);
+	// Najnovsi zverejneny snimok; false ak ziadny nie je alebo sa slot prave prepisuje
+	bool acquire(Frame& frame) const;
+	// Po spracovani: true ak slot medzitym nebol prepisany (obsah bol konzistentny)
+	bool isValid(const Frame& frame) const;
+	bool wasReplaced() const { return header && header->replaced.load(std::memory_order_acquire) != 0; }
+	quint64 frameSequence() const { return header ? header->frameSequence.load(std::memory_order_acquire) : 0; }
+
+	void close();
+	bool isOpen() const { return header != nullptr; }
+	bool isWriter() const { return writer; }
+	QString getName() const { return name; }
+	quint64 getCapacity() const { return header ? header->capacity : 0; }
+
+private:
+	QString name;
+	Header* header = nullptr;
+	uchar* base = nullptr;
+	size_t mappedBytes = 0;
+	bool writer = false;
+	int backSlot = -1;			// slot rozpracovaneho snimku
+	QImage backImage;
+
+	static size_t headerBytes();
+	bool map(int fd, size_t bytes, bool writable, QString* errorMessage);
+	void unmap();
+};
@@ -0,0 +1,249 @@
+#include "Stroker.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	double dot(const QPointF& a, const QPointF& b)
+	{
+		return a.x() * b.x() + a.y() * b.y();
+	}
+
+	double cross(const QPointF& a, const QPointF& b)
+	{
+		return a.x() * b.y() - a.y() * b.x();
+	}
+
+	// Normala = smer otoceny o +90 stupnov
+	QPointF unitNormal(const QPointF& from, const QPointF& to)
+	{
+		QPointF d = to - from;
+		double length = std::sqrt(dot(d, d));
+		return QPointF(-d.y() / length, d.x() / length);
+	}
+
+	QPointF directionOf(const QPointF& normal)
+	{
+		return QPointF(normal.y(), -normal.x());
+	}
+}
+
+Stroker::Outline Stroker::stroke(const QVector<QPointF>& input, bool closed, double width, Qt::PenJoinStyle join, Qt::PenCapStyle cap)
+{
+	Outline outline;
+	double halfWidth = 0.5 * width;
+	QVector<QPointF> points = distinctPoints(input, closed);
+	if (halfWidth <= 0 || points.isEmpty()) {
+		return outline;
+	}
+
+	// Bod: len konce (round = kruh, square = stvorec)
+	if (points.size() == 1) {
+		QVector<QPointF> marker;
+		if (cap == Qt::RoundCap) {
+			addArc(marker, points[0], points[0] + QPointF(halfWidth, 0), halfWidth, 2 * M_PI);
+		}
+		else if (cap == Qt::SquareCap) {
+			marker << points[0] + QPointF(-halfWidth, -halfWidth) << points[0] + QPointF(halfWidth, -halfWidth)
+				<< points[0] + QPointF(halfWidth, halfWidth) << points[0] + QPointF(-halfWidth, halfWidth);
+		}
+		if (!marker.isEmpty()) {
+			outline.append(marker);
+		}
+		return outline;
+	}
+	closed = closed && points.size() > 2;
+
+	int segments = closed ? points.size() : points.size() - 1;
+	QVector<QPointF> normals(segments);
+	for (int i = 0; i < segments; i++) {
+		normals[i] = unitNormal(points[i], points[(i + 1) % points.size()]);
+	}
+
+	QVector<QPointF> left, right;
+	addSide(left, points, normals, closed, halfWidth, join);
+	addSide(right, points, normals, closed, -halfWidth, join);
+	std::reverse(right.begin(), right.end());
+
+	if (closed) {
+		outline.append(left);
+		outline.append(right);
+		return outline;
+	}
+
+	// Otvorena: lava strana, koniec, prava strana spat, zaciatok
+	QVector<QPointF> contour = left;
+	addCap(contour, points.last(), directionOf(normals.last()), normals.last(), halfWidth, cap);
+	contour += right;
+	addCap(contour, points.first(), -directionOf(normals.first()), -normals.first(), halfWidth, cap);
+	outline.append(contour);
+	return outline;
+}
+
+Stroker::Outline Stroker::strokeCircle(const QPointF& center, double radius, double width)
+{
+	Outline outline;
+	double halfWidth = 0.5 * width;
+	if (halfWidth <= 0) {
+		return outline;
+	}
+
+	double outer = radius + halfWidth;
+	QVector<QPointF> outerContour;
+	addArc(outerContour, center, center + QPointF(outer, 0), outer, 2 * M_PI);
+	outline.append(outerContour);
+
+	// Vnutorna kruznica opacne, vnutro ma vinutie 0
+	double inner = radius - halfWidth;
+	if (inner > 0) {
+		QVector<QPointF> innerContour;
+		addArc(innerContour, center, center + QPointF(inner, 0), inner, -2 * M_PI);
+		outline.append(innerContour);
+	}
+	return outline;
+}
+
+// Body krivky v t = i / steps (de Casteljau), bez zaokruhlenia na pixely
+QVector<QPointF> Stroker::flattenBezier(const QVector<QPoint>& controlPoints, int steps)
+{
+	QVector<QPointF> points;
+	if (controlPoints.isEmpty() || steps <= 0) {
+		return points;
+	}
+
+	points.reserve(steps + 1);
+	QVector<QPointF> temp(controlPoints.size());
+	for (int step = 0; step <= steps; step++) {
+		double t = static_cast<double>(step) / steps;
+		for (int i = 0; i < controlPoints.size(); i++) {
+			temp[i] = QPointF(controlPoints[i]);
+		}
+		for (int i = 1; i < temp.size(); i++) {
+			for (int j = 0; j < temp.size() - i; j++) {
+				temp[j] = temp[j] * (1 - t) + temp[j + 1] * t;
+			}
+		}
+		points.append(temp[0]);
+	}
+	return points;
+}
+
+double Stroker::extent(double width, Qt::PenJoinStyle join, Qt::PenCapStyle cap)
+{
+	double halfWidth = 0.5 * width;
+	double reach = halfWidth;
+	if (join == Qt::MiterJoin) {
+		reach = qMax(reach, halfWidth * MiterLimit);
+	}
+	if (cap == Qt::SquareCap) {
+		reach = qMax(reach, halfWidth * M_SQRT2);
+	}
+	return reach;
+}
+
+//-----------------------------------------
+//		*** Outline parts ***
+//-----------------------------------------
+
+// Bez po sebe iducich duplicit (nulove segmenty nemaju smer), pri uzavretej aj posledny == prvy
+QVector<QPointF> Stroker::distinctPoints(const QVector<QPointF>& points, bool closed)
+{
+	QVector<QPointF> result;
+	result.reserve(points.size());
+	for (const QPointF& point : points) {
+		if (result.isEmpty() || result.last() != point) {
+			result.append(point);
+		}
+	}
+	while (closed && result.size() > 1 && result.last() == result.first()) {
+		result.removeLast();
+	}
+	return result;
+}
+
+// Jedna strana tahu vo vzdialenosti offset od ciary (kladna = na strane normal)
+void Stroker::addSide(QVector<QPointF>& side, const QVector<QPointF>& points, const QVector<QPointF>& normals, bool closed, double offset, Qt::PenJoinStyle join)
+{
+	int segments = normals.size();
+	if (closed) {
+		for (int i = 0; i < segments; i++) {
+			addJoin(side, points[i], normals[(i + segments - 1) % segments], normals[i], offset, join);
+		}
+		return;
+	}
+
+	side.append(points.first() + normals.first() * offset);
+	for (int i = 1; i < segments; i++) {
+		addJoin(side, points[i], normals[i - 1], normals[i], offset, join);
+	}
+	side.append(points.last() + normals.last() * offset);
+}
+
+void Stroker::addJoin(QVector<QPointF>& side, const QPointF& pivot, const QPointF& normalIn, const QPointF& normalOut, double offset, Qt::PenJoinStyle join)
+{
+	QPointF from = pivot + normalIn * offset;
+	QPointF to = pivot + normalOut * offset;
+	double turn = cross(normalIn, normalOut);
+	double alignment = dot(normalIn, normalOut);
+
+	// Takmer rovno: staci jeden bod
+	if (std::fabs(turn) < 1e-9 && alignment > 0) {
+		side.append(to);
+		return;
+	}
+
+	// Zatacka smerom k tejto strane: vnutorna strana ide cez vrchol
+	bool outer = (turn * offset < 0) || (std::fabs(turn) < 1e-9 && offset > 0);
+	side.append(from);
+	if (!outer) {
+		side.append(pivot);
+		side.append(to);
+		return;
+	}
+
+	double halfWidth = std::fabs(offset);
+	if (join == Qt::RoundJoin) {
+		double sweep = std::atan2(cross(normalIn * offset, normalOut * offset), dot(normalIn * offset, normalOut * offset));
+		addArc(side, pivot, from, halfWidth, sweep);
+	}
+	else if (join == Qt::MiterJoin && alignment > -1.0 + 1e-9) {
+		// Hrot lezi v smere suctu normal, vo vzdialenosti halfWidth / cos(polovica uhla)
+		QPointF bisector = normalIn + normalOut;
+		double bisectorLength = std::sqrt(dot(bisector, bisector));
+		double cosHalf = bisectorLength / 2;
+		if (cosHalf > 0 && 1.0 / cosHalf <= MiterLimit) {
+			side.append(pivot + bisector * (offset / (bisectorLength * cosHalf)));
+		}
+	}
+	side.append(to);
+}
+
+// Koniec otvorenej ciary: z pravej strany na lavu cez smer direction (normal ukazuje na poslednu pridanu stranu)
+void Stroker::addCap(QVector<QPointF>& outline, const QPointF& end, const QPointF& direction, const QPointF& normal, double halfWidth, Qt::PenCapStyle cap)
+{
+	if (cap == Qt::SquareCap) {
+		outline.append(end + (normal + direction) * halfWidth);
+		outline.append(end + (direction - normal) * halfWidth);
+	}
+	else if (cap == Qt::RoundCap) {
+		addArc(outline, end, end + normal * halfWidth, halfWidth, -M_PI);
+	}
+}
+
+// Vnutorne body oblubu od bodu from okolo stredu o uhol sweep (koncove body pridava volajuci)
+void Stroker::addArc(QVector<QPointF>& outline, const QPointF& center, const QPointF& from, double radius, double sweep)
+{
+	int segments = arcSegments(radius, sweep);
+	double start = std::atan2(from.y() - center.y(), from.x() - center.x());
+	bool full = std::fabs(sweep) >= 2 * M_PI;
+	for (int i = full ? 0 : 1; i < segments; i++) {
+		double angle = start + sweep * i / segments;
+		outline.append(center + QPointF(std::cos(angle), std::sin(angle)) * radius);
+	}
+}
+
+int Stroker::arcSegments(double radius, double sweep)
+{
+	double step = (radius > ArcTolerance) ? 2 * std::acos(1 - ArcTolerance / radius) : M_PI / 2;
+	return qBound(2, static_cast<int>(std::ceil(std::fabs(sweep) / step)), 1024);
+}
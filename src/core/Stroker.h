@@ -0,0 +1,33 @@
+#pragma once
+#include <QPoint>
+#include <QPointF>
+#include <QVector>
+
+// Obrys hrubeho tahu: lomena ciara sa zmeni na uzavrete obrysy, ktore sa vyplnia nenulovym vinutim (CoverageAccumulator).
+// Jedna strana ide dopredu, druha spat. Na vonkajsej strane zalomenia je spoj (miter/bevel/round), vnutorna strana
+// prejde cez vrchol - vzniknute slucky maju rovnake vinutie ako tah, takze ich nenulove pravidlo zjednoti.
+// Otvorena ciara je jeden obrys s koncami (butt/square/round), uzavreta dva opacne orientovane (vonkajsi a vnutorny).
+class Stroker {
+public:
+	using Outline = QVector<QVector<QPointF>>;
+
+	// Nad tento pomer dlzky hrotu k polovici hrubky sa miter zmeni na bevel (ako SVG)
+	static constexpr double MiterLimit = 4.0;
+	// Najvacsia odchylka oblukov (round spoje, konce, kruznice) od presneho tvaru v pixeloch
+	static constexpr double ArcTolerance = 0.1;
+
+	static Outline stroke(const QVector<QPointF>& points, bool closed, double width, Qt::PenJoinStyle join, Qt::PenCapStyle cap);
+	static Outline strokeCircle(const QPointF& center, double radius, double width);
+	static QVector<QPointF> flattenBezier(const QVector<QPoint>& controlPoints, int steps);
+
+	// Najvacsia vzdialenost obrysu od bodov tvaru (hrot mitra, roh square konca)
+	static double extent(double width, Qt::PenJoinStyle join, Qt::PenCapStyle cap);
+
+private:
+	static QVector<QPointF> distinctPoints(const QVector<QPointF>& points, bool closed);
+	static void addSide(QVector<QPointF>& side, const QVector<QPointF>& points, const QVector<QPointF>& normals, bool closed, double offset, Qt::PenJoinStyle join);
+	static void addJoin(QVector<QPointF>& side, const QPointF& pivot, const QPointF& normalIn, const QPointF& normalOut, double offset, Qt::PenJoinStyle join);
+	static void addCap(QVector<QPointF>& outline, const QPointF& end, const QPointF& direction, const QPointF& normal, double halfWidth, Qt::PenCapStyle cap);
+	static void addArc(QVector<QPointF>& outline, const QPointF& center, const QPointF& from, double radius, double sweep);
+	static int arcSegments(double radius, double sweep);
+};
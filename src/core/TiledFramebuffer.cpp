@@ -0,0 +1,116 @@
+#include "TiledFramebuffer.h"
+#include <algorithm>
+#include <cstring>
+
+TiledFramebuffer::TiledFramebuffer(int width, int height, QRgb background)
+	: w(qMax(width, 0)), h(qMax(height, 0)), backgroundColor(background)
+{
+	columns = (w + TileMask) >> TileShift;
+	rows = (h + TileMask) >> TileShift;
+	tiles.resize(static_cast<size_t>(columns) * rows);
+}
+
+TiledFramebuffer::TiledFramebuffer(const TiledFramebuffer& other)
+	: w(other.w), h(other.h), columns(other.columns), rows(other.rows), allocated(other.allocated), backgroundColor(other.backgroundColor)
+{
+	tiles.resize(other.tiles.size());
+	for (size_t i = 0; i < tiles.size(); i++) {
+		if (other.tiles[i]) {
+			tiles[i].reset(new QRgb[TileSize * TileSize]);
+			std::memcpy(tiles[i].get(), other.tiles[i].get(), sizeof(QRgb) * TileSize * TileSize);
+		}
+	}
+}
+
+void TiledFramebuffer::clear(QRgb background)
+{
+	backgroundColor = background;
+	for (std::unique_ptr<QRgb[]>& t : tiles) {
+		t.reset();
+	}
+	allocated = 0;
+}
+
+QRgb* TiledFramebuffer::tileForWrite(int tx, int ty)
+{
+	std::unique_ptr<QRgb[]>& t = tiles[static_cast<size_t>(ty) * columns + tx];
+	if (!t) {
+		t.reset(new QRgb[TileSize * TileSize]);
+		std::fill(t.get(), t.get() + TileSize * TileSize, backgroundColor);
+		allocated++;
+	}
+	return t.get();
+}
+
+QRect TiledFramebuffer::tileRect(int tx, int ty) const
+{
+	int x = tx << TileShift;
+	int y = ty << TileShift;
+	return QRect(x, y, qMin(TileSize, w - x), qMin(TileSize, h - y));
+}
+
+QRgb TiledFramebuffer::pixel(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= w || y >= h) {
+		return backgroundColor;
+	}
+
+	const QRgb* t = tile(x >> TileShift, y >> TileShift);
+	return t ? t[((y & TileMask) << TileShift) + (x & TileMask)] : backgroundColor;
+}
+
+void TiledFramebuffer::fillSpan(int y, int x0, int x1, QRgb color)
+{
+	if (y < 0 || y >= h) {
+		return;
+	}
+	x0 = qMax(x0, 0);
+	x1 = qMin(x1, w - 1);
+
+	int ty = y >> TileShift;
+	int rowOffset = (y & TileMask) << TileShift;
+	while (x0 <= x1) {
+		int tx = x0 >> TileShift;
+		int tileEnd = qMin(x1, (tx << TileShift) + TileMask);
+		QRgb* t = tileForWrite(tx, ty) + rowOffset;
+		std::fill(t + (x0 & TileMask), t + (tileEnd & TileMask) + 1, color);
+		x0 = tileEnd + 1;
+	}
+}
+
+void TiledFramebuffer::writeSpan(int y, int x0, int x1, const QRgb* colors)
+{
+	int ty = y >> TileShift;
+	int rowOffset = (y & TileMask) << TileShift;
+	while (x0 <= x1) {
+		int tx = x0 >> TileShift;
+		int tileEnd = qMin(x1, (tx << TileShift) + TileMask);
+		QRgb* t = tileForWrite(tx, ty) + rowOffset;
+		std::copy(colors, colors + (tileEnd - x0 + 1), t + (x0 & TileMask));
+		colors += tileEnd - x0 + 1;
+		x0 = tileEnd + 1;
+	}
+}
+
+void TiledFramebuffer::readRow(int y, QRgb* out) const
+{
+	int ty = y >> TileShift;
+	int rowOffset = (y & TileMask) << TileShift;
+	for (int tx = 0; tx < columns; tx++) {
+		int x = tx << TileShift;
+		int count = qMin(TileSize, w - x);
+		const QRgb* t = tile(tx, ty);
+		if (t) {
+			std::memcpy(out + x, t + rowOffset, sizeof(QRgb) * count);
+		}
+		else {
+			std::fill(out + x, out + x + count, backgroundColor);
+		}
+	}
+}
+
+qint64 TiledFramebuffer::memoryUsage() const
+{
+	return static_cast<qint64>(allocated) * TileSize * TileSize * sizeof(QRgb)
+		+ static_cast<qint64>(tiles.size()) * sizeof(std::unique_ptr<QRgb[]>);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <QColor>
+#include <QSize>
+#include <QRect>
+#include <memory>
+#include <vector>
+
+// Riedky framebuffer rozdeleny na dlazdice TileSize x TileSize (ARGB32).
+// Dlazdica sa alokuje az pri prvom zapise, nedotknute dlazdice maju implicitne farbu pozadia,
+// takze pamat rastie s nakreslenym obsahom a nie s plochou platna.
+class TiledFramebuffer {
+public:
+	static constexpr int TileShift = 6;
+	static constexpr int TileSize = 1 << TileShift;
+	static constexpr int TileMask = TileSize - 1;
+
+	// Platna vacsie ako tento pocet pixelov editor a davkovy renderer drzia v dlazdiciach
+	static constexpr qint64 DenseLimit = 4096LL * 4096LL;
+	static bool preferredFor(int width, int height) { return static_cast<qint64>(width) * height > DenseLimit; }
+
+	TiledFramebuffer(int width, int height, QRgb background = 0xffffffff);
+	TiledFramebuffer(const TiledFramebuffer& other);
+	TiledFramebuffer& operator=(const TiledFramebuffer&) = delete;
+
+	int width() const { return w; }
+	int height() const { return h; }
+	QSize size() const { return QSize(w, h); }
+	int tilesX() const { return columns; }
+	int tilesY() const { return rows; }
+	QRgb background() const { return backgroundColor; }
+
+	void clear() { clear(backgroundColor); }
+	void clear(QRgb background);
+
+	// nullptr znamena, ze dlazdica nebola alokovana a cela ma farbu pozadia
+	const QRgb* tile(int tx, int ty) const { return tiles[static_cast<size_t>(ty) * columns + tx].get(); }
+	QRgb* tileForWrite(int tx, int ty);
+	QRect tileRect(int tx, int ty) const;
+
+	void setPixel(int x, int y, QRgb color) {
+		if (x < 0 || y < 0 || x >= w || y >= h) {
+			return;
+		}
+		tileForWrite(x >> TileShift, y >> TileShift)[((y & TileMask) << TileShift) + (x & TileMask)] = color;
+	}
+	QRgb pixel(int x, int y) const;
+
+	void fillSpan(int y, int x0, int x1, QRgb color);	// x0..x1 vratane, orezane na platno
+	void writeSpan(int y, int x0, int x1, const QRgb* colors);	// colors[0] patri pixelu x0, bez orezania
+	void readRow(int y, QRgb* out) const;				// cely riadok, pre export po riadkoch
+
+	int allocatedTiles() const { return allocated; }
+	qint64 memoryUsage() const;
+
+private:
+	int w = 0;
+	int h = 0;
+	int columns = 0;
+	int rows = 0;
+	int allocated = 0;
+	QRgb backgroundColor = 0xffffffff;
+	std::vector<std::unique_ptr<QRgb[]>> tiles;
+};
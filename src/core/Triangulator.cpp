@@ -0,0 +1,213 @@
+#include "Triangulator.h"
+
+namespace {
+	qint64 cross(const QPoint& o, const QPoint& a, const QPoint& b)
+	{
+		return static_cast<qint64>(a.x() - o.x()) * (b.y() - o.y()) - static_cast<qint64>(a.y() - o.y()) * (b.x() - o.x());
+	}
+
+	int sign(qint64 value)
+	{
+		return (value > 0) - (value < 0);
+	}
+
+	bool onSegment(const QPoint& p, const QPoint& a, const QPoint& b)
+	{
+		return qMin(a.x(), b.x()) <= p.x() && p.x() <= qMax(a.x(), b.x()) && qMin(a.y(), b.y()) <= p.y() && p.y() <= qMax(a.y(), b.y());
+	}
+
+	// Usecky ab a cd sa pretinaju alebo dotykaju
+	bool segmentsIntersect(const QPoint& a, const QPoint& b, const QPoint& c, const QPoint& d)
+	{
+		int d1 = sign(cross(c, d, a));
+		int d2 = sign(cross(c, d, b));
+		int d3 = sign(cross(a, b, c));
+		int d4 = sign(cross(a, b, d));
+		if (d1 * d2 < 0 && d3 * d4 < 0) {
+			return true;
+		}
+		return (d1 == 0 && onSegment(a, c, d)) || (d2 == 0 && onSegment(b, c, d))
+			|| (d3 == 0 && onSegment(c, a, b)) || (d4 == 0 && onSegment(d, a, b));
+	}
+
+	// Bod v trojuholniku abc vratane hranice (orientation = znamienko plochy polygonu)
+	bool insideTriangle(const QPoint& p, const QPoint& a, const QPoint& b, const QPoint& c, qint64 orientation)
+	{
+		return cross(a, b, p) * orientation >= 0 && cross(b, c, p) * orientation >= 0 && cross(c, a, p) * orientation >= 0;
+	}
+}
+
+QVector<int> Triangulator::triangulate(const QVector<QPoint>& points)
+{
+	QVector<int> polygon = distinctVertices(points);
+	if (polygon.size() < 3) {
+		return QVector<int>();
+	}
+
+	qint64 area2 = signedArea2(points, polygon);
+	if (area2 == 0) {
+		return QVector<int>();
+	}
+	qint64 orientation = sign(area2);
+
+	// Rychla cesta: trojuholnik, konvexny polygon (obdlznik, pravidelne n-uholniky)
+	if (polygon.size() == 3 || isConvex(points, polygon, orientation)) {
+		return fan(points, polygon);
+	}
+
+	if (polygon.size() > MaxEarClippingVertices || !isSimple(points, polygon)) {
+		return QVector<int>();
+	}
+	return clipEars(points, polygon, orientation);
+}
+
+// Indexy vrcholov bez po sebe iducich duplicit (aj posledny == prvy)
+QVector<int> Triangulator::distinctVertices(const QVector<QPoint>& points)
+{
+	QVector<int> polygon;
+	polygon.reserve(points.size());
+	for (int i = 0; i < points.size(); i++) {
+		if (polygon.isEmpty() || points[polygon.last()] != points[i]) {
+			polygon.append(i);
+		}
+	}
+	while (polygon.size() > 1 && points[polygon.last()] == points[polygon.first()]) {
+		polygon.removeLast();
+	}
+	return polygon;
+}
+
+qint64 Triangulator::signedArea2(const QVector<QPoint>& points, const QVector<int>& polygon)
+{
+	qint64 area2 = 0;
+	for (int i = 0; i < polygon.size(); i++) {
+		const QPoint& a = points[polygon[i]];
+		const QPoint& b = points[polygon[(i + 1) % polygon.size()]];
+		area2 += static_cast<qint64>(a.x()) * b.y() - static_cast<qint64>(b.x()) * a.y();
+	}
+	return area2;
+}
+
+// Vsetky otocenia v smere orientacie a smer hran v x aj y sa meni najviac dvakrat (inak je to napr. hviezda)
+bool Triangulator::isConvex(const QVector<QPoint>& points, const QVector<int>& polygon, qint64 orientation)
+{
+	int n = polygon.size();
+	int dxChanges = 0, dyChanges = 0;
+	int firstDx = 0, firstDy = 0, lastDx = 0, lastDy = 0;
+
+	for (int i = 0; i < n; i++) {
+		const QPoint& a = points[polygon[i]];
+		const QPoint& b = points[polygon[(i + 1) % n]];
+		const QPoint& c = points[polygon[(i + 2) % n]];
+		if (cross(a, b, c) * orientation < 0) {
+			return false;
+		}
+
+		int dx = sign(b.x() - a.x());
+		int dy = sign(b.y() - a.y());
+		if (dx != 0) {
+			dxChanges += (lastDx != 0 && dx != lastDx);
+			lastDx = dx;
+			firstDx = firstDx != 0 ? firstDx : dx;
+		}
+		if (dy != 0) {
+			dyChanges += (lastDy != 0 && dy != lastDy);
+			lastDy = dy;
+			firstDy = firstDy != 0 ? firstDy : dy;
+		}
+	}
+	dxChanges += (lastDx != firstDx);
+	dyChanges += (lastDy != firstDy);
+	return dxChanges <= 2 && dyChanges <= 2;
+}
+
+// Ziadne dve nesusedne hrany sa nedotykaju, O(n^2)
+bool Triangulator::isSimple(const QVector<QPoint>& points, const QVector<int>& polygon)
+{
+	int n = polygon.size();
+	for (int i = 0; i < n; i++) {
+		const QPoint& a = points[polygon[i]];
+		const QPoint& b = points[polygon[(i + 1) % n]];
+		for (int j = i + 2; j < n; j++) {
+			if (i == 0 && j == n - 1) {
+				continue;	// prva a posledna hrana su susedne
+			}
+			if (segmentsIntersect(a, b, points[polygon[j]], points[polygon[(j + 1) % n]])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+QVector<int> Triangulator::fan(const QVector<QPoint>& points, const QVector<int>& polygon)
+{
+	QVector<int> triangles;
+	triangles.reserve(3 * (polygon.size() - 2));
+	for (int i = 1; i + 1 < polygon.size(); i++) {
+		// Kolinearne vrcholy by dali trojuholniky s nulovou plochou
+		if (cross(points[polygon[0]], points[polygon[i]], points[polygon[i + 1]]) == 0) {
+			continue;
+		}
+		triangles << polygon[0] << polygon[i] << polygon[i + 1];
+	}
+	return triangles;
+}
+
+QVector<int> Triangulator::clipEars(const QVector<QPoint>& points, const QVector<int>& polygon, qint64 orientation)
+{
+	int n = polygon.size();
+	QVector<int> prev(n), next(n);
+	for (int i = 0; i < n; i++) {
+		prev[i] = (i + n - 1) % n;
+		next[i] = (i + 1) % n;
+	}
+	auto point = [&](int i) -> const QPoint& { return points[polygon[i]]; };
+	auto turn = [&](int i) { return cross(point(prev[i]), point(i), point(next[i])) * orientation; };
+
+	QVector<int> triangles;
+	triangles.reserve(3 * (n - 2));
+
+	int remaining = n;
+	int current = 0;
+	int misses = 0;
+	while (remaining > 3) {
+		int a = prev[current];
+		int c = next[current];
+		qint64 currentTurn = turn(current);
+
+		bool clip = (currentTurn == 0);		// kolinearny vrchol ide prec bez trojuholnika
+		if (currentTurn > 0) {
+			// Ucho: v trojuholniku a-current-c nelezi ziadny nekonvexny vrchol
+			clip = true;
+			for (int v = next[c]; v != a; v = next[v]) {
+				if (turn(v) <= 0 && insideTriangle(point(v), point(a), point(current), point(c), orientation)) {
+					clip = false;
+					break;
+				}
+			}
+			if (clip) {
+				triangles << polygon[a] << polygon[current] << polygon[c];
+			}
+		}
+
+		if (!clip) {
+			current = c;
+			if (++misses > remaining) {
+				return QVector<int>();	// ziadne ucho, polygon nie je jednoduchy
+			}
+			continue;
+		}
+
+		next[a] = c;
+		prev[c] = a;
+		remaining--;
+		misses = 0;
+		current = a;
+	}
+
+	if (remaining == 3 && cross(point(prev[current]), point(current), point(next[current])) != 0) {
+		triangles << polygon[prev[current]] << polygon[current] << polygon[next[current]];
+	}
+	return triangles;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <QPoint>
+#include <QVector>
+
+// Triangulacia jednoducheho polygonu pre trojuholnikovu cestu vyplne.
+// Vysledok su trojice indexov do povodneho zoznamu bodov, takze plati aj pre body posunute/zoomovane pohladom.
+// Trojuholnik a konvexny polygon idu rychlou cestou (vejar), ostatne orezavanim usi (ear clipping).
+// Samopretinajuci sa alebo degenerovany polygon vrati prazdny zoznam, taky sa vyplna scanline algoritmom.
+class Triangulator {
+public:
+	// Nad tento pocet vrcholov sa nekonvexne polygony netrianguluju (orezavanie usi je O(n^2))
+	static constexpr int MaxEarClippingVertices = 1024;
+
+	static QVector<int> triangulate(const QVector<QPoint>& points);
+
+private:
+	static QVector<int> distinctVertices(const QVector<QPoint>& points);
+	static qint64 signedArea2(const QVector<QPoint>& points, const QVector<int>& polygon);
+	static bool isConvex(const QVector<QPoint>& points, const QVector<int>& polygon, qint64 orientation);
+	static bool isSimple(const QVector<QPoint>& points, const QVector<int>& polygon);
+	static QVector<int> fan(const QVector<QPoint>& points, const QVector<int>& polygon);
+	static QVector<int> clipEars(const QVector<QPoint>& points, const QVector<int>& polygon, qint64 orientation);
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <QColor>
+#include <QPoint>
+#include <QPointF>
+#include <QVector>
+#include <array>
+#include <memory>
+#include <variant>
+
+class FillShader;
+
+class Shape {
+public:
+    enum ShapeType { LINE, RECTANGLE, POLYGON, CIRCLE, BEZIER_CURVE };
+
+    Shape(ShapeType type, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor)
+        : zBufferPosition(zBufferPosition), type(type), isFilled(isFilled), borderValid(false), fillingValid(false), strokeValid(false)
+    {
+        setBorderColor(borderColor);
+        setFillingColor(fillingColor);
+    }
+    
+    virtual ~Shape() {}
+
+    ShapeType getType() const { return static_cast<ShapeType>(type); }
+    int getZBufferPosition() const { return zBufferPosition; }
+    bool getIsFilled() const { return isFilled; }
+    QColor getBorderColor() const { return borderValid ? QColor::fromRgba(borderRgba) : QColor(); }
+    QColor getFillingColor() const { return fillingValid ? QColor::fromRgba(fillingRgba) : QColor(); }
+    // Farby ulozene ako 32-bit ARGB; neplatna farba (nekresli sa) ma vlastny priznak
+    QRgb getBorderRgba() const { return borderRgba; }
+    QRgb getFillingRgba() const { return fillingRgba; }
+    bool hasBorderColor() const { return borderValid; }
+    bool hasFillingColor() const { return fillingValid; }
+
+    void setZBufferPosition(int zBufferPos) { zBufferPosition = zBufferPos; }
+    void setBorderColor(const QColor& color) { borderValid = color.isValid(); borderRgba = borderValid ? color.rgba() : 0; }
+    void setFillingColor(const QColor& color) { fillingValid = color.isValid(); fillingRgba = fillingValid ? color.rgba() : 0; }
+
+    // Kopia bodov cez zaklad; kod pre konkretny typ cita body bez kopie cez getPointArray() triedy
+    virtual QVector<QPoint> getPoints() { return { QPoint(), QPoint() }; }
+    virtual void setPoints(const QVector<QPoint>& points) {}
+    virtual void addPoint(QPoint point) {}
+
+    // Hrubka obrysu v pixeloch dokumentu; 1 = tenky obrys (Bresenham), hrubsi sa vyplni ako obrys tahu
+    int getStrokeWidth() const { return strokeWidth; }
+    Qt::PenJoinStyle getJoinStyle() const { return static_cast<Qt::PenJoinStyle>(joinStyle); }
+    Qt::PenCapStyle getCapStyle() const { return static_cast<Qt::PenCapStyle>(capStyle); }
+    bool hasThickStroke() const { return strokeWidth > 1; }
+    void setStrokeWidth(int width) { strokeWidth = qMax(1, width); invalidateStroke(); }
+    void setJoinStyle(Qt::PenJoinStyle join) { joinStyle = static_cast<quint16>(join); invalidateStroke(); }
+    void setCapStyle(Qt::PenCapStyle cap) { capStyle = static_cast<quint16>(cap); invalidateStroke(); }
+
+    // Obrys hrubeho tahu v suradniciach dokumentu (vyplna sa nenulovym vinutim), plati kym sa body nezmenia
+    bool hasStrokeOutline() const { return strokeValid; }
+    const QVector<QVector<QPointF>>& getStrokeOutline() const { return strokeOutline; }
+    void setStrokeOutline(const QVector<QVector<QPointF>>& outline) { strokeOutline = outline; strokeValid = true; }
+    void invalidateStroke() { strokeOutline.clear(); strokeValid = false; }
+
+    // Gradient alebo vzor vyplne namiesto fillingColor (nemenny, kopie tvaru ho zdielaju); nullptr = jedna farba.
+    // Suradnice shadera su relativne k prvemu bodu tvaru, posun tvaru ho netreba menit
+    const std::shared_ptr<const FillShader>& getFillShader() const { return fillShader; }
+    void setFillShader(std::shared_ptr<const FillShader> shader) { fillShader = std::move(shader); }
+
+protected:
+    // Priznaky a typ v jednom slove, farby ako ARGB (QColor ma 16 bajtov): zaklad ma 24 bajtov okrem vtable,
+    // cache tahu a shadera
+    QRgb borderRgba = 0;
+    QRgb fillingRgba = 0;
+    int zBufferPosition;
+    quint32 type : 3;
+    quint32 isFilled : 1;
+    quint32 borderValid : 1;
+    quint32 fillingValid : 1;
+    quint32 strokeValid : 1;
+    quint16 joinStyle = Qt::MiterJoin;
+    quint16 capStyle = Qt::FlatCap;
+    int strokeWidth = 1;
+
+    QVector<QVector<QPointF>> strokeOutline;
+    std::shared_ptr<const FillShader> fillShader;
+};
+
+class Line final : public Shape {
+public:
+    Line(const QPoint& p1, const QPoint& p2, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor)
+        : Shape(Shape::LINE, zBufferPosition, isFilled, borderColor, fillingColor), ends{ p1, p2 } {}
+
+    ~Line() override {}
+
+    QVector<QPoint> getPoints() override {
+        return { ends[0], ends[1] };
+    }
+    const std::array<QPoint, 2>& getPointArray() const { return ends; }
+
+    void setPoints(const QVector<QPoint>& points) override {
+        if (points.size() >= 2) {
+            ends[0] = points[0];
+            ends[1] = points[1];
+            invalidateStroke();
+        }
+    }
+
+private:
+    std::array<QPoint, 2> ends;
+};
+
+class MyRectangle final : public Shape {
+public:
+    MyRectangle(const QPoint& p1, const QPoint& p2, const QPoint& p3, const QPoint& p4, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor)
+        : Shape(Shape::RECTANGLE, zBufferPosition, isFilled, borderColor, fillingColor), corners{ p1, p2, p3, p4 } {}
+
+    ~MyRectangle() override {}
+
+    QVector<QPoint> getPoints() override {
+        return { corners[0], corners[1], corners[2], corners[3] };
+    }
+    const std::array<QPoint, 4>& getPointArray() const { return corners; }
+
+    void setPoints(const QVector<QPoint>& points) override {
+        if (points.size() >= 2) {
+            corners[0] = points[0];
+            corners[1] = points[1];
+            corners[2] = points[2];
+            corners[3] = points[3];
+            invalidateStroke();
+        }
+    }
+
+private:
+    std::array<QPoint, 4> corners;
+};
+
+class MyPolygon final : public Shape {
+public:
+    MyPolygon(const QVector<QPoint>& points, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor)
+        : Shape(Shape::POLYGON, zBufferPosition, isFilled, borderColor, fillingColor), points(points) {}
+
+    ~MyPolygon() override {}
+
+    QVector<QPoint> getPoints() override {
+        return points;
+    }
+    const QVector<QPoint>& getPointArray() const { return points; }
+
+    void setPoints(const QVector<QPoint>& newPoints) override {
+        points = newPoints;
+        invalidateTriangles();
+        invalidateStroke();
+    }
+
+    void addPoint(QPoint point) override {
+        points.append(point);
+        invalidateTriangles();
+        invalidateStroke();
+    }
+
+    // Triangulacia vyplne (trojice indexov do points), plati kym sa body nezmenia; prazdna = vyplna sa scanline
+    bool hasTriangles() const { return trianglesValid; }
+    const QVector<int>& getTriangles() const { return triangles; }
+    void setTriangles(const QVector<int>& indices) { triangles = indices; trianglesValid = true; }
+    void invalidateTriangles() { triangles.clear(); trianglesValid = false; }
+
+    // Pravidlo vyplne samopretinajuceho sa polygonu (scanline vyplna parne-neparne)
+    Qt::FillRule getFillRule() const { return fillRule; }
+    void setFillRule(Qt::FillRule rule) { fillRule = rule; }
+
+private:
+    QVector<QPoint> points;
+    QVector<int> triangles;
+    bool trianglesValid = false;
+    Qt::FillRule fillRule = Qt::OddEvenFill;
+};
+
+class Circle final : public Shape {
+public:
+    Circle(const QPoint& center, const QPoint& edge, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor)
+        : Shape(Shape::CIRCLE, zBufferPosition, isFilled, borderColor, fillingColor), centerAndEdge{ center, edge } {}
+
+    ~Circle() override {}
+
+    QVector<QPoint> getPoints() override {
+        return { centerAndEdge[0], centerAndEdge[1] };
+    }
+    const std::array<QPoint, 2>& getPointArray() const { return centerAndEdge; }
+
+    void setPoints(const QVector<QPoint>& points) override {
+        if (points.size() >= 2) {
+            centerAndEdge[0] = points[0];
+            centerAndEdge[1] = points[1];
+            invalidateStroke();
+        }
+    }
+
+private:
+    std::array<QPoint, 2> centerAndEdge;
+};
+
+class BezierCurve final : public Shape {
+public:
+    BezierCurve(const QVector<QPoint>& controlPoints, int zBufferPosition, bool isFilled, const QColor& borderColor, const QColor& fillingColor)
+        : Shape(Shape::BEZIER_CURVE, zBufferPosition, isFilled, borderColor, fillingColor), controlPoints(controlPoints) {}
+
+    ~BezierCurve() override {}
+
+    QVector<QPoint> getPoints() override {
+        return controlPoints;
+    }
+    const QVector<QPoint>& getPointArray() const { return controlPoints; }
+
+    void setPoints(const QVector<QPoint>& points) override {
+        controlPoints = points;
+        invalidateStroke();
+    }
+
+    void addPoint(QPoint point) override {
+        controlPoints.append(point);
+        invalidateStroke();
+    }
+
+private:
+    QVector<QPoint> controlPoints;
+};
+
+// Tvary ako hodnoty: zoznam ShapeVariant lezi v pamati suvisle a std::visit vola kod konkretneho typu
+// bez virtualnych volani (triedy su final, kompilator ich moze inlinovat). Editor drzi tvary na halde
+// (historia a zoznam vrstiev potrebuju stabilne adresy), davkove kreslenie ide cez hodnoty.
+using ShapeVariant = std::variant<Line, MyRectangle, MyPolygon, Circle, BezierCurve>;
+
+// Jedno rozhodnutie podla typu pre tvar za referenciou na zaklad; visitor dostane konkretny typ
+template <typename Visitor>
+decltype(auto) visitShape(Shape& shape, Visitor&& visitor)
+{
+    switch (shape.getType()) {
+    case Shape::LINE:
+        return visitor(static_cast<Line&>(shape));
+    case Shape::RECTANGLE:
+        return visitor(static_cast<MyRectangle&>(shape));
+    case Shape::POLYGON:
+        return visitor(static_cast<MyPolygon&>(shape));
+    case Shape::CIRCLE:
+        return visitor(static_cast<Circle&>(shape));
+    case Shape::BEZIER_CURVE:
+    default:
+        return visitor(static_cast<BezierCurve&>(shape));
+    }
+}
+
+inline Shape& shapeOf(ShapeVariant& shape)
+{
+    return std::visit([](Shape& base) -> Shape& { return base; }, shape);
+}
+
+// Kopia tvaru z haldy ako hodnota (body v QVector su implicitne zdielane, kopia je lacna)
+inline ShapeVariant toShapeVariant(Shape& shape)
+{
+    return visitShape(shape, [](auto& typed) { return ShapeVariant(typed); });
+}
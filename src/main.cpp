@@ -1,5 +1,6 @@
 #include "ImageViewer.h"
 #include <QtWidgets/QApplication>
+#include <cstring>
 
 int main(int argc, char* argv[])
 {
@@ -8,8 +9,39 @@ int main(int argc, char* argv[])
 	QCoreApplication::setOrganizationName("MPM");
 	QCoreApplication::setApplicationName("ImageViewer");
 
+	// Prehravanie relacie bezi bez okna, ak platforma nie je zadana inak
+	for (int i = 1; i < argc; i++) {
+		if (std::strncmp(argv[i], "--replay", 8) == 0 && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+			qputenv("QT_QPA_PLATFORM", "offscreen");
+		}
+	}
+
 	QApplication a(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("ImageViewer 2D editor.");
+	parser.addHelpOption();
+	QCommandLineOption replayOption("replay", "Replay a recorded session (Image > Record session) headless and print per-event latency.", "session");
+	QCommandLineOption flatOutOption("flat-out", "Replay events back to back instead of at the recorded rate.");
+	QCommandLineOption budgetOption("budget-p99", "Exit with code 1 if the p99 frame latency exceeds this many milliseconds.", "ms");
+	QCommandLineOption eventsOption("events", "Write per-event processing and frame times as CSV.", "file");
+	parser.addOption(replayOption);
+	parser.addOption(flatOutOption);
+	parser.addOption(budgetOption);
+	parser.addOption(eventsOption);
+	parser.process(a);
+
 	ImageViewer w;
 	w.show();
+
+	if (parser.isSet(replayOption)) {
+		bool budgetOk = true;
+		double budget = parser.isSet(budgetOption) ? parser.value(budgetOption).toDouble(&budgetOk) : 0.0;
+		if (!budgetOk || budget < 0) {
+			QTextStream(stderr) << "Invalid latency budget: " << parser.value(budgetOption) << "\n";
+			return 2;
+		}
+		return w.replaySession(parser.value(replayOption), !parser.isSet(flatOutOption), budget, parser.value(eventsOption));
+	}
 	return a.exec();
 }
@@ -0,0 +1,135 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLocale>
+#include <QTextStream>
+#include <QThread>
+#include "SharedFramebuffer.h"
+
+// Citatel zdielaneho framebufferu (ImageViewer, RenderBatch --shm): pripoji sa k segmentu, vypisuje prijate
+// snimky s oneskorenim od zverejnenia a na konci suhrn (prijate, preskocene, roztrhnute). Pixely sa citaju
+// priamo zo zdielanej pamate; --save ulozi posledny konzistentny snimok.
+
+int main(int argc, char* argv[])
+{
+	QLocale::setDefault(QLocale::c());
+
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("MPM");
+	QCoreApplication::setApplicationName("FrameTap");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Reads frames published in a shared-memory framebuffer.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("name", QString("Shared memory name (default %1).").arg(SharedFramebuffer::DefaultName), "[name]");
+
+	QCommandLineOption framesOption(QStringList() << "n" << "frames", "Stop after N received frames (default: until timeout).", "count", "0");
+	QCommandLineOption timeoutOption("timeout", "Stop after SEC seconds without a new frame (default 10).", "seconds", "10");
+	QCommandLineOption saveOption("save", "Save the last consistent frame to FILE.", "file");
+	QCommandLineOption quietOption(QStringList() << "q" << "quiet", "Print only the summary.");
+	parser.addOption(framesOption);
+	parser.addOption(timeoutOption);
+	parser.addOption(saveOption);
+	parser.addOption(quietOption);
+	parser.process(app);
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	QString name = parser.positionalArguments().isEmpty() ? QString(SharedFramebuffer::DefaultName) : parser.positionalArguments().first();
+	bool okFrames = false, okTimeout = false;
+	int frameLimit = parser.value(framesOption).toInt(&okFrames);
+	double timeout = parser.value(timeoutOption).toDouble(&okTimeout);
+	if (!okFrames || !okTimeout || frameLimit < 0 || timeout <= 0) {
+		err << "Invalid --frames or --timeout value.\n";
+		return 2;
+	}
+	bool quiet = parser.isSet(quietOption);
+
+	SharedFramebuffer shared;
+	QString errorMessage;
+	if (!shared.open(name, &errorMessage)) {
+		err << errorMessage << "\n";
+		return 1;
+	}
+
+	int received = 0;
+	int torn = 0;
+	quint64 skipped = 0;
+	quint64 lastNumber = 0;
+	qint64 latencyTotalNs = 0;
+	qint64 latencyMaxNs = 0;
+	QImage lastFrame;
+	QElapsedTimer idle;
+	idle.start();
+
+	while (frameLimit == 0 || received < frameLimit) {
+		// Zapisovatel segment zvacsil alebo skoncil; novy segment s rovnakym menom este nemusi existovat
+		if (!shared.isOpen() || shared.wasReplaced()) {
+			if (!shared.open(name)) {
+				if (idle.elapsed() >= timeout * 1000) {
+					break;
+				}
+				QThread::msleep(5);
+				continue;
+			}
+		}
+
+		SharedFramebuffer::Frame frame;
+		if (shared.frameSequence() == lastNumber || !shared.acquire(frame) || frame.number == lastNumber) {
+			if (idle.elapsed() >= timeout * 1000) {
+				break;
+			}
+			QThread::msleep(1);
+			continue;
+		}
+
+		qint64 latencyNs = SharedFramebuffer::monotonicNs() - frame.timestampNs;
+		// Kopia len pre --save; zvysok pracuje priamo nad zdielanou pamatou
+		QImage copy;
+		if (parser.isSet(saveOption)) {
+			copy = frame.image().copy();
+		}
+		if (!shared.isValid(frame)) {
+			torn++;
+			continue;
+		}
+
+		if (lastNumber != 0 && frame.number > lastNumber + 1) {
+			skipped += frame.number - lastNumber - 1;
+		}
+		lastNumber = frame.number;
+		received++;
+		latencyTotalNs += latencyNs;
+		latencyMaxNs = qMax(latencyMaxNs, latencyNs);
+		if (!copy.isNull()) {
+			lastFrame = copy;
+		}
+		idle.restart();
+
+		if (!quiet) {
+			out << QString("frame %1: %2x%3, latency %4 ms\n").arg(frame.number).arg(frame.width).arg(frame.height)
+				.arg(latencyNs / 1e6, 0, 'f', 3);
+			out.flush();
+		}
+	}
+
+	out << QString("%1 frames received, %2 skipped, %3 torn reads").arg(received).arg(skipped).arg(torn);
+	if (received > 0) {
+		out << QString(", latency mean %1 ms, max %2 ms").arg(latencyTotalNs / 1e6 / received, 0, 'f', 3).arg(latencyMaxNs / 1e6, 0, 'f', 3);
+	}
+	out << "\n";
+
+	if (parser.isSet(saveOption)) {
+		if (lastFrame.isNull()) {
+			err << "No frame to save.\n";
+			return 1;
+		}
+		if (!lastFrame.save(parser.value(saveOption))) {
+			err << "Unable to save " << parser.value(saveOption) << "\n";
+			return 1;
+		}
+	}
+	return received > 0 ? 0 : 1;
+}
@@ -0,0 +1,624 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLocale>
+#include <QtMath>
+#include <QTextStream>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Rasterizer.h"
+#include "RenderBackend.h"
+
+// Mikrobenchmarky rasterizera. --fill porovna scanline a trojuholnikovu vyplnu polygonov
+// podla poctu vrcholov a velkosti a vypise, pokial su trojuholniky rychlejsie (hranice pre Rasterizer::AutoFill).
+// --aa porovna ostru vyplnu s vyhladenou (analyticke pokrytie) a nenulovym vinutim.
+// --stroke porovna hruby tah (jedna vypln obrysu) s napodobnenim cez N posunutych Bresenhamovych ciar.
+// --shader porovna jednofarebnu vypln s linearnym a radialnym gradientom a dlazdicovym vzorom.
+// --batch porovna kreslenie tisicov malych tvarov po jednom (drawShape) s typovymi davkami (drawShapes).
+// --segments porovna skalarny Bresenham po jednej usecke so SIMD drahami drawSegments podla dlzky usecok.
+// --memory vypise pamat tvarov na halde a v kompaktnej scene podla typu a porovna kreslenie z oboch.
+
+static const int VertexCounts[] = { 3, 4, 5, 6, 8, 12, 16, 32 };
+static const int Radii[] = { 4, 8, 16, 32, 128, 512 };
+
+static bool parseCanvasSize(const QString& text, QSize& size)
+{
+	QStringList parts = text.toLower().split('x');
+	if (parts.size() != 2) {
+		return false;
+	}
+
+	bool okWidth = false, okHeight = false;
+	int width = parts[0].toInt(&okWidth);
+	int height = parts[1].toInt(&okHeight);
+	if (!okWidth || !okHeight || width <= 0 || height <= 0) {
+		return false;
+	}
+
+	size = QSize(width, height);
+	return true;
+}
+
+// Pravidelny (konvexny) alebo hviezdicovy (nekonvexny, ale jednoduchy) polygon okolo stredu
+static QVector<QPoint> makePolygon(int vertices, int radius, bool convex, const QPoint& center, std::mt19937& random)
+{
+	QVector<QPoint> points;
+	std::uniform_real_distribution<double> spread(0.45, 1.0);
+	for (int i = 0; i < vertices; i++) {
+		double angle = qDegreesToRadians(360.0 * i / vertices);
+		double r = convex ? radius : radius * spread(random);
+		points.append(QPoint(center.x() + qRound(r * std::cos(angle)), center.y() + qRound(r * std::sin(angle))));
+	}
+	return points;
+}
+
+// Najlepsi cas (ns) na jeden polygon z niekolkych opakovani; prve kolo triangulaciu ulozi do tvarov
+static double measureDraw(Rasterizer& raster, std::vector<MyPolygon>& polygons, int rounds)
+{
+	double best = 0;
+	for (int round = 0; round <= rounds; round++) {
+		QElapsedTimer timer;
+		timer.start();
+		for (MyPolygon& polygon : polygons) {
+			raster.drawShape(polygon);
+		}
+		double ns = static_cast<double>(timer.nsecsElapsed()) / polygons.size();
+		if (round == 1 || (round > 1 && ns < best)) {
+			best = ns;
+		}
+	}
+	return best;
+}
+
+static double measureFill(Rasterizer& raster, std::vector<MyPolygon>& polygons, Rasterizer::FillPath path, int rounds)
+{
+	raster.setFillPath(path);
+	return measureDraw(raster, polygons, rounds);
+}
+
+static int benchmarkFill(const QSize& canvasSize, int polygonCount, int rounds, quint32 seed, QTextStream& out)
+{
+	QImage image(canvasSize, QImage::Format_ARGB32);
+	if (image.isNull()) {
+		return 1;
+	}
+	Rasterizer raster(&image);
+	raster.clear(Qt::white);
+	std::mt19937 random(seed);
+
+	out << QString("%1 %2 %3 %4 %5 %6\n").arg("shape", -7).arg("n", 4).arg("radius", 7).arg("scan ns", 11).arg("tri ns", 11).arg("tri/scan", 9);
+	for (bool convex : { true, false }) {
+		for (int vertices : VertexCounts) {
+			int crossover = 0;
+			bool scanlineWon = false;
+			for (int radius : Radii) {
+				// Stredy su v platne, velke polygony ho presahuju (scanline ich musi orezat)
+				std::uniform_int_distribution<int> centerX(canvasSize.width() / 8, canvasSize.width() * 7 / 8);
+				std::uniform_int_distribution<int> centerY(canvasSize.height() / 8, canvasSize.height() * 7 / 8);
+				std::vector<MyPolygon> polygons;
+				for (int i = 0; i < polygonCount; i++) {
+					QPoint center(centerX(random), centerY(random));
+					polygons.emplace_back(makePolygon(vertices, radius, convex, center, random), 0, true, QColor(Qt::black), QColor(200, 40, 40));
+				}
+
+				double scanlineNs = measureFill(raster, polygons, Rasterizer::ScanlineFill, rounds);
+				double triangleNs = measureFill(raster, polygons, Rasterizer::TriangleFill, rounds);
+				if (triangleNs < scanlineNs && !scanlineWon) {
+					crossover = radius;
+				}
+				else {
+					scanlineWon = true;
+				}
+
+				out << QString("%1 %2 %3 %4 %5 %6\n").arg(convex ? "convex" : "star", -7).arg(vertices, 4).arg(radius, 7)
+					.arg(scanlineNs, 11, 'f', 0).arg(triangleNs, 11, 'f', 0).arg(triangleNs / scanlineNs, 9, 'f', 2);
+			}
+			out << QString("  -> %1 n=%2: ").arg(convex ? "convex" : "star").arg(vertices)
+				<< (crossover > 0 ? QString("triangles faster up to radius %1\n").arg(crossover) : QString("scanline faster at all sizes\n"));
+			out.flush();
+		}
+	}
+	return 0;
+}
+
+// Ostra scanline vypln vs. vyhladena (parne-neparne) vs. vyhladena s nenulovym vinutim
+static int benchmarkAntialiasing(const QSize& canvasSize, int polygonCount, int rounds, quint32 seed, QTextStream& out)
+{
+	QImage image(canvasSize, QImage::Format_ARGB32);
+	if (image.isNull()) {
+		return 1;
+	}
+	Rasterizer raster(&image);
+	raster.clear(Qt::white);
+	raster.setFillPath(Rasterizer::ScanlineFill);
+	std::mt19937 random(seed);
+
+	out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg("shape", -7).arg("n", 4).arg("radius", 7).arg("aliased ns", 11)
+		.arg("aa ns", 11).arg("nonzero ns", 11).arg("aa/aliased", 11);
+	for (bool convex : { true, false }) {
+		for (int vertices : { 4, 16 }) {
+			for (int radius : Radii) {
+				std::uniform_int_distribution<int> centerX(canvasSize.width() / 8, canvasSize.width() * 7 / 8);
+				std::uniform_int_distribution<int> centerY(canvasSize.height() / 8, canvasSize.height() * 7 / 8);
+				std::vector<MyPolygon> polygons;
+				for (int i = 0; i < polygonCount; i++) {
+					QPoint center(centerX(random), centerY(random));
+					polygons.emplace_back(makePolygon(vertices, radius, convex, center, random), 0, true, QColor(Qt::black), QColor(200, 40, 40));
+				}
+
+				raster.setAntialiasing(false);
+				double aliasedNs = measureDraw(raster, polygons, rounds);
+				raster.setAntialiasing(true);
+				double antialiasedNs = measureDraw(raster, polygons, rounds);
+				for (MyPolygon& polygon : polygons) {
+					polygon.setFillRule(Qt::WindingFill);
+				}
+				double nonzeroNs = measureDraw(raster, polygons, rounds);
+
+				out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg(convex ? "convex" : "star", -7).arg(vertices, 4).arg(radius, 7)
+					.arg(aliasedNs, 11, 'f', 0).arg(antialiasedNs, 11, 'f', 0).arg(nonzeroNs, 11, 'f', 0).arg(antialiasedNs / aliasedNs, 11, 'f', 2);
+				out.flush();
+			}
+		}
+	}
+	return 0;
+}
+
+// Hruba lomena ciara ako N rovnobeznych tenkych ciar (posun kolmo na hlavny smer segmentu)
+static void drawOffsetLines(Rasterizer& raster, const QVector<QPoint>& points, int strokeWidth, const QColor& color)
+{
+	raster.setBorderColor(color);
+	for (int i = 0; i + 1 < points.size(); i++) {
+		QPoint delta = points[i + 1] - points[i];
+		QPoint step = (std::abs(delta.x()) > std::abs(delta.y())) ? QPoint(0, 1) : QPoint(1, 0);
+		for (int k = 0; k < strokeWidth; k++) {
+			QPoint offset = step * (k - strokeWidth / 2);
+			QVector<QPoint> line = { points[i] + offset, points[i + 1] + offset };
+			raster.drawLineBresenham(line);
+		}
+	}
+}
+
+static int benchmarkStroke(const QSize& canvasSize, int polylineCount, int rounds, quint32 seed, QTextStream& out)
+{
+	QImage image(canvasSize, QImage::Format_ARGB32);
+	if (image.isNull()) {
+		return 1;
+	}
+	Rasterizer raster(&image);
+	raster.clear(Qt::white);
+	std::mt19937 random(seed);
+	const QColor color(40, 40, 160);
+
+	out << QString("%1 %2 %3 %4 %5\n").arg("width", 6).arg("lines ns", 11).arg("stroke ns", 11).arg("aa ns", 11).arg("stroke/lines", 13);
+	for (int strokeWidth : { 2, 4, 10, 20 }) {
+		// Lomene ciary so 16 bodmi, kazda v okoli nahodneho stredu
+		std::uniform_int_distribution<int> centerX(canvasSize.width() / 8, canvasSize.width() * 7 / 8);
+		std::uniform_int_distribution<int> centerY(canvasSize.height() / 8, canvasSize.height() * 7 / 8);
+		std::uniform_int_distribution<int> jitter(-60, 60);
+		std::vector<QVector<QPoint>> polylines;
+		std::vector<MyPolygon> strokes;
+		for (int i = 0; i < polylineCount; i++) {
+			QPoint center(centerX(random), centerY(random));
+			QVector<QPoint> points;
+			QVector<QPointF> pointsF;
+			for (int j = 0; j < 16; j++) {
+				points.append(center + QPoint(jitter(random), jitter(random)));
+				pointsF.append(QPointF(points.last()));
+			}
+			polylines.push_back(points);
+
+			// Obrys sa uklada v tvare, merane je uz len vyplnenie (ako pri prekresleni sceny)
+			strokes.emplace_back(points, 0, false, color, color);
+			strokes.back().setStrokeWidth(strokeWidth);
+			strokes.back().setStrokeOutline(Stroker::stroke(pointsF, false, strokeWidth, Qt::MiterJoin, Qt::FlatCap));
+		}
+
+		double best[3] = { 0, 0, 0 };
+		for (int round = 0; round <= rounds; round++) {
+			QElapsedTimer timer;
+			timer.start();
+			for (const QVector<QPoint>& points : polylines) {
+				drawOffsetLines(raster, points, strokeWidth, color);
+			}
+			double linesNs = static_cast<double>(timer.nsecsElapsed()) / polylineCount;
+
+			double strokeNs[2];
+			for (int antialiased = 0; antialiased < 2; antialiased++) {
+				raster.setAntialiasing(antialiased != 0);
+				timer.restart();
+				for (MyPolygon& stroke : strokes) {
+					raster.drawStroke(stroke);
+				}
+				strokeNs[antialiased] = static_cast<double>(timer.nsecsElapsed()) / polylineCount;
+			}
+			raster.setAntialiasing(false);
+
+			double values[3] = { linesNs, strokeNs[0], strokeNs[1] };
+			for (int k = 0; k < 3; k++) {
+				if (round == 1 || (round > 1 && values[k] < best[k])) {
+					best[k] = values[k];
+				}
+			}
+		}
+
+		out << QString("%1 %2 %3 %4 %5\n").arg(strokeWidth, 6).arg(best[0], 11, 'f', 0).arg(best[1], 11, 'f', 0)
+			.arg(best[2], 11, 'f', 0).arg(best[1] / best[0], 13, 'f', 2);
+		out.flush();
+	}
+	return 0;
+}
+
+// Rovnake polygony raz jednou farbou a raz s kazdym shaderom; shader je relativny k prvemu bodu polygonu
+// (stred + (radius, 0)), gradienty idu cez cely polygon
+static int benchmarkShader(const QSize& canvasSize, int polygonCount, int rounds, quint32 seed, QTextStream& out)
+{
+	QImage image(canvasSize, QImage::Format_ARGB32);
+	if (image.isNull()) {
+		return 1;
+	}
+	Rasterizer raster(&image);
+	raster.clear(Qt::white);
+	raster.setFillPath(Rasterizer::ScanlineFill);
+	std::mt19937 random(seed);
+
+	QImage tile(16, 16, QImage::Format_ARGB32);
+	for (int y = 0; y < tile.height(); y++) {
+		for (int x = 0; x < tile.width(); x++) {
+			tile.setPixel(x, y, ((x / 4 + y / 4) % 2) ? qRgb(40, 40, 160) : qRgb(230, 230, 250));
+		}
+	}
+	QVector<FillShader::Stop> stops = { { 0.0, QColor(200, 40, 40) }, { 0.5, QColor(250, 220, 60) }, { 1.0, QColor(40, 40, 160, 160) } };
+
+	out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg("fill", -8).arg("radius", 7).arg("solid ns", 11).arg("linear ns", 11)
+		.arg("radial ns", 11).arg("pattern ns", 11).arg("worst/solid", 12);
+	for (bool antialiased : { false, true }) {
+		raster.setAntialiasing(antialiased);
+		for (int radius : Radii) {
+			std::uniform_int_distribution<int> centerX(canvasSize.width() / 8, canvasSize.width() * 7 / 8);
+			std::uniform_int_distribution<int> centerY(canvasSize.height() / 8, canvasSize.height() * 7 / 8);
+			std::vector<MyPolygon> polygons;
+			for (int i = 0; i < polygonCount; i++) {
+				QPoint center(centerX(random), centerY(random));
+				polygons.emplace_back(makePolygon(8, radius, true, center, random), 0, true, QColor(Qt::black), QColor(200, 40, 40));
+			}
+
+			std::shared_ptr<const FillShader> shaders[] = {
+				nullptr,
+				std::make_shared<FillShader>(FillShader::linear(QPointF(0, -radius), QPointF(-2 * radius, radius), stops)),
+				std::make_shared<FillShader>(FillShader::radial(QPointF(-radius, 0), radius, stops)),
+				std::make_shared<FillShader>(FillShader::pattern(tile, QPointF(0, 0)))
+			};
+			double ns[4];
+			for (int k = 0; k < 4; k++) {
+				for (MyPolygon& polygon : polygons) {
+					polygon.setFillShader(shaders[k]);
+				}
+				ns[k] = measureDraw(raster, polygons, rounds);
+			}
+
+			double worst = qMax(ns[1], qMax(ns[2], ns[3]));
+			out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg(antialiased ? "aa" : "aliased", -8).arg(radius, 7)
+				.arg(ns[0], 11, 'f', 0).arg(ns[1], 11, 'f', 0).arg(ns[2], 11, 'f', 0).arg(ns[3], 11, 'f', 0).arg(worst / ns[0], 12, 'f', 2);
+			out.flush();
+		}
+	}
+	return 0;
+}
+
+// Scena count malych tvarov: usecky, kruznice, kruhy, zoradena zmes (behy rovnakeho typu) a striedana zmes
+static std::vector<ShapeVariant> makeBatchScene(int scene, const QSize& canvasSize, int count, quint32 seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> x(0, canvasSize.width() - 1), y(0, canvasSize.height() - 1), d(-8, 8), r(1, 6);
+	std::vector<ShapeVariant> shapes;
+	shapes.reserve(count);
+	for (int i = 0; i < count; i++) {
+		QPoint point(x(random), y(random));
+		QColor color(i % 256, 80, 160);
+		int type = (scene < 3) ? scene : (scene == 3 ? (i * 3) / count : i % 3);
+		if (type == 0) {
+			shapes.emplace_back(Line(point, point + QPoint(d(random), d(random)), i, false, color, color));
+		}
+		else {
+			shapes.emplace_back(Circle(point, point + QPoint(r(random), 0), i, type == 2, color, QColor(240, 200, 40)));
+		}
+	}
+	return shapes;
+}
+
+static int benchmarkBatch(const QSize& canvasSize, int shapeCount, int rounds, quint32 seed, QTextStream& out)
+{
+	QImage single(canvasSize, QImage::Format_ARGB32), batched(canvasSize, QImage::Format_ARGB32);
+	if (single.isNull() || batched.isNull()) {
+		return 1;
+	}
+	const char* names[] = { "lines", "circles", "discs", "sorted", "mixed" };
+
+	out << QString("%1 %2 %3 %4 %5 %6\n").arg("scene", -8).arg("shapes", 8).arg("single ms", 10).arg("batched ms", 11)
+		.arg("speedup", 8).arg("same", 5);
+	for (int scene = 0; scene < 5; scene++) {
+		double best[2] = { 1e300, 1e300 };
+		for (int round = 0; round < rounds; round++) {
+			// Scena sa pre kazde kolo vytvori znova, kreslenie po jednom nesmie tazit z predoslych kol
+			for (int mode = 0; mode < 2; mode++) {
+				std::vector<ShapeVariant> shapes = makeBatchScene(scene, canvasSize, shapeCount, seed);
+				Rasterizer raster(mode == 0 ? &single : &batched);
+				raster.clear(Qt::white);
+				QElapsedTimer timer;
+				timer.start();
+				if (mode == 0) {
+					for (ShapeVariant& shape : shapes) {
+						raster.drawShape(shape);
+					}
+				}
+				else {
+					raster.drawShapes(shapes);
+				}
+				best[mode] = qMin(best[mode], timer.nsecsElapsed() / 1e6);
+			}
+		}
+		out << QString("%1 %2 %3 %4 %5 %6\n").arg(names[scene], -8).arg(shapeCount, 8).arg(best[0], 10, 'f', 2)
+			.arg(best[1], 11, 'f', 2).arg(best[0] / best[1], 8, 'f', 2).arg(single == batched ? "yes" : "NO", 5);
+		out.flush();
+	}
+	return 0;
+}
+
+static int benchmarkSegments(const QSize& canvasSize, int segmentCount, int rounds, quint32 seed, QTextStream& out)
+{
+	QImage scalar(canvasSize, QImage::Format_ARGB32), lanes(canvasSize, QImage::Format_ARGB32);
+	if (scalar.isNull() || lanes.isNull()) {
+		return 1;
+	}
+	const int lengths[] = { 2, 4, 8, 16, 32, 64 };
+	bool allSame = true;
+
+	out << QString("%1 %2 %3 %4 %5\n").arg("length", 7).arg("scalar ns", 10).arg("lanes ns", 10).arg("speedup", 8).arg("same", 5);
+	for (int length : lengths) {
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> x(length, canvasSize.width() - 1 - length), y(length, canvasSize.height() - 1 - length);
+		std::uniform_int_distribution<int> d(-length, length);
+		std::vector<QPoint> starts(segmentCount), ends(segmentCount);
+		for (int i = 0; i < segmentCount; i++) {
+			starts[i] = QPoint(x(random), y(random));
+			ends[i] = starts[i] + QPoint(d(random), d(random));
+		}
+
+		double best[2] = { 1e300, 1e300 };
+		Rasterizer scalarRaster(&scalar), lanesRaster(&lanes);
+		QVector<QPoint> segment(2);
+		for (int round = 0; round < rounds; round++) {
+			scalarRaster.clear(Qt::white);
+			scalarRaster.setBorderColor(QColor(40, 40, 160));
+			QElapsedTimer timer;
+			timer.start();
+			for (int i = 0; i < segmentCount; i++) {
+				segment[0] = starts[i];
+				segment[1] = ends[i];
+				scalarRaster.drawLineBresenham(segment);
+			}
+			best[0] = qMin(best[0], static_cast<double>(timer.nsecsElapsed()));
+
+			lanesRaster.clear(Qt::white);
+			lanesRaster.setBorderColor(QColor(40, 40, 160));
+			timer.restart();
+			lanesRaster.drawSegments(starts.data(), ends.data(), segmentCount);
+			best[1] = qMin(best[1], static_cast<double>(timer.nsecsElapsed()));
+		}
+		out << QString("%1 %2 %3 %4 %5\n").arg(length, 7).arg(best[0] / segmentCount, 10, 'f', 1).arg(best[1] / segmentCount, 10, 'f', 1)
+			.arg(best[0] / best[1], 8, 'f', 2).arg(scalar == lanes ? "yes" : "NO", 5);
+		out.flush();
+		allSame = allSame && scalar == lanes;
+	}
+	// Rozdielne pixely su chyba drah, nie len pomale meranie (spusta sa aj v CTest)
+	return allSame ? 0 : 1;
+}
+
+// Zmes typov ako v editore: usecky, obdlzniky rovnobezne s osami, 8-uholniky, kruznice a krivky so 4 bodmi
+static std::vector<std::unique_ptr<Shape>> makeMemoryScene(const QSize& canvasSize, int count, quint32 seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> x(0, canvasSize.width() - 1), y(0, canvasSize.height() - 1), d(-40, 40);
+	std::vector<std::unique_ptr<Shape>> shapes;
+	shapes.reserve(count);
+	for (int i = 0; i < count; i++) {
+		QPoint point(x(random), y(random));
+		QColor border(random() % 256, random() % 256, random() % 256), filling(random() % 256, random() % 256, random() % 256);
+		switch (i % 5) {
+		case Shape::LINE:
+			shapes.emplace_back(new Line(point, point + QPoint(d(random), d(random)), i, false, border, filling));
+			break;
+		case Shape::RECTANGLE: {
+			QPoint corner = point + QPoint(qAbs(d(random)), qAbs(d(random)));
+			shapes.emplace_back(new MyRectangle(point, QPoint(corner.x(), point.y()), corner, QPoint(point.x(), corner.y()), i, true, border, filling));
+			break;
+		}
+		case Shape::POLYGON:
+			shapes.emplace_back(new MyPolygon(makePolygon(8, 40, true, point, random), i, true, border, filling));
+			break;
+		case Shape::CIRCLE:
+			shapes.emplace_back(new Circle(point, point + QPoint(qAbs(d(random)), 0), i, i % 2 == 0, border, filling));
+			break;
+		default:
+			shapes.emplace_back(new BezierCurve({ point, point + QPoint(d(random), d(random)), point + QPoint(d(random), d(random)),
+				point + QPoint(d(random), d(random)) }, i, false, border, filling));
+			break;
+		}
+	}
+	return shapes;
+}
+
+static int benchmarkMemory(const QSize& canvasSize, int shapeCount, int rounds, quint32 seed, QTextStream& out)
+{
+	std::vector<std::unique_ptr<Shape>> shapes = makeMemoryScene(canvasSize, shapeCount, seed);
+	std::vector<Shape*> heapShapes;
+	CompactScene compact;
+	for (std::unique_ptr<Shape>& shape : shapes) {
+		heapShapes.push_back(shape.get());
+		compact.append(*shape);
+	}
+	compact.squeeze();
+
+	CompactScene::MemoryReport heap = CompactScene::heapReport(heapShapes.data(), heapShapes.size());
+	CompactScene::MemoryReport packed = compact.memoryReport();
+	out << heap.toText("heap") << "\n\n" << packed.toText("compact") << "\n\n";
+	const double target = 100e6;
+	out << QString("100M vertices: heap %1 MB, compact %2 MB\n\n")
+		.arg(target * heap.totalBytes() / heap.totalVertices() / 1e6, 0, 'f', 0)
+		.arg(target * packed.totalBytes() / packed.totalVertices() / 1e6, 0, 'f', 0);
+
+	QImage fromHeap(canvasSize, QImage::Format_ARGB32), fromCompact(canvasSize, QImage::Format_ARGB32);
+	if (fromHeap.isNull() || fromCompact.isNull()) {
+		return 1;
+	}
+	double best[2] = { 1e300, 1e300 };
+	for (int round = 0; round < rounds; round++) {
+		for (int mode = 0; mode < 2; mode++) {
+			Rasterizer raster(mode == 0 ? &fromHeap : &fromCompact);
+			raster.clear(Qt::white);
+			QElapsedTimer timer;
+			timer.start();
+			if (mode == 0) {
+				raster.drawShapes(heapShapes.data(), heapShapes.size());
+			}
+			else {
+				raster.drawShapes(compact);
+			}
+			best[mode] = qMin(best[mode], timer.nsecsElapsed() / 1e6);
+		}
+	}
+	out << QString("%1 %2 %3\n").arg("heap ms", 10).arg("compact ms", 11).arg("same", 5);
+	out << QString("%1 %2 %3\n").arg(best[0], 10, 'f', 2).arg(best[1], 11, 'f', 2).arg(fromHeap == fromCompact ? "yes" : "NO", 5);
+	return 0;
+}
+
+// Ta ista zmiesana scena cez kazdy backend; null backend je cisty prechod scenou (body, obalky, orezanie),
+// rozdiel oproti nemu je cas rasterizacie
+static int benchmarkBackends(const QSize& canvasSize, int shapeCount, int rounds, quint32 seed, QTextStream& out)
+{
+	std::vector<std::unique_ptr<Shape>> shapes = makeMemoryScene(canvasSize, shapeCount, seed);
+	std::vector<Shape*> drawList;
+	for (std::unique_ptr<Shape>& shape : shapes) {
+		drawList.push_back(shape.get());
+	}
+
+	QImage image(canvasSize, QImage::Format_ARGB32);
+	if (image.isNull()) {
+		return 1;
+	}
+
+	double best[RenderBackend::KindCount];
+	out << QString("%1 %2 %3 %4 %5\n").arg("backend", -10).arg("ms", 10).arg("shapes/s", 12).arg("drawn", 9).arg("culled", 8);
+	for (int kind = 0; kind < RenderBackend::KindCount; kind++) {
+		std::unique_ptr<RenderBackend> backend = RenderBackend::create(static_cast<RenderBackend::Kind>(kind));
+		backend->setTarget(&image);
+		best[kind] = 1e300;
+		for (int round = 0; round < rounds; round++) {
+			backend->clear(Qt::white);
+			backend->resetStats();
+			QElapsedTimer timer;
+			timer.start();
+			backend->drawShapes(drawList.data(), drawList.size());
+			backend->finish();
+			best[kind] = qMin(best[kind], timer.nsecsElapsed() / 1e6);
+		}
+		const RenderBackend::Stats& stats = backend->getStats();
+		out << QString("%1 %2 %3 %4 %5\n").arg(backend->name(), -10).arg(best[kind], 10, 'f', 2)
+			.arg(best[kind] > 0 ? shapeCount / (best[kind] / 1e3) : 0.0, 12, 'f', 0).arg(stats.shapes, 9).arg(stats.culled, 8);
+		out.flush();
+	}
+
+	double traversal = best[RenderBackend::Null];
+	out << QString("\ntraversal %1 ms: %2 % of software, %3 % of qpainter; software is %4x qpainter speed\n")
+		.arg(traversal, 0, 'f', 2)
+		.arg(100.0 * traversal / best[RenderBackend::Software], 0, 'f', 1)
+		.arg(100.0 * traversal / best[RenderBackend::Painter], 0, 'f', 1)
+		.arg(best[RenderBackend::Painter] / best[RenderBackend::Software], 0, 'f', 2);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	QLocale::setDefault(QLocale::c());
+
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("MPM");
+	QCoreApplication::setApplicationName("RasterBench");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Rasterizer micro-benchmarks.");
+	parser.addHelpOption();
+
+	QCommandLineOption fillOption("fill", "Compare scanline and triangle polygon fill by vertex count and size.");
+	QCommandLineOption strokeOption("stroke", "Compare thick polyline strokes with N offset Bresenham lines.");
+	QCommandLineOption shaderOption("shader", "Compare solid polygon fill with linear, radial and pattern fill shaders.");
+	QCommandLineOption batchOption("batch", "Compare drawing thousands of small shapes one by one and in type batches (count x 1000 shapes).");
+	QCommandLineOption segmentsOption("segments", "Compare scalar Bresenham with SIMD lanes for short segments (count x 1000 segments).");
+	QCommandLineOption memoryOption("memory", "Report memory per shape type for heap shapes and the compact scene (count x 1000 shapes).");
+	QCommandLineOption backendsOption("backends", "Draw a mixed scene with the software, QPainter and null backends (count x 1000 shapes).");
+	QCommandLineOption aaOption("aa", "Compare aliased polygon fill with anti-aliased coverage fill (even-odd and nonzero).");
+	QCommandLineOption sizeOption(QStringList() << "s" << "size", "Canvas size WIDTHxHEIGHT (default 1920x1080).", "size", "1920x1080");
+	QCommandLineOption countOption(QStringList() << "n" << "count", "Polygons per measurement (default 64).", "count", "64");
+	QCommandLineOption roundsOption(QStringList() << "r" << "rounds", "Timed rounds per measurement, best is reported (default 5).", "rounds", "5");
+	QCommandLineOption seedOption("seed", "Random seed (default 1).", "seed", "1");
+	parser.addOption(fillOption);
+	parser.addOption(aaOption);
+	parser.addOption(strokeOption);
+	parser.addOption(shaderOption);
+	parser.addOption(batchOption);
+	parser.addOption(segmentsOption);
+	parser.addOption(memoryOption);
+	parser.addOption(backendsOption);
+	parser.addOption(sizeOption);
+	parser.addOption(countOption);
+	parser.addOption(roundsOption);
+	parser.addOption(seedOption);
+	parser.process(app);
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	QSize canvasSize;
+	if (!parseCanvasSize(parser.value(sizeOption), canvasSize)) {
+		err << "Invalid canvas size: " << parser.value(sizeOption) << "\n";
+		return 2;
+	}
+	int polygonCount = parser.value(countOption).toInt();
+	int rounds = parser.value(roundsOption).toInt();
+	if (polygonCount <= 0 || rounds <= 0) {
+		err << "Count and rounds must be positive.\n";
+		return 2;
+	}
+
+	quint32 seed = parser.value(seedOption).toUInt();
+	if (parser.isSet(aaOption)) {
+		return benchmarkAntialiasing(canvasSize, polygonCount, rounds, seed, out);
+	}
+	if (parser.isSet(strokeOption)) {
+		return benchmarkStroke(canvasSize, polygonCount, rounds, seed, out);
+	}
+	if (parser.isSet(shaderOption)) {
+		return benchmarkShader(canvasSize, polygonCount, rounds, seed, out);
+	}
+	if (parser.isSet(batchOption)) {
+		return benchmarkBatch(canvasSize, polygonCount * 1000, rounds, seed, out);
+	}
+	if (parser.isSet(segmentsOption)) {
+		return benchmarkSegments(canvasSize, polygonCount * 1000, rounds, seed, out);
+	}
+	if (parser.isSet(memoryOption)) {
+		return benchmarkMemory(canvasSize, polygonCount * 1000, rounds, seed, out);
+	}
+	if (parser.isSet(backendsOption)) {
+		return benchmarkBackends(canvasSize, polygonCount * 1000, rounds, seed, out);
+	}
+	if (!parser.isSet(fillOption)) {
+		err << "Nothing to run, choose a benchmark (--fill, --aa, --stroke, --shader, --batch, --segments, --memory, --backends).\n";
+		parser.showHelp(2);
+	}
+	return benchmarkFill(canvasSize, polygonCount, rounds, seed, out);
+}
@@ -0,0 +1,315 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLocale>
+#include <QPainter>
+#include <QTextStream>
+#include <QtMath>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Rasterizer.h"
+#include "RenderBackend.h"
+
+// Rozdielovy test rasterizera proti QPainter (referencia): nahodne tvary kazdej kategorie sa po jednom vykreslia
+// oboma na biely QImage a porovnaju po pixeloch. Pixel s inou farbou sa toleruje, ak ma druhy obrazok rovnaku
+// farbu do vzdialenosti --tolerance pixelov (iny vyber pixelov pri remizach Bresenhama, stredy pixelov pri vyplni).
+// Kategoria neprejde, ak pixely mimo tolerancie presiahnu --max-mismatch % nakreslenych pixelov, alebo ak ich ma
+// niektory tvar s aspon MinShapePixels pixelmi viac ako --max-shape-mismatch %. Vypise aj pomer rychlosti.
+// Bez okna (QCoreApplication), v CTest bezi s QT_QPA_PLATFORM=offscreen.
+
+static const int MinShapePixels = 100;
+
+enum Category { Lines, Circles, Discs, ConvexPolygons, ConcavePolygons, PolygonOutlines, Curves, OffCanvas, CategoryCount };
+
+static const char* categoryName(int category)
+{
+	static const char* names[] = { "lines", "circles", "discs", "convex", "concave", "outlines", "curves", "offcanvas" };
+	return names[category];
+}
+
+struct CategoryResult {
+	int shapes = 0;
+	qint64 drawnPixels = 0;
+	qint64 differentPixels = 0;
+	qint64 mismatchedPixels = 0;	// mimo tolerancie
+	double worstShape = 0;			// podiel pixelov mimo tolerancie najhorsieho tvaru (s aspon MinShapePixels)
+	int worstIndex = -1;
+	double rasterMs = 0;
+	double painterMs = 0;
+};
+
+static bool parseCanvasSize(const QString& text, QSize& size)
+{
+	QStringList parts = text.toLower().split('x');
+	if (parts.size() != 2) {
+		return false;
+	}
+
+	bool okWidth = false, okHeight = false;
+	int width = parts[0].toInt(&okWidth);
+	int height = parts[1].toInt(&okHeight);
+	if (!okWidth || !okHeight || width <= 0 || height <= 0) {
+		return false;
+	}
+
+	size = QSize(width, height);
+	return true;
+}
+
+// Hviezdicovy polygon okolo stredu: konvexny (pravidelny) alebo nekonvexny, ale jednoduchy
+static QVector<QPoint> makeStar(const QPoint& center, int vertices, int radius, bool convex, std::mt19937& random)
+{
+	std::uniform_real_distribution<double> spread(0.4, 1.0);
+	QVector<QPoint> points;
+	for (int i = 0; i < vertices; i++) {
+		double angle = 2 * M_PI * i / vertices;
+		double r = convex ? radius : radius * spread(random);
+		points.append(center + QPoint(qRound(r * std::cos(angle)), qRound(r * std::sin(angle))));
+	}
+	return points;
+}
+
+static std::vector<ShapeVariant> makeShapes(int category, const QSize& canvasSize, int count, quint32 seed)
+{
+	std::mt19937 random(seed * CategoryCount + category);
+	int size = qMin(canvasSize.width(), canvasSize.height());
+	std::uniform_int_distribution<int> x(8, canvasSize.width() - 9), y(8, canvasSize.height() - 9);
+	std::uniform_int_distribution<int> farX(-2 * canvasSize.width(), 3 * canvasSize.width()), farY(-2 * canvasSize.height(), 3 * canvasSize.height());
+	std::uniform_int_distribution<int> radius(1, size / 3), vertices(3, 8), concaveVertices(5, 12), channel(0, 255);
+
+	std::vector<ShapeVariant> shapes;
+	for (int i = 0; i < count; i++) {
+		QColor border(channel(random), channel(random), channel(random));
+		QColor filling(channel(random), channel(random), channel(random));
+		QPoint point(x(random), y(random));
+		switch (category) {
+		case Lines:
+			shapes.emplace_back(Line(point, QPoint(x(random), y(random)), 1, false, border, filling));
+			break;
+		case Circles:
+		case Discs:
+			shapes.emplace_back(Circle(point, point + QPoint(radius(random), 0), 1, category == Discs, border, filling));
+			break;
+		case ConvexPolygons:
+		case PolygonOutlines: {
+			QVector<QPoint> points = makeStar(point, vertices(random), 5 + radius(random), true, random);
+			shapes.emplace_back(MyPolygon(points, 1, category == ConvexPolygons, border, filling));
+			break;
+		}
+		case ConcavePolygons:
+			shapes.emplace_back(MyPolygon(makeStar(point, concaveVertices(random), 10 + radius(random), false, random), 1, true, border, filling));
+			break;
+		case Curves: {
+			QVector<QPoint> points = { point, QPoint(x(random), y(random)), QPoint(x(random), y(random)) };
+			if (random() % 2) {
+				points.append(QPoint(x(random), y(random)));
+			}
+			shapes.emplace_back(BezierCurve(points, 1, false, border, filling));
+			break;
+		}
+		case OffCanvas:
+		default:
+			// Usecky a vyplnene (aj samopretinajuce sa) polygony s vrcholmi daleko za okrajmi platna
+			if (i % 2 == 0) {
+				shapes.emplace_back(Line(QPoint(farX(random), farY(random)), QPoint(farX(random), farY(random)), 1, false, border, filling));
+			}
+			else {
+				QVector<QPoint> points;
+				for (int k = vertices(random); k > 0; k--) {
+					points.append(QPoint(farX(random), farY(random)));
+				}
+				shapes.emplace_back(MyPolygon(points, 1, true, border, filling));
+			}
+			break;
+		}
+	}
+	return shapes;
+}
+
+// Ma obrazok other farbu color v okoli (x, y) s polomerom radius?
+static bool hasColorNear(const QImage& other, int x, int y, QRgb color, int radius)
+{
+	for (int dy = -radius; dy <= radius; dy++) {
+		int row = y + dy;
+		if (row < 0 || row >= other.height()) {
+			continue;
+		}
+		const QRgb* line = reinterpret_cast<const QRgb*>(other.constScanLine(row));
+		for (int dx = -radius; dx <= radius; dx++) {
+			int column = x + dx;
+			if (column >= 0 && column < other.width() && line[column] == color) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// Porovna obrazky jedneho tvaru; vrati pocet nakreslenych pixelov (v aspon jednom z nich)
+static qint64 compareImages(const QImage& raster, const QImage& reference, int tolerance, qint64& different, qint64& mismatched)
+{
+	const QRgb background = qRgb(255, 255, 255);
+	qint64 drawn = 0;
+	different = 0;
+	mismatched = 0;
+	for (int y = 0; y < raster.height(); y++) {
+		const QRgb* rasterLine = reinterpret_cast<const QRgb*>(raster.constScanLine(y));
+		const QRgb* referenceLine = reinterpret_cast<const QRgb*>(reference.constScanLine(y));
+		for (int x = 0; x < raster.width(); x++) {
+			QRgb ours = rasterLine[x], theirs = referenceLine[x];
+			if (ours != background || theirs != background) {
+				drawn++;
+			}
+			if (ours == theirs) {
+				continue;
+			}
+			different++;
+			if (!hasColorNear(reference, x, y, ours, tolerance) || !hasColorNear(raster, x, y, theirs, tolerance)) {
+				mismatched++;
+			}
+		}
+	}
+	return drawn;
+}
+
+static CategoryResult runCategory(int category, const QSize& canvasSize, int count, quint32 seed, int tolerance, int rounds, const QString& dumpDir)
+{
+	CategoryResult result;
+	std::vector<ShapeVariant> shapes = makeShapes(category, canvasSize, count, seed);
+	result.shapes = static_cast<int>(shapes.size());
+
+	QImage raster(canvasSize, QImage::Format_ARGB32), reference(canvasSize, QImage::Format_ARGB32);
+	for (size_t i = 0; i < shapes.size(); i++) {
+		Rasterizer rasterizer(&raster);
+		rasterizer.clear(Qt::white);
+		rasterizer.drawShape(shapes[i]);
+
+		reference.fill(Qt::white);
+		{
+			QPainter painter(&reference);
+			Shape& shape = shapeOf(shapes[i]);
+			PainterBackend::paintShape(painter, shape, shape.getPoints());
+		}
+
+		qint64 different = 0, mismatched = 0;
+		qint64 drawn = compareImages(raster, reference, tolerance, different, mismatched);
+		result.drawnPixels += drawn;
+		result.differentPixels += different;
+		result.mismatchedPixels += mismatched;
+		double share = drawn > 0 ? static_cast<double>(mismatched) / drawn : 0.0;
+		if (drawn >= MinShapePixels && share > result.worstShape) {
+			result.worstShape = share;
+			result.worstIndex = static_cast<int>(i);
+		}
+		if (!dumpDir.isEmpty() && mismatched > 0 && drawn >= MinShapePixels) {
+			QString name = QString("%1_%2").arg(categoryName(category)).arg(i, 4, 10, QChar('0'));
+			raster.save(QDir(dumpDir).filePath(name + "_raster.png"));
+			reference.save(QDir(dumpDir).filePath(name + "_qpainter.png"));
+		}
+	}
+
+	// Rychlost: vsetky tvary kategorie do jedneho obrazka, najlepsie z rounds kol
+	result.rasterMs = result.painterMs = 1e300;
+	for (int round = 0; round < rounds; round++) {
+		Rasterizer rasterizer(&raster);
+		rasterizer.clear(Qt::white);
+		QElapsedTimer timer;
+		timer.start();
+		for (ShapeVariant& shape : shapes) {
+			rasterizer.drawShape(shape);
+		}
+		result.rasterMs = qMin(result.rasterMs, timer.nsecsElapsed() / 1e6);
+
+		reference.fill(Qt::white);
+		QPainter painter(&reference);
+		timer.restart();
+		for (ShapeVariant& shape : shapes) {
+			PainterBackend::paintShape(painter, shapeOf(shape), shapeOf(shape).getPoints());
+		}
+		painter.end();
+		result.painterMs = qMin(result.painterMs, timer.nsecsElapsed() / 1e6);
+	}
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	QLocale::setDefault(QLocale::c());
+
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("MPM");
+	QCoreApplication::setApplicationName("RasterDiff");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Differential test of the rasterizers against QPainter (pixel mismatches and speed ratio).");
+	parser.addHelpOption();
+
+	QCommandLineOption sizeOption(QStringList() << "s" << "size", "Canvas size WIDTHxHEIGHT (default 256x256).", "size", "256x256");
+	QCommandLineOption countOption(QStringList() << "n" << "count", "Random shapes per category (default 200).", "count", "200");
+	QCommandLineOption roundsOption(QStringList() << "r" << "rounds", "Timed rounds per category, best is reported (default 3).", "rounds", "3");
+	QCommandLineOption seedOption("seed", "Random seed (default 1).", "seed", "1");
+	QCommandLineOption toleranceOption("tolerance", "Distance in pixels within which a different pixel still matches (default 1).", "pixels", "1");
+	QCommandLineOption maxMismatchOption("max-mismatch", "Allowed share of drawn pixels outside the tolerance per category, in % (default 0.5).", "percent", "0.5");
+	QCommandLineOption maxShapeOption("max-shape-mismatch", "Allowed share for a single shape of at least 100 pixels, in % (default 5).", "percent", "5");
+	QCommandLineOption dumpOption("dump", "Save raster and QPainter images of shapes with mismatches into this directory.", "dir");
+	parser.addOption(sizeOption);
+	parser.addOption(countOption);
+	parser.addOption(roundsOption);
+	parser.addOption(seedOption);
+	parser.addOption(toleranceOption);
+	parser.addOption(maxMismatchOption);
+	parser.addOption(maxShapeOption);
+	parser.addOption(dumpOption);
+	parser.process(app);
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	QSize canvasSize;
+	if (!parseCanvasSize(parser.value(sizeOption), canvasSize) || canvasSize.width() < 32 || canvasSize.height() < 32) {
+		err << "Invalid canvas size: " << parser.value(sizeOption) << "\n";
+		return 2;
+	}
+	int count = parser.value(countOption).toInt();
+	int rounds = parser.value(roundsOption).toInt();
+	int tolerance = parser.value(toleranceOption).toInt();
+	if (count <= 0 || rounds <= 0 || tolerance < 0) {
+		err << "Count and rounds must be positive, tolerance non-negative.\n";
+		return 2;
+	}
+	double maxMismatch = parser.value(maxMismatchOption).toDouble() / 100.0;
+	double maxShapeMismatch = parser.value(maxShapeOption).toDouble() / 100.0;
+	quint32 seed = parser.value(seedOption).toUInt();
+
+	QString dumpDir = parser.value(dumpOption);
+	if (!dumpDir.isEmpty() && !QDir().mkpath(dumpDir)) {
+		err << "Unable to create dump directory: " << dumpDir << "\n";
+		return 2;
+	}
+
+	out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9  %10\n").arg("category", -10).arg("shapes", 7).arg("drawn px", 10)
+		.arg("diff %", 7).arg("beyond %", 9).arg("worst %", 8).arg("raster ms", 10).arg("qpainter ms", 12).arg("speedup", 8).arg("status");
+	int failed = 0;
+	for (int category = 0; category < CategoryCount; category++) {
+		CategoryResult result = runCategory(category, canvasSize, count, seed, tolerance, rounds, dumpDir);
+		double drawn = qMax<qint64>(result.drawnPixels, 1);
+		double beyond = result.mismatchedPixels / drawn;
+		bool ok = beyond <= maxMismatch && result.worstShape <= maxShapeMismatch;
+		QString status = ok ? QString("ok") : QString("FAILED (worst shape #%1)").arg(result.worstIndex);
+		out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9  %10\n").arg(categoryName(category), -10).arg(result.shapes, 7)
+			.arg(result.drawnPixels, 10).arg(100.0 * result.differentPixels / drawn, 7, 'f', 2).arg(100.0 * beyond, 9, 'f', 3)
+			.arg(100.0 * result.worstShape, 8, 'f', 2).arg(result.rasterMs, 10, 'f', 2).arg(result.painterMs, 12, 'f', 2)
+			.arg(result.rasterMs > 0 ? result.painterMs / result.rasterMs : 0.0, 8, 'f', 2).arg(status);
+		out.flush();
+		if (!ok) {
+			failed++;
+		}
+	}
+
+	out << QString("\n%1 of %2 categories failed (tolerance %3 px, seed %4)\n").arg(failed).arg(static_cast<int>(CategoryCount)).arg(tolerance).arg(seed);
+	RenderLog::flush();
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,406 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include "CompactScene.h"
+#include "ImageExporter.h"
+#include "Rasterizer.h"
+#include "RenderBackend.h"
+#include "SceneFile.h"
+#include "SharedFramebuffer.h"
+#include "TiledFramebuffer.h"
+
+// Davkovy renderer: nacita jednu alebo viac scen (CSV alebo kompaktne .cscene), vykresli ich rovnakymi rasterizermi ako editor
+// a ulozi vysledok ako PNG/PPM. Nezavisle sceny sa vykresluju paralelne na vsetkych jadrach.
+
+struct BatchJob {
+	QString inputPath;
+	QString outputPath;
+
+	bool ok = false;
+	QString error;
+	int shapeCount = 0;
+	int skippedShapes = 0;
+	qint64 loadNs = 0;
+	qint64 renderNs = 0;
+	qint64 saveNs = 0;
+
+	QString memoryReport;		// --memory: tvary na halde vs. kompaktna scena
+};
+
+static bool isGlobPattern(const QString& path)
+{
+	return path.contains('*') || path.contains('?') || path.contains('[');
+}
+
+static bool isListFile(const QString& path)
+{
+	QString suffix = QFileInfo(path).suffix().toLower();
+	return suffix == "txt" || suffix == "lst";
+}
+
+static void expandInput(const QString& input, const QDir& baseDir, QStringList& scenes, int depth = 0)
+{
+	if (depth > 8) {
+		return;
+	}
+
+	QString path = input;
+	bool forceList = false;
+	if (path.startsWith('@')) {
+		path = path.mid(1);
+		forceList = true;
+	}
+	if (QFileInfo(path).isRelative()) {
+		path = baseDir.filePath(path);
+	}
+
+	if (isGlobPattern(path)) {
+		QFileInfo patternInfo(path);
+		QDir dir = patternInfo.absoluteDir();
+		const QFileInfoList matches = dir.entryInfoList(QStringList() << patternInfo.fileName(), QDir::Files, QDir::Name);
+		for (const QFileInfo& match : matches) {
+			expandInput(match.absoluteFilePath(), baseDir, scenes, depth + 1);
+		}
+		return;
+	}
+
+	if (forceList || isListFile(path)) {
+		QFile listFile(path);
+		if (!listFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+			qWarning().noquote() << "Unable to open list file" << path;
+			return;
+		}
+
+		QDir listDir = QFileInfo(path).absoluteDir();
+		QTextStream in(&listFile);
+		while (!in.atEnd()) {
+			QString line = in.readLine().trimmed();
+			if (line.isEmpty() || line.startsWith('#')) {
+				continue;
+			}
+			expandInput(line, listDir, scenes, depth + 1);
+		}
+		return;
+	}
+
+	scenes.append(QFileInfo(path).absoluteFilePath());
+}
+
+static bool parseCanvasSize(const QString& text, QSize& size)
+{
+	QStringList parts = text.toLower().split('x');
+	if (parts.size() != 2) {
+		return false;
+	}
+
+	bool okWidth = false, okHeight = false;
+	int width = parts[0].toInt(&okWidth);
+	int height = parts[1].toInt(&okHeight);
+	if (!okWidth || !okHeight || width <= 0 || height <= 0) {
+		return false;
+	}
+
+	size = QSize(width, height);
+	return true;
+}
+
+static void renderJob(BatchJob& job, const QSize& canvasSize, bool antialiasing, bool reportMemory, RenderBackend::Kind backendKind, SharedFramebuffer* shared)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// Kompaktny subor (napr. zo SceneGen) sa nacita priamo, tvary uz su v poradi vrstiev
+	CompactScene drawList;
+	if (CompactScene::isCompactFile(job.inputPath)) {
+		bool loaded = drawList.load(job.inputPath, &job.error);
+		job.loadNs = timer.nsecsElapsed();
+		if (!loaded) {
+			return;
+		}
+		job.shapeCount = static_cast<int>(drawList.size());
+		if (reportMemory) {
+			job.memoryReport = drawList.memoryReport().toText("compact");
+		}
+		timer.restart();
+	}
+	else {
+		std::vector<std::unique_ptr<Shape>> shapes;
+		if (!SceneFile::load(job.inputPath, shapes, &job.error, &job.skippedShapes)) {
+			job.loadNs = timer.nsecsElapsed();
+			return;
+		}
+		job.loadNs = timer.nsecsElapsed();
+		job.shapeCount = static_cast<int>(shapes.size());
+
+		timer.restart();
+		std::stable_sort(shapes.begin(), shapes.end(), [](const std::unique_ptr<Shape>& a, const std::unique_ptr<Shape>& b) {
+			return a->getZBufferPosition() < b->getZBufferPosition();
+			});
+
+		// Tvary sa v poradi vrstiev presunu do kompaktnej sceny (20 B na tvar + 4 B na bod namiesto objektov na halde),
+		// kreslia sa po usekoch hodnot, male tvary rovnakeho typu po davkach (drawShapes)
+		qint64 vertexCount = 0;
+		for (const std::unique_ptr<Shape>& shape : shapes) {
+			vertexCount += shape->getPoints().size();
+		}
+		drawList.reserve(shapes.size(), static_cast<size_t>(vertexCount));
+		for (std::unique_ptr<Shape>& shape : shapes) {
+			drawList.append(*shape);
+		}
+		if (reportMemory) {
+			std::vector<Shape*> heapShapes;
+			for (std::unique_ptr<Shape>& shape : shapes) {
+				heapShapes.push_back(shape.get());
+			}
+			job.memoryReport = CompactScene::heapReport(heapShapes.data(), heapShapes.size()).toText("heap") + "\n"
+				+ drawList.memoryReport().toText("compact");
+		}
+	}
+
+	std::unique_ptr<RenderBackend> backend = RenderBackend::create(backendKind);
+	backend->setAntialiasing(antialiasing);
+
+	// Velke platna sa kreslia do riedkeho dlazdicoveho framebufferu, pamat rastie len s obsahom (len Software)
+	if (!shared && backendKind == RenderBackend::Software && TiledFramebuffer::preferredFor(canvasSize.width(), canvasSize.height())) {
+		TiledFramebuffer tiles(canvasSize.width(), canvasSize.height());
+		backend->setTarget(&tiles);
+		backend->clear(Qt::white);
+		backend->drawShapes(drawList);
+		job.renderNs = timer.nsecsElapsed();
+
+		timer.restart();
+		job.ok = job.outputPath.isEmpty() || ImageExporter::encode(tiles, job.outputPath, &job.error);
+		job.saveNs = timer.nsecsElapsed();
+		return;
+	}
+
+	// Null backend nic nekresli ani neuklada, meria sa len prechod scenou.
+	// So --shm sa kresli priamo do volneho slotu zdielanej pamate a snimok sa po dokresleni zverejni
+	QImage image;
+	QImage* target = &image;
+	if (shared) {
+		target = shared->beginFrame(canvasSize);
+		if (target == nullptr) {
+			job.error = "Unable to get a shared framebuffer slot.";
+			return;
+		}
+	}
+	else if (backendKind != RenderBackend::Null) {
+		image = QImage(canvasSize, QImage::Format_ARGB32);
+		if (image.isNull()) {
+			job.error = "Unable to allocate canvas.";
+			return;
+		}
+	}
+
+	if (backendKind == RenderBackend::Null) {
+		backend->setTargetSize(canvasSize);
+	}
+	else {
+		backend->setTarget(target);
+	}
+	backend->clear(Qt::white);
+	backend->drawShapes(drawList);
+	backend->finish();
+	if (shared) {
+		shared->publish();
+	}
+	job.renderNs = timer.nsecsElapsed();
+	if (backendKind == RenderBackend::Null || job.outputPath.isEmpty()) {
+		job.ok = true;
+		return;
+	}
+
+	// Zverejneny slot sa prepise az snimkom po dalsom, takze sa da este zakodovat
+	timer.restart();
+	job.ok = ImageExporter::encode(*target, job.outputPath, &job.error);
+	job.saveNs = timer.nsecsElapsed();
+}
+
+int main(int argc, char* argv[])
+{
+	QLocale::setDefault(QLocale::c());
+
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("MPM");
+	QCoreApplication::setApplicationName("RenderBatch");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Headless batch renderer for saved ImageViewer scenes.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("inputs", "Scene files (*.csv, *.cscene), glob patterns, or list files (*.txt, *.lst, @file) with one entry per line.", "inputs...");
+
+	QCommandLineOption sizeOption(QStringList() << "s" << "size", "Canvas size WIDTHxHEIGHT (default 500x500).", "size", "500x500");
+	QCommandLineOption outputOption(QStringList() << "o" << "output-dir", "Directory for rendered images (default: next to each scene).", "dir");
+	QCommandLineOption formatOption(QStringList() << "f" << "format", "Output format: png, ppm or none (render only; default png).", "format", "png");
+	QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Number of scenes rendered concurrently (default: all cores).", "count");
+	QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "Print rasterizer debug log (same as RENDER_LOG=*=debug).");
+	QCommandLineOption aliasedOption("aliased", "Fill shapes without anti-aliasing (exports are anti-aliased by default).");
+	QCommandLineOption backendOption(QStringList() << "b" << "backend", "Render backend: software, qpainter or null (draws nothing, no output; default software).", "name", "software");
+	QCommandLineOption shmOption("shm", "Publish every rendered scene in POSIX shared memory NAME (e.g. /imageviewer-canvas); scenes are rendered one at a time in input order.", "name");
+	QCommandLineOption memoryOption("memory", "Print memory per shape type: heap shapes vs. the compact scene used for rendering.");
+	parser.addOption(sizeOption);
+	parser.addOption(outputOption);
+	parser.addOption(formatOption);
+	parser.addOption(jobsOption);
+	parser.addOption(verboseOption);
+	parser.addOption(aliasedOption);
+	parser.addOption(memoryOption);
+	parser.addOption(backendOption);
+	parser.addOption(shmOption);
+	parser.process(app);
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	if (parser.isSet(verboseOption)) {
+		RenderLog::setLevel(RenderLog::Debug);
+	}
+
+	QSize canvasSize;
+	if (!parseCanvasSize(parser.value(sizeOption), canvasSize)) {
+		err << "Invalid canvas size: " << parser.value(sizeOption) << "\n";
+		return 2;
+	}
+
+	RenderBackend::Kind backendKind = RenderBackend::Software;
+	if (!RenderBackend::parseKind(parser.value(backendOption), backendKind)) {
+		err << "Unknown render backend: " << parser.value(backendOption) << "\n";
+		return 2;
+	}
+
+	QString format = parser.value(formatOption).toLower();
+	if (format != "png" && format != "ppm" && format != "none") {
+		err << "Unsupported output format: " << format << "\n";
+		return 2;
+	}
+
+	int jobCount = QThread::idealThreadCount();
+	if (parser.isSet(jobsOption)) {
+		jobCount = parser.value(jobsOption).toInt();
+		if (jobCount <= 0) {
+			err << "Invalid job count: " << parser.value(jobsOption) << "\n";
+			return 2;
+		}
+	}
+
+	// Zdielany framebuffer zverejnuje snimky postupne, kreslenie do neho preto nebezi paralelne
+	std::unique_ptr<SharedFramebuffer> shared;
+	if (parser.isSet(shmOption)) {
+		if (backendKind == RenderBackend::Null) {
+			err << "The null backend draws nothing to publish in shared memory.\n";
+			return 2;
+		}
+		QString errorMessage;
+		shared = std::make_unique<SharedFramebuffer>();
+		if (!shared->create(parser.value(shmOption), canvasSize, &errorMessage)) {
+			err << "Unable to create shared framebuffer: " << errorMessage << "\n";
+			return 2;
+		}
+		jobCount = 1;
+	}
+
+	QStringList scenes;
+	for (const QString& input : parser.positionalArguments()) {
+		expandInput(input, QDir::current(), scenes);
+	}
+	if (scenes.isEmpty()) {
+		err << "No scene files to render.\n";
+		parser.showHelp(2);
+	}
+
+	QDir outputDir;
+	bool useOutputDir = parser.isSet(outputOption);
+	if (useOutputDir) {
+		outputDir = QDir(parser.value(outputOption));
+		if (!outputDir.exists() && !QDir().mkpath(outputDir.absolutePath())) {
+			err << "Unable to create output directory: " << outputDir.absolutePath() << "\n";
+			return 2;
+		}
+	}
+
+	std::vector<BatchJob> jobs(scenes.size());
+	QSet<QString> usedOutputs;
+	for (int i = 0; i < scenes.size(); i++) {
+		QFileInfo sceneInfo(scenes[i]);
+		QDir targetDir = useOutputDir ? outputDir : sceneInfo.absoluteDir();
+		QString outputPath = targetDir.filePath(sceneInfo.completeBaseName() + "." + format);
+		for (int suffix = 1; usedOutputs.contains(outputPath); suffix++) {
+			outputPath = targetDir.filePath(QString("%1_%2.%3").arg(sceneInfo.completeBaseName()).arg(suffix).arg(format));
+		}
+		usedOutputs.insert(outputPath);
+
+		jobs[i].inputPath = scenes[i];
+		jobs[i].outputPath = format == "none" ? QString() : outputPath;
+	}
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(jobCount);
+
+	QElapsedTimer wallTimer;
+	wallTimer.start();
+	bool antialiasing = !parser.isSet(aliasedOption);
+	bool reportMemory = parser.isSet(memoryOption);
+	for (BatchJob& job : jobs) {
+		SharedFramebuffer* sharedFrames = shared.get();
+		pool.start([&job, canvasSize, antialiasing, reportMemory, backendKind, sharedFrames]() {
+			renderJob(job, canvasSize, antialiasing, reportMemory, backendKind, sharedFrames);
+			});
+	}
+	pool.waitForDone();
+	qint64 wallNs = wallTimer.nsecsElapsed();
+
+	double canvasMegapixels = static_cast<double>(canvasSize.width()) * canvasSize.height() / 1e6;
+	int failed = 0;
+	qint64 totalShapes = 0;
+
+	out << QString("%1 %2 %3 %4 %5 %6 %7  %8\n")
+		.arg("scene", -32).arg("shapes", 8).arg("load ms", 9).arg("render ms", 10).arg("save ms", 9).arg("shapes/s", 12).arg("Mpx/s", 9).arg("status");
+	for (const BatchJob& job : jobs) {
+		double renderSeconds = job.renderNs / 1e9;
+		double shapesPerSecond = renderSeconds > 0 ? job.shapeCount / renderSeconds : 0.0;
+		double megapixelsPerSecond = renderSeconds > 0 ? canvasMegapixels / renderSeconds : 0.0;
+		QString status = job.ok ? QString("ok") : QString("FAILED: %1").arg(job.error);
+		if (job.ok && job.skippedShapes > 0) {
+			status = QString("ok (%1 invalid shapes skipped)").arg(job.skippedShapes);
+		}
+
+		out << QString("%1 %2 %3 %4 %5 %6 %7  %8\n")
+			.arg(QFileInfo(job.inputPath).fileName(), -32)
+			.arg(job.shapeCount, 8)
+			.arg(job.loadNs / 1e6, 9, 'f', 2)
+			.arg(job.renderNs / 1e6, 10, 'f', 2)
+			.arg(job.saveNs / 1e6, 9, 'f', 2)
+			.arg(shapesPerSecond, 12, 'f', 0)
+			.arg(megapixelsPerSecond, 9, 'f', 1)
+			.arg(status);
+
+		if (!job.memoryReport.isEmpty()) {
+			out << job.memoryReport << "\n\n";
+		}
+
+		totalShapes += job.shapeCount;
+		if (!job.ok) {
+			failed++;
+		}
+	}
+
+	double wallSeconds = wallNs / 1e9;
+	out << QString("\n%1 scenes (%2 failed), %3 shapes, %4x%5 canvas, %6 jobs, %7 backend\n")
+		.arg(jobs.size()).arg(failed).arg(totalShapes).arg(canvasSize.width()).arg(canvasSize.height()).arg(jobCount).arg(RenderBackend::kindName(backendKind));
+	out << QString("wall %1 s, %2 scenes/s, %3 shapes/s\n")
+		.arg(wallSeconds, 0, 'f', 3)
+		.arg(wallSeconds > 0 ? jobs.size() / wallSeconds : 0.0, 0, 'f', 1)
+		.arg(wallSeconds > 0 ? totalShapes / wallSeconds : 0.0, 0, 'f', 0);
+
+	RenderLog::flush();
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QTextStream>
+#include "CompactScene.h"
+#include "SceneFile.h"
+#include "SceneGenerator.h"
+
+// Generator proceduralnych scen pre benchmarky (RenderBatch, RasterBench): rovnaky seed a nastavenia
+// daju rovnaky subor. .csv sa zapisuje priebezne tvar po tvare, .cscene (kompaktny binarny format)
+// sa postavi v pamati a ulozi naraz - nacita sa radovo rychlejsie ako CSV.
+
+static bool parseCanvasSize(const QString& text, QSize& size)
+{
+	QStringList parts = text.toLower().split('x');
+	if (parts.size() != 2) {
+		return false;
+	}
+
+	bool okWidth = false, okHeight = false;
+	int width = parts[0].toInt(&okWidth);
+	int height = parts[1].toInt(&okHeight);
+	if (!okWidth || !okHeight || width <= 0 || height <= 0) {
+		return false;
+	}
+
+	size = QSize(width, height);
+	return true;
+}
+
+// "MIN:MAX" alebo jedno cislo (MIN = MAX)
+static bool parseRange(const QString& text, int& low, int& high)
+{
+	QStringList parts = text.split(':');
+	if (parts.size() > 2) {
+		return false;
+	}
+
+	bool okLow = false, okHigh = true;
+	low = parts[0].toInt(&okLow);
+	high = parts.size() == 2 ? parts[1].toInt(&okHigh) : low;
+	return okLow && okHigh;
+}
+
+// Pocty mozu mat priponu k/M (napr. 250k, 10M)
+static bool parseCount(const QString& text, qint64& count)
+{
+	QString number = text.trimmed();
+	qint64 scale = 1;
+	if (number.endsWith('k') || number.endsWith('K')) {
+		scale = 1000;
+		number.chop(1);
+	}
+	else if (number.endsWith('m') || number.endsWith('M')) {
+		scale = 1000000;
+		number.chop(1);
+	}
+
+	bool ok = false;
+	count = number.toLongLong(&ok) * scale;
+	return ok && count >= 0;
+}
+
+static bool writeCsv(SceneGenerator& generator, const QString& path, QString* errorMessage)
+{
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+		*errorMessage = file.errorString();
+		return false;
+	}
+
+	QTextStream out(&file);
+	out << SceneFile::CsvHeader << "\n";
+	generator.generate([&out](Shape& shape) {
+		out << SceneFile::toCsvRow(shape, shape.getZBufferPosition()) << "\n";
+		});
+	out.flush();
+
+	if (out.status() != QTextStream::Ok || !file.commit()) {
+		*errorMessage = file.errorString();
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	QLocale::setDefault(QLocale::c());
+
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("MPM");
+	QCoreApplication::setApplicationName("SceneGen");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Deterministic procedural scene generator for benchmarks.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("output", "Scene file to write: *.csv (editor format) or *.cscene (compact binary).");
+
+	QCommandLineOption sizeOption(QStringList() << "s" << "size", "Canvas size WIDTHxHEIGHT (default 1920x1080).", "size", "1920x1080");
+	QCommandLineOption countOption(QStringList() << "n" << "count", "Total shape count split evenly between all types (suffix k/M allowed).", "count");
+	QCommandLineOption linesOption("lines", "Number of lines.", "count");
+	QCommandLineOption rectanglesOption("rectangles", "Number of rectangles.", "count");
+	QCommandLineOption polygonsOption("polygons", "Number of polygons.", "count");
+	QCommandLineOption circlesOption("circles", "Number of circles.", "count");
+	QCommandLineOption curvesOption("curves", "Number of Bezier curves.", "count");
+	QCommandLineOption verticesOption("vertices", "Polygon vertex count MIN:MAX (default 3:8).", "range", "3:8");
+	QCommandLineOption curvePointsOption("curve-points", "Bezier control point count MIN:MAX (default 3:4).", "range", "3:4");
+	QCommandLineOption fillOption("fill", "Fraction of filled rectangles, polygons and circles (default 0.5).", "ratio", "0.5");
+	QCommandLineOption overlapOption("overlap", "Average number of shape bounds covering a canvas pixel (default 2).", "depth", "2");
+	QCommandLineOption offCanvasOption("off-canvas", "Fraction of shapes placed entirely outside the canvas (default 0).", "ratio", "0");
+	QCommandLineOption seedOption("seed", "Random seed (default 1).", "seed", "1");
+	parser.addOption(sizeOption);
+	parser.addOption(countOption);
+	parser.addOption(linesOption);
+	parser.addOption(rectanglesOption);
+	parser.addOption(polygonsOption);
+	parser.addOption(circlesOption);
+	parser.addOption(curvesOption);
+	parser.addOption(verticesOption);
+	parser.addOption(curvePointsOption);
+	parser.addOption(fillOption);
+	parser.addOption(overlapOption);
+	parser.addOption(offCanvasOption);
+	parser.addOption(seedOption);
+	parser.process(app);
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	if (parser.positionalArguments().size() != 1) {
+		err << "Exactly one output file is required.\n";
+		parser.showHelp(2);
+	}
+	QString outputPath = parser.positionalArguments().first();
+	QString suffix = QFileInfo(outputPath).suffix().toLower();
+	if (suffix != "csv" && suffix != CompactScene::FileSuffix) {
+		err << "Unsupported output format: " << suffix << " (use .csv or .cscene)\n";
+		return 2;
+	}
+
+	SceneGenerator::Settings settings;
+	if (!parseCanvasSize(parser.value(sizeOption), settings.canvasSize)) {
+		err << "Invalid canvas size: " << parser.value(sizeOption) << "\n";
+		return 2;
+	}
+
+	// --count rozdeli pocet rovnomerne (zvysok dostanu prve typy), konkretne typy ho prepisu
+	if (parser.isSet(countOption)) {
+		qint64 total = 0;
+		if (!parseCount(parser.value(countOption), total)) {
+			err << "Invalid shape count: " << parser.value(countOption) << "\n";
+			return 2;
+		}
+		for (int type = 0; type < 5; type++) {
+			settings.counts[type] = total / 5 + (type < total % 5 ? 1 : 0);
+		}
+	}
+	const QCommandLineOption* typeOptions[5] = { &linesOption, &rectanglesOption, &polygonsOption, &circlesOption, &curvesOption };
+	for (int type = 0; type < 5; type++) {
+		if (parser.isSet(*typeOptions[type]) && !parseCount(parser.value(*typeOptions[type]), settings.counts[type])) {
+			err << "Invalid shape count: " << parser.value(*typeOptions[type]) << "\n";
+			return 2;
+		}
+	}
+
+	if (!parseRange(parser.value(verticesOption), settings.minVertices, settings.maxVertices)) {
+		err << "Invalid vertex range: " << parser.value(verticesOption) << "\n";
+		return 2;
+	}
+	if (!parseRange(parser.value(curvePointsOption), settings.minCurvePoints, settings.maxCurvePoints)) {
+		err << "Invalid curve point range: " << parser.value(curvePointsOption) << "\n";
+		return 2;
+	}
+
+	bool okFill = false, okOverlap = false, okOffCanvas = false, okSeed = false;
+	settings.fillRatio = parser.value(fillOption).toDouble(&okFill);
+	settings.overlap = parser.value(overlapOption).toDouble(&okOverlap);
+	settings.offCanvas = parser.value(offCanvasOption).toDouble(&okOffCanvas);
+	settings.seed = parser.value(seedOption).toUInt(&okSeed);
+	if (!okFill || !okOverlap || !okOffCanvas || !okSeed) {
+		err << "Invalid --fill, --overlap, --off-canvas or --seed value.\n";
+		return 2;
+	}
+
+	QString problem = settings.validate();
+	if (!problem.isEmpty()) {
+		err << problem << "\n";
+		return 2;
+	}
+
+	SceneGenerator generator(settings);
+	QElapsedTimer timer;
+	timer.start();
+	QString errorMessage;
+	qint64 generateNs = 0;
+	qint64 writeNs = 0;
+
+	if (suffix == "csv") {
+		if (!writeCsv(generator, outputPath, &errorMessage)) {
+			err << "Unable to write " << outputPath << ": " << errorMessage << "\n";
+			return 1;
+		}
+		writeNs = timer.nsecsElapsed();
+	}
+	else {
+		CompactScene scene;
+		generator.generate(scene);
+		generateNs = timer.nsecsElapsed();
+		timer.restart();
+		if (!scene.save(outputPath, &errorMessage)) {
+			err << "Unable to write " << outputPath << ": " << errorMessage << "\n";
+			return 1;
+		}
+		writeNs = timer.nsecsElapsed();
+	}
+
+	out << QString("%1: %2 shapes (lines %3, rectangles %4, polygons %5, circles %6, curves %7)\n")
+		.arg(QFileInfo(outputPath).fileName()).arg(settings.totalShapes())
+		.arg(settings.counts[Shape::LINE]).arg(settings.counts[Shape::RECTANGLE]).arg(settings.counts[Shape::POLYGON])
+		.arg(settings.counts[Shape::CIRCLE]).arg(settings.counts[Shape::BEZIER_CURVE]);
+	out << QString("canvas %1x%2, mean shape size %3 px, seed %4\n")
+		.arg(settings.canvasSize.width()).arg(settings.canvasSize.height()).arg(generator.getShapeSize(), 0, 'f', 1).arg(settings.seed);
+	if (generateNs > 0) {
+		out << QString("generate %1 ms, ").arg(generateNs / 1e6, 0, 'f', 1);
+	}
+	out << QString("write %1 ms, %2 MB\n").arg(writeNs / 1e6, 0, 'f', 1).arg(QFileInfo(outputPath).size() / 1e6, 0, 'f', 1);
+	return 0;
+}